@@ -0,0 +1,93 @@
+// Measures the throughput of bit vector operations for vectors of sizes from
+// 64 kilobits up to the given maximum number of bits.
+//
+// Usage: bitvec [max number of bits]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+typedef struct {
+    bitvec a;
+    bitvec b;
+} bitvec_ctx;
+
+static void bench_and(void *ctx, ullong iterations) {
+    bitvec_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bitvec_and(&c->a, &c->b);
+    }
+    bench_keep(c->a.words[0]);
+}
+
+static void bench_xor(void *ctx, ullong iterations) {
+    bitvec_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bitvec_xor(&c->a, &c->b);
+    }
+    bench_keep(c->a.words[0]);
+}
+
+static void bench_count(void *ctx, ullong iterations) {
+    bitvec_ctx *c = ctx;
+    size_t count = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        count += bitvec_count(&c->b);
+    }
+    bench_keep(count);
+}
+
+static void bench_iter(void *ctx, ullong iterations) {
+    bitvec_ctx *c = ctx;
+    size_t sum = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bitvec_iter it;
+        size_t bit;
+        bitvec_iter_init(&it, &c->b);
+        while (bitvec_iter_next(&it, &bit)) {
+            sum += bit;
+        }
+    }
+    bench_keep(sum);
+}
+
+static void bench_print(const char *name, bench_fun fn, bitvec_ctx *ctx) {
+    size_t bytes = bitvec_word_count(ctx->b.len) * sizeof(ullong);
+    bench_result res = bench_run(fn, ctx, bench_default_min_ns);
+    cstr_fmt_float gbs = {bench_gb_per_sec(res, bytes), 2};
+    cstr_fmt_float ns = {bench_ns_per_op(res), 1};
+    io_stdout_fmt("S\tU\tF\tF\n", name, (ullong)ctx->b.len, gbs, ns);
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t max_bits = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 26);
+
+    io_stdout_write_sstr("op\tbits\tgb_per_s\tns\n");
+    for (size_t bits = 1UL << 16; bits <= max_bits; bits *= 4) {
+        bitvec_ctx ctx;
+        if (!bitvec_init(&ctx.a, bits, &std_allocator)
+            || !bitvec_init(&ctx.b, bits, &std_allocator)) {
+            io_stderr_write_sstr("allocation failed!\n");
+            io_stderr_flush();
+            return 1;
+        }
+        // about one bit in eight is set
+        ullong state = 1;
+        for (size_t i = 0; i < bits; i += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            if ((state >> 61) == 0) {
+                bitvec_set(&ctx.b, i);
+            }
+        }
+        bitvec_fill(&ctx.a, true);
+
+        bench_print("and", bench_and, &ctx);
+        bench_print("xor", bench_xor, &ctx);
+        bench_print("count", bench_count, &ctx);
+        bench_print("iter", bench_iter, &ctx);
+
+        bitvec_free(&ctx.a);
+        bitvec_free(&ctx.b);
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+// Compares bytes_copy, bytes_move and bytes_set against libc memcpy, memmove
+// and memset. Built with JP_DISABLE_STRING_H so that the custom
+// implementations are used for the bytes_* functions.
+//
+// Usage: bytes_copy [max size in bytes]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+#include <string.h>
+
+// Offset of the source in overlapping moves
+#define move_shift 33
+
+typedef struct {
+    uchar *dest;
+    uchar *src;
+    size_t len;
+} copy_ctx;
+
+static void bench_bytes_copy(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bytes_copy(c->dest, c->src, c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_memcpy(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        memcpy(c->dest, c->src, c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_bytes_move(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bytes_move(c->dest + move_shift, c->dest, c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_memmove(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        memmove(c->dest + move_shift, c->dest, c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_bytes_set(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bytes_set(c->dest, (int)(i & 0xFF), c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_memset(void *ctx, ullong iterations) {
+    copy_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        memset(c->dest, (int)(i & 0xFF), c->len);
+        bench_keep(c->dest);
+    }
+}
+
+static void bench_compare(
+    const char *name, bench_fun custom, bench_fun libc, copy_ctx *ctx
+) {
+    ullong min_ns = bench_default_min_ns;
+    bench_result custom_res = bench_run(custom, ctx, min_ns);
+    bench_result libc_res = bench_run(libc, ctx, min_ns);
+    cstr_fmt_float custom_gbs = {bench_gb_per_sec(custom_res, ctx->len), 2};
+    cstr_fmt_float libc_gbs = {bench_gb_per_sec(libc_res, ctx->len), 2};
+    cstr_fmt_float custom_ns = {bench_ns_per_op(custom_res), 1};
+    cstr_fmt_float libc_ns = {bench_ns_per_op(libc_res), 1};
+    io_stdout_fmt(
+        "S\tU\tF\tF\tF\tF\n",
+        name,
+        (ullong)ctx->len,
+        custom_gbs,
+        libc_gbs,
+        custom_ns,
+        libc_ns
+    );
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t max_size = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 30);
+
+    allocation dest = alloc_new(&mmap_allocator, uchar, max_size + 64);
+    allocation src = alloc_new(&mmap_allocator, uchar, max_size + 64);
+    if (!allocation_exists(dest) || !allocation_exists(src)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+
+    // fault in the pages before measuring
+    memset(dest.ptr, 1, dest.len);
+    memset(src.ptr, 2, src.len);
+
+    io_stdout_write_sstr(
+        "op\tsize\tbytes_gb_per_s\tlibc_gb_per_s\tbytes_ns\tlibc_ns\n"
+    );
+    copy_ctx ctx = {.dest = dest.ptr, .src = src.ptr};
+    for (size_t len = 1; len <= max_size; len *= 2) {
+        ctx.len = len;
+        bench_compare("copy", bench_bytes_copy, bench_memcpy, &ctx);
+        bench_compare("move", bench_bytes_move, bench_memmove, &ctx);
+        bench_compare("set", bench_bytes_set, bench_memset, &ctx);
+    }
+
+    alloc_free(&mmap_allocator, dest);
+    alloc_free(&mmap_allocator, src);
+    return 0;
+}
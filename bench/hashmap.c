@@ -0,0 +1,134 @@
+// Compares hash map lookups against a binary search over a sorted dynamic
+// array of the same keys. Half of the lookups hit and half miss.
+//
+// Usage: hashmap [max number of keys]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+#define key_size 16
+
+typedef struct {
+    slice_const key;
+    size_t value;
+} sorted_entry;
+
+typedef struct {
+    hashmap map;
+    sorted_entry *sorted;
+    const uchar *keys;
+    const uchar *misses;
+    size_t len;
+} lookup_ctx;
+
+static int sorted_entry_cmp(const void *a, const void *b) {
+    const sorted_entry *ea = a;
+    const sorted_entry *eb = b;
+    return slice_const_cmp(ea->key, eb->key);
+}
+
+static const sorted_entry *
+sorted_find(const sorted_entry *entries, size_t len, slice_const key) {
+    size_t lo = 0;
+    size_t hi = len;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = slice_const_cmp(entries[mid].key, key);
+        if (cmp == 0) {
+            return &entries[mid];
+        }
+        if (cmp < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return NULL;
+}
+
+static slice_const lookup_key(lookup_ctx *c, ullong i) {
+    size_t index = (size_t)((i * 0x9E3779B97F4A7C15ULL) >> 11) % c->len;
+    const uchar *keys = (i & 1) ? c->misses : c->keys;
+    return slice_const_new(keys + index * key_size, key_size);
+}
+
+static void bench_hashmap(void *ctx, ullong iterations) {
+    lookup_ctx *c = ctx;
+    size_t sum = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        size_t *value = hashmap_get(&c->map, lookup_key(c, i));
+        sum += value ? *value : 1;
+    }
+    bench_keep(sum);
+}
+
+static void bench_sorted(void *ctx, ullong iterations) {
+    lookup_ctx *c = ctx;
+    size_t sum = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        const sorted_entry *e =
+            sorted_find(c->sorted, c->len, lookup_key(c, i));
+        sum += e ? e->value : 1;
+    }
+    bench_keep(sum);
+}
+
+static void bench_print(const char *name, bench_fun fn, lookup_ctx *ctx) {
+    bench_result res = bench_run(fn, ctx, bench_default_min_ns);
+    cstr_fmt_float ns = {bench_ns_per_op(res), 1};
+    io_stdout_fmt("S\tU\tF\n", name, (ullong)ctx->len, ns);
+    io_stdout_flush();
+}
+
+static void fill_keys(uchar *keys, size_t count, ullong seed) {
+    for (size_t i = 0; i < count * key_size; i += sizeof(ullong)) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        ullong x = seed ^ (seed >> 29);
+        bytes_copy(keys + i, &x, sizeof(x));
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t max_len = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 20);
+
+    allocation keys = alloc_new(&std_allocator, uchar, max_len * key_size);
+    allocation misses = alloc_new(&std_allocator, uchar, max_len * key_size);
+    if (!allocation_exists(keys) || !allocation_exists(misses)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+    fill_keys(keys.ptr, max_len, 1);
+    fill_keys(misses.ptr, max_len, 2);
+
+    io_stdout_write_sstr("op\tkeys\tns\n");
+    for (size_t len = 16; len <= max_len; len *= 4) {
+        lookup_ctx ctx = {.keys = keys.ptr, .misses = misses.ptr, .len = len};
+        ctx.sorted = dynarr_new(len, sorted_entry, &std_allocator);
+        if (!ctx.sorted ||
+            !hashmap_init(&ctx.map, len, size_t, &std_allocator)) {
+            io_stderr_write_sstr("allocation failed!\n");
+            io_stderr_flush();
+            return 1;
+        }
+        for (size_t i = 0; i < len; i += 1) {
+            slice_const key =
+                slice_const_new(ctx.keys + i * key_size, key_size);
+            size_t *value = hashmap_put(&ctx.map, key, NULL);
+            *value = i;
+            sorted_entry e = {key, i};
+            dynarr_push(ctx.sorted, &e, 1);
+        }
+        qsort(ctx.sorted, len, sizeof(sorted_entry), sorted_entry_cmp);
+
+        bench_print("hashmap", bench_hashmap, &ctx);
+        bench_print("sorted", bench_sorted, &ctx);
+
+        hashmap_free(&ctx.map);
+        dynarr_free(ctx.sorted);
+    }
+
+    alloc_free(&std_allocator, keys);
+    alloc_free(&std_allocator, misses);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Compares memory mapping options by page faults and TLB misses. The fault
+// workload maps a buffer, touches every page, and unmaps it. The TLB workload
+// reads random cache lines from a buffer that was mapped once.
+//
+// Usage: mmap_alloc [buffer size in bytes]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+#include <sys/resource.h>
+
+typedef struct {
+    allocator alloc;
+    const uchar *buffer;
+    size_t buffer_len;
+    size_t size;
+    size_t page_size;
+} mmap_ctx;
+
+static void touch_pages(uchar *bytes, size_t size, size_t page_size) {
+    for (size_t i = 0; i < size; i += page_size) {
+        bytes[i] = (uchar)i;
+    }
+}
+
+static void bench_map_touch(void *ctx, ullong iterations) {
+    mmap_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        allocation a = alloc_malloc(&c->alloc, c->size, 1);
+        if (!allocation_exists(a)) {
+            return;
+        }
+        touch_pages(a.ptr, a.len, c->page_size);
+        bench_keep(a.ptr);
+        alloc_free(&c->alloc, a);
+    }
+}
+
+#define random_reads 4096
+
+static void bench_random_read(void *ctx, ullong iterations) {
+    mmap_ctx *c = ctx;
+    const uchar *bytes = c->buffer;
+    size_t lines = c->buffer_len / 64;
+    ullong state = 1, sum = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        for (size_t r = 0; r < random_reads; r += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            sum += bytes[((size_t)(state >> 33) % lines) * 64];
+        }
+    }
+    bench_keep(sum);
+}
+
+static ullong minor_faults(void) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+    return (ullong)usage.ru_minflt;
+}
+
+static void bench_print(const char *name, mmap_options *options, size_t size) {
+    mmap_ctx ctx = {
+        .alloc = mmap_allocator_new(options),
+        .size = size,
+        .page_size = (size_t)sysconf(_SC_PAGE_SIZE),
+    };
+
+    // faults of a single map and touch
+    ullong faults = minor_faults();
+    bench_map_touch(&ctx, 1);
+    faults = minor_faults() - faults;
+    bench_result map_res =
+        bench_run(bench_map_touch, &ctx, bench_default_min_ns);
+
+    allocation buffer = alloc_malloc(&ctx.alloc, size, 1);
+    if (!allocation_exists(buffer)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return;
+    }
+    touch_pages(buffer.ptr, buffer.len, ctx.page_size);
+    ctx.buffer = buffer.ptr;
+    ctx.buffer_len = buffer.len;
+    bench_result read_res =
+        bench_run(bench_random_read, &ctx, bench_default_min_ns);
+    alloc_free(&ctx.alloc, buffer);
+
+    cstr_fmt_float map_us = {bench_ns_per_op(map_res) / 1000.0, 1};
+    cstr_fmt_float read_ns = {bench_ns_per_op(read_res) / random_reads, 2};
+    io_stdout_fmt(
+        "S\tU\tU\tF\tF\n", name, (ullong)size, faults, map_us, read_ns
+    );
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t size = bench_arg_size(argc > 1 ? argv[1] : NULL, 256UL << 20);
+
+    io_stdout_write_sstr("op\tsize\tfaults\tmap_touch_us\tread_ns\n");
+    mmap_options options = {0};
+    bench_print("plain", &options, size);
+    options.flags = mmap_flag_populate;
+    bench_print("populate", &options, size);
+    options.flags = mmap_flag_transparent_huge_pages;
+    bench_print("thp", &options, size);
+    options.flags = mmap_flag_transparent_huge_pages | mmap_flag_populate;
+    bench_print("thp_populate", &options, size);
+    options.flags = mmap_flag_huge_pages;
+    bench_print("hugetlb", &options, size);
+    return 0;
+}
@@ -0,0 +1,101 @@
+// Compares the pool allocator to std_malloc for same-sized nodes. Each
+// workload allocates the given number of nodes, then either frees them all or
+// keeps replacing random nodes.
+//
+// Usage: pool [number of nodes] [node size]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+typedef struct {
+    allocator *alloc;
+    void **nodes;
+    size_t count;
+    size_t node_size;
+} pool_ctx;
+
+static void *node_alloc(pool_ctx *c) {
+    return alloc_malloc(c->alloc, c->node_size, 8).ptr;
+}
+
+static void node_free(pool_ctx *c, void *node) {
+    allocation a = {.ptr = node, .len = c->node_size};
+    alloc_free(c->alloc, a);
+}
+
+static void bench_fill_free(void *ctx, ullong iterations) {
+    pool_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        for (size_t n = 0; n < c->count; n += 1) {
+            c->nodes[n] = node_alloc(c);
+            *(size_t *)c->nodes[n] = n;
+        }
+        for (size_t n = 0; n < c->count; n += 1) {
+            node_free(c, c->nodes[n]);
+        }
+    }
+    bench_keep(c->nodes[0]);
+}
+
+static void bench_churn(void *ctx, ullong iterations) {
+    pool_ctx *c = ctx;
+    for (size_t n = 0; n < c->count; n += 1) {
+        c->nodes[n] = node_alloc(c);
+    }
+    ullong state = 1;
+    for (ullong i = 0; i < iterations; i += 1) {
+        for (size_t n = 0; n < c->count; n += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            size_t victim = (size_t)(state >> 33) % c->count;
+            node_free(c, c->nodes[victim]);
+            c->nodes[victim] = node_alloc(c);
+            *(size_t *)c->nodes[victim] = n;
+        }
+    }
+    for (size_t n = 0; n < c->count; n += 1) {
+        node_free(c, c->nodes[n]);
+    }
+    bench_keep(c->nodes[0]);
+}
+
+static void bench_print(const char *name, bench_fun fn, pool_ctx *ctx) {
+    bench_result res = bench_run(fn, ctx, bench_default_min_ns);
+    // one allocation and one free per node
+    cstr_fmt_float ns = {bench_ns_per_op(res) / (double)ctx->count, 2};
+    io_stdout_fmt(
+        "S\tU\tU\tF\n", name, (ullong)ctx->count, (ullong)ctx->node_size, ns
+    );
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t count = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 20);
+    size_t node_size = bench_arg_size(argc > 2 ? argv[2] : NULL, 48);
+    node_size = max(node_size, sizeof(size_t));
+
+    allocation nodes = alloc_new(&std_allocator, void *, count);
+    if (!allocation_exists(nodes)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+
+    pool p;
+    pool_init(&p, node_size, 8, 0, 0, &mmap_allocator);
+    allocator pool_alloc = pool_allocator_new(&p);
+
+    io_stdout_write_sstr("op\tnodes\tnode_size\tns_per_node\n");
+    pool_ctx ctx = {
+        .nodes = nodes.ptr, .count = count, .node_size = node_size
+    };
+    ctx.alloc = &std_allocator;
+    bench_print("std_fill_free", bench_fill_free, &ctx);
+    bench_print("std_churn", bench_churn, &ctx);
+    ctx.alloc = &pool_alloc;
+    bench_print("pool_fill_free", bench_fill_free, &ctx);
+    bench_print("pool_churn", bench_churn, &ctx);
+
+    pool_release(&p);
+    alloc_free(&std_allocator, nodes);
+    return 0;
+}
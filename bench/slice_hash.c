@@ -0,0 +1,78 @@
+// Measures the throughput of slice_hash64, slice_hash128 and the incremental
+// hash for key sizes from 8 bytes up to the given maximum.
+//
+// Usage: slice_hash [max size in bytes]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+typedef struct {
+    const uchar *data;
+    size_t len;
+} hash_ctx;
+
+static void bench_hash64(void *ctx, ullong iterations) {
+    hash_ctx *c = ctx;
+    ullong h = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        // chain the hashes so that calls can not be overlapped or removed
+        h = slice_hash64(slice_const_new(c->data, c->len), h);
+    }
+    bench_keep(h);
+}
+
+static void bench_hash128(void *ctx, ullong iterations) {
+    hash_ctx *c = ctx;
+    hash128 h = {0};
+    for (ullong i = 0; i < iterations; i += 1) {
+        h = slice_hash128(slice_const_new(c->data, c->len), h.lo ^ h.hi);
+    }
+    bench_keep(h.lo);
+}
+
+static void bench_hash_incremental(void *ctx, ullong iterations) {
+    hash_ctx *c = ctx;
+    ullong h = 0;
+    for (ullong i = 0; i < iterations; i += 1) {
+        slice_hash_state state;
+        slice_hash_init(&state, h);
+        slice_hash_update(&state, slice_const_new(c->data, c->len));
+        h = slice_hash_final64(&state);
+    }
+    bench_keep(h);
+}
+
+static void bench_print(const char *name, bench_fun fn, hash_ctx *ctx) {
+    bench_result res = bench_run(fn, ctx, bench_default_min_ns);
+    cstr_fmt_float gbs = {bench_gb_per_sec(res, ctx->len), 2};
+    cstr_fmt_float ns = {bench_ns_per_op(res), 1};
+    io_stdout_fmt("S\tU\tF\tF\n", name, (ullong)ctx->len, gbs, ns);
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t max_size = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 20);
+
+    allocation data = alloc_new(&std_allocator, uchar, max_size);
+    if (!allocation_exists(data)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+    uchar *bytes = data.ptr;
+    for (size_t i = 0; i < max_size; i += 1) {
+        bytes[i] = (uchar)(i * 131 + (i >> 8));
+    }
+
+    io_stdout_write_sstr("op\tsize\tgb_per_s\tns\n");
+    hash_ctx ctx = {.data = bytes};
+    for (size_t len = 8; len <= max_size; len *= 2) {
+        ctx.len = len;
+        bench_print("hash64", bench_hash64, &ctx);
+        bench_print("hash128", bench_hash128, &ctx);
+        bench_print("incremental", bench_hash_incremental, &ctx);
+    }
+
+    alloc_free(&std_allocator, data);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// Compares the radix sorts to qsort for arrays of random numbers of the given
+// maximum size.
+//
+// Usage: sort_radix [max number of items]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+typedef struct {
+    const uchar *input;
+    uchar *keys;
+    size_t len;
+    size_t key_size;
+    uint key_kind;
+    int (*cmp)(const void *, const void *);
+} sort_ctx;
+
+static int cmp_uint(const void *a, const void *b) {
+    uint x = *(const uint *)a, y = *(const uint *)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_llong(const void *a, const void *b) {
+    llong x = *(const llong *)a, y = *(const llong *)b;
+    return (x > y) - (x < y);
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_radix(void *ctx, ullong iterations) {
+    sort_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bytes_copy(c->keys, c->input, c->len * c->key_size);
+        sort_radix_ut(
+            c->keys, NULL, c->len, c->key_size, c->key_kind, &std_allocator
+        );
+    }
+    bench_keep(c->keys[0]);
+}
+
+static void bench_qsort(void *ctx, ullong iterations) {
+    sort_ctx *c = ctx;
+    for (ullong i = 0; i < iterations; i += 1) {
+        bytes_copy(c->keys, c->input, c->len * c->key_size);
+        qsort(c->keys, c->len, c->key_size, c->cmp);
+    }
+    bench_keep(c->keys[0]);
+}
+
+static void bench_print(const char *name, bench_fun fn, sort_ctx *ctx) {
+    bench_result res = bench_run(fn, ctx, bench_default_min_ns);
+    cstr_fmt_float ns = {bench_ns_per_op(res) / (double)ctx->len, 2};
+    io_stdout_fmt("S\tU\tF\n", name, (ullong)ctx->len, ns);
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t max_len = bench_arg_size(argc > 1 ? argv[1] : NULL, 1UL << 20);
+
+    allocation input = alloc_new(&std_allocator, ullong, max_len);
+    allocation keys = alloc_new(&std_allocator, ullong, max_len);
+    if (!allocation_exists(input) || !allocation_exists(keys)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+
+    io_stdout_write_sstr("op\titems\tns_per_item\n");
+    for (size_t len = 1024; len <= max_len; len *= 4) {
+        sort_ctx ctx = {.input = input.ptr, .keys = keys.ptr, .len = len};
+        ullong state = 1;
+
+        uint *u = input.ptr;
+        for (size_t i = 0; i < len; i += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            u[i] = (uint)(state >> 32);
+        }
+        ctx.key_size = sizeof(uint);
+        ctx.key_kind = sort_key_unsigned;
+        ctx.cmp = cmp_uint;
+        bench_print("radix_uint", bench_radix, &ctx);
+        bench_print("qsort_uint", bench_qsort, &ctx);
+
+        llong *l = input.ptr;
+        for (size_t i = 0; i < len; i += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            l[i] = (llong)state;
+        }
+        ctx.key_size = sizeof(llong);
+        ctx.key_kind = sort_key_signed;
+        ctx.cmp = cmp_llong;
+        bench_print("radix_llong", bench_radix, &ctx);
+        bench_print("qsort_llong", bench_qsort, &ctx);
+
+        double *d = input.ptr;
+        for (size_t i = 0; i < len; i += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            d[i] = (double)(llong)state / 1e6;
+        }
+        ctx.key_kind = sort_key_float;
+        ctx.cmp = cmp_double;
+        bench_print("radix_double", bench_radix, &ctx);
+        bench_print("qsort_double", bench_qsort, &ctx);
+    }
+
+    alloc_free(&std_allocator, input);
+    alloc_free(&std_allocator, keys);
+    return 0;
+}
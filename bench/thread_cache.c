@@ -0,0 +1,115 @@
+// Compares the thread-caching allocator to std_malloc when several threads
+// allocate and free short-lived buffers at the same time. Each thread keeps a
+// small set of live buffers and keeps replacing random ones with buffers of
+// random sizes up to 4 KiB.
+//
+// Usage: thread_cache [max number of threads] [operations per thread]
+#include "benchr.h"
+#include "io.h"
+#include "mt.h"
+#include "std.h"
+#include <pthread.h>
+
+#define live_buffers 64
+
+typedef struct {
+    allocator *alloc;
+    size_t ops;
+    ullong seed;
+} worker_ctx;
+
+static void *worker_f(void *ctx) {
+    worker_ctx *w = ctx;
+    void *ptrs[live_buffers] = {0};
+    size_t lens[live_buffers] = {0};
+    ullong state = w->seed;
+    for (size_t i = 0; i < w->ops; i += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t slot = (size_t)(state >> 33) % live_buffers;
+        if (ptrs[slot]) {
+            allocation a = {.ptr = ptrs[slot], .len = lens[slot]};
+            alloc_free(w->alloc, a);
+        }
+        allocation a = alloc_malloc(w->alloc, 16 + (size_t)(state >> 52), 8);
+        ptrs[slot] = a.ptr;
+        lens[slot] = a.len;
+        if (a.ptr) {
+            *(uchar *)a.ptr = (uchar)i;
+        }
+    }
+    for (size_t i = 0; i < live_buffers; i += 1) {
+        if (ptrs[i]) {
+            allocation a = {.ptr = ptrs[i], .len = lens[i]};
+            alloc_free(w->alloc, a);
+        }
+    }
+    bench_keep(ptrs[0]);
+    return NULL;
+}
+
+typedef struct {
+    allocator *alloc;
+    thread_cache *tc;
+    size_t threads;
+    size_t ops;
+} run_ctx;
+
+static void *cached_worker_f(void *ctx) {
+    worker_ctx *w = ctx;
+    worker_f(w);
+    thread_cache_flush(w->alloc->ctx);
+    return NULL;
+}
+
+// Run the workers once and return the elapsed time
+static ullong run_workers(run_ctx *c) {
+    pthread_t threads[64];
+    worker_ctx workers[64];
+    ullong start = bench_now_ns();
+    for (size_t i = 0; i < c->threads; i += 1) {
+        workers[i] = (worker_ctx) {
+            .alloc = c->alloc, .ops = c->ops, .seed = i + 1
+        };
+        pthread_create(
+            &threads[i], NULL, c->tc ? cached_worker_f : worker_f, &workers[i]
+        );
+    }
+    for (size_t i = 0; i < c->threads; i += 1) {
+        pthread_join(threads[i], NULL);
+    }
+    return bench_now_ns() - start;
+}
+
+static void bench_print(const char *name, run_ctx *ctx) {
+    // best of a few runs to filter out scheduling noise
+    ullong best = ULLONG_MAX;
+    for (size_t i = 0; i < 5; i += 1) {
+        best = min(best, run_workers(ctx));
+    }
+    // one allocation and one free per operation
+    cstr_fmt_float ns = {(double)best / (double)ctx->ops, 2};
+    io_stdout_fmt("S\tU\tF\n", name, (ullong)ctx->threads, ns);
+    io_stdout_flush();
+}
+
+int main(int argc, char **argv) {
+    size_t max_threads = bench_arg_size(argc > 1 ? argv[1] : NULL, 8);
+    size_t ops = bench_arg_size(argc > 2 ? argv[2] : NULL, 1000000);
+    max_threads = clamp(max_threads, (size_t)1, (size_t)64);
+
+    thread_cache tc;
+    thread_cache_init(&tc, &std_allocator, 0);
+    allocator cached = thread_cache_allocator_new(&tc);
+
+    io_stdout_write_sstr("allocator\tthreads\tns_per_op\n");
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        run_ctx ctx = {.alloc = &std_allocator, .threads = threads, .ops = ops};
+        bench_print("std", &ctx);
+        ctx.alloc = &cached;
+        ctx.tc = &tc;
+        bench_print("thread_cache", &ctx);
+    }
+
+    thread_cache_release(&tc);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Compares the latency of the TLSF allocator to std_malloc under a mixed-size
+// workload. Each operation frees a random live block and allocates a new one
+// with a size drawn from a mix of small, medium, and large sizes. Every
+// allocation and free is timed on its own, so the numbers include the timer
+// overhead.
+//
+// Usage: tlsf [number of operations] [number of live blocks]
+#include "benchr.h"
+#include "io.h"
+#include "std.h"
+
+typedef struct {
+    allocator *alloc;
+    void **ptrs;
+    size_t *sizes;
+    size_t live;
+    ullong *malloc_ns;
+    ullong *free_ns;
+    size_t ops;
+} latency_ctx;
+
+// 70% up to 256 bytes, 25% up to 4 KiB, and 5% up to 64 KiB
+static size_t mixed_size(ullong r) {
+    ullong bucket = r % 100;
+    r >>= 8;
+    if (bucket < 70) {
+        return 16 + (size_t)(r % 241);
+    }
+    if (bucket < 95) {
+        return 256 + (size_t)(r % 3841);
+    }
+    return 4096 + (size_t)(r % 61441);
+}
+
+static void run_workload(latency_ctx *c) {
+    ullong state = 1;
+    for (size_t i = 0; i < c->live; i += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        c->sizes[i] = mixed_size(state >> 33);
+        c->ptrs[i] = alloc_malloc(c->alloc, c->sizes[i], 8).ptr;
+    }
+    for (size_t i = 0; i < c->ops; i += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t slot = (size_t)(state >> 33) % c->live;
+        allocation old = {.ptr = c->ptrs[slot], .len = c->sizes[slot]};
+        c->sizes[slot] = mixed_size(state >> 17);
+
+        ullong start = bench_now_ns();
+        if (old.ptr) {
+            alloc_free(c->alloc, old);
+        }
+        ullong mid = bench_now_ns();
+        c->ptrs[slot] = alloc_malloc(c->alloc, c->sizes[slot], 8).ptr;
+        ullong end = bench_now_ns();
+
+        // touch the block like a real user would
+        if (c->ptrs[slot]) {
+            *(uchar *)c->ptrs[slot] = (uchar)i;
+        }
+        c->free_ns[i] = mid - start;
+        c->malloc_ns[i] = end - mid;
+    }
+    for (size_t i = 0; i < c->live; i += 1) {
+        if (c->ptrs[i]) {
+            allocation a = {.ptr = c->ptrs[i], .len = c->sizes[i]};
+            alloc_free(c->alloc, a);
+        }
+    }
+}
+
+static void
+print_latency(const char *name, const char *op, ullong *ns, size_t len) {
+    ullong sum = 0;
+    for (size_t i = 0; i < len; i += 1) {
+        sum += ns[i];
+    }
+    sort_radix_ullong(ns, NULL, len, &std_allocator);
+    cstr_fmt_float mean = {(double)sum / (double)len, 1};
+    io_stdout_fmt(
+        "S\tS\tF\tU\tU\tU\tU\n",
+        name,
+        op,
+        mean,
+        ns[len / 2],
+        ns[len - len / 100 - 1],
+        ns[len - len / 10000 - 1],
+        ns[len - 1]
+    );
+    io_stdout_flush();
+}
+
+static void bench_print(const char *name, latency_ctx *ctx) {
+    run_workload(ctx);
+    print_latency(name, "malloc", ctx->malloc_ns, ctx->ops);
+    print_latency(name, "free", ctx->free_ns, ctx->ops);
+}
+
+int main(int argc, char **argv) {
+    size_t ops = bench_arg_size(argc > 1 ? argv[1] : NULL, 1000000);
+    size_t live = bench_arg_size(argc > 2 ? argv[2] : NULL, 4096);
+    ops = max(ops, (size_t)100);
+    live = max(live, (size_t)1);
+
+    // prefaulted so that first touches do not show up as allocator latency
+    size_t region_size = live * 16 * 1024 + (1UL << 20);
+    mmap_options region_options = {.flags = mmap_flag_populate};
+    allocator region_alloc = mmap_allocator_new(&region_options);
+    allocation region = alloc_malloc(&region_alloc, region_size, 1);
+    allocation ptrs = alloc_new(&std_allocator, void *, live);
+    allocation sizes = alloc_new(&std_allocator, size_t, live);
+    allocation malloc_ns = alloc_new(&std_allocator, ullong, ops);
+    allocation free_ns = alloc_new(&std_allocator, ullong, ops);
+    if (!allocation_exists(region) || !allocation_exists(ptrs)
+        || !allocation_exists(sizes) || !allocation_exists(malloc_ns)
+        || !allocation_exists(free_ns)) {
+        io_stderr_write_sstr("allocation failed!\n");
+        io_stderr_flush();
+        return 1;
+    }
+
+    tlsf tl;
+    tlsf_init(&tl, slice_new(region.ptr, region.len));
+    allocator tlsf_alloc = tlsf_allocator_new(&tl);
+
+    io_stdout_write_sstr("allocator\top\tmean_ns\tp50_ns\tp99_ns\tp9999_ns\t"
+                         "max_ns\n");
+    latency_ctx ctx = {
+        .ptrs = ptrs.ptr,
+        .sizes = sizes.ptr,
+        .live = live,
+        .malloc_ns = malloc_ns.ptr,
+        .free_ns = free_ns.ptr,
+        .ops = ops,
+    };
+    ctx.alloc = &std_allocator;
+    bench_print("std", &ctx);
+    ctx.alloc = &tlsf_alloc;
+    bench_print("tlsf", &ctx);
+
+    alloc_free(&std_allocator, free_ns);
+    alloc_free(&std_allocator, malloc_ns);
+    alloc_free(&std_allocator, sizes);
+    alloc_free(&std_allocator, ptrs);
+    alloc_free(&region_alloc, region);
+    return 0;
+}
@@ -6,8 +6,7 @@
 int array_demo(void) {
     int exit_code = 0;
 
-    allocation buffer = alloc_new(&std_allocator, uchar, 1024 * 1024);
-    arena arena = arena_new(buffer.ptr, 1024 * 1024);
+    arena arena = arena_new_chained(&std_allocator, 0);
     allocator allocator = arena_allocator_new(&arena);
 
     float *arr = dynarr_new(10, float, &allocator);
@@ -39,8 +38,7 @@ int array_demo(void) {
     );
 end:
     dynarr_free(arr);
-    arena_clear(&arena);
-    alloc_free(&std_allocator, buffer);
+    arena_release(&arena);
 
     return exit_code;
 }
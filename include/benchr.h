@@ -0,0 +1,78 @@
+#ifndef JP_BENCHR_H
+#define JP_BENCHR_H
+
+#include "std.h"
+
+////////////////////////
+// Timing
+////////////////////////
+
+/**
+ * Get the current time of a monotonic clock.
+ *
+ * @returns time in nanoseconds
+ */
+ullong bench_now_ns(void);
+
+/**
+ * Keep the compiler from optimising away a value or the memory behind it.
+ */
+#define bench_keep(v) __asm__ __volatile__("" : : "g"(v) : "memory")
+
+////////////////////////
+// Bench runner
+////////////////////////
+
+/**
+ * Default minimum duration for a single benchmark run
+ */
+#define bench_default_min_ns (ullong)(100 * 1000 * 1000)
+
+/**
+ * Benchmark function that runs the benchmarked code the given number of times.
+ */
+typedef void (*bench_fun)(void *ctx, ullong iterations);
+
+typedef struct {
+    ullong iterations;
+    ullong elapsed_ns;
+} bench_result;
+
+/**
+ * Run a benchmark function with a growing number of iterations until a single
+ * run takes at least the given amount of time.
+ *
+ * @param fn benchmark function to run
+ * @param ctx context to pass to the benchmark function
+ * @param min_ns minimum duration of the measured run
+ * @returns iterations and elapsed time of the measured run
+ */
+bench_result bench_run(bench_fun fn, void *ctx, ullong min_ns);
+
+/**
+ * Get the average time spent per iteration.
+ *
+ * @param res benchmark result
+ * @returns nanoseconds per iteration
+ */
+double bench_ns_per_op(bench_result res);
+
+/**
+ * Get the throughput of a benchmark.
+ *
+ * @param res benchmark result
+ * @param bytes_per_op number of bytes processed per iteration
+ * @returns throughput in gigabytes (10^9 bytes) per second
+ */
+double bench_gb_per_sec(bench_result res, ullong bytes_per_op);
+
+/**
+ * Parse a size argument for a benchmark.
+ *
+ * @param arg argument to parse (null for no argument)
+ * @param default_value value to use when there is no argument or it is invalid
+ * @returns parsed size
+ */
+size_t bench_arg_size(const char *arg, size_t default_value);
+
+#endif // JP_BENCHR_H
@@ -21,6 +21,16 @@ io_write_all_sync(int fd, const void *buffer, size_t len, size_t chunk_size);
 #define io_write_str_sync(fd, str) \
     io_write_all_sync((fd), (str), sizeof(str), 0)
 
+/**
+ * Write the whole content of a segmented byte buffer to a file descriptor
+ * using writev, without gathering the chunks into a single buffer first.
+ *
+ * @param fd file descriptor to write to
+ * @param sbuf buffer to write
+ * @returns number of bytes written and the error code of the failed write
+ */
+io_result io_write_segbuf_sync(int fd, segbuf *sbuf);
+
 typedef struct {
     slice data;
     size_t cap;
@@ -44,4 +44,275 @@ bool ringbuf_spsc_acquire_read(ringbuf_spsc *rbuf, ringbuf_spsc_h *handle);
 
 void ringbuf_spsc_release_read(ringbuf_spsc *rbuf, ringbuf_spsc_h handle);
 
+////////////////////////
+// Instrumented allocator
+////////////////////////
+
+/**
+ * Number of size classes. Class i counts sizes in (2^(i-1), 2^i], and the
+ * last class counts all larger sizes.
+ */
+#define alloc_stats_size_classes 32
+
+/**
+ * Number of alignment classes. Class i counts alignment 2^i, and the last
+ * class counts all larger alignments.
+ */
+#define alloc_stats_align_classes 16
+
+/**
+ * Statistics of an allocator wrapping another allocator. The counters are
+ * updated with relaxed atomics, so the allocator can be shared by threads
+ * when the inner allocator can.
+ */
+typedef struct {
+    /**
+     * Allocator the calls are forwarded to
+     */
+    allocator *inner;
+    /**
+     * Successful allocations
+     */
+    atomic_size_t allocs;
+    /**
+     * Frees
+     */
+    atomic_size_t frees;
+    /**
+     * Successful reallocations
+     */
+    atomic_size_t reallocs;
+    /**
+     * Failed allocations and reallocations
+     */
+    atomic_size_t failures;
+    /**
+     * Bytes allocated but not freed
+     */
+    atomic_size_t live_bytes;
+    /**
+     * Highest live bytes seen
+     */
+    atomic_size_t peak_bytes;
+    /**
+     * Bytes allocated in total (reallocations count the growth)
+     */
+    atomic_size_t total_bytes;
+    /**
+     * Requested sizes of allocations and reallocations by size class
+     */
+    atomic_size_t size_classes[alloc_stats_size_classes];
+    /**
+     * Requested alignments of allocations and reallocations by class
+     */
+    atomic_size_t align_classes[alloc_stats_align_classes];
+} alloc_stats;
+
+/**
+ * Initialize allocator statistics with zero counters.
+ *
+ * @param stats statistics to initialize
+ * @param inner allocator to forward the calls to
+ */
+void alloc_stats_init(alloc_stats *stats, allocator *inner);
+
+/**
+ * Get the size class of an allocation size.
+ *
+ * @param size allocation size
+ * @returns size class (less than alloc_stats_size_classes)
+ */
+uint alloc_stats_size_class(size_t size);
+
+/**
+ * Get the alignment class of an allocation alignment.
+ *
+ * @param alignment allocation alignment
+ * @returns alignment class (less than alloc_stats_align_classes)
+ */
+uint alloc_stats_align_class(size_t alignment);
+
+/**
+ * Write a human-readable report of the statistics. The histograms only list
+ * the classes that have been used.
+ *
+ * @param stats statistics to report
+ * @param bstream stream to write the report to
+ * @returns number of bytes written and the first error
+ */
+bufstream_write_result
+alloc_stats_report(alloc_stats *stats, bufstream *bstream);
+
+/**
+ * Custom allocator malloc function that records statistics
+ */
+allocation alloc_stats_malloc(size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator free function that records statistics
+ */
+void alloc_stats_free(allocation ptr, void *ctx);
+
+/**
+ * Custom allocator realloc function that records statistics
+ */
+allocation
+alloc_stats_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
+/**
+ * Create an allocator that records statistics and forwards the calls to the
+ * inner allocator of the statistics.
+ *
+ * @param stats statistics to record to (must outlive the allocator)
+ * @returns allocator
+ */
+ignore_unused static inline allocator
+alloc_stats_allocator_new(alloc_stats *stats) {
+    assert(stats && "stats must not be null");
+    allocator a = {
+        alloc_stats_malloc, alloc_stats_free, alloc_stats_realloc, stats
+    };
+    return a;
+}
+
+////////////////////////
+// Thread-caching allocator
+////////////////////////
+
+/**
+ * Number of size classes cached by the thread-caching allocator. The classes
+ * are powers of two from thread_cache_min_size to thread_cache_max_size.
+ */
+#define thread_cache_class_count 12
+
+/**
+ * Smallest size class of the thread-caching allocator
+ */
+#define thread_cache_min_size (size_t)(16)
+
+/**
+ * Largest size class of the thread-caching allocator. Larger allocations go
+ * directly to the inner allocator.
+ */
+#define thread_cache_max_size \
+    (thread_cache_min_size << (thread_cache_class_count - 1))
+
+/**
+ * Default number of bytes a thread can keep cached
+ */
+#define thread_cache_default_max_bytes (size_t)(1024 * 1024)
+
+/**
+ * Number of thread-caching allocators a thread can use at once with a cache.
+ * Further allocators go directly to their central lists.
+ */
+#define thread_cache_slots 4
+
+/**
+ * Free objects of a size class shared by all threads
+ */
+typedef struct {
+    atomic_flag lock;
+    void *objects;
+    size_t count;
+} thread_cache_central;
+
+/**
+ * Allocator that caches freed objects per thread.
+ *
+ * Sizes are rounded up to power-of-two size classes. Each thread keeps free
+ * lists per size class in thread-local storage, so most allocations and frees
+ * do not synchronize. The thread caches are refilled from and flushed to
+ * central free lists in batches, and the central lists return objects to the
+ * inner allocator when they hold too much. Every object is allocated
+ * individually from the inner allocator, so the inner allocator must be
+ * thread safe.
+ */
+typedef struct {
+    /**
+     * Allocator for the objects
+     */
+    allocator *inner;
+    /**
+     * Number of bytes a thread can keep cached
+     */
+    size_t max_thread_bytes;
+    /**
+     * Number of bytes the central lists can hold
+     */
+    size_t max_central_bytes;
+    /**
+     * Bytes held by the central lists
+     */
+    atomic_size_t central_bytes;
+    /**
+     * Identifier of the allocator in the thread-local caches
+     */
+    uint id;
+    /**
+     * Central free lists per size class
+     */
+    thread_cache_central central[thread_cache_class_count];
+} thread_cache;
+
+/**
+ * Initialise a thread-caching allocator.
+ *
+ * @param[out] tc allocator to initialise
+ * @param[in] inner thread-safe allocator for the objects
+ * @param[in] max_thread_bytes number of bytes a thread can keep cached (0 for
+ * the default). The central lists hold up to 16 times this.
+ */
+void thread_cache_init(
+    thread_cache *tc, allocator *inner, size_t max_thread_bytes
+);
+
+/**
+ * Move the objects cached by the calling thread to the central lists. This
+ * should be called before a thread that used the allocator exits.
+ *
+ * @param tc allocator to flush
+ */
+void thread_cache_flush(thread_cache *tc);
+
+/**
+ * Return the objects in the central lists to the inner allocator. The threads
+ * that used the allocator should be flushed first.
+ *
+ * @param tc allocator to release
+ */
+void thread_cache_release(thread_cache *tc);
+
+/**
+ * Custom allocator malloc function for the thread-caching allocator.
+ * Alignments larger than thread_cache_min_size go to the inner allocator.
+ */
+allocation thread_cache_malloc(size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator free function for the thread-caching allocator
+ */
+void thread_cache_free(allocation ptr, void *ctx);
+
+/**
+ * Custom allocator realloc function for the thread-caching allocator
+ */
+allocation
+thread_cache_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
+/**
+ * Create an allocator that caches objects per thread.
+ *
+ * @param tc thread-caching allocator (must outlive the allocator)
+ * @returns allocator
+ */
+ignore_unused static inline allocator
+thread_cache_allocator_new(thread_cache *tc) {
+    assert(tc && "thread cache must not be null");
+    allocator a = {
+        thread_cache_malloc, thread_cache_free, thread_cache_realloc, tc
+    };
+    return a;
+}
+
 #endif
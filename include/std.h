@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 // Disabling string.h will enable custom "memcpy" and "memmove" functions.
@@ -16,6 +17,13 @@
 #include <string.h>
 #endif // JP_DISABLE_STRING_H
 
+// Disabling SIMD will make the byte search functions use only the portable
+// scalar code paths.
+#if !defined(JP_DISABLE_SIMD) && defined(__x86_64__) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define JP_SIMD_X86
+#endif // JP_DISABLE_SIMD
+
 ////////////////////////
 // Scalar types
 ////////////////////////
@@ -296,6 +304,49 @@ ignore_unused static inline uint bits_most_significant(ullong n) {
 #endif
 }
 
+/**
+ * Get the position of the least significant bit from the given number.
+ *
+ * This is the same as counting the trailing zeros of the number.
+ *
+ * Since zero does not have a significant bit, the result for it will be
+ * undefined.
+ *
+ * @param n number to check for the least significant bit
+ * @returns position of the least significant bit
+ */
+ignore_unused static inline uint bits_least_significant(ullong n) {
+    assert(n > 0 && "n must be >0");
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint)__builtin_ctzll(n);
+#else
+    // On x86, this can get converted to bit scan forward (BSF)
+    uint i = 0;
+    while (!(n & 1)) {
+        i += 1;
+        n >>= 1;
+    }
+    return i;
+#endif
+}
+
+/**
+ * Count the number of bits set in the given number.
+ *
+ * @param n number to count the bits from
+ * @returns number of bits set
+ */
+ignore_unused static inline uint bits_count_ones(ullong n) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint)__builtin_popcountll(n);
+#else
+    n = n - ((n >> 1) & 0x5555555555555555ULL);
+    n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+    n = (n + (n >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (uint)((n * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
 /**
  * Get the number of bits set on left for an unsigned char.
  *
@@ -313,6 +364,125 @@ ignore_unused static inline uint bits_set_on_left_uchar(uchar n) {
     return r ? r : 1;
 }
 
+////////////////////////
+// CPU features
+////////////////////////
+
+/**
+ * CPU feature: SSE2
+ */
+#define cpu_feature_sse2 (uint)(1)
+
+/**
+ * CPU feature: SSSE3
+ */
+#define cpu_feature_ssse3 (uint)(2)
+
+/**
+ * CPU feature: SSE4.1
+ */
+#define cpu_feature_sse41 (uint)(4)
+
+/**
+ * CPU feature: SSE4.2 (including the CRC32 instructions)
+ */
+#define cpu_feature_sse42 (uint)(8)
+
+/**
+ * CPU feature: POPCNT
+ */
+#define cpu_feature_popcnt (uint)(16)
+
+/**
+ * CPU feature: carry-less multiplication (PCLMULQDQ)
+ */
+#define cpu_feature_pclmul (uint)(32)
+
+/**
+ * CPU feature: AVX2 with the OS saving the YMM registers
+ */
+#define cpu_feature_avx2 (uint)(64)
+
+/**
+ * CPU feature: BMI2
+ */
+#define cpu_feature_bmi2 (uint)(128)
+
+/**
+ * CPU feature: AVX-512 F and BW with the OS saving the ZMM registers
+ */
+#define cpu_feature_avx512 (uint)(256)
+
+/**
+ * CPU feature: enhanced rep movsb/stosb (ERMS)
+ */
+#define cpu_feature_erms (uint)(512)
+
+/**
+ * Get the features supported by the CPU.
+ *
+ * The CPU is probed with cpuid and xgetbv on the first call and the result is
+ * cached. Features that are not usable by the library (SIMD is disabled or
+ * the CPU is not x86-64) are never reported.
+ *
+ * @returns CPU feature flags (see cpu_feature_*)
+ */
+uint cpu_features(void);
+
+/**
+ * Check whether the CPU supports all of the given features.
+ *
+ * @param features CPU feature flags to check (see cpu_feature_*)
+ * @returns true if all of the features are supported
+ */
+ignore_unused static inline bool cpu_has_features(uint features) {
+    return (cpu_features() & features) == features;
+}
+
+/**
+ * Limit the CPU features that are reported and used for dispatch.
+ *
+ * Routines that dispatch to CPU specific implementations pick their
+ * implementation again on the next call. This can be used for testing the
+ * narrower implementations or for ruling out an instruction set.
+ *
+ * This is not thread-safe: call it before other threads use the dispatched
+ * routines.
+ *
+ * @param features CPU feature flags that may be used (see cpu_feature_*)
+ */
+void cpu_features_limit(uint features);
+
+/**
+ * Variant of a table of routines for runtime dispatch.
+ *
+ * The table is usually a struct of function pointers where every routine is
+ * implemented with the instructions allowed by the required features.
+ */
+typedef struct {
+    /**
+     * CPU features required by the routines (see cpu_feature_*)
+     */
+    uint features;
+    /**
+     * Table of routines
+     */
+    const void *table;
+} cpu_dispatch_variant;
+
+/**
+ * Pick the first variant whose required features the CPU supports.
+ *
+ * Variants should be listed from the most to the least demanding one. The
+ * last variant should require no features, so that there is always a match.
+ *
+ * @param variants variants to pick from
+ * @param len number of variants
+ * @returns table of the picked variant or null if none matched
+ */
+const void *
+cpu_dispatch_select(const cpu_dispatch_variant *variants, size_t len);
+
 ////////////////////////
 // Bytes
 ////////////////////////
@@ -336,77 +506,57 @@ ignore_unused static inline uint bits_set_on_left_uchar(uchar n) {
 
 #else
 
+// Copies and fills of at least this many bytes use rep movsb/stosb on CPUs
+// that have fast string operations.
+#ifndef JP_BYTES_REP_THRESHOLD
+#define JP_BYTES_REP_THRESHOLD 2048
+#endif // JP_BYTES_REP_THRESHOLD
+
+// Copies and fills of at least this many bytes use non-temporal stores, which
+// bypass the cache instead of evicting the working set.
+#ifndef JP_BYTES_NT_THRESHOLD
+#define JP_BYTES_NT_THRESHOLD (4 * 1024 * 1024)
+#endif // JP_BYTES_NT_THRESHOLD
+
 /**
- * Basically memcpy. This will most likely be replaced with memcpy during
- * compilation anyway.
+ * Basically memcpy.
+ *
+ * Copies a word or a SIMD block at a time. Large copies switch to
+ * rep movsb or non-temporal stores (see JP_BYTES_REP_THRESHOLD and
+ * JP_BYTES_NT_THRESHOLD).
  *
  * @param[out] dest area of memory to copy bytes to
  * @param[in] src area of memory to copy bytes from
  * @param[in] n number of bytes to copy
  * @returns pointer to area of memory where bytes were copied to
  */
-static inline void *
-bytes_copy(void *restrict dest, const void *restrict src, size_t n) {
-    assert(dest && "dest must not be null");
-    assert(src && "src must not be null");
-
-    uchar *d = dest;
-    const uchar *s = src;
-    for (size_t i = 0; i < n; i += 1) { d[i] = s[i]; }
-    return d;
-}
+void *bytes_copy(void *restrict dest, const void *restrict src, size_t n);
 
 /**
- * Basically memmove. Assumes that overlapping can be avoided by comparing
- * pointer ordering, which is OK for targets where this code is used.
+ * Basically memmove.
+ *
+ * Overlapping areas are copied forward when dest is before src and backward
+ * otherwise. Areas that don't overlap are copied using bytes_copy.
  *
  * @param[out] dest area of memory to move bytes to
  * @param[in] src area of memory to move bytes from
  * @param[in] n number of bytes to move
  * @returns pointer to area of memory where bytes were copied to
  */
-ignore_unused static inline void *
-bytes_move(void *dest, const void *src, size_t n) {
-    assert(dest && "dest must not be null");
-    assert(src && "src must not be null");
-
-    if (dest == src) {
-        return dest;
-    }
-    uintptr_t diff = dest < src ? (uintptr_t)src - (uintptr_t)dest
-                                : (uintptr_t)dest - (uintptr_t)src;
-    if ((size_t)diff > n) {
-        bytes_copy(dest, src, n);
-    }
-
-    char *d = dest;
-    const char *s = src;
-
-    if (dest < src) {
-        for (size_t i = n; i > 0; i -= 1) { d[n - i] = s[n - i]; }
-    } else {
-        for (size_t i = n; i > 0; i -= 1) { d[i - 1] = s[i - 1]; }
-    }
-    return d;
-}
+void *bytes_move(void *dest, const void *src, size_t n);
 
 /**
  * Basically memset.
  *
+ * Fills a word or a SIMD block at a time. Large fills switch to rep stosb or
+ * non-temporal stores like bytes_copy.
+ *
  * @param[out] dest buffer to fill with a pattern
  * @param[in] c byte pattern to fill the buffer with
  * @param[in] n number of bytes to fill
  * @returns pointer to the memory area that was filled
  */
-ignore_unused static inline void *bytes_set(void *dest, int c, size_t n) {
-    if (!n) {
-        return dest;
-    }
-    uchar *d = dest;
-    uchar c_ = (uchar)c;
-    for (size_t i = 0; i < n; i += 1) { d[i] = c_; }
-    return d;
-}
+void *bytes_set(void *dest, int c, size_t n);
 
 #endif // JP_DISABLE_STRING_H
 
@@ -478,6 +628,9 @@ ignore_unused static inline void *bytes_set(void *dest, int c, size_t n) {
 /**
  * Check at which index the given two buffers differ starting from given index
  *
+ * The buffers are compared a word or a SIMD block at a time, depending on
+ * what the CPU supports.
+ *
  * @param a,b byte buffers to compare
  * @param start index to start comparing from
  * @param len the length of the buffers
@@ -495,9 +648,23 @@ llong bytes_diff_index(const void *a, const void *b, size_t start, size_t len);
  */
 bool bytes_eq(const void *a, const void *b, size_t len);
 
+/**
+ * Compare two buffers byte by byte as unsigned chars (like memcmp).
+ *
+ * @param a,b byte buffers to compare
+ * @param len the length of the buffers
+ * @returns negative number when a orders before b, positive number when a
+ * orders after b, and zero when the buffers contain the same bytes
+ */
+int bytes_cmp(const void *a, const void *b, size_t len);
+
 /**
  * Find the index of a byte string from another byte string
  *
+ * The search strategy is picked based on the length of b: short sub-strings
+ * are searched using a SIMD filter on their first and last bytes, and longer
+ * ones using a Horspool skip table (see bytes_finder).
+ *
  * @param a byte string to find a sub-string from
  * @param b sub-string to search
  * @param a_len the length of a buffer
@@ -511,27 +678,237 @@ llong bytes_index_of(const void *a, size_t a_len, const void *b, size_t b_len);
  * Write bytes as a hex string.
  *
  * Note that the destination buffer must have at least twice + 1 the space as
- * the number of bytes that are to be converted.
+ * the number of bytes that are to be converted. When there is less space, only
+ * as many whole bytes as fit are converted. The hex string is null terminated
+ * when there is space left for it.
+ *
+ * Uses SIMD to convert 16 or 32 bytes at a time when available.
  *
  * @param[out] dest buffer to write the hex string to
  * @param[in] dest_len length of the dest buffer
  * @param[in] src data to convert to a hex string
  * @param[in] src_len number of bytes to convert to a hex string
- * @returns number of bytes written
+ * @returns number of bytes written (excluding the null terminator)
  */
 size_t
 bytes_to_hex(char *dest, size_t dest_len, const char *src, size_t src_len);
 
+/**
+ * Read bytes from a hex string.
+ *
+ * Both lower and upper case hex digits are accepted. Decoding stops when the
+ * destination buffer is full. Contents of the destination buffer are
+ * unspecified when the hex string is invalid.
+ *
+ * Uses SIMD to convert 16 or 32 bytes at a time when available.
+ *
+ * @param[out] dest buffer to write the bytes to
+ * @param[in] dest_len length of the dest buffer
+ * @param[in] src hex string to convert
+ * @param[in] src_len length of the hex string (must be even)
+ * @returns number of bytes written or -1 when the hex string has an odd length
+ * or contains characters that are not hex digits
+ */
+llong
+bytes_from_hex(void *dest, size_t dest_len, const char *src, size_t src_len);
+
 /**
  * Find the index of a byte.
  *
+ * Uses SIMD (SSE2/AVX2/AVX-512) when the CPU supports it. The best available
+ * implementation is picked on the first call.
+ *
  * @param buffer bytes to search for a byte
  * @param len length of the bytes buffer
  * @param byte byte to search for in the buffer
- * @returns index of the byte and whether or not the byte was found
+ * @returns index of the first matching byte or -1 when the byte was not found
  */
 llong bytes_index_of_byte(const uchar *buffer, size_t len, uchar byte);
 
+/**
+ * Find the index of the last occurrence of a byte.
+ *
+ * Uses the same SIMD implementations as bytes_index_of_byte.
+ *
+ * @param buffer bytes to search for a byte
+ * @param len length of the bytes buffer
+ * @param byte byte to search for in the buffer
+ * @returns index of the last matching byte or -1 when the byte was not found
+ */
+llong bytes_last_index_of_byte(const uchar *buffer, size_t len, uchar byte);
+
+/**
+ * Count the occurrences of a byte.
+ *
+ * Uses SIMD (SSE2/AVX2/AVX-512) when the CPU supports it. The best available
+ * implementation is picked on the first call.
+ *
+ * @param buffer bytes to count the byte from
+ * @param len length of the bytes buffer
+ * @param byte byte to count
+ * @returns number of times the byte occurs in the buffer
+ */
+size_t bytes_count_byte(const uchar *buffer, size_t len, uchar byte);
+
+/**
+ * Count the lines in a buffer.
+ *
+ * Every newline character ends a line. Bytes after the last newline are
+ * counted as one more line, so "a\nb" and "a\nb\n" both have two lines and
+ * an empty buffer has none.
+ *
+ * @param buffer bytes to count the lines from
+ * @param len length of the bytes buffer
+ * @returns number of lines in the buffer
+ */
+size_t bytes_count_lines(const uchar *buffer, size_t len);
+
+/**
+ * Find the index of the Nth occurrence of a byte.
+ *
+ * The search stops as soon as the Nth occurrence is found, which makes this
+ * useful for splitting input into chunks by record count: the index of the
+ * Nth newline is the end of the first N lines.
+ *
+ * Uses the same SIMD implementations as bytes_count_byte.
+ *
+ * @param buffer bytes to search for a byte
+ * @param len length of the bytes buffer
+ * @param byte byte to search for in the buffer
+ * @param n which occurrence to find starting from 1
+ * @returns index of the Nth matching byte or -1 when the byte occurs fewer
+ * than N times
+ */
+llong
+bytes_index_of_nth_byte(const uchar *buffer, size_t len, uchar byte, size_t n);
+
+/**
+ * Compiled set of byte values for searching any of several bytes at once.
+ *
+ * The set is stored as a 256-bit table that is laid out so that it can be
+ * used directly as nibble lookup tables by the SIMD matchers: byte c is in
+ * the set when bit (c >> 4) & 7 of bits[(c & 15) + (c >= 128 ? 16 : 0)] is
+ * set.
+ */
+typedef struct {
+    /**
+     * Membership bits indexed by the low nibble of a byte
+     */
+    uchar bits[32];
+} byteset;
+
+/**
+ * Initialise a byte set from the given bytes.
+ *
+ * @param[out] set byte set to initialise
+ * @param[in] bytes bytes to add to the set
+ * @param[in] len number of bytes to add
+ */
+void byteset_init(byteset *set, const void *bytes, size_t len);
+
+/**
+ * Add a byte to a byte set.
+ *
+ * @param set byte set to add the byte to
+ * @param byte byte to add
+ */
+ignore_unused static inline void byteset_add(byteset *set, uchar byte) {
+    assert(set && "byte set must not be null");
+    set->bits[(byte & 15) | ((byte >> 3) & 16)] |=
+        (uchar)(1U << ((byte >> 4) & 7));
+}
+
+/**
+ * Check whether a byte is in a byte set.
+ *
+ * @param set byte set to check
+ * @param byte byte to look for
+ * @returns true if the byte is in the set
+ */
+ignore_unused static inline bool
+byteset_contains(const byteset *set, uchar byte) {
+    assert(set && "byte set must not be null");
+    return (set->bits[(byte & 15) | ((byte >> 3) & 16)] >> ((byte >> 4) & 7))
+        & 1;
+}
+
+/**
+ * Find the index of the first byte that is in the given byte set.
+ *
+ * Uses SIMD nibble lookups to test 16 or 32 bytes at a time when available.
+ *
+ * @param buffer bytes to search from
+ * @param len length of the bytes buffer
+ * @param set byte set to match against
+ * @returns index of the first matching byte or -1 when no byte matched
+ */
+llong bytes_index_of_any(const uchar *buffer, size_t len, const byteset *set);
+
+/**
+ * Find the index of the first byte that is not in the given byte set.
+ *
+ * @param buffer bytes to search from
+ * @param len length of the bytes buffer
+ * @param set byte set to match against
+ * @returns index of the first byte not in the set or -1 when all bytes are in
+ * the set
+ */
+llong
+bytes_index_not_of_any(const uchar *buffer, size_t len, const byteset *set);
+
+/**
+ * Maximum length of a needle that is searched without a skip table.
+ */
+#define bytes_finder_short_needle_max 32
+
+/**
+ * Precompiled needle for searching the same byte string repeatedly.
+ *
+ * Needles up to bytes_finder_short_needle_max bytes are searched by filtering
+ * candidate positions using their first and last bytes (SIMD when available).
+ * Longer needles are searched using the Horspool algorithm, which can skip
+ * over up to needle length bytes of the haystack at a time.
+ */
+typedef struct {
+    /**
+     * Byte string to search for. Must outlive the finder.
+     */
+    const uchar *needle;
+
+    /**
+     * Length of the needle in bytes
+     */
+    size_t len;
+
+    /**
+     * Horspool shift distance for each byte value (long needles only)
+     */
+    size_t skip[256];
+} bytes_finder;
+
+/**
+ * Initialise a finder for the given needle.
+ *
+ * @param[out] finder finder to initialise
+ * @param[in] needle byte string to search for
+ * @param[in] len length of the needle
+ */
+void bytes_finder_init(bytes_finder *finder, const void *needle, size_t len);
+
+/**
+ * Find the index of the finder's needle from a byte string.
+ *
+ * @param finder initialised finder
+ * @param haystack byte string to search the needle from
+ * @param len length of the haystack
+ * @returns -1 when the needle was not found, and otherwise the index of the
+ * first occurrence of the needle in the haystack (an empty needle is found at
+ * 0 in a non-empty haystack, like in bytes_index_of)
+ */
+llong bytes_finder_find(
+    const bytes_finder *finder, const void *haystack, size_t len
+);
+
 ////////////////////////
 // Slices
 ////////////////////////
@@ -664,6 +1041,28 @@ bool slice_const_eq(const slice_const a, const slice_const b);
  */
 bool slice_eq(const slice a, const slice b);
 
+/**
+ * Compare two slices in lexicographic order.
+ *
+ * When one slice is a prefix of the other, the shorter one orders first.
+ *
+ * @param a,b slices to compare
+ * @returns negative number when a orders before b, positive number when a
+ * orders after b, and zero when the slices are equal
+ */
+int slice_const_cmp(const slice_const a, const slice_const b);
+
+/**
+ * Compare two slices in lexicographic order.
+ *
+ * When one slice is a prefix of the other, the shorter one orders first.
+ *
+ * @param a,b slices to compare
+ * @returns negative number when a orders before b, positive number when a
+ * orders after b, and zero when the slices are equal
+ */
+int slice_cmp(const slice a, const slice b);
+
 /**
  * Copy slice contents to another slice where the slices do not overlap.
  *
@@ -723,53 +1122,200 @@ ignore_unused static inline bool slice_const_is_set(slice_const s) {
 }
 
 ////////////////////////
-// Allocator
+// Hashing
 ////////////////////////
 
 /**
- * Allocation returned from an allocator
+ * 128-bit hash value
  */
 typedef struct {
     /**
-     * Pointer to allocated data
+     * Low 64 bits of the hash
      */
-    void *ptr;
-
+    ullong lo;
     /**
-     * Length of the data
+     * High 64 bits of the hash
      */
-    const size_t len;
-} allocation;
+    ullong hi;
+} hash128;
 
 /**
- * Check if an allocation exists in the given value
+ * Hash the contents of a slice to a 64-bit value.
+ *
+ * This is a fast non-cryptographic hash in the style of wyhash that is meant
+ * for hash tables, deduplication, and checksums against accidental changes.
+ * Do not use it where an attacker could pick keys to cause collisions, unless
+ * the seed is kept secret.
+ *
+ * Keys of up to 16 bytes are hashed with a couple of loads and multiplies.
+ * Longer keys are consumed 48 bytes at a time in three independent lanes.
+ *
+ * @param s slice to hash
+ * @param seed seed for the hash
+ * @returns hash of the slice
  */
-ignore_unused static inline bool allocation_exists(allocation a) {
-    return a.ptr && a.len;
-}
+ullong slice_hash64(slice_const s, ullong seed);
 
 /**
- * Interface for memory allocation
+ * Hash the contents of a slice to a 128-bit value.
+ *
+ * Uses the same block function as slice_hash64, but keeps the lanes apart for
+ * the high half of the hash. The low half equals slice_hash64.
+ *
+ * @param s slice to hash
+ * @param seed seed for the hash
+ * @returns hash of the slice
+ */
+hash128 slice_hash128(slice_const s, ullong seed);
+
+/**
+ * Number of bytes buffered by the incremental hash state
+ */
+#define slice_hash_buffer_size 64
+
+/**
+ * State for hashing data that arrives in pieces.
+ *
+ * Hashing the pieces gives the same result as hashing all of the data at once
+ * with slice_hash64 or slice_hash128.
  */
 typedef struct {
     /**
-     * Function for allocating memory.
-     *
-     * @param size amount of memory in bytes to allocate
-     * @param alignment memory alignment to use for the allocation
-     * @param ctx additional data to provide context for the allocation
-     * @returns pointer to area of memory that was allocated
+     * Lanes of the block function
      */
-    allocation (*malloc)(size_t size, size_t alignment, void *ctx);
-
+    ullong lanes[3];
     /**
-     * Function for freeing memory.
+     * Total number of bytes hashed
+     */
+    ullong len;
+    /**
+     * Bytes that have not been consumed by the block function yet
+     */
+    uchar buffer[slice_hash_buffer_size];
+    /**
+     * Number of bytes in the buffer
+     */
+    size_t buffered;
+} slice_hash_state;
+
+/**
+ * Initialise an incremental hash state.
+ *
+ * @param[out] h hash state to initialise
+ * @param[in] seed seed for the hash
+ */
+void slice_hash_init(slice_hash_state *h, ullong seed);
+
+/**
+ * Add data to an incremental hash.
+ *
+ * @param h hash state to add the data to
+ * @param s data to add
+ */
+void slice_hash_update(slice_hash_state *h, slice_const s);
+
+/**
+ * Get the 64-bit hash of the data added so far.
+ *
+ * The state is not modified, so more data can be added afterwards.
+ *
+ * @param h hash state
+ * @returns hash of the data
+ */
+ullong slice_hash_final64(const slice_hash_state *h);
+
+/**
+ * Get the 128-bit hash of the data added so far.
+ *
+ * The state is not modified, so more data can be added afterwards.
+ *
+ * @param h hash state
+ * @returns hash of the data
+ */
+hash128 slice_hash_final128(const slice_hash_state *h);
+
+/**
+ * Compute or continue a CRC-32C (Castagnoli) checksum of a slice.
+ *
+ * Start with a crc of 0 and pass the previous result back in to checksum data
+ * that arrives in pieces.
+ *
+ * Uses the SSE4.2 crc32 instruction when the CPU supports it, with large
+ * buffers split into three interleaved streams when carry-less multiplication
+ * is available too. Otherwise, the data is processed 8 bytes at a time using
+ * lookup tables.
+ *
+ * @param s slice to checksum
+ * @param crc checksum of the preceding data or 0
+ * @returns checksum of the preceding data and the slice
+ */
+uint slice_crc32c(slice_const s, uint crc);
+
+////////////////////////
+// Allocator
+////////////////////////
+
+/**
+ * Allocation returned from an allocator
+ */
+typedef struct {
+    /**
+     * Pointer to allocated data
+     */
+    void *ptr;
+
+    /**
+     * Length of the data
+     */
+    const size_t len;
+} allocation;
+
+/**
+ * Check if an allocation exists in the given value
+ */
+ignore_unused static inline bool allocation_exists(allocation a) {
+    return a.ptr && a.len;
+}
+
+/**
+ * Interface for memory allocation
+ */
+typedef struct {
+    /**
+     * Function for allocating memory.
+     *
+     * @param size amount of memory in bytes to allocate
+     * @param alignment memory alignment to use for the allocation
+     * @param ctx additional data to provide context for the allocation
+     * @returns pointer to area of memory that was allocated
+     */
+    allocation (*malloc)(size_t size, size_t alignment, void *ctx);
+
+    /**
+     * Function for freeing memory.
      *
      * @param ptr pointer to area of memory to free
      * @param ctx additional data to provide context for freeing memory
      */
     void (*free)(allocation ptr, void *ctx);
 
+    /**
+     * Function for resizing memory (optional, can be null).
+     *
+     * The memory is resized in place when possible and moved otherwise. The
+     * contents are kept up to the smaller of the old and the new size. When
+     * resizing fails, the original memory is left untouched.
+     *
+     * @param ptr area of memory to resize
+     * @param size new size of the memory in bytes
+     * @param alignment memory alignment of the original allocation
+     * @param ctx additional data to provide context for the allocation
+     * @returns the resized area of memory or an empty allocation on failure
+     */
+    allocation (*realloc)(
+        allocation ptr, size_t size, size_t alignment, void *ctx
+    );
+
     /**
      * Custom data to provide context for the allocator.
      */
@@ -810,6 +1356,36 @@ ignore_unused static inline void alloc_free(allocator *a, allocation ptr) {
     a->free(ptr, a->ctx);
 }
 
+/**
+ * Resize memory using a custom memory allocation interface.
+ *
+ * Allocators without a realloc function are resized by allocating new memory,
+ * copying the contents, and freeing the original memory.
+ *
+ * @param allocator allocator the memory was acquired from
+ * @param ptr area of memory to resize
+ * @param size new size of the memory in bytes
+ * @param alignment memory alignment of the original allocation
+ * @returns the resized area of memory or an empty allocation on failure, in
+ * which case the original memory is left untouched
+ */
+ignore_unused static inline allocation
+alloc_realloc(allocator *a, allocation ptr, size_t size, size_t alignment) {
+    if (!allocation_exists(ptr)) {
+        return alloc_malloc(a, size, alignment);
+    }
+    if (a->realloc) {
+        return a->realloc(ptr, size, alignment, a->ctx);
+    }
+    allocation resized = alloc_malloc(a, size, alignment);
+    if (!allocation_exists(resized)) {
+        return resized;
+    }
+    bytes_copy(resized.ptr, ptr.ptr, min(ptr.len, size));
+    alloc_free(a, ptr);
+    return resized;
+}
+
 /**
  * Standard memory allocation (stdlib malloc) compatible with the custom memory
  * allocation interface.
@@ -846,19 +1422,87 @@ static void std_free(allocation a, void *ctx) {
     free(a.ptr);
 }
 
+/**
+ * Standard memory resizing (stdlib realloc) compatible with the custom memory
+ * allocation interface.
+ *
+ * @param ptr area of memory to resize
+ * @param size new size of the memory in bytes
+ * @param alignment memory alignment to use for the allocation (unused)
+ * @param ctx additional data to provide context for the allocation (unused)
+ * @returns the resized area of memory or an empty allocation on failure
+ */
+static allocation
+std_realloc(allocation a, size_t size, size_t alignment, void *ctx) {
+    assert(a.ptr && "ptr must not be null");
+    assert(size > 0 && "size must be greater than 0");
+    (void)ctx;
+    (void)alignment;
+    void *ptr = realloc(a.ptr, size);
+    if (ptr == NULL) {
+        return (allocation) {0};
+    }
+    return (allocation) {
+        .ptr = ptr,
+        .len = size,
+    };
+}
+
 /**
  * Standard memory allocation compatible with the custom memory
  * allocation interface.
  */
-ignore_unused static allocator std_allocator = {std_malloc, std_free, NULL};
+ignore_unused static allocator std_allocator = {
+    std_malloc, std_free, std_realloc, NULL
+};
+
+/**
+ * Size of a huge page (the default huge page size on x86-64 and on arm64 with
+ * 4 KiB pages)
+ */
+#define mmap_huge_page_size ((size_t)2 * 1024 * 1024)
+
+/**
+ * Map the memory with explicit huge pages (MAP_HUGETLB). Falls back to
+ * transparent huge pages when no huge pages are reserved.
+ */
+#define mmap_flag_huge_pages (uint)(1)
+
+/**
+ * Ask the kernel to back the memory with transparent huge pages
+ * (madvise MADV_HUGEPAGE). Mappings of at least a huge page are aligned to
+ * the huge page size so that they can be backed by huge pages.
+ */
+#define mmap_flag_transparent_huge_pages (uint)(2)
+
+/**
+ * Fault in the memory when it is mapped rather than on first touch
+ * (MAP_POPULATE)
+ */
+#define mmap_flag_populate (uint)(4)
+
+/**
+ * Options for the memory mapping allocator
+ */
+typedef struct {
+    /**
+     * Combination of mmap_flag_* values
+     */
+    uint flags;
+    /**
+     * Minimum alignment of the mappings (power-of-two, 0 for page alignment)
+     */
+    size_t alignment;
+} mmap_options;
 
 /**
  * Memory allocation using memory mapping compatible with the custom memory
- * allocation interface.
+ * allocation interface. Alignments larger than a page are provided by mapping
+ * extra memory and unmapping the misaligned ends.
  *
  * @param size amount of memory in bytes to allocate
- * @param alignment memory alignment to use for the allocation (unused)
- * @param ctx additional data to provide context for the allocation (unused)
+ * @param alignment memory alignment to use for the allocation (power-of-two)
+ * @param ctx options for the mapping (mmap_options, can be null)
  * @returns pointer to area of memory that was allocated
  */
 allocation mmap_malloc(size_t size, size_t alignment, void *ctx);
@@ -872,22 +1516,93 @@ allocation mmap_malloc(size_t size, size_t alignment, void *ctx);
  */
 void mmap_free(allocation ptr, void *ctx);
 
+/**
+ * Memory resizing using memory mapping compatible with the custom memory
+ * allocation interface. The mapping is resized with mremap when available,
+ * unless the mapping uses explicit huge pages or an alignment larger than a
+ * page, in which case the memory is copied to a new mapping.
+ *
+ * @param ptr area of memory to resize
+ * @param size new size of the memory in bytes
+ * @param alignment memory alignment to use for the allocation (power-of-two)
+ * @param ctx options for the mapping (mmap_options, can be null)
+ * @returns the resized area of memory or an empty allocation on failure
+ */
+allocation
+mmap_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
 /**
  * Memory allocation using memory mapping compatible with the custom memory
  * allocation interface.
  */
-ignore_unused static allocator mmap_allocator = {mmap_malloc, mmap_free, NULL};
+ignore_unused static allocator mmap_allocator = {
+    mmap_malloc, mmap_free, mmap_realloc, NULL
+};
+
+/**
+ * Create a memory mapping allocator that maps memory with the given options.
+ *
+ * @param options mapping options (must outlive the allocator)
+ * @returns allocator
+ */
+ignore_unused static inline allocator
+mmap_allocator_new(mmap_options *options) {
+    assert(options && "options must not be null");
+    assert(
+        (options->alignment == 0 || is_power_of_two(options->alignment))
+        && "alignment must be power of two"
+    );
+    allocator a = {mmap_malloc, mmap_free, mmap_realloc, options};
+    return a;
+}
 
 ////////////////////////
 // Arena allocator
 ////////////////////////
 
+/**
+ * Default size of the first block of a chained arena
+ */
+#define arena_default_block_size (size_t)(64 * 1024)
+
+/**
+ * Largest block size a chained arena grows to. Larger allocations get
+ * dedicated blocks.
+ */
+#define arena_max_block_size (size_t)(64 * 1024 * 1024)
+
+/**
+ * Default size of the address range reserved for a virtual memory arena
+ */
+#if SIZE_MAX > 0xFFFFFFFFUL
+#define arena_default_reserve_size ((size_t)64 * 1024 * 1024 * 1024)
+#else
+#define arena_default_reserve_size ((size_t)1024 * 1024 * 1024)
+#endif
+
+/**
+ * Number of bytes a virtual memory arena commits at a time
+ */
+#define arena_commit_size (size_t)(64 * 1024)
+
+/**
+ * Arena flag: return the memory of a virtual memory arena to the system when
+ * the arena is cleared
+ */
+#define arena_flag_decommit_on_clear (uint)(1)
+
 /**
  * Linear memory arena.
+ *
+ * The arena either bumps through a single fixed buffer, or it is chained: when
+ * the current block is full, a new block is requested from a backing allocator
+ * and the block sizes grow geometrically. A virtual memory arena bumps
+ * through a reserved address range and commits pages as it goes, so its
+ * allocations never move and the last allocation can always grow in place.
  */
 typedef struct {
     /**
-     * Buffer to back the arena.
+     * Buffer to back the arena (the current block of a chained arena).
      */
     uchar *buffer;
 
@@ -900,6 +1615,38 @@ typedef struct {
      * Amount of memory used in the arena.
      */
     size_t used;
+
+    /**
+     * Allocator for new blocks (null for a fixed buffer)
+     */
+    allocator *backing;
+
+    /**
+     * Blocks from the backing allocator linked through their headers, the
+     * current block first
+     */
+    void *blocks;
+
+    /**
+     * Dedicated blocks of oversized allocations, the newest block first
+     */
+    void *oversized;
+
+    /**
+     * Size of the next block to request from the backing allocator
+     */
+    size_t next_block_size;
+
+    /**
+     * Size of the reserved address range of a virtual memory arena (0 for
+     * other arenas). The committed part is the arena size.
+     */
+    size_t reserved;
+
+    /**
+     * Arena flags (e.g. arena_flag_decommit_on_clear)
+     */
+    uint flags;
 } arena;
 
 /**
@@ -907,6 +1654,31 @@ typedef struct {
  */
 arena arena_new(void *buffer, size_t size);
 
+/**
+ * Create a new chained arena. No memory is allocated until the first
+ * allocation.
+ *
+ * Each new block is twice the size of the previous one, up to
+ * arena_max_block_size. Allocations larger than half of the next block size
+ * get a dedicated block, so the current block can still be used.
+ *
+ * @param backing allocator to request blocks from
+ * @param block_size size of the first block (0 for the default)
+ * @returns the arena
+ */
+arena arena_new_chained(allocator *backing, size_t block_size);
+
+/**
+ * Create a new virtual memory arena. The address range is reserved without
+ * access rights up front, and pages are committed (made accessible) in
+ * arena_commit_size steps as the arena is used.
+ *
+ * @param reserve_size size of the address range to reserve (0 for the default)
+ * @param flags arena flags (e.g. arena_flag_decommit_on_clear)
+ * @returns the arena, which has no buffer if the reservation failed
+ */
+arena arena_new_reserved(size_t reserve_size, uint flags);
+
 /**
  * Allocate bytes from the given arena.
  */
@@ -920,82 +1692,472 @@ void *arena_alloc_bytes(arena *arena, size_t size, size_t alignment);
 
 /**
  * Clear the arena usage.
+ *
+ * A chained arena keeps its current block and returns the other blocks to the
+ * backing allocator. A virtual memory arena with arena_flag_decommit_on_clear
+ * returns its committed pages to the system, and they are zeroed when they
+ * are used again.
  */
 void arena_clear(arena *arena);
 
 /**
- * Custom allocator malloc function for the arena
+ * Clear the arena usage and return all blocks of a chained arena to the
+ * backing allocator. A virtual memory arena releases its address range.
  */
-allocation arena_malloc(size_t size, size_t alignment, void *ctx);
+void arena_release(arena *arena);
 
 /**
- * Custom allocator free function for the arena
+ * Saved position of an arena
  */
-void arena_free(allocation ptr, void *ctx);
+typedef struct {
+    /**
+     * Current block at the time of the mark
+     */
+    void *block;
+    /**
+     * Newest oversized block at the time of the mark
+     */
+    void *oversized;
+    /**
+     * Amount of memory used in the current block
+     */
+    size_t used;
+} arena_marker;
 
 /**
- * Custom allocator for a memory arena
+ * Save the current position of an arena.
+ *
+ * @param arena arena to mark
+ * @returns marker to pass to arena_reset_to
  */
-allocator arena_allocator_new(arena *arena);
-
-////////////////////////
-// Dynamic array
-////////////////////////
+arena_marker arena_mark(const arena *arena);
 
 /**
- * Dynamic array header
+ * Release everything allocated from an arena after the given mark. Blocks of
+ * a chained arena that were added after the mark are returned to the backing
+ * allocator, except that resetting to a mark taken before the first block
+ * keeps the current block like arena_clear.
+ *
+ * Marks must be reset to in reverse order: a mark is invalid after resetting
+ * to an earlier mark.
+ *
+ * @param arena arena to reset
+ * @param mark marker from arena_mark
  */
-typedef struct {
-    /**
-     * Number of existing items
-     */
-    ullong len;
+void arena_reset_to(arena *arena, arena_marker mark);
 
-    /**
-     * Number of items the array can hold
-     */
-    ullong capacity;
+/**
+ * Number of scratch arenas per thread
+ */
+#define arena_scratch_count 2
 
+/**
+ * Scratch arena borrowed from the per-thread pool
+ */
+typedef struct {
     /**
-     * Allocation size in bytes
-     *
-     * This is used for deallocation
+     * Arena to allocate temporary memory from
      */
-    size_t alloc_size;
-
+    arena *arena;
     /**
-     * Memory allocator used for growing
+     * Position to reset the arena to when the scratch arena is returned
      */
-    allocator *allocator;
-} dynarr_header;
+    arena_marker mark;
+} arena_scratch;
 
 /**
- * Convert item count and size to byte size (incl. header)
+ * Borrow a scratch arena of the calling thread.
  *
- * @param n item count
- * @param item_size size of a single item
- * @returns dynarr size in bytes
+ * The scratch arenas are chained arenas backed by std_allocator. A function
+ * that gets arenas from its caller should pass them as conflicts, so that
+ * the returned arena is not one the caller is still allocating from. Scratch
+ * arenas can be borrowed recursively: everything allocated after borrowing is
+ * released by arena_scratch_end.
+ *
+ * @param conflicts arenas that must not be returned (can be null)
+ * @param conflict_count number of conflicting arenas (less than
+ * arena_scratch_count)
+ * @returns the scratch arena and its position
  */
-ignore_unused static inline size_t
-dynarr_count_to_bytes(ullong n, size_t item_size) {
-    assert(item_size > 0 && "item size must be >0");
-    assert(n > 0 && "n must be >0");
-    assert(
-        (SIZE_MAX - sizeof(dynarr_header)) / item_size > n
-        && "n * item size + header size must not exceed size max"
-    );
-    return (size_t)n * item_size + sizeof(dynarr_header);
-}
+arena_scratch
+arena_scratch_begin(arena *const *conflicts, size_t conflict_count);
 
 /**
- * Create a new dynamic array
+ * Return a scratch arena and release the memory allocated after borrowing it.
+ *
+ * @param scratch scratch arena from arena_scratch_begin
  */
-void *dynarr_new_sized(
-    ullong capacity, size_t item_size, size_t alignment, allocator *allocator
-);
+void arena_scratch_end(arena_scratch scratch);
 
 /**
- * Create a new dynamic array
+ * Return the memory of the calling thread's scratch arenas to the system.
+ * This should be called before a thread that used scratch arenas exits.
+ */
+void arena_scratch_release(void);
+
+/**
+ * Custom allocator malloc function for the arena
+ */
+allocation arena_malloc(size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator free function for the arena
+ */
+void arena_free(allocation ptr, void *ctx);
+
+/**
+ * Custom allocator realloc function for the arena. The memory is extended or
+ * shrunk in place when it is the last allocation in the arena and it fits the
+ * current block. Otherwise, new memory is allocated and the old memory stays
+ * unused until the arena is cleared.
+ */
+allocation
+arena_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator for a memory arena
+ */
+allocator arena_allocator_new(arena *arena);
+
+////////////////////////
+// Pool allocator
+////////////////////////
+
+/**
+ * Default number of bytes in a pool page
+ */
+#define pool_default_page_size (size_t)(64 * 1024)
+
+/**
+ * Size of a cache line used for aligning pool slots
+ */
+#define pool_cache_line_size (size_t)(64)
+
+/**
+ * Pool flag: align the slots to cache lines so that no two slots share a cache
+ * line
+ */
+#define pool_flag_cache_aligned (uint)(1)
+
+/**
+ * Fixed-size object pool.
+ *
+ * The pool carves slots of one size out of pages allocated from a backing
+ * allocator. Freed slots are kept in an intrusive free list (the link is
+ * stored in the free slot itself), so allocating and freeing a slot is O(1).
+ * Pages are only returned to the backing allocator by pool_trim and
+ * pool_release.
+ */
+typedef struct {
+    /**
+     * Free slots linked through their first bytes
+     */
+    void *free_list;
+    /**
+     * Pages linked through their headers, the newest page first
+     */
+    void *pages;
+    /**
+     * Next never used slot in the newest page
+     */
+    uchar *bump;
+    /**
+     * End of the slots in the newest page
+     */
+    uchar *bump_end;
+    /**
+     * Size of a slot in bytes
+     */
+    size_t slot_size;
+    /**
+     * Alignment of a slot
+     */
+    size_t slot_align;
+    /**
+     * Number of bytes in a page, not counting the padding requested for
+     * aligning the slots
+     */
+    size_t page_size;
+    /**
+     * Number of slots in a page
+     */
+    size_t slots_per_page;
+    /**
+     * Number of pages in use
+     */
+    size_t page_count;
+    /**
+     * Number of slots in use
+     */
+    size_t used;
+    /**
+     * Allocator for the pages
+     */
+    allocator *backing;
+} pool;
+
+/**
+ * Initialise a pool. No memory is allocated until the first slot is taken.
+ *
+ * @param[out] p pool to initialise
+ * @param[in] slot_size size of a slot in bytes
+ * @param[in] slot_align alignment of a slot
+ * @param[in] page_size bytes to allocate per page (0 for the default)
+ * @param[in] flags pool flags (e.g. pool_flag_cache_aligned)
+ * @param[in] backing allocator for the pages
+ */
+void pool_init(
+    pool *p,
+    size_t slot_size,
+    size_t slot_align,
+    size_t page_size,
+    uint flags,
+    allocator *backing
+);
+
+/**
+ * Initialise a pool for objects of type t.
+ */
+#define pool_init_for(p, t, flags, backing) \
+    pool_init((p), sizeof(t), alignof(t), 0, (flags), (backing))
+
+/**
+ * Take a slot from a pool.
+ *
+ * @param p pool to take the slot from
+ * @returns pointer to the slot or null if a new page could not be allocated
+ */
+void *pool_alloc_slot(pool *p);
+
+/**
+ * Return a slot to a pool.
+ *
+ * @param p pool the slot was taken from
+ * @param slot slot to return
+ */
+void pool_free_slot(pool *p, void *slot);
+
+/**
+ * Return the pages that have no slots in use to the backing allocator.
+ *
+ * This walks the free list, so it takes time proportional to the number of
+ * free slots. Temporary memory for the page bookkeeping is taken from the
+ * backing allocator.
+ *
+ * @param p pool to trim
+ * @returns number of pages returned
+ */
+size_t pool_trim(pool *p);
+
+/**
+ * Return all pages to the backing allocator. All slots become invalid.
+ *
+ * @param p pool to release
+ */
+void pool_release(pool *p);
+
+/**
+ * Custom allocator malloc function for the pool. Allocations larger than a
+ * slot, or with a larger alignment, fail.
+ */
+allocation pool_malloc(size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator free function for the pool
+ */
+void pool_free(allocation ptr, void *ctx);
+
+/**
+ * Custom allocator realloc function for the pool. Sizes up to the slot size
+ * keep the slot and larger sizes fail.
+ */
+allocation
+pool_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator for a pool
+ */
+allocator pool_allocator_new(pool *p);
+
+////////////////////////
+// TLSF allocator
+////////////////////////
+
+/**
+ * Number of first-level size classes of the TLSF allocator. Blocks can be up
+ * to 2^(tlsf_fl_count + 8) bytes.
+ */
+#define tlsf_fl_count 32
+
+/**
+ * Number of second-level size classes per first-level class
+ */
+#define tlsf_sl_count 32
+
+/**
+ * Alignment of the TLSF blocks. Larger alignments are supported by splitting
+ * off the unaligned start of a block.
+ */
+#define tlsf_block_align (size_t)(16)
+
+/**
+ * Two-level segregated fit (TLSF) allocator over a fixed region of memory.
+ *
+ * Free blocks are kept in segregated free lists indexed by a two-level
+ * bitmap, so finding a suitable block, allocating, and freeing are O(1).
+ * Freed blocks are coalesced with their free neighbours immediately.
+ * Each block has a 16-byte header in front of the memory returned.
+ */
+typedef struct {
+    /**
+     * First-level classes that have free blocks
+     */
+    uint fl_bitmap;
+    /**
+     * Second-level classes that have free blocks, per first-level class
+     */
+    uint sl_bitmap[tlsf_fl_count];
+    /**
+     * Free lists per size class
+     */
+    void *free_lists[tlsf_fl_count][tlsf_sl_count];
+    /**
+     * Number of bytes in blocks in use, including the block headers
+     */
+    size_t used;
+    /**
+     * Number of bytes in the region available for blocks
+     */
+    size_t size;
+} tlsf;
+
+/**
+ * Initialise a TLSF allocator over a region of memory.
+ *
+ * @param[out] t allocator to initialise
+ * @param[in] memory region to allocate from (must outlive the allocator)
+ * @returns true if the region was large enough
+ */
+bool tlsf_init(tlsf *t, slice memory);
+
+/**
+ * Allocate memory from a TLSF allocator.
+ *
+ * @param t allocator to allocate from
+ * @param size number of bytes to allocate
+ * @param alignment alignment of the memory (power-of-two)
+ * @returns pointer to the memory or null when no free block is large enough
+ */
+void *tlsf_alloc_bytes(tlsf *t, size_t size, size_t alignment);
+
+/**
+ * Return memory to a TLSF allocator.
+ *
+ * @param t allocator the memory was allocated from
+ * @param ptr memory to free (can be null)
+ */
+void tlsf_free_bytes(tlsf *t, void *ptr);
+
+/**
+ * Resize memory from a TLSF allocator. The memory is resized in place when the
+ * block or the free block after it is large enough, and moved otherwise.
+ *
+ * @param t allocator the memory was allocated from
+ * @param ptr memory to resize (null to allocate)
+ * @param size new size in bytes
+ * @param alignment alignment of the memory (power-of-two)
+ * @returns pointer to the resized memory or null on failure, in which case
+ * the memory is left unchanged
+ */
+void *tlsf_realloc_bytes(tlsf *t, void *ptr, size_t size, size_t alignment);
+
+/**
+ * Get the usable size of memory from a TLSF allocator.
+ *
+ * @param ptr memory allocated from a TLSF allocator
+ * @returns number of usable bytes (at least the requested size)
+ */
+size_t tlsf_usable_size(const void *ptr);
+
+/**
+ * Custom allocator malloc function for the TLSF allocator
+ */
+allocation tlsf_malloc(size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator free function for the TLSF allocator
+ */
+void tlsf_free(allocation ptr, void *ctx);
+
+/**
+ * Custom allocator realloc function for the TLSF allocator
+ */
+allocation
+tlsf_realloc(allocation ptr, size_t size, size_t alignment, void *ctx);
+
+/**
+ * Custom allocator for a TLSF allocator
+ */
+allocator tlsf_allocator_new(tlsf *t);
+
+////////////////////////
+// Dynamic array
+////////////////////////
+
+/**
+ * Dynamic array header
+ */
+typedef struct {
+    /**
+     * Number of existing items
+     */
+    ullong len;
+
+    /**
+     * Number of items the array can hold
+     */
+    ullong capacity;
+
+    /**
+     * Allocation size in bytes
+     *
+     * This is used for deallocation
+     */
+    size_t alloc_size;
+
+    /**
+     * Memory allocator used for growing
+     */
+    allocator *allocator;
+} dynarr_header;
+
+/**
+ * Convert item count and size to byte size (incl. header)
+ *
+ * @param n item count
+ * @param item_size size of a single item
+ * @returns dynarr size in bytes
+ */
+ignore_unused static inline size_t
+dynarr_count_to_bytes(ullong n, size_t item_size) {
+    assert(item_size > 0 && "item size must be >0");
+    assert(n > 0 && "n must be >0");
+    assert(
+        (SIZE_MAX - sizeof(dynarr_header)) / item_size > n
+        && "n * item size + header size must not exceed size max"
+    );
+    return (size_t)n * item_size + sizeof(dynarr_header);
+}
+
+/**
+ * Create a new dynamic array
+ */
+void *dynarr_new_sized(
+    ullong capacity, size_t item_size, size_t alignment, allocator *allocator
+);
+
+/**
+ * Create a new dynamic array
  */
 #define dynarr_new(capacity, t, allocator) \
     ((t *)dynarr_new_sized((capacity), sizeof(t), alignof(t), (allocator)))
@@ -1040,9 +2202,10 @@ void dynarr_free(void *array);
 /**
  * Grow an existing array with a capacity increase.
  *
- * Growing is done by allocating more memory using the array's allocator. If the
- * allocated memory is adjacent to the existing array, the existing array is
- * extended to cover the allocated memory.
+ * Growing is done by resizing the array's memory using its allocator, which
+ * extends the memory in place when the allocator supports it. Any extra memory
+ * the allocator hands out is used as additional capacity. After a successful
+ * grow, only the returned array is valid.
  *
  * @param array the array to grow
  * @param capacity_increase the number of additional items the new array should
@@ -1056,146 +2219,828 @@ void *dynarr_grow_ut(
 );
 
 /**
- * Grow an existing array with a capacity increase.
+ * Grow an existing array with a capacity increase.
+ *
+ * Growing is done by resizing the array's memory using its allocator, which
+ * extends the memory in place when the allocator supports it. Any extra memory
+ * the allocator hands out is used as additional capacity. After a successful
+ * grow, only the returned array is valid.
+ *
+ * @param array the array to grow
+ * @param capacity_increase the number of additional items the new array should
+ * hold
+ * @param t type of the item to hold in the array
+ * @returns an array with increased capacity
+ */
+#define dynarr_grow(array, capacity_increase, t) \
+    dynarr_grow_ut((array), (capacity_increase), sizeof(t), alignof(t))
+
+/**
+ * Clone a given array with new capacity.
+ *
+ * @returns new array with the original array contents or null when the memory
+ * allocation fails
+ */
+void *dynarr_clone_ut(
+    void *array, ullong capacity_increase, size_t item_size, size_t alignment
+);
+
+/**
+ * Clone a given array with new capacity.
+ */
+#define dynarr_clone(array, capacity_increase, type) \
+    (type *)dynarr_clone_ut( \
+        (array), (capacity_increase), sizeof(*(array)), alignof(type) \
+    )
+
+/**
+ * Push items to given array. Returns true when the operation succeeded (i.e.
+ * there's capacity).
+ */
+bool dynarr_push_ut(
+    void *array, const void *items, ullong count, size_t item_size
+);
+
+/**
+ * Push items to given array.
+ *
+ * Push may fail under these conditions:
+ * - Array is NULL
+ * - There is not enough capacity to hold the items
+ *
+ * @returns false when the operation succeeds and false otherwise
+ */
+#define dynarr_push(array, items, count) \
+    dynarr_push_ut((array), (items), (count), sizeof(*(items)))
+
+/**
+ * Push items to given array and grow the array automatically.
+ *
+ * Push may fail under these conditions:
+ * - Array is NULL
+ * - Array growth fails
+ *
+ * @returns array containing the new contents or null when push fails
+ */
+void *dynarr_push_grow_ut(
+    void *array,
+    const void *items,
+    ullong count,
+    size_t item_size,
+    size_t alignment
+);
+
+/**
+ * Push items to given array and grow the array automatically.
+ *
+ * Push may fail under these conditions:
+ * - Array is NULL
+ * - Array growth fails
+ *
+ * @returns array containing the new contents or null when push fails
+ */
+#define dynarr_push_grow(array, items, count, type) \
+    (type *)dynarr_push_grow_ut( \
+        (array), (items), (count), sizeof(type), alignof(type) \
+    )
+
+/**
+ * Pop an element from the tail of the array.
+ *
+ * @param[in] array array to pop the value from
+ * @param[out] out pointer to write the popped value to
+ * @param[in] item_size size of an array item
+ * @returns true when an item was popped and false otherwise
+ */
+bool dynarr_pop_ut(void *array, void *out, size_t item_size);
+
+/**
+ * Pop an element from the tail of the array
+ */
+#define dynarr_pop(array, out) dynarr_pop_ut((array), &(out), sizeof(*(array)))
+
+/**
+ * Remove an element by index from given array.
+ *
+ * @param array array remove the value from
+ * @param index the index of the element to remove
+ * @param item_size size of an array item
+ * @returns true when an item was removed and false otherwise
+ */
+bool dynarr_remove_ut(void *array, ullong index, size_t item_size);
+
+/**
+ * Remove an element by index from given array.
+ *
+ * @param array array remove the value from
+ * @param index the index of the element to remove
+ * @returns true when an item was removed and false otherwise
+ */
+#define dynarr_remove(array, index) \
+    dynarr_remove_ut((array), (index), sizeof(*(array)))
+
+/**
+ * Remove an element by index from given array, but do not guarantee array
+ * element ordering after remove.
+ *
+ * @param array array remove the value from
+ * @param index the index of the element to remove
+ * @param item_size size of an array item
+ * @returns true when an item was removed and false otherwise
+ */
+bool dynarr_remove_uo_ut(void *array, ullong index, size_t item_size);
+
+/**
+ * Remove an element by index from given array, but do not guarantee array
+ * element ordering after remove.
+ *
+ * @param array array remove the value from
+ * @param index the index of the element to remove
+ * @returns true when an item was removed and false otherwise
+ */
+#define dynarr_remove_uo(array, index) \
+    dynarr_remove_uo_ut((array), (index), sizeof(*(array)))
+
+////////////////////////
+// Hash map
+////////////////////////
+
+/**
+ * Number of slots whose control bytes are probed at once
+ */
+#define hashmap_group_size 16
+
+/**
+ * Key and hash stored in every occupied hash map slot. The value follows the
+ * slot in the same entry.
+ */
+typedef struct {
+    /**
+     * Key of the entry. The key bytes are not copied.
+     */
+    slice_const key;
+    /**
+     * Hash of the key
+     */
+    ullong hash;
+} hashmap_slot;
+
+/**
+ * Open-addressing hash map from byte string keys to fixed-size values.
+ *
+ * The map is laid out as a Swiss table: every slot has a control byte that
+ * is either empty or holds 7 bits of the key's hash, and lookups compare a
+ * group of 16 control bytes at once (SSE2 when available) before looking at
+ * any keys. Collisions are resolved with linear probing, which lets removal
+ * shift the following entries back instead of leaving tombstones.
+ *
+ * Keys are not copied: the key bytes must outlive the entry.
+ */
+typedef struct {
+    /**
+     * Control bytes (capacity + group size, the tail mirrors the first group)
+     */
+    uchar *ctrl;
+    /**
+     * Entries (slot + value) of the map
+     */
+    uchar *entries;
+    /**
+     * Number of slots (zero or a power of two)
+     */
+    size_t capacity;
+    /**
+     * Number of entries in the map
+     */
+    size_t len;
+    /**
+     * Size of an entry in bytes
+     */
+    size_t entry_size;
+    /**
+     * Offset of the value within an entry
+     */
+    size_t value_offset;
+    /**
+     * Size of a value in bytes
+     */
+    size_t value_size;
+    /**
+     * Alignment of the entries
+     */
+    size_t entry_align;
+    /**
+     * Seed for hashing the keys
+     */
+    ullong seed;
+    /**
+     * Size of the memory backing the control bytes and the entries
+     */
+    size_t alloc_size;
+    /**
+     * Memory allocator used for growing
+     */
+    allocator *allocator;
+} hashmap;
+
+/**
+ * Initialise a hash map.
+ *
+ * @param[out] map hash map to initialise
+ * @param[in] capacity number of entries to make room for (can be zero)
+ * @param[in] value_size size of a value in bytes (can be zero for sets)
+ * @param[in] value_align alignment of a value
+ * @param[in] allocator allocator to use for the table
+ * @returns true if the table could be allocated
+ */
+bool hashmap_init_ut(
+    hashmap *map,
+    size_t capacity,
+    size_t value_size,
+    size_t value_align,
+    allocator *allocator
+);
+
+/**
+ * Initialise a hash map for values of type t.
+ */
+#define hashmap_init(map, capacity, t, allocator) \
+    hashmap_init_ut((map), (capacity), sizeof(t), alignof(t), (allocator))
+
+/**
+ * Free the memory of a hash map.
+ *
+ * @param map hash map to free
+ */
+void hashmap_free(hashmap *map);
+
+/**
+ * Remove all entries from a hash map while keeping its memory.
+ *
+ * @param map hash map to clear
+ */
+void hashmap_clear(hashmap *map);
+
+/**
+ * Make room for at least the given number of entries without growing.
+ *
+ * @param map hash map to reserve space for
+ * @param count number of entries the map should hold
+ * @returns true if there is room for the entries
+ */
+bool hashmap_reserve(hashmap *map, size_t count);
+
+/**
+ * Move the entries to a new table with room for at least the given number of
+ * entries (or the current number of entries, when that is larger).
+ *
+ * This can be used for shrinking a map after removing entries.
+ *
+ * @param map hash map to rehash
+ * @param count number of entries the new table should hold
+ * @returns true if the new table could be allocated
+ */
+bool hashmap_rehash(hashmap *map, size_t count);
+
+/**
+ * Find the value of a key.
+ *
+ * @param map hash map to search
+ * @param key key to search for
+ * @returns pointer to the value or null when the key is not in the map
+ */
+void *hashmap_get(const hashmap *map, slice_const key);
+
+/**
+ * Find the value of a key, and add the key with a zeroed value if it is not
+ * in the map yet.
+ *
+ * The returned pointer is valid until the map is modified.
+ *
+ * @param[in] map hash map to add the key to
+ * @param[in] key key to add
+ * @param[out] inserted set to true if the key was added (can be null)
+ * @returns pointer to the value or null if the map could not grow
+ */
+void *hashmap_put(hashmap *map, slice_const key, bool *inserted);
+
+/**
+ * Remove a key from the map.
+ *
+ * @param map hash map to remove the key from
+ * @param key key to remove
+ * @returns true if the key was found and removed
+ */
+bool hashmap_remove(hashmap *map, slice_const key);
+
+/**
+ * Hash map iterator
+ *
+ * The map must not be modified while iterating.
+ */
+typedef struct {
+    /**
+     * Map to iterate
+     */
+    const hashmap *map;
+    /**
+     * Index of the next slot to look at
+     */
+    size_t index;
+    /**
+     * Key of the current entry
+     */
+    slice_const key;
+    /**
+     * Value of the current entry
+     */
+    void *value;
+} hashmap_iter;
+
+/**
+ * Initialise an iterator over the entries of a hash map.
+ *
+ * @param[out] it iterator to initialise
+ * @param[in] map hash map to iterate
+ */
+void hashmap_iter_init(hashmap_iter *it, const hashmap *map);
+
+/**
+ * Move to the next entry of a hash map. The entries are visited in no
+ * particular order.
+ *
+ * @param it iterator to advance
+ * @returns true if the iterator points to an entry and false when done
+ */
+bool hashmap_iter_next(hashmap_iter *it);
+
+////////////////////////
+// String interning
+////////////////////////
+
+/**
+ * Id returned by the interner when a string is not found or could not be
+ * interned
+ */
+#define interner_id_none (uint)(UINT_MAX)
+
+/**
+ * String interning table.
+ *
+ * Every unique byte string is copied into an arena once and given a stable
+ * 32-bit id. Interned strings can be compared by id, and the arena copy
+ * (the canonical slice) is shared by all duplicates of the string.
+ *
+ * The arena copies are null terminated, so canonical slices can also be used
+ * as C strings.
+ */
+typedef struct {
+    /**
+     * Ids of the interned strings keyed by the arena copies
+     */
+    hashmap ids;
+    /**
+     * Canonical slices indexed by id (dynamic array)
+     */
+    slice_const *strings;
+    /**
+     * Arena the strings are copied to
+     */
+    arena *arena;
+} interner;
+
+/**
+ * Statistics of a bulk interning call
+ */
+typedef struct {
+    /**
+     * Number of strings interned
+     */
+    size_t count;
+    /**
+     * Number of strings that were not in the interner yet
+     */
+    size_t added;
+    /**
+     * Total bytes of the strings interned
+     */
+    size_t bytes;
+    /**
+     * Bytes copied to the arena for the added strings
+     */
+    size_t added_bytes;
+} interner_stats;
+
+/**
+ * Initialise an interner.
+ *
+ * @param[out] in interner to initialise
+ * @param[in] capacity number of unique strings to make room for
+ * @param[in] arena arena to copy the strings to
+ * @param[in] allocator allocator for the lookup table and the id table
+ * @returns true if the tables could be allocated
+ */
+bool interner_init(
+    interner *in, size_t capacity, arena *arena, allocator *allocator
+);
+
+/**
+ * Free the tables of an interner. The strings stay in the arena.
+ *
+ * @param in interner to free
+ */
+void interner_free(interner *in);
+
+/**
+ * Get the number of unique strings in an interner.
+ */
+ignore_unused static inline size_t interner_len(const interner *in) {
+    assert(in && "interner must not be null");
+    return (size_t)dynarr_len(in->strings);
+}
+
+/**
+ * Intern a string.
+ *
+ * @param in interner to add the string to
+ * @param s string to intern
+ * @returns id of the string or interner_id_none if the string could not be
+ * copied or the tables could not grow
+ */
+uint interner_intern(interner *in, slice_const s);
+
+/**
+ * Intern a string and get its canonical slice.
+ *
+ * @param in interner to add the string to
+ * @param s string to intern
+ * @returns the canonical slice or a null slice if the string could not be
+ * interned
+ */
+slice_const interner_intern_slice(interner *in, slice_const s);
+
+/**
+ * Intern an array of strings.
+ *
+ * @param[in] in interner to add the strings to
+ * @param[in] strings strings to intern
+ * @param[in] count number of strings
+ * @param[out] ids ids of the strings (can be null)
+ * @param[out] stats statistics of the call (can be null)
+ * @returns true if all strings were interned and false if the interning
+ * stopped because of a failed allocation
+ */
+bool interner_intern_all(
+    interner *in,
+    const slice_const *strings,
+    size_t count,
+    uint *ids,
+    interner_stats *stats
+);
+
+/**
+ * Get the ratio of duplicates in a bulk interning call, i.e. the fraction of
+ * the strings that did not need to be copied.
+ *
+ * @param stats statistics of the call
+ * @returns ratio between 0 (all strings added) and 1 (no strings added)
+ */
+ignore_unused static inline double
+interner_stats_dedup_ratio(interner_stats stats) {
+    if (stats.count == 0) {
+        return 0.0;
+    }
+    return 1.0 - (double)stats.added / (double)stats.count;
+}
+
+/**
+ * Find the id of a string without interning it.
+ *
+ * @param in interner to search
+ * @param s string to search for
+ * @returns id of the string or interner_id_none if it is not interned
+ */
+uint interner_find(const interner *in, slice_const s);
+
+/**
+ * Get the canonical slice of an interned string.
+ *
+ * @param in interner to search
+ * @param id id of the string
+ * @returns the canonical slice
+ */
+ignore_unused static inline slice_const
+interner_get(const interner *in, uint id) {
+    assert(in && "interner must not be null");
+    assert(id < interner_len(in) && "id must be interned");
+    return in->strings[id];
+}
+
+////////////////////////
+// Sorting
+////////////////////////
+
+/**
+ * Keys are compared as unsigned integers
+ */
+#define sort_key_unsigned (uint)(0)
+
+/**
+ * Keys are compared as two's complement signed integers
+ */
+#define sort_key_signed (uint)(1)
+
+/**
+ * Keys are compared as IEEE 754 floating point numbers
+ */
+#define sort_key_float (uint)(2)
+
+/**
+ * Sort an array of 4 or 8 byte numeric keys in ascending order using a least
+ * significant digit radix sort.
+ *
+ * The keys are sorted one byte at a time, and passes where all keys have the
+ * same byte are skipped. The sort is stable. Scratch memory is taken from the
+ * allocator: one key per item (two for floating point keys), and one payload
+ * item per item when a payload is given.
+ *
+ * Floating point keys are ordered by their bits: -0.0 comes before 0.0, and
+ * NaNs come before negative infinity or after positive infinity depending on
+ * their sign bit.
+ *
+ * @param keys keys to sort
+ * @param payload values to move along with the keys, e.g. indices (can be
+ * null)
+ * @param len number of keys
+ * @param key_size size of a key (4 or 8)
+ * @param key_kind how the keys are compared (sort_key_unsigned,
+ * sort_key_signed, or sort_key_float)
+ * @param allocator allocator for the scratch memory
+ * @returns true if the keys were sorted and false if scratch memory could not
+ * be allocated, in which case the keys are left untouched
+ */
+bool sort_radix_ut(
+    void *keys,
+    uint *payload,
+    size_t len,
+    size_t key_size,
+    uint key_kind,
+    allocator *allocator
+);
+
+/**
+ * Sort an array of ints in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool
+sort_radix_int(int *keys, uint *payload, size_t len, allocator *allocator) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(int), sort_key_signed, allocator
+    );
+}
+
+/**
+ * Sort an array of uints in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool
+sort_radix_uint(uint *keys, uint *payload, size_t len, allocator *allocator) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(uint), sort_key_unsigned, allocator
+    );
+}
+
+/**
+ * Sort an array of llongs in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool
+sort_radix_llong(llong *keys, uint *payload, size_t len, allocator *allocator) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(llong), sort_key_signed, allocator
+    );
+}
+
+/**
+ * Sort an array of ullongs in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool sort_radix_ullong(
+    ullong *keys, uint *payload, size_t len, allocator *allocator
+) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(ullong), sort_key_unsigned, allocator
+    );
+}
+
+/**
+ * Sort an array of floats in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool
+sort_radix_float(float *keys, uint *payload, size_t len, allocator *allocator) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(float), sort_key_float, allocator
+    );
+}
+
+/**
+ * Sort an array of doubles in ascending order (see sort_radix_ut).
+ */
+ignore_unused static inline bool sort_radix_double(
+    double *keys, uint *payload, size_t len, allocator *allocator
+) {
+    return sort_radix_ut(
+        keys, payload, len, sizeof(double), sort_key_float, allocator
+    );
+}
+
+////////////////////////
+// Bit vector
+////////////////////////
+
+/**
+ * Number of bits in a bit vector word
+ */
+#define bitvec_word_bits (sizeof(ullong) * CHAR_BIT)
+
+/**
+ * Dense set of bits backed by an allocator.
+ *
+ * The bits are stored in 64-bit words, bit i being bit (i % 64) of word
+ * (i / 64). The bits past the length of the vector are always zero, so that
+ * whole words can be counted and combined.
+ */
+typedef struct {
+    /**
+     * Words holding the bits
+     */
+    ullong *words;
+    /**
+     * Number of bits in the vector
+     */
+    size_t len;
+    /**
+     * Allocation size in bytes
+     */
+    size_t alloc_size;
+    /**
+     * Memory allocator used for the words
+     */
+    allocator *allocator;
+} bitvec;
+
+/**
+ * Get the number of words needed for the given number of bits.
+ */
+ignore_unused static inline size_t bitvec_word_count(size_t len) {
+    return len / bitvec_word_bits + (len % bitvec_word_bits != 0);
+}
+
+/**
+ * Initialise a bit vector with all bits unset.
  *
- * Growing is done by allocating more memory using the array's allocator. If the
- * allocated memory is adjacent to the existing array, the existing array is
- * extended to cover the allocated memory.
- *
- * @param array the array to grow
- * @param capacity_increase the number of additional items the new array should
- * hold
- * @param t type of the item to hold in the array
- * @returns an array with increased capacity
+ * @param[out] b bit vector to initialise
+ * @param[in] len number of bits
+ * @param[in] allocator allocator to use for the words
+ * @returns true if the words could be allocated
  */
-#define dynarr_grow(array, capacity_increase, t) \
-    dynarr_grow_ut((array), (capacity_increase), sizeof(t), alignof(t))
+bool bitvec_init(bitvec *b, size_t len, allocator *allocator);
 
 /**
- * Clone a given array with new capacity.
+ * Free the memory of a bit vector.
  *
- * @returns new array with the original array contents or null when the memory
- * allocation fails
+ * @param b bit vector to free
  */
-void *dynarr_clone_ut(
-    void *array, ullong capacity_increase, size_t item_size, size_t alignment
-);
+void bitvec_free(bitvec *b);
 
 /**
- * Clone a given array with new capacity.
+ * Check if a bit is set.
  */
-#define dynarr_clone(array, capacity_increase, type) \
-    (type *)dynarr_clone_ut( \
-        (array), (capacity_increase), sizeof(*(array)), alignof(type) \
-    )
+ignore_unused static inline bool bitvec_get(const bitvec *b, size_t bit) {
+    assert(bit < b->len && "bit must be within the vector");
+    return (b->words[bit / bitvec_word_bits] >> (bit % bitvec_word_bits)) & 1;
+}
 
 /**
- * Push items to given array. Returns true when the operation succeeded (i.e.
- * there's capacity).
+ * Set a bit.
  */
-bool dynarr_push_ut(
-    void *array, const void *items, ullong count, size_t item_size
-);
+ignore_unused static inline void bitvec_set(bitvec *b, size_t bit) {
+    assert(bit < b->len && "bit must be within the vector");
+    b->words[bit / bitvec_word_bits] |= 1ULL << (bit % bitvec_word_bits);
+}
 
 /**
- * Push items to given array.
- *
- * Push may fail under these conditions:
- * - Array is NULL
- * - There is not enough capacity to hold the items
- *
- * @returns false when the operation succeeds and false otherwise
+ * Unset a bit.
  */
-#define dynarr_push(array, items, count) \
-    dynarr_push_ut((array), (items), (count), sizeof(*(items)))
+ignore_unused static inline void bitvec_unset(bitvec *b, size_t bit) {
+    assert(bit < b->len && "bit must be within the vector");
+    b->words[bit / bitvec_word_bits] &= ~(1ULL << (bit % bitvec_word_bits));
+}
 
 /**
- * Push items to given array and grow the array automatically.
- *
- * Push may fail under these conditions:
- * - Array is NULL
- * - Array growth fails
+ * Set or unset all bits of a bit vector.
  *
- * @returns array containing the new contents or null when push fails
+ * @param b bit vector to fill
+ * @param value true to set all bits and false to unset them
  */
-void *dynarr_push_grow_ut(
-    void *array,
-    const void *items,
-    ullong count,
-    size_t item_size,
-    size_t alignment
-);
+void bitvec_fill(bitvec *b, bool value);
 
 /**
- * Push items to given array and grow the array automatically.
- *
- * Push may fail under these conditions:
- * - Array is NULL
- * - Array growth fails
- *
- * @returns array containing the new contents or null when push fails
+ * Intersect a bit vector with another one of the same length (dest &= src).
  */
-#define dynarr_push_grow(array, items, count, type) \
-    (type *)dynarr_push_grow_ut( \
-        (array), (items), (count), sizeof(type), alignof(type) \
-    )
+void bitvec_and(bitvec *dest, const bitvec *src);
 
 /**
- * Pop an element from the tail of the array.
- *
- * @param[in] array array to pop the value from
- * @param[out] out pointer to write the popped value to
- * @param[in] item_size size of an array item
- * @returns true when an item was popped and false otherwise
+ * Unite a bit vector with another one of the same length (dest |= src).
  */
-bool dynarr_pop_ut(void *array, void *out, size_t item_size);
+void bitvec_or(bitvec *dest, const bitvec *src);
 
 /**
- * Pop an element from the tail of the array
+ * Toggle the bits of a bit vector that are set in another one of the same
+ * length (dest ^= src).
  */
-#define dynarr_pop(array, out) dynarr_pop_ut((array), &(out), sizeof(*(array)))
+void bitvec_xor(bitvec *dest, const bitvec *src);
 
 /**
- * Remove an element by index from given array.
+ * Unset the bits of a bit vector that are set in another one of the same
+ * length (dest &= ~src).
+ */
+void bitvec_andnot(bitvec *dest, const bitvec *src);
+
+/**
+ * Count the bits set in a bit vector.
  *
- * @param array array remove the value from
- * @param index the index of the element to remove
- * @param item_size size of an array item
- * @returns true when an item was removed and false otherwise
+ * @param b bit vector to count the bits from
+ * @returns number of bits set
  */
-bool dynarr_remove_ut(void *array, ullong index, size_t item_size);
+size_t bitvec_count(const bitvec *b);
 
 /**
- * Remove an element by index from given array.
+ * Find the first bit set at or after the given bit.
  *
- * @param array array remove the value from
- * @param index the index of the element to remove
- * @returns true when an item was removed and false otherwise
+ * @param b bit vector to search
+ * @param from bit to start the search from
+ * @returns the index of the bit or -1 if no bit is set
  */
-#define dynarr_remove(array, index) \
-    dynarr_remove_ut((array), (index), sizeof(*(array)))
+llong bitvec_next_set(const bitvec *b, size_t from);
 
 /**
- * Remove an element by index from given array, but do not guarantee array
- * element ordering after remove.
+ * Iterator over the bits set in a bit vector
+ */
+typedef struct {
+    /**
+     * Words of the bit vector
+     */
+    const ullong *words;
+    /**
+     * Number of words
+     */
+    size_t word_count;
+    /**
+     * Index of the current word
+     */
+    size_t word_index;
+    /**
+     * Bits of the current word that have not been visited yet
+     */
+    ullong word;
+} bitvec_iter;
+
+/**
+ * Initialise an iterator over the bits set in a bit vector.
  *
- * @param array array remove the value from
- * @param index the index of the element to remove
- * @param item_size size of an array item
- * @returns true when an item was removed and false otherwise
+ * @param[out] it iterator to initialise
+ * @param[in] b bit vector to iterate
  */
-bool dynarr_remove_uo_ut(void *array, ullong index, size_t item_size);
+ignore_unused static inline void
+bitvec_iter_init(bitvec_iter *it, const bitvec *b) {
+    assert(it && "iterator must not be null");
+    assert(b && "bit vector must not be null");
+    it->words = b->words;
+    it->word_count = bitvec_word_count(b->len);
+    it->word_index = 0;
+    it->word = it->word_count ? b->words[0] : 0;
+}
 
 /**
- * Remove an element by index from given array, but do not guarantee array
- * element ordering after remove.
+ * Move to the next bit set in a bit vector. The bits are visited in
+ * ascending order.
  *
- * @param array array remove the value from
- * @param index the index of the element to remove
- * @returns true when an item was removed and false otherwise
+ * @param[in] it iterator to advance
+ * @param[out] bit index of the bit
+ * @returns true if a bit was found and false when done
  */
-#define dynarr_remove_uo(array, index) \
-    dynarr_remove_uo_ut((array), (index), sizeof(*(array)))
+ignore_unused static inline bool
+bitvec_iter_next(bitvec_iter *it, size_t *bit) {
+    while (!it->word) {
+        it->word_index += 1;
+        if (it->word_index >= it->word_count) {
+            return false;
+        }
+        it->word = it->words[it->word_index];
+    }
+    *bit = it->word_index * bitvec_word_bits
+        + bits_least_significant(it->word);
+    // clear the lowest bit set
+    it->word &= it->word - 1;
+    return true;
+}
 
 ////////////////////////
 // UTF-8
@@ -1292,7 +3137,8 @@ typedef bool (*cstr_split_predicate)(const uchar *c, size_t len, void *state);
  */
 typedef struct {
     /**
-     * Predicate function for splitting strings
+     * Predicate function for splitting strings (null when splitting by
+     * split_set)
      */
     cstr_split_predicate predicate;
 
@@ -1315,11 +3161,22 @@ typedef struct {
      * Flag options for splitting
      */
     uint flags;
+
+    /**
+     * Split characters compiled to a byte set. Used for scanning when no
+     * predicate is set.
+     */
+    byteset split_set;
 } cstr_split;
 
 /**
  * Initialise a split iterator with split characters.
  *
+ * The split characters are compiled to a byte set, so the string is scanned
+ * using bytes_index_of_any instead of calling a predicate for every character.
+ * The split characters don't need to outlive the iterator. In UTF-8 mode, only
+ * ASCII split characters are used.
+ *
  * @param[out] split iterator to initialise
  * @param[in] str string to split
  * @param[in] split_chars characters based on which string should be split
@@ -1614,6 +3471,31 @@ bytebuf_result bytebuf_fill(bytebuf *bbuf, uchar pattern, size_t len);
 
 bytebuf_result bytebuf_write(bytebuf *bbuf, const void *src, size_t len);
 
+/**
+ * Reserve space for writing bytes directly to the buffer, growing the buffer
+ * if needed. The bytes become part of the content with bytebuf_commit.
+ *
+ * @param bbuf buffer to reserve the space from
+ * @param len number of bytes to reserve
+ * @returns pointer to the space or null when the buffer cannot grow enough
+ */
+uchar *bytebuf_reserve(bytebuf *bbuf, size_t len);
+
+/**
+ * Add bytes written to the reserved space to the content of the buffer.
+ *
+ * @param bbuf buffer the space was reserved from
+ * @param len number of bytes written (up to the reserved number of bytes)
+ */
+ignore_unused static inline void bytebuf_commit(bytebuf *bbuf, size_t len) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(
+        len <= bytebuf_bytes_available(bbuf)
+        && "len must not exceed the reserved space"
+    );
+    bbuf->len += len;
+}
+
 bytebuf_result bytebuf_write_int(bytebuf *bbuf, int src);
 bytebuf_result bytebuf_write_uint(bytebuf *bbuf, uint src);
 bytebuf_result bytebuf_write_llong(bytebuf *bbuf, llong src);
@@ -1641,6 +3523,165 @@ bytebuf_fmt(bytebuf *bbuf, const char *restrict format, ...) {
     return res;
 }
 
+////////////////////////
+// Segmented byte buffer
+////////////////////////
+
+/**
+ * Default number of bytes in each chunk of a segmented byte buffer
+ */
+#define segbuf_default_chunk_size (size_t)(64 * 1024)
+
+/**
+ * Chunk of a segmented byte buffer. The bytes follow the chunk header.
+ */
+typedef struct segbuf_chunk {
+    struct segbuf_chunk *next;
+    size_t len;
+    size_t cap;
+} segbuf_chunk;
+
+/**
+ * Byte buffer that grows by appending fixed-size chunks instead of moving the
+ * content into a larger buffer, so written bytes are never copied again.
+ *
+ * The content is not contiguous. Use segbuf_iovec to pass it to writev or
+ * segbuf_copy to gather it into a single buffer.
+ *
+ * Cleared chunks are kept and reused for later writes.
+ */
+typedef struct {
+    /**
+     * First chunk
+     */
+    segbuf_chunk *head;
+    /**
+     * Chunk being written to
+     */
+    segbuf_chunk *current;
+    /**
+     * Last allocated chunk
+     */
+    segbuf_chunk *last;
+    /**
+     * Number of bytes written
+     */
+    size_t len;
+    /**
+     * Number of bytes in all chunks
+     */
+    size_t cap;
+    /**
+     * Number of bytes in each new chunk
+     */
+    size_t chunk_size;
+    /**
+     * Number of allocated chunks
+     */
+    size_t chunk_count;
+    allocator *allocator;
+} segbuf;
+
+/**
+ * Initialise a segmented byte buffer. No memory is allocated until the first
+ * write.
+ *
+ * @param[out] sbuf buffer to initialise
+ * @param chunk_size number of bytes in each chunk (0 for the default size)
+ * @param allocator allocator for the chunks
+ */
+void segbuf_init(segbuf *sbuf, size_t chunk_size, allocator *allocator);
+
+ignore_unused static inline segbuf
+segbuf_new(size_t chunk_size, allocator *allocator) {
+    segbuf sbuf;
+    segbuf_init(&sbuf, chunk_size, allocator);
+    return sbuf;
+}
+
+/**
+ * Free all chunks of a segmented byte buffer.
+ */
+void segbuf_free(segbuf *sbuf);
+
+/**
+ * Clear the content of a segmented byte buffer while keeping its chunks.
+ */
+void segbuf_clear(segbuf *sbuf);
+
+/**
+ * Allocate enough chunks for writing the given number of bytes.
+ *
+ * @param sbuf buffer to grow
+ * @param len number of bytes that must fit in the buffer after its content
+ * @returns true if the space is available
+ */
+bool segbuf_reserve(segbuf *sbuf, size_t len);
+
+bytebuf_result segbuf_fill(segbuf *sbuf, uchar pattern, size_t len);
+
+bytebuf_result segbuf_write(segbuf *sbuf, const void *src, size_t len);
+
+bytebuf_result segbuf_write_int(segbuf *sbuf, int src);
+bytebuf_result segbuf_write_uint(segbuf *sbuf, uint src);
+bytebuf_result segbuf_write_llong(segbuf *sbuf, llong src);
+bytebuf_result segbuf_write_ullong(segbuf *sbuf, ullong src);
+bytebuf_result segbuf_write_float(segbuf *sbuf, float src, uint decimals);
+bytebuf_result segbuf_write_double(segbuf *sbuf, double src, uint decimals);
+
+ignore_unused static inline bytebuf_result
+segbuf_write_str(segbuf *sbuf, const char *str, size_t len) {
+    return segbuf_write(sbuf, str, len);
+}
+
+#define segbuf_write_sstr(sbuf, str) \
+    segbuf_write_str((sbuf), (str), lengthof(str))
+
+/**
+ * Write formatted text to a segmented byte buffer. The format is the same as
+ * in bytebuf_fmt, but the output is not null terminated.
+ */
+bytebuf_result
+segbuf_fmt_va(segbuf *sbuf, const char *restrict format, va_list va_args);
+
+ignore_unused static inline bytebuf_result
+segbuf_fmt(segbuf *sbuf, const char *restrict format, ...) {
+    va_list va_args;
+    va_start(va_args, format);
+    bytebuf_result res = segbuf_fmt_va(sbuf, format, va_args);
+    va_end(va_args);
+    return res;
+}
+
+/**
+ * Number of non-empty chunks in a segmented byte buffer i.e. the number of
+ * iovecs needed for the whole content.
+ */
+size_t segbuf_iovec_count(segbuf *sbuf);
+
+/**
+ * Describe the content of a segmented byte buffer as an iovec list.
+ *
+ * @param sbuf buffer to describe
+ * @param[out] iov iovecs to fill
+ * @param iov_len maximum number of iovecs to fill
+ * @param offset number of bytes to skip from the start of the content
+ * @returns number of iovecs filled
+ */
+size_t segbuf_iovec(
+    segbuf *sbuf, struct iovec *iov, size_t iov_len, size_t offset
+);
+
+/**
+ * Copy the content of a segmented byte buffer to a contiguous buffer.
+ *
+ * @param sbuf buffer to copy from
+ * @param[out] dest buffer to copy to
+ * @param dest_len size of the destination buffer
+ * @returns number of bytes copied
+ */
+size_t segbuf_copy(segbuf *sbuf, void *dest, size_t dest_len);
+
 ////////////////////////
 // Buffered byte stream
 ////////////////////////
@@ -1672,6 +3713,51 @@ bytesink_result bufstream_flush(bufstream *bstream);
 bufstream_write_result
 bufstream_write(bufstream *bstream, const void *src, size_t len);
 
+typedef struct {
+    /**
+     * Start of the reserved space or null when it could not be reserved
+     */
+    uchar *ptr;
+    /**
+     * Number of bytes available at ptr (at least the reserved number)
+     */
+    size_t len;
+    /**
+     * Error from flushing the buffer to make space
+     */
+    int err_code;
+} bufstream_reserve_result;
+
+/**
+ * Reserve space for writing bytes directly to the stream buffer, flushing the
+ * buffer first if the space is not available. The bytes become part of the
+ * stream with bufstream_commit.
+ *
+ * The space cannot be reserved when it is larger than the buffer or when the
+ * sink accepts only part of the buffered bytes. Use bufstream_write then.
+ *
+ * @param bstream stream to reserve the space from
+ * @param len number of bytes to reserve
+ * @returns the reserved space and the error from flushing
+ */
+bufstream_reserve_result bufstream_reserve(bufstream *bstream, size_t len);
+
+/**
+ * Add bytes written to the reserved space to the stream buffer.
+ *
+ * @param bstream stream the space was reserved from
+ * @param len number of bytes written (up to the reserved number of bytes)
+ */
+ignore_unused static inline void
+bufstream_commit(bufstream *bstream, size_t len) {
+    assert(bstream && "bstream must not be null");
+    assert(
+        len <= bstream->cap - bstream->len
+        && "len must not exceed the reserved space"
+    );
+    bstream->len += len;
+}
+
 ignore_unused static inline bufstream_write_result
 bufstream_write_str(bufstream *bstream, const char *src, size_t len) {
     return bufstream_write(bstream, src, len);
@@ -1702,4 +3788,44 @@ bufstream_fmt(bufstream *bstream, const char *restrict format, ...) {
     return res;
 }
 
+/**
+ * Context for a bytesink that keeps a CRC-32C checksum of the bytes passed
+ * through it to another sink.
+ */
+typedef struct {
+    /**
+     * Sink to pass the bytes to
+     */
+    bytesink sink;
+    /**
+     * Checksum of the bytes accepted by the sink so far
+     */
+    uint crc;
+} crc32c_bytesink_context;
+
+/**
+ * Pass bytes to the wrapped sink and update the checksum with the bytes it
+ * accepted.
+ */
+bytesink_result
+crc32c_bytesink_fn(void *context, const uchar *bytes, size_t len);
+
+/**
+ * Create a bytesink that checksums the bytes it passes to another sink.
+ *
+ * Use this as the sink of a bufstream to checksum the data while it is
+ * flushed instead of making a separate pass over it.
+ *
+ * @param ctx context with the wrapped sink and the initial checksum
+ * @returns checksumming bytesink
+ */
+ignore_unused static inline bytesink
+crc32c_bytesink(crc32c_bytesink_context *ctx) {
+    bytesink sink = {
+        .context = ctx,
+        .fn = crc32c_bytesink_fn,
+    };
+    return sink;
+}
+
 #endif // JP_STD_H
@@ -4,10 +4,11 @@ HEADER_FILES = $(wildcard include/*.h)
 SRC_FILES = $(wildcard src/*.c)
 CMD_FILES = $(wildcard cmd/*.c)
 TEST_FILES = $(wildcard test/*.c)
+BENCH_FILES = $(wildcard bench/*.c)
 
-lint: $(SRC_FILES) $(HEADER_FILES) $(CMD_FILES) $(TEST_FILES)
+lint: $(SRC_FILES) $(HEADER_FILES) $(CMD_FILES) $(TEST_FILES) $(BENCH_FILES)
 	cppcheck -DJP_USE_ASSERT_H --check-level=exhaustive $^
 
-format: $(SRC_FILES) $(HEADER_FILES) $(CMD_FILES) $(TEST_FILES)
+format: $(SRC_FILES) $(HEADER_FILES) $(CMD_FILES) $(TEST_FILES) $(BENCH_FILES)
 	clang-format -i $^
 
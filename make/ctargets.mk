@@ -11,6 +11,13 @@ $(OBJ_DIR)/io.o: src/io.c include/io.h include/std.h
 $(OBJ_DIR)/std.o: src/std.c include/std.h
 	@mkdir -p $(OBJ_DIR)
 	$(CC) $(CFLAGS) -c $< -o $@
+# Library without string.h, so that bytes_* use the custom copy kernels
+$(OBJ_DIR)/std_nostr.o: src/std.c include/std.h
+	@mkdir -p $(OBJ_DIR)
+	$(CC) $(CFLAGS) -DJP_DISABLE_STRING_H -c $< -o $@
+$(OBJ_DIR)/benchr.o: src/benchr.c include/benchr.h include/std.h
+	@mkdir -p $(OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
 $(OBJ_DIR)/testr.o: src/testr.c include/io.h include/std.h include/testr.h
 	@mkdir -p $(OBJ_DIR)
 	$(CC) $(CFLAGS) -c $< -o $@
@@ -43,14 +50,24 @@ $(BIN_DIR)/reals: $(CMD_OBJ_DIR)/reals.o $(OBJ_DIR)/io.o $(OBJ_DIR)/std.o
 TEST_NAMES += \
 	arena \
 	bits \
+	bitvec \
 	bufstream \
 	bytes \
+	bytes_nostr \
 	cliargs \
+	cpu \
+	cpu_nostr \
 	cstr \
 	dynarr \
+	hashmap \
+	interner \
 	math \
 	mmap_alloc \
-	slice
+	pool \
+	segbuf \
+	slice \
+	sort \
+	tlsf
 
 # Arena
 $(TEST_OBJ_DIR)/arena.o: test/arena.c include/testr.h include/std.h
@@ -74,6 +91,16 @@ $(TEST_REPORT_DIR)/bits.txt: $(TEST_OBJ_DIR)/bits
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# Bit vector
+$(TEST_OBJ_DIR)/bitvec.o: test/bitvec.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/bitvec: $(TEST_OBJ_DIR)/bitvec.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/bitvec.txt: $(TEST_OBJ_DIR)/bitvec
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
 # Buffered stream
 $(TEST_OBJ_DIR)/bufstream.o: test/bufstream.c include/testr.h include/std.h
 	@mkdir -p $(TEST_OBJ_DIR)
@@ -94,6 +121,16 @@ $(TEST_REPORT_DIR)/bytes.txt: $(TEST_OBJ_DIR)/bytes
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# Bytes without string.h (custom copy, move, and set kernels)
+$(TEST_OBJ_DIR)/bytes_nostr.o: test/bytes.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -DJP_DISABLE_STRING_H -c $< -o $@
+$(TEST_OBJ_DIR)/bytes_nostr: $(TEST_OBJ_DIR)/bytes_nostr.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std_nostr.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/bytes_nostr.txt: $(TEST_OBJ_DIR)/bytes_nostr
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
 # CLI args
 $(TEST_OBJ_DIR)/cliargs.o: test/cliargs.c include/testr.h include/std.h include/cliargs.h
 	@mkdir -p $(TEST_OBJ_DIR)
@@ -104,6 +141,26 @@ $(TEST_REPORT_DIR)/cliargs.txt: $(TEST_OBJ_DIR)/cliargs
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# CPU features
+$(TEST_OBJ_DIR)/cpu.o: test/cpu.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/cpu: $(TEST_OBJ_DIR)/cpu.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/cpu.txt: $(TEST_OBJ_DIR)/cpu
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+# CPU features without string.h (custom copy, move, and set kernels)
+$(TEST_OBJ_DIR)/cpu_nostr.o: test/cpu.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -DJP_DISABLE_STRING_H -c $< -o $@
+$(TEST_OBJ_DIR)/cpu_nostr: $(TEST_OBJ_DIR)/cpu_nostr.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std_nostr.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/cpu_nostr.txt: $(TEST_OBJ_DIR)/cpu_nostr
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
 # C strings
 $(TEST_OBJ_DIR)/cstr.o: test/cstr.c include/testr.h include/std.h
 	@mkdir -p $(TEST_OBJ_DIR)
@@ -124,6 +181,26 @@ $(TEST_REPORT_DIR)/dynarr.txt: $(TEST_OBJ_DIR)/dynarr
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# Hash map
+$(TEST_OBJ_DIR)/hashmap.o: test/hashmap.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/hashmap: $(TEST_OBJ_DIR)/hashmap.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/hashmap.txt: $(TEST_OBJ_DIR)/hashmap
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+# String interning
+$(TEST_OBJ_DIR)/interner.o: test/interner.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/interner: $(TEST_OBJ_DIR)/interner.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/interner.txt: $(TEST_OBJ_DIR)/interner
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
 # Math
 $(TEST_OBJ_DIR)/math.o: test/math.c include/testr.h include/std.h
 	@mkdir -p $(TEST_OBJ_DIR)
@@ -144,6 +221,36 @@ $(TEST_REPORT_DIR)/mmap_alloc.txt: $(TEST_OBJ_DIR)/mmap_alloc
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# Pool allocator
+$(TEST_OBJ_DIR)/pool.o: test/pool.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/pool: $(TEST_OBJ_DIR)/pool.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/pool.txt: $(TEST_OBJ_DIR)/pool
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+# Segmented byte buffer
+$(TEST_OBJ_DIR)/segbuf.o: test/segbuf.c include/testr.h include/io.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/segbuf: $(TEST_OBJ_DIR)/segbuf.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/segbuf.txt: $(TEST_OBJ_DIR)/segbuf
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+# TLSF allocator
+$(TEST_OBJ_DIR)/tlsf.o: test/tlsf.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/tlsf: $(TEST_OBJ_DIR)/tlsf.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/tlsf.txt: $(TEST_OBJ_DIR)/tlsf
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
 # Slice
 $(TEST_OBJ_DIR)/slice.o: test/slice.c include/testr.h include/std.h
 	@mkdir -p $(TEST_OBJ_DIR)
@@ -154,6 +261,94 @@ $(TEST_REPORT_DIR)/slice.txt: $(TEST_OBJ_DIR)/slice
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+# Sorting
+$(TEST_OBJ_DIR)/sort.o: test/sort.c include/testr.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/sort: $(TEST_OBJ_DIR)/sort.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/sort.txt: $(TEST_OBJ_DIR)/sort
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+#
+# Benchmarks
+#
+
+BENCH_NAMES += \
+	bitvec \
+	bytes_copy \
+	hashmap \
+	mmap_alloc \
+	pool \
+	slice_hash \
+	sort_radix \
+	tlsf
+
+# Bytes copy, move, and set
+$(BENCH_OBJ_DIR)/bytes_copy.o: bench/bytes_copy.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -DJP_DISABLE_STRING_H -c $< -o $@
+$(BENCH_OBJ_DIR)/bytes_copy: $(BENCH_OBJ_DIR)/bytes_copy.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std_nostr.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Slice hashing
+$(BENCH_OBJ_DIR)/slice_hash.o: bench/slice_hash.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/slice_hash: $(BENCH_OBJ_DIR)/slice_hash.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Hash map benchmark
+$(BENCH_OBJ_DIR)/hashmap.o: bench/hashmap.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/hashmap: $(BENCH_OBJ_DIR)/hashmap.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Radix sort
+$(BENCH_OBJ_DIR)/sort_radix.o: bench/sort_radix.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/sort_radix: $(BENCH_OBJ_DIR)/sort_radix.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Bit vector
+$(BENCH_OBJ_DIR)/bitvec.o: bench/bitvec.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/bitvec: $(BENCH_OBJ_DIR)/bitvec.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Pool allocator
+$(BENCH_OBJ_DIR)/pool.o: bench/pool.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/pool: $(BENCH_OBJ_DIR)/pool.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# Memory mapping options
+$(BENCH_OBJ_DIR)/mmap_alloc.o: bench/mmap_alloc.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/mmap_alloc: $(BENCH_OBJ_DIR)/mmap_alloc.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
+# TLSF allocator latency
+$(BENCH_OBJ_DIR)/tlsf.o: bench/tlsf.c include/benchr.h include/io.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/tlsf: $(BENCH_OBJ_DIR)/tlsf.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
+
 #
 # Clean-up
 #
@@ -10,7 +10,10 @@ $(OBJ_DIR)/mt.o: src/mt.c include/mt.h include/std.h
 # Testing
 #
 
-TEST_NAMES += ringbuf_spsc
+TEST_NAMES += \
+	alloc_stats \
+	ringbuf_spsc \
+	thread_cache
 
 # Ring buffer (SPSC)
 $(TEST_OBJ_DIR)/ringbuf_spsc.o: test/ringbuf_spsc.c include/testr.h include/mt.h include/std.h
@@ -22,3 +25,37 @@ $(TEST_REPORT_DIR)/ringbuf_spsc.txt: $(TEST_OBJ_DIR)/ringbuf_spsc
 	@mkdir -p $(TEST_REPORT_DIR)
 	./$< $(TEST_FILTERS) > $@
 
+
+# Instrumented allocator
+$(TEST_OBJ_DIR)/alloc_stats.o: test/alloc_stats.c include/testr.h include/mt.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/alloc_stats: $(TEST_OBJ_DIR)/alloc_stats.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/mt.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/alloc_stats.txt: $(TEST_OBJ_DIR)/alloc_stats
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+# Thread-caching allocator
+$(TEST_OBJ_DIR)/thread_cache.o: test/thread_cache.c include/testr.h include/mt.h include/std.h
+	@mkdir -p $(TEST_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(TEST_OBJ_DIR)/thread_cache: $(TEST_OBJ_DIR)/thread_cache.o $(OBJ_DIR)/testr.o $(OBJ_DIR)/mt.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	$(CC) $(LDFLAGS) $^ -o $@
+$(TEST_REPORT_DIR)/thread_cache.txt: $(TEST_OBJ_DIR)/thread_cache
+	@mkdir -p $(TEST_REPORT_DIR)
+	./$< $(TEST_FILTERS) > $@
+
+#
+# Benchmarks
+#
+
+BENCH_NAMES += thread_cache
+
+# Thread-caching allocator
+$(BENCH_OBJ_DIR)/thread_cache.o: bench/thread_cache.c include/benchr.h include/io.h include/mt.h include/std.h
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(CFLAGS) -c $< -o $@
+$(BENCH_OBJ_DIR)/thread_cache: $(BENCH_OBJ_DIR)/thread_cache.o $(OBJ_DIR)/benchr.o $(OBJ_DIR)/mt.o $(OBJ_DIR)/std.o $(OBJ_DIR)/io.o
+	@mkdir -p $(BENCH_OBJ_DIR)
+	$(CC) $(LDFLAGS) $^ -o $@
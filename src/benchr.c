@@ -0,0 +1,61 @@
+#define _POSIX_C_SOURCE 200809L
+#include "benchr.h"
+#include "std.h"
+#include <time.h>
+
+ullong bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (ullong)ts.tv_sec * 1000000000ULL + (ullong)ts.tv_nsec;
+}
+
+bench_result bench_run(bench_fun fn, void *ctx, ullong min_ns) {
+    assert(fn && "benchmark function must not be null");
+
+    bench_result res = {0};
+    ullong iterations = 1;
+    for (;;) {
+        ullong start = bench_now_ns();
+        fn(ctx, iterations);
+        ullong elapsed = bench_now_ns() - start;
+
+        res.iterations = iterations;
+        res.elapsed_ns = elapsed;
+        if (elapsed >= min_ns || iterations >= ULLONG_MAX / 2) {
+            return res;
+        }
+
+        // aim slightly past the minimum duration, but grow at most 100x
+        ullong next = elapsed > 0 ? iterations * min_ns / elapsed : 0;
+        next = next + next / 5;
+        iterations = clamp(next, iterations * 2, iterations * 100);
+    }
+}
+
+double bench_ns_per_op(bench_result res) {
+    if (res.iterations == 0) {
+        return 0.0;
+    }
+    return (double)res.elapsed_ns / (double)res.iterations;
+}
+
+double bench_gb_per_sec(bench_result res, ullong bytes_per_op) {
+    if (res.elapsed_ns == 0) {
+        return 0.0;
+    }
+    // bytes per nanosecond equals gigabytes per second
+    return (double)bytes_per_op * (double)res.iterations
+         / (double)res.elapsed_ns;
+}
+
+size_t bench_arg_size(const char *arg, size_t default_value) {
+    if (!arg) {
+        return default_value;
+    }
+    ullong v = 0;
+    size_t len = cstr_byte_len_unsafe(arg);
+    if (len == 0 || cstr_to_ullong(arg, len, &v) != len || v == 0) {
+        return default_value;
+    }
+    return (size_t)v;
+}
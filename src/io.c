@@ -74,6 +74,28 @@ io_write_all_sync(int fd, const void *buffer, size_t len, size_t chunk_len) {
     return res;
 }
 
+io_result io_write_segbuf_sync(int fd, segbuf *sbuf) {
+    assert(sbuf && "segbuf must not be null");
+
+    io_result res = {0};
+    struct iovec iov[64];
+
+    while (res.len < sbuf->len) {
+        size_t iov_len = segbuf_iovec(sbuf, iov, countof(iov), res.len);
+        ssize_t write_res = writev(fd, iov, (int)iov_len);
+        if (write_res < 0 && errno == EINTR) {
+            continue;
+        }
+        if (write_res < 0) {
+            res.err_code = errno;
+            break;
+        }
+        res.len += (size_t)write_res;
+    }
+
+    return res;
+}
+
 file_read_result file_read_sync(const char *filename, allocator *allocator) {
     assert(filename && "filename must not be null");
     assert(allocator && "allocator must not be null");
@@ -159,3 +159,508 @@ void ringbuf_spsc_release_read(ringbuf_spsc *rbuf, ringbuf_spsc_h handle) {
     size_t next_read_idx = (handle.idx + 1) % rbuf->max_items;
     atomic_store_explicit(&rbuf->read_idx, next_read_idx, memory_order_release);
 }
+
+////////////////////////
+// Instrumented allocator
+////////////////////////
+
+void alloc_stats_init(alloc_stats *stats, allocator *inner) {
+    assert(stats && "stats must not be null");
+    assert(inner && "inner allocator must not be null");
+    bytes_set(stats, 0, sizeof(*stats));
+    stats->inner = inner;
+}
+
+uint alloc_stats_size_class(size_t size) {
+    if (size <= 1) {
+        return 0;
+    }
+    uint size_class = bits_most_significant((ullong)(size - 1)) + 1;
+    return min(size_class, (uint)(alloc_stats_size_classes - 1));
+}
+
+uint alloc_stats_align_class(size_t alignment) {
+    if (alignment <= 1) {
+        return 0;
+    }
+    uint align_class = bits_most_significant((ullong)alignment);
+    return min(align_class, (uint)(alloc_stats_align_classes - 1));
+}
+
+static size_t alloc_stats_load(atomic_size_t *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static void alloc_stats_count(atomic_size_t *counter, size_t n) {
+    atomic_fetch_add_explicit(counter, n, memory_order_relaxed);
+}
+
+static void alloc_stats_record(
+    alloc_stats *stats, size_t size, size_t alignment, size_t added
+) {
+    alloc_stats_count(&stats->size_classes[alloc_stats_size_class(size)], 1);
+    alloc_stats_count(
+        &stats->align_classes[alloc_stats_align_class(alignment)], 1
+    );
+    if (added == 0) {
+        return;
+    }
+    alloc_stats_count(&stats->total_bytes, added);
+    size_t live = added
+                  + atomic_fetch_add_explicit(
+                      &stats->live_bytes, added, memory_order_relaxed
+                  );
+    size_t peak = alloc_stats_load(&stats->peak_bytes);
+    while (peak < live
+           && !atomic_compare_exchange_weak_explicit(
+               &stats->peak_bytes,
+               &peak,
+               live,
+               memory_order_relaxed,
+               memory_order_relaxed
+           )) {}
+}
+
+allocation alloc_stats_malloc(size_t size, size_t alignment, void *ctx) {
+    alloc_stats *stats = ctx;
+    assert(stats && "stats must not be null");
+    allocation a = alloc_malloc(stats->inner, size, alignment);
+    if (!allocation_exists(a)) {
+        alloc_stats_count(&stats->failures, 1);
+        return a;
+    }
+    alloc_stats_count(&stats->allocs, 1);
+    alloc_stats_record(stats, size, alignment, a.len);
+    return a;
+}
+
+void alloc_stats_free(allocation ptr, void *ctx) {
+    alloc_stats *stats = ctx;
+    assert(stats && "stats must not be null");
+    alloc_free(stats->inner, ptr);
+    alloc_stats_count(&stats->frees, 1);
+    atomic_fetch_sub_explicit(
+        &stats->live_bytes, ptr.len, memory_order_relaxed
+    );
+}
+
+allocation
+alloc_stats_realloc(allocation ptr, size_t size, size_t alignment, void *ctx) {
+    alloc_stats *stats = ctx;
+    assert(stats && "stats must not be null");
+    size_t old_len = ptr.len;
+    allocation a = alloc_realloc(stats->inner, ptr, size, alignment);
+    if (!allocation_exists(a)) {
+        alloc_stats_count(&stats->failures, 1);
+        return a;
+    }
+    alloc_stats_count(&stats->reallocs, 1);
+    if (a.len < old_len) {
+        atomic_fetch_sub_explicit(
+            &stats->live_bytes, old_len - a.len, memory_order_relaxed
+        );
+    }
+    alloc_stats_record(
+        stats, size, alignment, a.len > old_len ? a.len - old_len : 0
+    );
+    return a;
+}
+
+// Keep the length of all writes and the first error
+static void alloc_stats_report_add(
+    bufstream_write_result *total, bufstream_write_result res
+) {
+    total->len += res.len;
+    if (total->err_code == 0) {
+        total->err_code = res.err_code;
+    }
+}
+
+// Write a line of a label, a value, and a count. The value is omitted when
+// the label is for a counter.
+static void alloc_stats_report_line(
+    bufstream *bstream,
+    bufstream_write_result *total,
+    const char *label,
+    bool has_value,
+    ullong value,
+    size_t count
+) {
+    slice_const s = slice_const_from_cstr_unsafe(label);
+    alloc_stats_report_add(total, bufstream_write(bstream, s.ptr, s.len));
+    if (has_value) {
+        alloc_stats_report_add(total, bufstream_write_ullong(bstream, value));
+        alloc_stats_report_add(total, bufstream_write_sstr(bstream, ": "));
+    }
+    alloc_stats_report_add(total, bufstream_write_ullong(bstream, count));
+    alloc_stats_report_add(total, bufstream_write_sstr(bstream, "\n"));
+}
+
+bufstream_write_result
+alloc_stats_report(alloc_stats *stats, bufstream *bstream) {
+    assert(stats && "stats must not be null");
+    assert(bstream && "bstream must not be null");
+    bufstream_write_result total = {0};
+
+    struct {
+        const char *label;
+        atomic_size_t *counter;
+    } counters[] = {
+        {"allocs: ", &stats->allocs},
+        {"frees: ", &stats->frees},
+        {"reallocs: ", &stats->reallocs},
+        {"failures: ", &stats->failures},
+        {"live bytes: ", &stats->live_bytes},
+        {"peak bytes: ", &stats->peak_bytes},
+        {"total bytes: ", &stats->total_bytes},
+    };
+    for (size_t i = 0; i < countof(counters); i += 1) {
+        alloc_stats_report_line(
+            bstream,
+            &total,
+            counters[i].label,
+            0,
+            0,
+            alloc_stats_load(counters[i].counter)
+        );
+    }
+
+    alloc_stats_report_add(&total, bufstream_write_sstr(bstream, "sizes:\n"));
+    for (uint i = 0; i < alloc_stats_size_classes; i += 1) {
+        size_t count = alloc_stats_load(&stats->size_classes[i]);
+        if (count == 0) {
+            continue;
+        }
+        bool last = i == alloc_stats_size_classes - 1;
+        alloc_stats_report_line(
+            bstream,
+            &total,
+            last ? "  >" : "  <=",
+            1,
+            last ? 1ULL << (i - 1) : 1ULL << i,
+            count
+        );
+    }
+
+    alloc_stats_report_add(
+        &total, bufstream_write_sstr(bstream, "alignments:\n")
+    );
+    for (uint i = 0; i < alloc_stats_align_classes; i += 1) {
+        size_t count = alloc_stats_load(&stats->align_classes[i]);
+        if (count == 0) {
+            continue;
+        }
+        bool last = i == alloc_stats_align_classes - 1;
+        alloc_stats_report_line(
+            bstream, &total, last ? "  >=" : "  ", 1, 1ULL << i, count
+        );
+    }
+    return total;
+}
+
+////////////////////////
+// Thread-caching allocator
+////////////////////////
+
+// Bytes moved between a thread cache and the central lists at a time
+#define thread_cache_batch_bytes (size_t)(16 * 1024)
+#define thread_cache_batch_min 2
+#define thread_cache_batch_max 64
+
+// Free lists of a thread for one thread-caching allocator
+typedef struct {
+    uint owner;
+    size_t bytes;
+    void *objects[thread_cache_class_count];
+    size_t counts[thread_cache_class_count];
+} thread_cache_local;
+
+#if __STDC_VERSION__ >= 201112L
+static _Thread_local thread_cache_local thread_cache_locals[thread_cache_slots];
+#else
+static __thread thread_cache_local thread_cache_locals[thread_cache_slots];
+#endif
+
+// Identifiers of the allocators, so that a new allocator at the address of a
+// released one does not pick up stale thread caches
+static atomic_uint thread_cache_next_id = 1;
+
+static uint thread_cache_class(size_t size) {
+    if (size <= thread_cache_min_size) {
+        return 0;
+    }
+    return bits_most_significant((ullong)(size - 1)) + 1
+           - bits_most_significant(thread_cache_min_size);
+}
+
+static size_t thread_cache_class_size(uint size_class) {
+    return thread_cache_min_size << size_class;
+}
+
+static size_t thread_cache_batch(uint size_class) {
+    size_t batch =
+        thread_cache_batch_bytes / thread_cache_class_size(size_class);
+    return clamp(
+        batch, (size_t)thread_cache_batch_min, (size_t)thread_cache_batch_max
+    );
+}
+
+// Find the calling thread's cache for an allocator, claiming a free slot when
+// there is none yet
+static thread_cache_local *thread_cache_local_get(const thread_cache *tc) {
+    thread_cache_local *unused = NULL;
+    for (size_t i = 0; i < thread_cache_slots; i += 1) {
+        thread_cache_local *local = &thread_cache_locals[i];
+        if (local->owner == tc->id) {
+            return local;
+        }
+        if (local->owner == 0 && !unused) {
+            unused = local;
+        }
+    }
+    if (unused) {
+        unused->owner = tc->id;
+    }
+    return unused;
+}
+
+static void thread_cache_lock(thread_cache_central *central) {
+    while (atomic_flag_test_and_set_explicit(
+        &central->lock, memory_order_acquire
+    )) {}
+}
+
+static void thread_cache_unlock(thread_cache_central *central) {
+    atomic_flag_clear_explicit(&central->lock, memory_order_release);
+}
+
+static void thread_cache_inner_free(thread_cache *tc, void *ptr, size_t len) {
+    allocation a = {.ptr = ptr, .len = len};
+    alloc_free(tc->inner, a);
+}
+
+// Move up to count objects of a size class from a thread cache to the
+// central list, or to the inner allocator when the central list is full
+static void thread_cache_flush_class(
+    thread_cache *tc, thread_cache_local *local, uint size_class, size_t count
+) {
+    size_t size = thread_cache_class_size(size_class);
+    count = min(count, local->counts[size_class]);
+    if (count == 0) {
+        return;
+    }
+
+    // detach the first count objects
+    void *first = local->objects[size_class];
+    void *last = first;
+    for (size_t i = 1; i < count; i += 1) {
+        last = *(void **)last;
+    }
+    local->objects[size_class] = *(void **)last;
+    local->counts[size_class] -= count;
+    local->bytes -= count * size;
+
+    size_t bytes = count * size;
+    size_t central_bytes = atomic_fetch_add_explicit(
+        &tc->central_bytes, bytes, memory_order_relaxed
+    );
+    if (central_bytes + bytes > tc->max_central_bytes) {
+        atomic_fetch_sub_explicit(
+            &tc->central_bytes, bytes, memory_order_relaxed
+        );
+        *(void **)last = NULL;
+        while (first) {
+            void *next = *(void **)first;
+            thread_cache_inner_free(tc, first, size);
+            first = next;
+        }
+        return;
+    }
+
+    thread_cache_central *central = &tc->central[size_class];
+    thread_cache_lock(central);
+    *(void **)last = central->objects;
+    central->objects = first;
+    central->count += count;
+    thread_cache_unlock(central);
+}
+
+// Fill an empty thread cache list from the central list or the inner
+// allocator
+static bool thread_cache_refill(
+    thread_cache *tc, thread_cache_local *local, uint size_class
+) {
+    size_t size = thread_cache_class_size(size_class);
+    size_t batch = thread_cache_batch(size_class);
+    thread_cache_central *central = &tc->central[size_class];
+
+    thread_cache_lock(central);
+    size_t count = min(batch, central->count);
+    void *first = central->objects;
+    void *last = first;
+    for (size_t i = 1; i < count; i += 1) {
+        last = *(void **)last;
+    }
+    if (count > 0) {
+        central->objects = *(void **)last;
+        central->count -= count;
+    }
+    thread_cache_unlock(central);
+
+    if (count > 0) {
+        atomic_fetch_sub_explicit(
+            &tc->central_bytes, count * size, memory_order_relaxed
+        );
+        *(void **)last = local->objects[size_class];
+        local->objects[size_class] = first;
+    } else {
+        for (; count < batch; count += 1) {
+            allocation a = alloc_malloc(tc->inner, size, thread_cache_min_size);
+            if (!allocation_exists(a)) {
+                break;
+            }
+            *(void **)a.ptr = local->objects[size_class];
+            local->objects[size_class] = a.ptr;
+        }
+    }
+    local->counts[size_class] += count;
+    local->bytes += count * size;
+    return count > 0;
+}
+
+void thread_cache_init(
+    thread_cache *tc, allocator *inner, size_t max_thread_bytes
+) {
+    assert(tc && "thread cache must not be null");
+    assert(inner && "inner allocator must not be null");
+    bytes_set(tc, 0, sizeof(*tc));
+    tc->inner = inner;
+    tc->max_thread_bytes =
+        max_thread_bytes ? max_thread_bytes : thread_cache_default_max_bytes;
+    tc->max_central_bytes = tc->max_thread_bytes * 16;
+    tc->id = atomic_fetch_add_explicit(
+        &thread_cache_next_id, 1, memory_order_relaxed
+    );
+    for (size_t i = 0; i < thread_cache_class_count; i += 1) {
+        atomic_flag_clear(&tc->central[i].lock);
+    }
+}
+
+void thread_cache_flush(thread_cache *tc) {
+    assert(tc && "thread cache must not be null");
+    for (size_t i = 0; i < thread_cache_slots; i += 1) {
+        thread_cache_local *local = &thread_cache_locals[i];
+        if (local->owner != tc->id) {
+            continue;
+        }
+        for (uint c = 0; c < thread_cache_class_count; c += 1) {
+            thread_cache_flush_class(tc, local, c, local->counts[c]);
+        }
+        local->owner = 0;
+    }
+}
+
+void thread_cache_release(thread_cache *tc) {
+    assert(tc && "thread cache must not be null");
+    for (uint c = 0; c < thread_cache_class_count; c += 1) {
+        thread_cache_central *central = &tc->central[c];
+        thread_cache_lock(central);
+        void *object = central->objects;
+        central->objects = NULL;
+        central->count = 0;
+        thread_cache_unlock(central);
+        while (object) {
+            void *next = *(void **)object;
+            thread_cache_inner_free(tc, object, thread_cache_class_size(c));
+            object = next;
+        }
+    }
+    atomic_store_explicit(&tc->central_bytes, 0, memory_order_relaxed);
+}
+
+allocation thread_cache_malloc(size_t size, size_t alignment, void *ctx) {
+    thread_cache *tc = ctx;
+    assert(tc && "thread cache must not be null");
+    if (size > thread_cache_max_size || alignment > thread_cache_min_size) {
+        return alloc_malloc(tc->inner, size, alignment);
+    }
+
+    uint size_class = thread_cache_class(size);
+    size_t class_size = thread_cache_class_size(size_class);
+    thread_cache_local *local = thread_cache_local_get(tc);
+    if (!local) {
+        return alloc_malloc(tc->inner, class_size, thread_cache_min_size);
+    }
+    if (!local->objects[size_class]
+        && !thread_cache_refill(tc, local, size_class)) {
+        return (allocation) {0};
+    }
+
+    void *object = local->objects[size_class];
+    local->objects[size_class] = *(void **)object;
+    local->counts[size_class] -= 1;
+    local->bytes -= class_size;
+    return (allocation) {
+        .ptr = object,
+        .len = class_size,
+    };
+}
+
+void thread_cache_free(allocation a, void *ctx) {
+    thread_cache *tc = ctx;
+    assert(tc && "thread cache must not be null");
+    assert(a.ptr && "ptr must not be null");
+    uint size_class = thread_cache_class(a.len);
+    thread_cache_local *local = NULL;
+    if (a.len <= thread_cache_max_size
+        && a.len == thread_cache_class_size(size_class)) {
+        local = thread_cache_local_get(tc);
+    }
+    if (!local) {
+        // not a size class, or no room for another thread cache
+        alloc_free(tc->inner, a);
+        return;
+    }
+
+    *(void **)a.ptr = local->objects[size_class];
+    local->objects[size_class] = a.ptr;
+    local->counts[size_class] += 1;
+    local->bytes += a.len;
+    if (local->bytes <= tc->max_thread_bytes) {
+        return;
+    }
+
+    // keep half a batch for the next allocations of the class
+    size_t keep = thread_cache_batch(size_class) / 2;
+    size_t count = local->counts[size_class];
+    thread_cache_flush_class(
+        tc, local, size_class, count > keep ? count - keep : 0
+    );
+    for (uint c = 0; c < thread_cache_class_count
+                     && local->bytes > tc->max_thread_bytes;
+         c += 1) {
+        thread_cache_flush_class(tc, local, c, local->counts[c]);
+    }
+}
+
+allocation thread_cache_realloc(
+    allocation a, size_t size, size_t alignment, void *ctx
+) {
+    thread_cache *tc = ctx;
+    assert(tc && "thread cache must not be null");
+    if (a.len > thread_cache_max_size && size > thread_cache_max_size) {
+        return alloc_realloc(tc->inner, a, size, alignment);
+    }
+    if (size <= a.len && a.len <= thread_cache_max_size
+        && (uintptr_t)a.ptr % alignment == 0
+        && thread_cache_class(size) == thread_cache_class(a.len)) {
+        return a;
+    }
+    allocation resized = thread_cache_malloc(size, alignment, ctx);
+    if (!allocation_exists(resized)) {
+        return resized;
+    }
+    bytes_copy(resized.ptr, a.ptr, min(a.len, size));
+    thread_cache_free(a, ctx);
+    return resized;
+}
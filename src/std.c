@@ -1,1622 +1,6267 @@
+// mremap is a GNU extension
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
 #include "std.h"
 #include <float.h>
 #include <limits.h>
 #include <stdarg.h>
 #include <stdint.h>
 
+#ifdef JP_SIMD_X86
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 ////////////////////////
-// Bytes
+// CPU features
 ////////////////////////
 
-llong bytes_diff_index(const void *a, const void *b, size_t start, size_t len) {
-    if (len == 0 || (uintptr_t)a == (uintptr_t)b) {
-        return -1LL;
-    }
-    if (!a || !b) {
-        return 0LL;
-    }
-    assert(start < len && "start must be lower than or equal to length");
-    assert(len < LLONG_MAX && "len must be smaller than llong max");
-
-    const uchar *a_ = a, *b_ = b;
-    for (size_t i = start; i < len; i += 1) {
-        if (a_[i] != b_[i]) {
-            return (long)i;
-        }
-    }
-    return -1LL;
+#if defined(__GNUC__) || defined(__clang__)
+#define cpu_atomic_load(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define cpu_atomic_store(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+#define cpu_atomic_load(p) (*(p))
+#define cpu_atomic_store(p, v) (*(p) = (v))
+#endif
+
+// Marks the feature cache as probed, so that an empty feature set is cached too
+#define cpu_features_probed (uint)(1U << 31)
+
+static uint cpu_features_cache;
+static uint cpu_features_allowed = ~0U;
+
+// Routine families that dispatch through cpu_dispatch_get
+#define cpu_dispatch_bytes 0
+#define cpu_dispatch_bytes_mem 1
+#define cpu_dispatch_crc32c 2
+#define cpu_dispatch_bitvec 3
+#define cpu_dispatch_families 4
+
+static const void *cpu_dispatch_active[cpu_dispatch_families];
+
+#ifdef JP_SIMD_X86
+
+// The CPU may support AVX while the OS does not save the wider registers on
+// context switches, so the register state enabled in XCR0 is checked too.
+static ullong cpu_xgetbv(void) {
+    uint lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((ullong)hi << 32) | lo;
 }
 
-bool bytes_eq(const void *a, const void *b, size_t len) {
-    if (bytes_diff_index(a, b, 0, len) >= 0) {
-        return false;
+static uint cpu_features_probe(void) {
+    uint eax, ebx, ecx, edx;
+    uint features = 0;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return features;
     }
-    return true;
-}
+    features |= (edx & bit_SSE2) ? cpu_feature_sse2 : 0;
+    features |= (ecx & bit_SSSE3) ? cpu_feature_ssse3 : 0;
+    features |= (ecx & bit_SSE4_1) ? cpu_feature_sse41 : 0;
+    features |= (ecx & bit_SSE4_2) ? cpu_feature_sse42 : 0;
+    features |= (ecx & bit_POPCNT) ? cpu_feature_popcnt : 0;
+    features |= (ecx & bit_PCLMUL) ? cpu_feature_pclmul : 0;
 
-llong bytes_index_of(const void *a, size_t a_len, const void *b, size_t b_len) {
-    assert(a_len < LLONG_MAX && "len must be smaller than llong max");
+    ullong xcr0 = (ecx & bit_OSXSAVE) ? cpu_xgetbv() : 0;
+    bool ymm_state = (xcr0 & 0x6) == 0x6; // SSE and AVX state
+    bool zmm_state = (xcr0 & 0xE6) == 0xE6; // and opmask + ZMM state
 
-    if (a_len == 0 || a_len < b_len || !a || !b) {
-        return -1LL;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return features;
     }
-    if (b_len == 0 || (uintptr_t)a == (uintptr_t)b) {
-        return 0LL;
+    features |= (ebx & bit_BMI2) ? cpu_feature_bmi2 : 0;
+    features |= (ebx & (1U << 9)) ? cpu_feature_erms : 0;
+    if (ymm_state && (ebx & bit_AVX2)) {
+        features |= cpu_feature_avx2;
     }
-    for (size_t i = 0; i < a_len; i += 1) {
-        if (bytes_eq((const uchar *)a + i, b, min(a_len - i, b_len))) {
-            return (llong)i;
-        }
+    if (zmm_state && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW)) {
+        features |= cpu_feature_avx512;
     }
-    return -1LL;
+    return features;
 }
 
-static inline char byte_to_hex_char(char b) {
-    assert(b < 16 && "byte must be between 0..=15");
-    return (char)('0' + b
-                  + ( // promote numbers >9 to ascii a-f range
-                      (b > 9) * ('a' - '0' - 10)
-                  ));
-}
+#endif // JP_SIMD_X86
 
-size_t
-bytes_to_hex(char *dest, size_t dest_len, const char *src, size_t src_len) {
-    size_t j = 0;
-    for (size_t i = 0; i < src_len && j < dest_len; i += 1, j += 2) {
-        dest[j] = byte_to_hex_char(src[i] >> 4); // high bit
-        dest[j + 1] = byte_to_hex_char(src[i] & 15); // low bit
+uint cpu_features(void) {
+    uint features = cpu_atomic_load(&cpu_features_cache);
+    if (!features) {
+#ifdef JP_SIMD_X86
+        features = cpu_features_probe();
+#endif
+        features |= cpu_features_probed;
+        cpu_atomic_store(&cpu_features_cache, features);
     }
+    return features & cpu_atomic_load(&cpu_features_allowed)
+        & ~cpu_features_probed;
+}
 
-    if (j < dest_len) {
-        // null terminate if possible
-        dest[j] = 0;
+void cpu_features_limit(uint features) {
+    cpu_atomic_store(&cpu_features_allowed, features);
+    for (size_t i = 0; i < countof(cpu_dispatch_active); i += 1) {
+        cpu_atomic_store(&cpu_dispatch_active[i], NULL);
     }
-    return j;
 }
 
-llong bytes_index_of_byte(const uchar *buffer, size_t len, uchar byte) {
-    assert(len < LLONG_MAX && "len must be less than llong max");
+const void *
+cpu_dispatch_select(const cpu_dispatch_variant *variants, size_t len) {
+    assert(variants && "variants must not be null");
+    uint features = cpu_features();
     for (size_t i = 0; i < len; i += 1) {
-        if (buffer[i] == byte) {
-            return (llong)i;
+        if ((variants[i].features & features) == variants[i].features) {
+            return variants[i].table;
         }
     }
-    return -1;
+    return NULL;
+}
+
+// Get the active routine table of a family. The table is picked on the first
+// call and again after the allowed features are changed.
+static const void *cpu_dispatch_get(
+    uint family, const cpu_dispatch_variant *variants, size_t len
+) {
+    assert(family < cpu_dispatch_families && "unknown dispatch family");
+    const void *table = cpu_atomic_load(&cpu_dispatch_active[family]);
+    if (!table) {
+        table = cpu_dispatch_select(variants, len);
+        assert(table && "no dispatch variant matched");
+        cpu_atomic_store(&cpu_dispatch_active[family], table);
+    }
+    return table;
 }
 
 ////////////////////////
-// Allocator
+// Bytes
 ////////////////////////
 
-allocation mmap_malloc(size_t size, size_t alignment, void *ctx) {
-    assert(size > 0 && "size must be greater than 0");
-    (void)alignment;
-    (void)ctx;
-
-    long page_size_signed = sysconf(_SC_PAGE_SIZE);
-    assert(page_size_signed > 0 && "expected a page size >0");
-
-    size = (size_t)round_up_multiple_ullong(
-        (ullong)size, (ullong)page_size_signed
-    );
-
-    void *ptr = mmap(
-        0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
-    );
-    if (ptr == MAP_FAILED) {
-        return (allocation) {0};
+#ifdef JP_DISABLE_STRING_H
+
+// The compiler may recognise the loops below as memcpy, memmove or memset and
+// replace them with calls to the very functions that are not available when
+// string.h is disabled.
+#if defined(__clang__)
+#define bytes_no_builtin __attribute__((no_builtin))
+#elif defined(__GNUC__)
+#define bytes_no_builtin \
+    __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define bytes_no_builtin
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+// Word types for unaligned loads and stores that may alias any other type
+typedef ullong __attribute__((may_alias, aligned(1))) bytes_word;
+typedef uint __attribute__((may_alias, aligned(1))) bytes_word32;
+#define JP_BYTES_WORD
+#endif
+
+#ifndef JP_SIMD_X86
+
+// Forward copy. Each word is loaded before it is stored, so this is also safe
+// for overlapping moves where dest is before src.
+bytes_no_builtin static void
+bytes_copy_forward_scalar(uchar *d, const uchar *s, size_t n) {
+#ifdef JP_BYTES_WORD
+    for (; n >= sizeof(ullong); n -= sizeof(ullong)) {
+        *(bytes_word *)d = *(const bytes_word *)s;
+        d += sizeof(ullong);
+        s += sizeof(ullong);
+    }
+#endif
+    for (; n > 0; n -= 1) {
+        *d++ = *s++;
     }
-    return (allocation) {
-        .ptr = ptr,
-        .len = size,
-    };
 }
 
-void mmap_free(allocation a, void *ctx) {
-    assert(a.ptr && "ptr must not be null");
-    (void)ctx;
-    munmap(a.ptr, a.len);
+// Backward copy for overlapping moves where dest is after src
+bytes_no_builtin static void
+bytes_copy_backward_scalar(uchar *d, const uchar *s, size_t n) {
+    d += n;
+    s += n;
+#ifdef JP_BYTES_WORD
+    for (; n >= sizeof(ullong); n -= sizeof(ullong)) {
+        d -= sizeof(ullong);
+        s -= sizeof(ullong);
+        *(bytes_word *)d = *(const bytes_word *)s;
+    }
+#endif
+    for (; n > 0; n -= 1) {
+        *--d = *--s;
+    }
 }
 
-////////////////////////
-// Slices
-////////////////////////
-
-slice slice_span(void *start, void *end) {
-    assert(start && "start must not be null");
-    assert(end && "end must not be null");
-
-    uchar *temp;
-    if ((uintptr_t)start > (uintptr_t)end) {
-        temp = start;
-        start = end;
-        end = temp;
+bytes_no_builtin static void bytes_set_scalar(uchar *d, uchar c, size_t n) {
+#ifdef JP_BYTES_WORD
+    ullong word = c * 0x0101010101010101ULL;
+    for (; n >= sizeof(ullong); n -= sizeof(ullong)) {
+        *(bytes_word *)d = word;
+        d += sizeof(ullong);
+    }
+#endif
+    for (; n > 0; n -= 1) {
+        *d++ = c;
     }
-
-    slice s = {0};
-    s.ptr = start;
-    s.len = (size_t)((uintptr_t)end - (uintptr_t)start);
-    return s;
 }
 
-bool slice_const_eq(const slice_const a, const slice_const b) {
-    if (a.len != b.len) {
-        return 0;
+#endif // JP_SIMD_X86
+
+#ifdef JP_SIMD_X86
+
+// Copies of up to 64 bytes. Everything is loaded before anything is stored,
+// which makes this safe for overlapping moves too.
+__attribute__((target("sse2"))) static inline void
+bytes_copy_small(uchar *d, const uchar *s, size_t n) {
+    assert(n <= 64 && "n must be <= 64");
+    if (n >= 32) {
+        __m128i a = _mm_loadu_si128((const __m128i *)s);
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(s + n - 32));
+        __m128i e = _mm_loadu_si128((const __m128i *)(s + n - 16));
+        _mm_storeu_si128((__m128i *)d, a);
+        _mm_storeu_si128((__m128i *)(d + 16), b);
+        _mm_storeu_si128((__m128i *)(d + n - 32), c);
+        _mm_storeu_si128((__m128i *)(d + n - 16), e);
+    } else if (n >= 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)s);
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + n - 16));
+        _mm_storeu_si128((__m128i *)d, a);
+        _mm_storeu_si128((__m128i *)(d + n - 16), b);
+    } else if (n >= 8) {
+        ullong a = *(const bytes_word *)s;
+        ullong b = *(const bytes_word *)(s + n - 8);
+        *(bytes_word *)d = a;
+        *(bytes_word *)(d + n - 8) = b;
+    } else if (n >= 4) {
+        uint a = *(const bytes_word32 *)s;
+        uint b = *(const bytes_word32 *)(s + n - 4);
+        *(bytes_word32 *)d = a;
+        *(bytes_word32 *)(d + n - 4) = b;
+    } else if (n > 0) {
+        uchar a = s[0], b = s[n / 2], c = s[n - 1];
+        d[0] = a;
+        d[n / 2] = b;
+        d[n - 1] = c;
     }
-    return bytes_eq(a.ptr, b.ptr, a.len);
 }
 
-bool slice_eq(const slice a, const slice b) {
-    if (a.len != b.len) {
-        return 0;
+__attribute__((target("sse2"))) static inline void
+bytes_set_small(uchar *d, uchar c, size_t n) {
+    assert(n <= 64 && "n must be <= 64");
+    if (n >= 16) {
+        __m128i v = _mm_set1_epi8((char)c);
+        _mm_storeu_si128((__m128i *)d, v);
+        _mm_storeu_si128((__m128i *)(d + n - 16), v);
+        if (n >= 32) {
+            _mm_storeu_si128((__m128i *)(d + 16), v);
+            _mm_storeu_si128((__m128i *)(d + n - 32), v);
+        }
+    } else if (n >= 8) {
+        ullong word = c * 0x0101010101010101ULL;
+        *(bytes_word *)d = word;
+        *(bytes_word *)(d + n - 8) = word;
+    } else if (n >= 4) {
+        uint word = c * 0x01010101U;
+        *(bytes_word32 *)d = word;
+        *(bytes_word32 *)(d + n - 4) = word;
+    } else if (n > 0) {
+        d[0] = c;
+        d[n / 2] = c;
+        d[n - 1] = c;
     }
-    return bytes_eq(a.ptr, b.ptr, a.len);
 }
 
-void slice_copy(slice dest, const slice src) {
-    size_t amount = min(src.len, dest.len);
-    bytes_copy(dest.ptr, src.ptr, amount);
+// Whether rep movsb/stosb is the fastest way to copy or fill n bytes
+static inline bool bytes_use_rep(size_t n) {
+    return n >= JP_BYTES_REP_THRESHOLD && cpu_has_features(cpu_feature_erms);
 }
 
-void slice_move(slice dest, const slice src) {
-    size_t amount = min(src.len, dest.len);
-    bytes_move(dest.ptr, src.ptr, amount);
+static inline void bytes_copy_rep(uchar *d, const uchar *s, size_t n) {
+    __asm__ __volatile__("rep movsb" : "+D"(d), "+S"(s), "+c"(n) : : "memory");
 }
 
-slice_const slice_const_from_cstr_unsafe(const char *str) {
-    slice_const slice = {0};
-    slice.ptr = (const uchar *)str;
-    slice.len = (str == NULL) ? 0 : cstr_byte_len_unsafe(str);
-    return slice;
+static inline void bytes_set_rep(uchar *d, uchar c, size_t n) {
+    __asm__ __volatile__("rep stosb" : "+D"(d), "+c"(n) : "a"(c) : "memory");
 }
 
-slice slice_from_cstr_unsafe(char *str) {
-    slice slice = {0};
-    slice.ptr = (uchar *)str;
-    slice.len = cstr_byte_len_unsafe(str);
-    return slice;
+// The kernels below are used for more than 64 bytes. Forward copies load the
+// last block before the loop and backward copies the first block, so that the
+// unaligned remainder can be stored last without reading overwritten bytes.
+// Non-temporal copies and fills first store one unaligned block, and then
+// continue from the next aligned destination address.
+
+__attribute__((target("sse2"))) static void
+bytes_copy_forward_sse2(uchar *d, const uchar *s, size_t n) {
+    __m128i tail = _mm_loadu_si128((const __m128i *)(s + n - 16));
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + i + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(s + i + 32));
+        __m128i e = _mm_loadu_si128((const __m128i *)(s + i + 48));
+        _mm_storeu_si128((__m128i *)(d + i), a);
+        _mm_storeu_si128((__m128i *)(d + i + 16), b);
+        _mm_storeu_si128((__m128i *)(d + i + 32), c);
+        _mm_storeu_si128((__m128i *)(d + i + 48), e);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm_storeu_si128(
+            (__m128i *)(d + i), _mm_loadu_si128((const __m128i *)(s + i))
+        );
+    }
+    _mm_storeu_si128((__m128i *)(d + n - 16), tail);
 }
 
-////////////////////////
-// Arena allocator
-////////////////////////
+__attribute__((target("sse2"))) static void
+bytes_copy_backward_sse2(uchar *d, const uchar *s, size_t n) {
+    __m128i head = _mm_loadu_si128((const __m128i *)s);
+    size_t i = n;
+    for (; i >= 64; i -= 64) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(s + i - 16));
+        __m128i b = _mm_loadu_si128((const __m128i *)(s + i - 32));
+        __m128i c = _mm_loadu_si128((const __m128i *)(s + i - 48));
+        __m128i e = _mm_loadu_si128((const __m128i *)(s + i - 64));
+        _mm_storeu_si128((__m128i *)(d + i - 16), a);
+        _mm_storeu_si128((__m128i *)(d + i - 32), b);
+        _mm_storeu_si128((__m128i *)(d + i - 48), c);
+        _mm_storeu_si128((__m128i *)(d + i - 64), e);
+    }
+    for (; i >= 16; i -= 16) {
+        _mm_storeu_si128(
+            (__m128i *)(d + i - 16),
+            _mm_loadu_si128((const __m128i *)(s + i - 16))
+        );
+    }
+    _mm_storeu_si128((__m128i *)d, head);
+}
 
-arena arena_new(void *buffer, size_t size) {
-    arena arena = {.buffer = (uchar *)buffer, .size = size, .used = 0};
-    return arena;
+__attribute__((target("sse2"))) static void
+bytes_copy_sse2(uchar *d, const uchar *s, size_t n) {
+    if (n >= JP_BYTES_NT_THRESHOLD) {
+        _mm_storeu_si128((__m128i *)d, _mm_loadu_si128((const __m128i *)s));
+        size_t i = 16 - ((uintptr_t)d & 15);
+        for (; i + 64 <= n; i += 64) {
+            __m128i a = _mm_loadu_si128((const __m128i *)(s + i));
+            __m128i b = _mm_loadu_si128((const __m128i *)(s + i + 16));
+            __m128i c = _mm_loadu_si128((const __m128i *)(s + i + 32));
+            __m128i e = _mm_loadu_si128((const __m128i *)(s + i + 48));
+            _mm_stream_si128((__m128i *)(d + i), a);
+            _mm_stream_si128((__m128i *)(d + i + 16), b);
+            _mm_stream_si128((__m128i *)(d + i + 32), c);
+            _mm_stream_si128((__m128i *)(d + i + 48), e);
+        }
+        _mm_sfence();
+        bytes_copy_forward_sse2(d + n - 64, s + n - 64, 64);
+        return;
+    }
+    if (bytes_use_rep(n)) {
+        bytes_copy_rep(d, s, n);
+        return;
+    }
+    bytes_copy_forward_sse2(d, s, n);
 }
 
-void *arena_alloc_bytes(arena *arena, size_t size, size_t alignment) {
-    assert(arena && "arena must not be null");
+__attribute__((target("sse2"))) static void
+bytes_move_sse2(uchar *d, const uchar *s, size_t n) {
+    if ((uintptr_t)d < (uintptr_t)s) {
+        bytes_copy_forward_sse2(d, s, n);
+    } else {
+        bytes_copy_backward_sse2(d, s, n);
+    }
+}
 
-    size_t aligned_used = align_to_nearest(arena->used, alignment);
-    assert(
-        SIZE_MAX - aligned_used > size
-        && "size + aligned_used must not exceed size max"
-    );
+__attribute__((target("sse2"))) static void
+bytes_set_sse2(uchar *d, uchar c, size_t n) {
+    const __m128i v = _mm_set1_epi8((char)c);
+    size_t i = 0;
+    if (n >= JP_BYTES_NT_THRESHOLD) {
+        _mm_storeu_si128((__m128i *)d, v);
+        i = 16 - ((uintptr_t)d & 15);
+        for (; i + 64 <= n; i += 64) {
+            _mm_stream_si128((__m128i *)(d + i), v);
+            _mm_stream_si128((__m128i *)(d + i + 16), v);
+            _mm_stream_si128((__m128i *)(d + i + 32), v);
+            _mm_stream_si128((__m128i *)(d + i + 48), v);
+        }
+        _mm_sfence();
+    } else if (bytes_use_rep(n)) {
+        bytes_set_rep(d, c, n);
+        return;
+    }
+    for (; i + 64 <= n; i += 64) {
+        _mm_storeu_si128((__m128i *)(d + i), v);
+        _mm_storeu_si128((__m128i *)(d + i + 16), v);
+        _mm_storeu_si128((__m128i *)(d + i + 32), v);
+        _mm_storeu_si128((__m128i *)(d + i + 48), v);
+    }
+    for (; i + 16 <= n; i += 16) {
+        _mm_storeu_si128((__m128i *)(d + i), v);
+    }
+    _mm_storeu_si128((__m128i *)(d + n - 16), v);
+}
 
-    if (arena->size < size + aligned_used) {
-        return NULL;
+__attribute__((target("avx2"))) static void
+bytes_copy_forward_avx2(uchar *d, const uchar *s, size_t n) {
+    __m256i tail = _mm256_loadu_si256((const __m256i *)(s + n - 32));
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+        _mm256_storeu_si256((__m256i *)(d + i), a);
+        _mm256_storeu_si256((__m256i *)(d + i + 32), b);
+        _mm256_storeu_si256((__m256i *)(d + i + 64), c);
+        _mm256_storeu_si256((__m256i *)(d + i + 96), e);
+    }
+    for (; i + 32 <= n; i += 32) {
+        _mm256_storeu_si256(
+            (__m256i *)(d + i), _mm256_loadu_si256((const __m256i *)(s + i))
+        );
     }
-    void *p = arena->buffer + aligned_used;
-    arena->used = aligned_used + size;
-    return p;
+    _mm256_storeu_si256((__m256i *)(d + n - 32), tail);
 }
 
-void arena_clear(arena *arena) {
-    arena->used = 0;
+__attribute__((target("avx2"))) static void
+bytes_copy_backward_avx2(uchar *d, const uchar *s, size_t n) {
+    __m256i head = _mm256_loadu_si256((const __m256i *)s);
+    size_t i = n;
+    for (; i >= 128; i -= 128) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(s + i - 32));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(s + i - 64));
+        __m256i c = _mm256_loadu_si256((const __m256i *)(s + i - 96));
+        __m256i e = _mm256_loadu_si256((const __m256i *)(s + i - 128));
+        _mm256_storeu_si256((__m256i *)(d + i - 32), a);
+        _mm256_storeu_si256((__m256i *)(d + i - 64), b);
+        _mm256_storeu_si256((__m256i *)(d + i - 96), c);
+        _mm256_storeu_si256((__m256i *)(d + i - 128), e);
+    }
+    for (; i >= 32; i -= 32) {
+        _mm256_storeu_si256(
+            (__m256i *)(d + i - 32),
+            _mm256_loadu_si256((const __m256i *)(s + i - 32))
+        );
+    }
+    _mm256_storeu_si256((__m256i *)d, head);
 }
 
-allocation arena_malloc(size_t size, size_t alignment, void *ctx) {
-    arena *arena = ctx;
-    void *ptr = arena_alloc_bytes(arena, size, alignment);
-    if (ptr == NULL) {
-        return (allocation) {0};
+__attribute__((target("avx2"))) static void
+bytes_copy_avx2(uchar *d, const uchar *s, size_t n) {
+    if (n >= JP_BYTES_NT_THRESHOLD) {
+        _mm256_storeu_si256(
+            (__m256i *)d, _mm256_loadu_si256((const __m256i *)s)
+        );
+        size_t i = 32 - ((uintptr_t)d & 31);
+        for (; i + 128 <= n; i += 128) {
+            __m256i a = _mm256_loadu_si256((const __m256i *)(s + i));
+            __m256i b = _mm256_loadu_si256((const __m256i *)(s + i + 32));
+            __m256i c = _mm256_loadu_si256((const __m256i *)(s + i + 64));
+            __m256i e = _mm256_loadu_si256((const __m256i *)(s + i + 96));
+            _mm256_stream_si256((__m256i *)(d + i), a);
+            _mm256_stream_si256((__m256i *)(d + i + 32), b);
+            _mm256_stream_si256((__m256i *)(d + i + 64), c);
+            _mm256_stream_si256((__m256i *)(d + i + 96), e);
+        }
+        _mm_sfence();
+        bytes_copy_forward_avx2(d + n - 128, s + n - 128, 128);
+        return;
     }
-    return (allocation) {
-        .ptr = ptr,
-        .len = size,
-    };
+    if (bytes_use_rep(n)) {
+        bytes_copy_rep(d, s, n);
+        return;
+    }
+    bytes_copy_forward_avx2(d, s, n);
 }
 
-void arena_free(allocation a, void *ctx) {
-    (void)ctx;
-    (void)a;
+__attribute__((target("avx2"))) static void
+bytes_move_avx2(uchar *d, const uchar *s, size_t n) {
+    if ((uintptr_t)d < (uintptr_t)s) {
+        bytes_copy_forward_avx2(d, s, n);
+    } else {
+        bytes_copy_backward_avx2(d, s, n);
+    }
 }
 
-allocator arena_allocator_new(arena *arena) {
-    allocator a = {.ctx = arena, .malloc = arena_malloc, .free = arena_free};
-    return a;
+__attribute__((target("avx2"))) static void
+bytes_set_avx2(uchar *d, uchar c, size_t n) {
+    const __m256i v = _mm256_set1_epi8((char)c);
+    size_t i = 0;
+    if (n >= JP_BYTES_NT_THRESHOLD) {
+        _mm256_storeu_si256((__m256i *)d, v);
+        i = 32 - ((uintptr_t)d & 31);
+        for (; i + 128 <= n; i += 128) {
+            _mm256_stream_si256((__m256i *)(d + i), v);
+            _mm256_stream_si256((__m256i *)(d + i + 32), v);
+            _mm256_stream_si256((__m256i *)(d + i + 64), v);
+            _mm256_stream_si256((__m256i *)(d + i + 96), v);
+        }
+        _mm_sfence();
+    } else if (bytes_use_rep(n)) {
+        bytes_set_rep(d, c, n);
+        return;
+    }
+    for (; i + 128 <= n; i += 128) {
+        _mm256_storeu_si256((__m256i *)(d + i), v);
+        _mm256_storeu_si256((__m256i *)(d + i + 32), v);
+        _mm256_storeu_si256((__m256i *)(d + i + 64), v);
+        _mm256_storeu_si256((__m256i *)(d + i + 96), v);
+    }
+    for (; i + 32 <= n; i += 32) {
+        _mm256_storeu_si256((__m256i *)(d + i), v);
+    }
+    _mm256_storeu_si256((__m256i *)(d + n - 32), v);
 }
 
-////////////////////////
-// Dynamic array
-////////////////////////
+typedef struct {
+    void (*copy)(uchar *, const uchar *, size_t);
+    void (*move)(uchar *, const uchar *, size_t);
+    void (*set)(uchar *, uchar, size_t);
+} bytes_mem_kernels;
 
-void *dynarr_new_sized(
-    ullong capacity, size_t item_size, size_t alignment, allocator *allocator
-) {
-    alignment = max(alignment, alignof(dynarr_header));
-    allocation a = alloc_malloc(
-        allocator, dynarr_count_to_bytes(capacity, item_size), alignment
+static const bytes_mem_kernels bytes_mem_kernels_avx2 = {
+    bytes_copy_avx2, bytes_move_avx2, bytes_set_avx2
+};
+static const bytes_mem_kernels bytes_mem_kernels_sse2 = {
+    bytes_copy_sse2, bytes_move_sse2, bytes_set_sse2
+};
+
+static const cpu_dispatch_variant bytes_mem_variants[] = {
+    {cpu_feature_avx2, &bytes_mem_kernels_avx2},
+    {0, &bytes_mem_kernels_sse2},
+};
+
+static inline const bytes_mem_kernels *bytes_mem_kernels_get(void) {
+    return cpu_dispatch_get(
+        cpu_dispatch_bytes_mem, bytes_mem_variants, countof(bytes_mem_variants)
     );
-    if (!allocation_exists(a)) {
-        return NULL;
-    }
+}
 
-    dynarr_header *header = (dynarr_header *)a.ptr;
-    header->len = 0;
-    header->capacity = capacity;
-    header->alloc_size = a.len;
-    header->allocator = allocator;
+#endif // JP_SIMD_X86
 
-    return (uchar *)(a.ptr) + sizeof(dynarr_header);
+void *bytes_copy(void *restrict dest, const void *restrict src, size_t n) {
+    assert(dest && "dest must not be null");
+    assert(src && "src must not be null");
+
+#ifdef JP_SIMD_X86
+    if (n <= 64) {
+        bytes_copy_small(dest, src, n);
+        return dest;
+    }
+    bytes_mem_kernels_get()->copy(dest, src, n);
+#else
+    bytes_copy_forward_scalar(dest, src, n);
+#endif
+    return dest;
 }
 
-void dynarr_free(void *array) {
-    dynarr_header *header = dynarr_get_header(array);
-    if (!header) {
-        return;
+void *bytes_move(void *dest, const void *src, size_t n) {
+    assert(dest && "dest must not be null");
+    assert(src && "src must not be null");
+
+    if (dest == src || n == 0) {
+        return dest;
     }
-    allocation a = {
-        .ptr = header,
-        .len = header->alloc_size,
-    };
-    alloc_free(header->allocator, a);
+    uintptr_t d = (uintptr_t)dest, s = (uintptr_t)src;
+    if ((size_t)(d < s ? s - d : d - s) >= n) {
+        return bytes_copy(dest, src, n);
+    }
+
+#ifdef JP_SIMD_X86
+    if (n <= 64) {
+        bytes_copy_small(dest, src, n);
+        return dest;
+    }
+    bytes_mem_kernels_get()->move(dest, src, n);
+#else
+    if (d < s) {
+        bytes_copy_forward_scalar(dest, src, n);
+    } else {
+        bytes_copy_backward_scalar(dest, src, n);
+    }
+#endif
+    return dest;
 }
 
-void *dynarr_grow_ut(
-    void *array, ullong capacity_increase, size_t item_size, size_t alignment
-) {
-    if (!array) {
-        return NULL;
+void *bytes_set(void *dest, int c, size_t n) {
+    if (!n) {
+        return dest;
     }
-    dynarr_header *header = dynarr_get_header(array);
-    assert(header && "Header must not be null");
+    assert(dest && "dest must not be null");
 
-    assert(
-        ULLONG_MAX - header->capacity > capacity_increase
-        && "new capacity must not exceed ullong max"
-    );
-    ullong capacity = capacity_increase + header->capacity;
-    alignment = max(alignment, alignof(dynarr_header));
-    allocation new_array_data = alloc_malloc(
-        header->allocator, dynarr_count_to_bytes(capacity, item_size), alignment
-    );
-    if (!allocation_exists(new_array_data)) {
-        return NULL;
+#ifdef JP_SIMD_X86
+    if (n <= 64) {
+        bytes_set_small(dest, (uchar)c, n);
+        return dest;
     }
+    bytes_mem_kernels_get()->set(dest, (uchar)c, n);
+#else
+    bytes_set_scalar(dest, (uchar)c, n);
+#endif
+    return dest;
+}
 
-    uchar *new_array = (uchar *)(new_array_data.ptr) + sizeof(dynarr_header);
-    dynarr_header *new_header = (dynarr_header *)new_array_data.ptr;
-    new_header->len = header->len;
-    new_header->capacity = capacity;
-    new_header->alloc_size = new_array_data.len;
-    new_header->allocator = header->allocator;
+#endif // JP_DISABLE_STRING_H
 
-    bytes_copy(new_array, array, new_header->len * item_size);
-    return new_array;
+static const char hex_digits[] = "0123456789abcdef";
+
+// Writes exactly 2 * len hex characters
+static void bytes_to_hex_scalar(char *dest, const uchar *src, size_t len) {
+    for (size_t i = 0; i < len; i += 1) {
+        dest[i * 2] = hex_digits[src[i] >> 4]; // high bits
+        dest[i * 2 + 1] = hex_digits[src[i] & 15]; // low bits
+    }
 }
 
-void *dynarr_clone_ut(
-    void *array, ullong capacity_increase, size_t item_size, size_t alignment
-) {
-    if (!array) {
-        return NULL;
+// Value of a hex digit or 0xFF for characters that are not hex digits
+static inline uchar hex_char_value(char c) {
+    uchar digit = (uchar)((uchar)c - '0');
+    if (digit < 10) {
+        return digit;
     }
-    dynarr_header *header = dynarr_get_header(array);
-    assert(header && "Header must not be null");
+    uchar alpha = (uchar)(((uchar)c | 0x20) - 'a');
+    if (alpha < 6) {
+        return (uchar)(alpha + 10);
+    }
+    return 0xFF;
+}
 
-    assert(
-        ULLONG_MAX - header->capacity > capacity_increase
-        && "new capacity must not exceed ullong max"
-    );
-    ullong capacity = capacity_increase + header->capacity;
-    void *new_array =
-        dynarr_new_sized(capacity, item_size, alignment, header->allocator);
-    if (!new_array) {
-        return NULL;
+// Reads exactly 2 * len hex characters
+static bool bytes_from_hex_scalar(uchar *dest, const char *src, size_t len) {
+    uchar invalid = 0;
+    for (size_t i = 0; i < len; i += 1) {
+        uchar high = hex_char_value(src[i * 2]);
+        uchar low = hex_char_value(src[i * 2 + 1]);
+        invalid |= high | low;
+        dest[i] = (uchar)((high << 4) | low);
     }
+    return (invalid & 0xF0) == 0;
+}
 
-    dynarr_header *new_header = dynarr_get_header(new_array);
-    new_header->len = header->len;
-    new_header->capacity = capacity;
+static inline ullong bytes_load_ullong(const uchar *ptr) {
+    ullong v;
+#if defined(__GNUC__) || defined(__clang__)
+    // always a single load, even when bytes_copy is not memcpy
+    __builtin_memcpy(&v, ptr, sizeof(v));
+#else
+    bytes_copy(&v, ptr, sizeof(v));
+#endif
+    return v;
+}
 
-    bytes_copy(new_array, array, new_header->len * item_size);
-    return new_array;
+// Index of the first differing byte in two differing words
+static inline size_t bytes_ullong_diff_index(ullong a, ullong b) {
+    assert(a != b && "words must differ");
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return bits_least_significant(a ^ b) / CHAR_BIT;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (sizeof(ullong) * CHAR_BIT - 1 - bits_most_significant(a ^ b))
+        / CHAR_BIT;
+#else
+    const uchar *a_ = (const uchar *)&a, *b_ = (const uchar *)&b;
+    size_t i = 0;
+    while (a_[i] == b_[i]) { i += 1; }
+    return i;
+#endif
 }
 
-bool dynarr_push_ut(
-    void *array, const void *items, ullong count, size_t item_size
+// Word-at-a-time comparison. Bytes before the current index are known to be
+// equal, so the tail can be compared using the last full word of the buffers.
+static llong bytes_diff_index_scalar(
+    const uchar *a, const uchar *b, size_t start, size_t len
 ) {
-    if (count == 0) {
-        return 0;
+    size_t i = start;
+    if (len - start < sizeof(ullong)) {
+        for (; i < len; i += 1) {
+            if (a[i] != b[i]) {
+                return (llong)i;
+            }
+        }
+        return -1LL;
     }
-    if (!array) {
-        return 0;
+    for (; i + sizeof(ullong) <= len; i += sizeof(ullong)) {
+        ullong a_word = bytes_load_ullong(a + i);
+        ullong b_word = bytes_load_ullong(b + i);
+        if (a_word != b_word) {
+            return (llong)(i + bytes_ullong_diff_index(a_word, b_word));
+        }
+    }
+    if (i < len) {
+        i = len - sizeof(ullong);
+        ullong a_word = bytes_load_ullong(a + i);
+        ullong b_word = bytes_load_ullong(b + i);
+        if (a_word != b_word) {
+            return (llong)(i + bytes_ullong_diff_index(a_word, b_word));
+        }
     }
+    return -1LL;
+}
 
-    dynarr_header *header = dynarr_get_header(array);
-    assert(header && "Header must not be null");
+static llong
+bytes_index_of_byte_scalar(const uchar *buffer, size_t len, uchar byte) {
+    for (size_t i = 0; i < len; i += 1) {
+        if (buffer[i] == byte) {
+            return (llong)i;
+        }
+    }
+    return -1;
+}
 
-    assert(
-        ULLONG_MAX - header->len > count
-        && "len + count must not exceed ullong max"
-    );
-    if (header->len + count > header->capacity) {
-        // out of capacity
-        return 0;
+static llong
+bytes_last_index_of_byte_scalar(const uchar *buffer, size_t len, uchar byte) {
+    for (size_t i = len; i > 0; i -= 1) {
+        if (buffer[i - 1] == byte) {
+            return (llong)(i - 1);
+        }
     }
+    return -1;
+}
 
-    bytes_copy(
-        ((uchar *)array) + header->len * item_size, items, count * item_size
-    );
-    header->len += count;
-    return 1;
+// Word-at-a-time count: a byte of x is zero exactly when the high bit of
+// ((x & 0x7F) + 0x7F) | x is clear for that byte.
+static size_t
+bytes_count_byte_scalar(const uchar *buffer, size_t len, uchar byte) {
+    const ullong low7 = 0x7F7F7F7F7F7F7F7FULL;
+    const ullong pattern = 0x0101010101010101ULL * byte;
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + sizeof(ullong) <= len; i += sizeof(ullong)) {
+        ullong x = bytes_load_ullong(buffer + i) ^ pattern;
+        count += bits_count_ones(~(((x & low7) + low7) | x | low7));
+    }
+    for (; i < len; i += 1) {
+        count += buffer[i] == byte;
+    }
+    return count;
 }
 
-void *dynarr_push_grow_ut(
-    void *array,
-    const void *items,
-    ullong count,
-    size_t item_size,
-    size_t alignment
+static llong bytes_index_of_nth_byte_scalar(
+    const uchar *buffer, size_t len, uchar byte, size_t n
 ) {
-    if (count == 0) {
-        return array;
+    for (size_t i = 0; i < len; i += 1) {
+        if (buffer[i] == byte) {
+            n -= 1;
+            if (n == 0) {
+                return (llong)i;
+            }
+        }
     }
+    return -1;
+}
 
-    assert(array && "array must not be null");
-    if (!array) {
-        return NULL;
+// Byte set search: find the first byte whose set membership equals in_set.
+static llong bytes_index_of_set_scalar(
+    const uchar *buffer, size_t len, const byteset *set, bool in_set
+) {
+    for (size_t i = 0; i < len; i += 1) {
+        if (byteset_contains(set, buffer[i]) == in_set) {
+            return (llong)i;
+        }
     }
-    dynarr_header *header = dynarr_get_header(array);
-    assert(header && "header must not be null");
+    return -1;
+}
 
-    assert(
-        ULLONG_MAX - header->len > count + 8
-        && "len + count + 8 must not exceed ullong max"
-    );
-    if (header->len + count > header->capacity) {
-        ullong capacity_increase = header->capacity + count + 8;
-        void *new_array =
-            dynarr_grow_ut(array, capacity_increase, item_size, alignment);
-        if (!new_array) {
-            return NULL;
+// Short needle search: find candidates using the first byte of the needle and
+// verify the rest.
+static llong bytes_index_of_short_scalar(
+    const uchar *haystack, size_t len, const uchar *needle, size_t needle_len
+) {
+    assert(needle_len > 0 && "needle len must be >0");
+    size_t i = 0;
+    while (i + needle_len <= len) {
+        llong j =
+            bytes_index_of_byte(haystack + i, len - i - needle_len + 1, *needle);
+        if (j < 0) {
+            return -1;
         }
-        if ((uintptr_t)array != (uintptr_t)new_array) {
-            // Arrays are different, so we need to replace the old one
-            dynarr_header *new_header = dynarr_get_header(new_array);
-            assert(new_header && "new header must not be null");
-            dynarr_free(array);
-            array = new_array;
-            header = new_header;
+        i += (size_t)j;
+        if (bytes_eq(haystack + i + 1, needle + 1, needle_len - 1)) {
+            return (llong)i;
         }
+        i += 1;
     }
-
-    void *dest = ((uchar *)array) + header->len * item_size;
-    bytes_copy(dest, items, count * item_size);
-    header->len += count;
-    return array;
+    return -1;
 }
 
-bool dynarr_pop_ut(void *array, void *out, size_t item_size) {
-    if (!array) {
-        return 0;
+#ifdef JP_SIMD_X86
+
+// Block comparison: the inverted equality mask has a bit set for every
+// differing byte. Like with the scalar version, the tail is compared using the
+// last full block of the buffers.
+
+__attribute__((target("sse2"))) static llong bytes_diff_index_sse2(
+    const uchar *a, const uchar *b, size_t start, size_t len
+) {
+    if (len - start < 16) {
+        return bytes_diff_index_scalar(a, b, start, len);
+    }
+    size_t i = start;
+    for (; i + 16 <= len; i += 16) {
+        __m128i a_block = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i b_block = _mm_loadu_si128((const __m128i *)(b + i));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(a_block, b_block));
+        mask ^= 0xFFFF;
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
     }
-    dynarr_header *header = dynarr_get_header(array);
-    if (header->len == 0) {
-        return 0;
+    if (i < len) {
+        i = len - 16;
+        __m128i a_block = _mm_loadu_si128((const __m128i *)(a + i));
+        __m128i b_block = _mm_loadu_si128((const __m128i *)(b + i));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(a_block, b_block));
+        mask ^= 0xFFFF;
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
     }
-    uchar *item = ((uchar *)array) + (header->len - 1) * item_size;
-    bytes_copy(out, item, item_size);
-    header->len -= 1;
-    return 1;
+    return -1LL;
 }
 
-bool dynarr_remove_ut(void *array, ullong index, size_t item_size) {
-    if (!array) {
-        return 0;
+__attribute__((target("avx2"))) static llong bytes_diff_index_avx2(
+    const uchar *a, const uchar *b, size_t start, size_t len
+) {
+    if (len - start < 32) {
+        return bytes_diff_index_sse2(a, b, start, len);
+    }
+    size_t i = start;
+    for (; i + 32 <= len; i += 32) {
+        __m256i a_block = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i b_block = _mm256_loadu_si256((const __m256i *)(b + i));
+        uint mask =
+            ~(uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a_block, b_block));
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
     }
-    dynarr_header *header = dynarr_get_header(array);
-    if (header->len <= index) {
-        return 0;
+    if (i < len) {
+        i = len - 32;
+        __m256i a_block = _mm256_loadu_si256((const __m256i *)(a + i));
+        __m256i b_block = _mm256_loadu_si256((const __m256i *)(b + i));
+        uint mask =
+            ~(uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a_block, b_block));
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
     }
-    uchar *data = (uchar *)array;
-    uchar *data_dst = data + index * item_size;
-    uchar *data_src = data_dst + item_size;
-    size_t bytes = (size_t)(header->len - index - 1) * item_size;
-    bytes_move(data_dst, data_src, bytes);
-    header->len -= 1;
-    return 1;
+    return -1LL;
 }
 
-bool dynarr_remove_uo_ut(void *array, ullong index, size_t item_size) {
-    if (!array) {
-        return 0;
+// The SIMD kernels below scan whole blocks using unaligned loads. The last
+// partial block is handled by re-reading the final full block of the buffer
+// and masking out the bytes that were already scanned, so that no reads are
+// done past the end of the buffer. Buffers shorter than a block are passed to
+// the next narrower kernel.
+
+__attribute__((target("sse2"))) static llong
+bytes_index_of_byte_sse2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 16) {
+        return bytes_index_of_byte_scalar(buffer, len, byte);
     }
-    dynarr_header *header = dynarr_get_header(array);
-    if (header->len <= index) {
-        return 0;
+    const __m128i needle = _mm_set1_epi8((char)byte);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
     }
-    uchar *data = (uchar *)array;
-    uchar *data_dst = data + index * item_size;
-    uchar *data_src = data + (header->len - 1) * item_size;
-    bytes_copy(data_dst, data_src, item_size);
-    header->len -= 1;
-    return 1;
+    if (i < len) {
+        size_t start = len - 16;
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + start));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        mask &= ~0U << (i - start);
+        if (mask) {
+            return (llong)(start + bits_least_significant(mask));
+        }
+    }
+    return -1;
 }
 
-////////////////////////
-// C strings
-////////////////////////
-
-bool cstr_eq_unsafe(const char *s1, const char *s2) {
-    if (s1 == s2) {
-        return 1;
+__attribute__((target("sse2"))) static llong
+bytes_last_index_of_byte_sse2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 16) {
+        return bytes_last_index_of_byte_scalar(buffer, len, byte);
+    }
+    const __m128i needle = _mm_set1_epi8((char)byte);
+    size_t i = len;
+    for (; i >= 16; i -= 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i - 16));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (llong)(i - 16 + bits_most_significant(mask));
+        }
     }
-    if (!s1 || !s2) {
-        return 0;
+    if (i > 0) {
+        __m128i block = _mm_loadu_si128((const __m128i *)buffer);
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        mask &= (1U << i) - 1;
+        if (mask) {
+            return (llong)bits_most_significant(mask);
+        }
     }
+    return -1;
+}
 
-    size_t len = 0;
-    while (s1[len] && s2[len]) {
-        if (s1[len] != s2[len]) {
-            return 0;
+__attribute__((target("avx2"))) static llong
+bytes_index_of_byte_avx2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 32) {
+        return bytes_index_of_byte_sse2(buffer, len, byte);
+    }
+    const __m256i needle = _mm256_set1_epi8((char)byte);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + i));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
         }
-        len += 1;
     }
-    if (s1[len] != s2[len]) {
-        return 0;
+    if (i < len) {
+        size_t start = len - 32;
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + start));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        mask &= ~0U << (i - start);
+        if (mask) {
+            return (llong)(start + bits_least_significant(mask));
+        }
     }
-
-    return 1;
+    return -1;
 }
 
-bool cstr_eq(const char *s1, const char *s2, size_t len) {
-    if (s1 == s2) {
-        return 1;
+__attribute__((target("avx2"))) static llong
+bytes_last_index_of_byte_avx2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 32) {
+        return bytes_last_index_of_byte_sse2(buffer, len, byte);
+    }
+    const __m256i needle = _mm256_set1_epi8((char)byte);
+    size_t i = len;
+    for (; i >= 32; i -= 32) {
+        __m256i block =
+            _mm256_loadu_si256((const __m256i *)(buffer + i - 32));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask) {
+            return (llong)(i - 32 + bits_most_significant(mask));
+        }
     }
-    if (!s1 || !s2) {
-        return 0;
+    if (i > 0) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)buffer);
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        mask &= (1U << i) - 1;
+        if (mask) {
+            return (llong)bits_most_significant(mask);
+        }
     }
+    return -1;
+}
 
-    for (size_t i = 0; i < len; i += 1) {
-        if (s1[i] != s2[i]) {
-            return 0;
+__attribute__((target("avx512f,avx512bw"))) static llong
+bytes_index_of_byte_avx512(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 64) {
+        return bytes_index_of_byte_avx2(buffer, len, byte);
+    }
+    const __m512i needle = _mm512_set1_epi8((char)byte);
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i block = _mm512_loadu_si512(buffer + i);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
         }
-        if (!s1[i] && !s2[i]) {
-            break;
+    }
+    if (i < len) {
+        size_t start = len - 64;
+        __m512i block = _mm512_loadu_si512(buffer + start);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        mask &= ~0ULL << (i - start);
+        if (mask) {
+            return (llong)(start + bits_least_significant(mask));
         }
     }
+    return -1;
+}
 
-    return 1;
+__attribute__((target("avx512f,avx512bw"))) static llong
+bytes_last_index_of_byte_avx512(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 64) {
+        return bytes_last_index_of_byte_avx2(buffer, len, byte);
+    }
+    const __m512i needle = _mm512_set1_epi8((char)byte);
+    size_t i = len;
+    for (; i >= 64; i -= 64) {
+        __m512i block = _mm512_loadu_si512(buffer + i - 64);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        if (mask) {
+            return (llong)(i - 64 + bits_most_significant(mask));
+        }
+    }
+    if (i > 0) {
+        __m512i block = _mm512_loadu_si512(buffer);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        mask &= (1ULL << i) - 1;
+        if (mask) {
+            return (llong)bits_most_significant(mask);
+        }
+    }
+    return -1;
 }
 
-size_t cstr_byte_len_unsafe(const char *str) {
-    if (!str) {
-        return 0;
+// Byte counting: compare results (0 or -1 per byte) are subtracted from byte
+// counters, which are summed with SAD before they can overflow after 255
+// blocks. The tail is counted from the last full block with the already
+// counted bytes masked out.
+
+// Position of the Nth (starting from 1) set bit in the mask
+static inline uint bytes_mask_nth_bit(ullong mask, size_t n) {
+    for (; n > 1; n -= 1) {
+        mask &= mask - 1;
     }
-    size_t len = 0;
-    while (str[len]) { len += 1; }
-    return len;
+    return bits_least_significant(mask);
 }
 
-size_t cstr_byte_len(const char *str, size_t capacity) {
-    if (!str) {
-        return 0;
+__attribute__((target("sse2"))) static size_t
+bytes_count_byte_sse2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 16) {
+        return bytes_count_byte_scalar(buffer, len, byte);
     }
-    size_t len = 0;
-    while (str[len] && len < capacity) { len += 1; }
-    if (len + 1 < capacity) {
-        len += 1;
+    const __m128i needle = _mm_set1_epi8((char)byte);
+    const __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 16 <= len) {
+        size_t blocks = (len - i) / 16;
+        blocks = blocks > 255 ? 255 : blocks;
+        __m128i counters = zero;
+        for (size_t b = 0; b < blocks; b += 1, i += 16) {
+            __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i));
+            counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(block, needle));
+        }
+        __m128i sums = _mm_sad_epu8(counters, zero);
+        count += (size_t)_mm_extract_epi16(sums, 0)
+            + (size_t)_mm_extract_epi16(sums, 4);
     }
-    return len;
+    if (i < len) {
+        size_t start = len - 16;
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + start));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        count += bits_count_ones(mask & (~0U << (i - start)));
+    }
+    return count;
 }
 
-void cstr_split_init_chars(
-    cstr_split *s, slice str, slice_const *split_chars, uint flags
+__attribute__((target("sse2"))) static llong bytes_index_of_nth_byte_sse2(
+    const uchar *buffer, size_t len, uchar byte, size_t n
 ) {
-    assert(s && "split struct must not be null");
+    if (len < 16) {
+        return bytes_index_of_nth_byte_scalar(buffer, len, byte, n);
+    }
+    const __m128i needle = _mm_set1_epi8((char)byte);
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (!mask) {
+            continue;
+        }
+        uint found = bits_count_ones(mask);
+        if (found >= n) {
+            return (llong)(i + bytes_mask_nth_bit(mask, n));
+        }
+        n -= found;
+    }
+    if (i < len) {
+        size_t start = len - 16;
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + start));
+        uint mask = (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        mask &= ~0U << (i - start);
+        if (mask && bits_count_ones(mask) >= n) {
+            return (llong)(start + bytes_mask_nth_bit(mask, n));
+        }
+    }
+    return -1;
+}
 
-    bytes_set(s, 0, sizeof(*s));
-    s->str = str;
-    s->predicate = cstr_split_predicate_chars_ascii;
-    s->predicate_data = split_chars;
-    s->flags = flags;
+__attribute__((target("avx2"))) static size_t
+bytes_count_byte_avx2(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 32) {
+        return bytes_count_byte_sse2(buffer, len, byte);
+    }
+    const __m256i needle = _mm256_set1_epi8((char)byte);
+    const __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+    size_t i = 0;
+    while (i + 32 <= len) {
+        size_t blocks = (len - i) / 32;
+        blocks = blocks > 255 ? 255 : blocks;
+        __m256i counters = zero;
+        for (size_t b = 0; b < blocks; b += 1, i += 32) {
+            __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + i));
+            counters =
+                _mm256_sub_epi8(counters, _mm256_cmpeq_epi8(block, needle));
+        }
+        __m256i sums256 = _mm256_sad_epu8(counters, zero);
+        __m128i sums = _mm_add_epi64(
+            _mm256_castsi256_si128(sums256),
+            _mm256_extracti128_si256(sums256, 1)
+        );
+        count += (size_t)_mm_extract_epi16(sums, 0)
+            + (size_t)_mm_extract_epi16(sums, 4);
+    }
+    if (i < len) {
+        size_t start = len - 32;
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + start));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        count += bits_count_ones(mask & (~0U << (i - start)));
+    }
+    return count;
 }
 
-void cstr_split_init(
-    cstr_split *split,
-    slice str,
-    cstr_split_predicate fn,
-    void *fn_state,
-    uint flags
+__attribute__((target("avx2,popcnt"))) static llong
+bytes_index_of_nth_byte_avx2(
+    const uchar *buffer, size_t len, uchar byte, size_t n
 ) {
-    assert(split && "split struct must not be null");
-
-    bytes_set(split, 0, sizeof(*split));
-    split->str = str;
-    split->predicate = fn;
-    split->predicate_data = fn_state;
-    split->flags = flags;
-}
-
-slice_const cstr_split_next(cstr_split *s) {
-    assert(s && "split struct must not be null");
-    assert(s->str.ptr && "string must not be null");
-    assert(s->predicate && "predicate must not be null");
-
-    if (!slice_is_set(s->str) || s->predicate == NULL
-        || s->index >= s->str.len) {
-        return slice_null;
+    if (len < 32) {
+        return bytes_index_of_nth_byte_sse2(buffer, len, byte, n);
     }
-
-    size_t start_index = s->index;
-    uchar *ptr = s->str.ptr + start_index;
-
-    size_t split_at = 0;
-    if (bitset_is_set(s->flags, cstr_split_flag_utf8)) {
-        while (s->index < s->str.len) {
-            uchar *ch = s->str.ptr + s->index;
-            size_t ch_len = utf8_next_char_break(ch, s->str.len - s->index);
-            if (!ch_len) {
-                return slice_null;
-            }
-            bool ok = s->predicate(ch, ch_len, s->predicate_data);
-            if (ok) {
-                split_at = s->index;
-                s->index += ch_len;
-                break;
-            }
-            s->index += ch_len;
+    const __m256i needle = _mm256_set1_epi8((char)byte);
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + i));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (!mask) {
+            continue;
         }
-    } else {
-        while (s->index < s->str.len) {
-            uchar ch = s->str.ptr[s->index];
-            bool ok = s->predicate(&ch, sizeof(ch), s->predicate_data);
-            if (ok) {
-                split_at = s->index;
-                s->index += 1;
-                break;
-            }
-            s->index += 1;
+        uint found = bits_count_ones(mask);
+        if (found >= n) {
+            return (llong)(i + bytes_mask_nth_bit(mask, n));
         }
-    }
-
-    size_t len;
-    if (split_at == 0 && s->index >= s->str.len) {
-        len = s->str.len - start_index;
-    } else {
-        len = split_at - start_index;
-        if (bitset_is_set(s->flags, cstr_split_flag_null_terminate)) {
-            s->str.ptr[split_at] = '\0';
+        n -= found;
+    }
+    if (i < len) {
+        size_t start = len - 32;
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + start));
+        uint mask =
+            (uint)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        mask &= ~0U << (i - start);
+        if (mask && bits_count_ones(mask) >= n) {
+            return (llong)(start + bytes_mask_nth_bit(mask, n));
         }
     }
-
-    return slice_const_new(ptr, len);
+    return -1;
 }
 
-size_t cstr_split_collect(cstr_split *s, slice_const *arr, size_t len) {
-    assert(arr && "array must not be null");
-    assert(s && "split must not be null");
+__attribute__((target("avx512f,avx512bw,popcnt"))) static size_t
+bytes_count_byte_avx512(const uchar *buffer, size_t len, uchar byte) {
+    if (len < 64) {
+        return bytes_count_byte_avx2(buffer, len, byte);
+    }
+    const __m512i needle = _mm512_set1_epi8((char)byte);
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m512i block = _mm512_loadu_si512(buffer + i);
+        count += bits_count_ones(_mm512_cmpeq_epi8_mask(block, needle));
+    }
+    if (i < len) {
+        size_t start = len - 64;
+        __m512i block = _mm512_loadu_si512(buffer + start);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        count += bits_count_ones(mask & (~0ULL << (i - start)));
+    }
+    return count;
+}
 
+__attribute__((target("avx512f,avx512bw,popcnt"))) static llong
+bytes_index_of_nth_byte_avx512(
+    const uchar *buffer, size_t len, uchar byte, size_t n
+) {
+    if (len < 64) {
+        return bytes_index_of_nth_byte_avx2(buffer, len, byte, n);
+    }
+    const __m512i needle = _mm512_set1_epi8((char)byte);
     size_t i = 0;
-    for (; i < len; i += 1) {
-        slice_const slice = cstr_split_next(s);
-        if (!slice.ptr) {
-            break;
+    for (; i + 64 <= len; i += 64) {
+        __m512i block = _mm512_loadu_si512(buffer + i);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        if (!mask) {
+            continue;
+        }
+        uint found = bits_count_ones(mask);
+        if (found >= n) {
+            return (llong)(i + bytes_mask_nth_bit(mask, n));
+        }
+        n -= found;
+    }
+    if (i < len) {
+        size_t start = len - 64;
+        __m512i block = _mm512_loadu_si512(buffer + start);
+        ullong mask = _mm512_cmpeq_epi8_mask(block, needle);
+        mask &= ~0ULL << (i - start);
+        if (mask && bits_count_ones(mask) >= n) {
+            return (llong)(start + bytes_mask_nth_bit(mask, n));
         }
-        arr[i] = slice;
     }
-    return i;
+    return -1;
 }
 
-size_t cstr_split_collect_strings(cstr_split *s, const char **strings, size_t len) {
-    assert(strings && "strings must not be null");
-    assert(s && "split must not be null");
+// Byte set search: the low nibble of each byte selects a row from the set's
+// bit table (pshufb), and the high nibble selects the bit from that row. Bytes
+// with a high nibble of 8 or more use the upper half of the table.
 
-    uint flags = s->flags;
-    bitset_set_mut(s->flags, cstr_split_flag_null_terminate);
+__attribute__((target("ssse3"))) static inline uint bytes_byteset_mask_ssse3(
+    __m128i block, __m128i rows_lo, __m128i rows_hi
+) {
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i bit_lookup = _mm_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128
+    );
+    __m128i lo = _mm_and_si128(block, nibble);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(block, 4), nibble);
+    __m128i upper = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+    __m128i row = _mm_or_si128(
+        _mm_andnot_si128(upper, _mm_shuffle_epi8(rows_lo, lo)),
+        _mm_and_si128(upper, _mm_shuffle_epi8(rows_hi, lo))
+    );
+    __m128i bit = _mm_shuffle_epi8(bit_lookup, hi);
+    __m128i miss =
+        _mm_cmpeq_epi8(_mm_and_si128(row, bit), _mm_setzero_si128());
+    return ~(uint)_mm_movemask_epi8(miss) & 0xFFFFU;
+}
 
+__attribute__((target("ssse3"))) static llong bytes_index_of_set_ssse3(
+    const uchar *buffer, size_t len, const byteset *set, bool in_set
+) {
+    if (len < 16) {
+        return bytes_index_of_set_scalar(buffer, len, set, in_set);
+    }
+    const __m128i rows_lo = _mm_loadu_si128((const __m128i *)set->bits);
+    const __m128i rows_hi = _mm_loadu_si128((const __m128i *)(set->bits + 16));
+    const uint flip = in_set ? 0 : 0xFFFFU;
     size_t i = 0;
-    for (; i < len; i += 1) {
-        slice_const slice = cstr_split_next(s);
-        if (!slice.ptr) {
-            break;
+    for (; i + 16 <= len; i += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + i));
+        uint mask = bytes_byteset_mask_ssse3(block, rows_lo, rows_hi) ^ flip;
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
         }
-        strings[i] = (const char *)slice.ptr;
     }
-
-    s->flags = flags;
-    return i;
-}
-
-bool cstr_split_predicate_chars_ascii(const uchar *c, size_t len, void *state) {
-    assert(c && "character must not be null");
-    assert(state && "state must not be null (expected split chars)");
-    if (len == 0 || len > 1) {
-        return false;
+    if (i < len) {
+        size_t start = len - 16;
+        __m128i block = _mm_loadu_si128((const __m128i *)(buffer + start));
+        uint mask = bytes_byteset_mask_ssse3(block, rows_lo, rows_hi) ^ flip;
+        mask &= ~0U << (i - start);
+        if (mask) {
+            return (llong)(start + bits_least_significant(mask));
+        }
     }
-    slice_const *split_chars = state;
-    return bytes_index_of_byte(split_chars->ptr, split_chars->len, *c) >= 0;
+    return -1;
 }
 
-bool cstr_split_predicate_ascii_whitespace(
-    const uchar *c, size_t len, void *state
+__attribute__((target("avx2"))) static inline uint bytes_byteset_mask_avx2(
+    __m256i block, __m256i rows_lo, __m256i rows_hi
 ) {
-    assert(c && "string must not be null");
-    (void)state;
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i bit_lookup = _mm256_setr_epi8(
+        1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128,
+        1, 2, 4, 8, 16, 32, 64, (char)128, 1, 2, 4, 8, 16, 32, 64, (char)128
+    );
+    __m256i lo = _mm256_and_si256(block, nibble);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+    __m256i upper = _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7));
+    __m256i row = _mm256_blendv_epi8(
+        _mm256_shuffle_epi8(rows_lo, lo),
+        _mm256_shuffle_epi8(rows_hi, lo),
+        upper
+    );
+    __m256i bit = _mm256_shuffle_epi8(bit_lookup, hi);
+    __m256i miss =
+        _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), _mm256_setzero_si256());
+    return ~(uint)_mm256_movemask_epi8(miss);
+}
 
-    if (len > sizeof(char)) {
-        return false;
+__attribute__((target("avx2"))) static llong bytes_index_of_set_avx2(
+    const uchar *buffer, size_t len, const byteset *set, bool in_set
+) {
+    if (len < 32) {
+        return bytes_index_of_set_ssse3(buffer, len, set, in_set);
     }
-    switch (*c) {
-    case ' ':
-    case '\n':
-    case '\t':
-        return true;
-    default:
-        return false;
+    // pshufb works within 128-bit lanes, so both lanes get the same tables
+    const __m256i rows_lo = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)set->bits)
+    );
+    const __m256i rows_hi = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)(set->bits + 16))
+    );
+    const uint flip = in_set ? 0 : ~0U;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + i));
+        uint mask = bytes_byteset_mask_avx2(block, rows_lo, rows_hi) ^ flip;
+        if (mask) {
+            return (llong)(i + bits_least_significant(mask));
+        }
+    }
+    if (i < len) {
+        size_t start = len - 32;
+        __m256i block = _mm256_loadu_si256((const __m256i *)(buffer + start));
+        uint mask = bytes_byteset_mask_avx2(block, rows_lo, rows_hi) ^ flip;
+        mask &= ~0U << (i - start);
+        if (mask) {
+            return (llong)(start + bits_least_significant(mask));
+        }
     }
+    return -1;
 }
 
-bool cstr_split_predicate_ascii_punctuation(
-    const uchar *c, size_t len, void *state
-) {
-    assert(c && "string must not be null");
-    (void)state;
+// Hex encoding: each nibble is mapped to its hex digit using a table lookup
+// (pshufb), and the high and low digits are interleaved. The tail is handled
+// by re-encoding the last full block.
+
+__attribute__((target("ssse3"))) static inline void
+bytes_to_hex_block_ssse3(char *dest, const uchar *src) {
+    const __m128i digits = _mm_loadu_si128((const __m128i *)hex_digits);
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    __m128i block = _mm_loadu_si128((const __m128i *)src);
+    __m128i high = _mm_shuffle_epi8(
+        digits, _mm_and_si128(_mm_srli_epi16(block, 4), nibble)
+    );
+    __m128i low = _mm_shuffle_epi8(digits, _mm_and_si128(block, nibble));
+    _mm_storeu_si128((__m128i *)dest, _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128((__m128i *)(dest + 16), _mm_unpackhi_epi8(high, low));
+}
 
-    if (len > sizeof(char)) {
-        return false;
-    }
-    if (*c >= ' ' && *c <= '/') {
-        return true;
-    }
-    if (*c >= ':' && *c <= '@') {
-        return true;
+__attribute__((target("ssse3"))) static void
+bytes_to_hex_ssse3(char *dest, const uchar *src, size_t len) {
+    if (len < 16) {
+        bytes_to_hex_scalar(dest, src, len);
+        return;
     }
-    if (*c >= '[' && *c <= '`') {
-        return true;
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16) {
+        bytes_to_hex_block_ssse3(dest + i * 2, src + i);
     }
-    if (*c >= '{' && *c <= '~') {
-        return true;
+    if (i < len) {
+        bytes_to_hex_block_ssse3(dest + (len - 16) * 2, src + len - 16);
     }
-    return false;
 }
 
-bool cstr_match_wild_ascii(
-    const char *txt, size_t txt_len, const char *pat, size_t pat_len
-) {
-    size_t i = 0, j = 0, start_index = 0, match = 0;
-    bool start_index_set = 0;
+__attribute__((target("avx2"))) static inline void
+bytes_to_hex_block_avx2(char *dest, const uchar *src) {
+    const __m256i digits = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)hex_digits)
+    );
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i block = _mm256_loadu_si256((const __m256i *)src);
+    __m256i high = _mm256_shuffle_epi8(
+        digits, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble)
+    );
+    __m256i low = _mm256_shuffle_epi8(digits, _mm256_and_si256(block, nibble));
+    // unpack works within 128-bit lanes: reorder the lanes back to byte order
+    __m256i first = _mm256_unpacklo_epi8(high, low);
+    __m256i second = _mm256_unpackhi_epi8(high, low);
+    _mm256_storeu_si256(
+        (__m256i *)dest, _mm256_permute2x128_si256(first, second, 0x20)
+    );
+    _mm256_storeu_si256(
+        (__m256i *)(dest + 32), _mm256_permute2x128_si256(first, second, 0x31)
+    );
+}
 
-    while (i < txt_len) {
-        if (j < pat_len && (pat[j] == '?' || pat[j] == txt[i])) {
-            i += 1;
-            j += 1;
-        } else if (j < pat_len && pat[j] == '*') {
-            start_index = j;
-            start_index_set = 1;
-            match = i;
-            j += 1;
-        } else if (start_index_set) {
-            j = start_index + 1;
-            match += 1;
-            i = match;
-        } else {
-            return 0;
-        }
+__attribute__((target("avx2"))) static void
+bytes_to_hex_avx2(char *dest, const uchar *src, size_t len) {
+    if (len < 32) {
+        bytes_to_hex_ssse3(dest, src, len);
+        return;
+    }
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        bytes_to_hex_block_avx2(dest + i * 2, src + i);
     }
+    if (i < len) {
+        bytes_to_hex_block_avx2(dest + (len - 32) * 2, src + len - 32);
+    }
+}
 
-    while (j < pat_len && pat[j] == '*') { j += 1; }
+// Hex decoding: characters are converted to nibble values using range checks,
+// which also flag invalid characters. Pairs of nibbles are combined using a
+// multiply-add (high * 16 + low) and packed back to bytes.
 
-    return j == pat_len;
+__attribute__((target("ssse3"))) static inline __m128i
+bytes_hex_values_ssse3(__m128i chars, __m128i *valid) {
+    __m128i digit = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    __m128i alpha = _mm_sub_epi8(
+        _mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a')
+    );
+    __m128i is_digit =
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    __m128i is_alpha =
+        _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+    *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_alpha));
+    return _mm_maddubs_epi16(
+        _mm_or_si128(
+            _mm_and_si128(is_digit, digit),
+            _mm_and_si128(is_alpha, _mm_add_epi8(alpha, _mm_set1_epi8(10)))
+        ),
+        _mm_set1_epi16(0x0110)
+    );
 }
 
-bool char_is_digit(char c) {
-    return c >= '0' && c <= '9';
+__attribute__((target("ssse3"))) static inline bool
+bytes_from_hex_block_ssse3(uchar *dest, const char *src) {
+    __m128i valid = _mm_set1_epi8(-1);
+    __m128i first = bytes_hex_values_ssse3(
+        _mm_loadu_si128((const __m128i *)src), &valid
+    );
+    __m128i second = bytes_hex_values_ssse3(
+        _mm_loadu_si128((const __m128i *)(src + 16)), &valid
+    );
+    _mm_storeu_si128((__m128i *)dest, _mm_packus_epi16(first, second));
+    return _mm_movemask_epi8(valid) == 0xFFFF;
 }
 
-size_t cstr_to_int(const char *s, size_t len, int *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
-        return 0;
+__attribute__((target("ssse3"))) static bool
+bytes_from_hex_ssse3(uchar *dest, const char *src, size_t len) {
+    if (len < 16) {
+        return bytes_from_hex_scalar(dest, src, len);
     }
-    size_t bytes_parsed = 0;
+    bool ok = true;
     size_t i = 0;
-    int v_ = 0;
-    int sign = 1;
-
-    if (s[0] == '-') {
-        i += 1;
-        sign = -1;
-        bytes_parsed += 1;
+    for (; i + 16 <= len; i += 16) {
+        ok &= bytes_from_hex_block_ssse3(dest + i, src + i * 2);
     }
-
-    for (; i < len && char_is_digit(s[i]); i += 1) {
-        int n = s[i] - '0';
-        if ((INT_MAX - n) / 10 < v_) {
-            // exceeds int size
-            return 0;
-        }
-        v_ *= 10;
-        v_ += n;
-        bytes_parsed += 1;
+    if (i < len) {
+        ok &= bytes_from_hex_block_ssse3(dest + len - 16, src + (len - 16) * 2);
     }
+    return ok;
+}
 
-    *v = sign * v_;
-    return bytes_parsed;
+__attribute__((target("avx2"))) static inline __m256i
+bytes_hex_values_avx2(__m256i chars, __m256i *valid) {
+    __m256i digit = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    __m256i alpha = _mm256_sub_epi8(
+        _mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a')
+    );
+    __m256i is_digit =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+    __m256i is_alpha =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+    *valid = _mm256_and_si256(*valid, _mm256_or_si256(is_digit, is_alpha));
+    return _mm256_maddubs_epi16(
+        _mm256_or_si256(
+            _mm256_and_si256(is_digit, digit),
+            _mm256_and_si256(
+                is_alpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))
+            )
+        ),
+        _mm256_set1_epi16(0x0110)
+    );
 }
 
-size_t cstr_to_uint(const char *s, size_t len, uint *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
-        return 0;
+__attribute__((target("avx2"))) static inline bool
+bytes_from_hex_block_avx2(uchar *dest, const char *src) {
+    __m256i valid = _mm256_set1_epi8(-1);
+    __m256i first = bytes_hex_values_avx2(
+        _mm256_loadu_si256((const __m256i *)src), &valid
+    );
+    __m256i second = bytes_hex_values_avx2(
+        _mm256_loadu_si256((const __m256i *)(src + 32)), &valid
+    );
+    // pack works within 128-bit lanes: reorder the quarters back to byte order
+    __m256i packed = _mm256_permute4x64_epi64(
+        _mm256_packus_epi16(first, second), _MM_SHUFFLE(3, 1, 2, 0)
+    );
+    _mm256_storeu_si256((__m256i *)dest, packed);
+    return (uint)_mm256_movemask_epi8(valid) == ~0U;
+}
+
+__attribute__((target("avx2"))) static bool
+bytes_from_hex_avx2(uchar *dest, const char *src, size_t len) {
+    if (len < 32) {
+        return bytes_from_hex_ssse3(dest, src, len);
     }
-    size_t bytes_parsed = 0;
-    uint v_ = 0;
+    bool ok = true;
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32) {
+        ok &= bytes_from_hex_block_avx2(dest + i, src + i * 2);
+    }
+    if (i < len) {
+        ok &= bytes_from_hex_block_avx2(dest + len - 32, src + (len - 32) * 2);
+    }
+    return ok;
+}
 
-    for (size_t i = 0; i < len && char_is_digit(s[i]); i += 1) {
-        uint n = (uchar)s[i] - '0';
-        if ((UINT_MAX - n) / 10 < v_) {
-            // exceeds int size
-            return 0;
+// Short needle search: compare a block of haystack against the first byte of
+// the needle, and a block offset by needle length - 1 against the last byte of
+// the needle. Only positions where both match are verified byte by byte.
+// Positions that do not fit a whole block are passed to the scalar search.
+
+__attribute__((target("sse2"))) static llong bytes_index_of_short_sse2(
+    const uchar *haystack, size_t len, const uchar *needle, size_t needle_len
+) {
+    assert(needle_len > 1 && "needle len must be >1");
+    const __m128i first = _mm_set1_epi8((char)needle[0]);
+    const __m128i last = _mm_set1_epi8((char)needle[needle_len - 1]);
+    size_t i = 0;
+    for (; i + needle_len - 1 + 16 <= len; i += 16) {
+        __m128i block_first =
+            _mm_loadu_si128((const __m128i *)(haystack + i));
+        __m128i block_last =
+            _mm_loadu_si128((const __m128i *)(haystack + i + needle_len - 1));
+        __m128i eq = _mm_and_si128(
+            _mm_cmpeq_epi8(block_first, first), _mm_cmpeq_epi8(block_last, last)
+        );
+        uint mask = (uint)_mm_movemask_epi8(eq);
+        while (mask) {
+            size_t candidate = i + bits_least_significant(mask);
+            if (bytes_eq(
+                    haystack + candidate + 1, needle + 1, needle_len - 2
+                )) {
+                return (llong)candidate;
+            }
+            mask &= mask - 1;
         }
-        v_ *= 10;
-        v_ += n;
-        bytes_parsed += 1;
     }
-
-    *v = v_;
-    return bytes_parsed;
+    llong tail = bytes_index_of_short_scalar(
+        haystack + i, len - i, needle, needle_len
+    );
+    return tail < 0 ? -1 : (llong)i + tail;
 }
 
-size_t cstr_to_llong(const char *s, size_t len, llong *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
-        return 0;
-    }
-    size_t bytes_parsed = 0;
+__attribute__((target("avx2"))) static llong bytes_index_of_short_avx2(
+    const uchar *haystack, size_t len, const uchar *needle, size_t needle_len
+) {
+    assert(needle_len > 1 && "needle len must be >1");
+    const __m256i first = _mm256_set1_epi8((char)needle[0]);
+    const __m256i last = _mm256_set1_epi8((char)needle[needle_len - 1]);
     size_t i = 0;
-    llong v_ = 0;
-    llong sign = 1;
-
-    if (s[0] == '-') {
-        i += 1;
-        sign = -1;
-        bytes_parsed += 1;
-    }
-
-    for (; i < len && char_is_digit(s[i]); i += 1) {
-        llong n = s[i] - '0';
-        if ((LLONG_MAX - n) / 10 < v_) {
-            // exceeds int size
-            return 0;
+    for (; i + needle_len - 1 + 32 <= len; i += 32) {
+        __m256i block_first =
+            _mm256_loadu_si256((const __m256i *)(haystack + i));
+        __m256i block_last = _mm256_loadu_si256(
+            (const __m256i *)(haystack + i + needle_len - 1)
+        );
+        __m256i eq = _mm256_and_si256(
+            _mm256_cmpeq_epi8(block_first, first),
+            _mm256_cmpeq_epi8(block_last, last)
+        );
+        uint mask = (uint)_mm256_movemask_epi8(eq);
+        while (mask) {
+            size_t candidate = i + bits_least_significant(mask);
+            if (bytes_eq(
+                    haystack + candidate + 1, needle + 1, needle_len - 2
+                )) {
+                return (llong)candidate;
+            }
+            mask &= mask - 1;
         }
-        v_ *= 10;
-        v_ += n;
-        bytes_parsed += 1;
     }
-
-    *v = sign * v_;
-    return bytes_parsed;
+    llong tail = bytes_index_of_short_sse2(
+        haystack + i, len - i, needle, needle_len
+    );
+    return tail < 0 ? -1 : (llong)i + tail;
 }
 
-size_t cstr_to_ullong(const char *s, size_t len, ullong *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
-        return 0;
-    }
-    size_t bytes_parsed = 0;
-    ullong v_ = 0;
+#endif // JP_SIMD_X86
+
+typedef struct {
+    llong (*diff_index)(const uchar *, const uchar *, size_t, size_t);
+    llong (*index_of_byte)(const uchar *, size_t, uchar);
+    llong (*last_index_of_byte)(const uchar *, size_t, uchar);
+    size_t (*count_byte)(const uchar *, size_t, uchar);
+    llong (*index_of_nth_byte)(const uchar *, size_t, uchar, size_t);
+    llong (*index_of_short)(const uchar *, size_t, const uchar *, size_t);
+    llong (*index_of_set)(const uchar *, size_t, const byteset *, bool);
+    void (*to_hex)(char *, const uchar *, size_t);
+    bool (*from_hex)(uchar *, const char *, size_t);
+} bytes_kernels;
+
+static const bytes_kernels bytes_kernels_scalar = {
+    bytes_diff_index_scalar,
+    bytes_index_of_byte_scalar,
+    bytes_last_index_of_byte_scalar,
+    bytes_count_byte_scalar,
+    bytes_index_of_nth_byte_scalar,
+    bytes_index_of_short_scalar,
+    bytes_index_of_set_scalar,
+    bytes_to_hex_scalar,
+    bytes_from_hex_scalar,
+};
 
-    for (size_t i = 0; i < len && char_is_digit(s[i]); i += 1) {
-        ullong n = (uchar)s[i] - '0';
-        if ((ULLONG_MAX - n) / 10 < v_) {
-            // exceeds int size
-            return 0;
-        }
-        v_ *= 10;
-        v_ += n;
-        bytes_parsed += 1;
-    }
+#ifdef JP_SIMD_X86
+
+static const bytes_kernels bytes_kernels_sse2 = {
+    bytes_diff_index_sse2,
+    bytes_index_of_byte_sse2,
+    bytes_last_index_of_byte_sse2,
+    bytes_count_byte_sse2,
+    bytes_index_of_nth_byte_sse2,
+    bytes_index_of_short_sse2,
+    bytes_index_of_set_scalar,
+    bytes_to_hex_scalar,
+    bytes_from_hex_scalar,
+};
 
-    *v = v_;
-    return bytes_parsed;
-}
+static const bytes_kernels bytes_kernels_ssse3 = {
+    bytes_diff_index_sse2,
+    bytes_index_of_byte_sse2,
+    bytes_last_index_of_byte_sse2,
+    bytes_count_byte_sse2,
+    bytes_index_of_nth_byte_sse2,
+    bytes_index_of_short_sse2,
+    bytes_index_of_set_ssse3,
+    bytes_to_hex_ssse3,
+    bytes_from_hex_ssse3,
+};
 
-static const double pow10_double[] = {
-    1e0,   1e1,   1e2,   1e3,   1e4,   1e5,   1e6,   1e7,   1e8,   1e9,   1e10,
-    1e11,  1e12,  1e13,  1e14,  1e15,  1e16,  1e17,  1e18,  1e19,  1e20,  1e21,
-    1e22,  1e23,  1e24,  1e25,  1e26,  1e27,  1e28,  1e29,  1e30,  1e31,  1e32,
-    1e33,  1e34,  1e35,  1e36,  1e37,  1e38,  1e39,  1e40,  1e41,  1e42,  1e43,
-    1e44,  1e45,  1e46,  1e47,  1e48,  1e49,  1e50,  1e51,  1e52,  1e53,  1e54,
-    1e55,  1e56,  1e57,  1e58,  1e59,  1e60,  1e61,  1e62,  1e63,  1e64,  1e65,
-    1e66,  1e67,  1e68,  1e69,  1e70,  1e71,  1e72,  1e73,  1e74,  1e75,  1e76,
-    1e77,  1e78,  1e79,  1e80,  1e81,  1e82,  1e83,  1e84,  1e85,  1e86,  1e87,
-    1e88,  1e89,  1e90,  1e91,  1e92,  1e93,  1e94,  1e95,  1e96,  1e97,  1e98,
-    1e99,  1e100, 1e101, 1e102, 1e103, 1e104, 1e105, 1e106, 1e107, 1e108, 1e109,
-    1e110, 1e111, 1e112, 1e113, 1e114, 1e115, 1e116, 1e117, 1e118, 1e119, 1e120,
-    1e121, 1e122, 1e123, 1e124, 1e125, 1e126, 1e127, 1e128, 1e129, 1e130, 1e131,
-    1e132, 1e133, 1e134, 1e135, 1e136, 1e137, 1e138, 1e139, 1e140, 1e141, 1e142,
-    1e143, 1e144, 1e145, 1e146, 1e147, 1e148, 1e149, 1e150, 1e151, 1e152, 1e153,
-    1e154, 1e155, 1e156, 1e157, 1e158, 1e159, 1e160, 1e161, 1e162, 1e163, 1e164,
-    1e165, 1e166, 1e167, 1e168, 1e169, 1e170, 1e171, 1e172, 1e173, 1e174, 1e175,
-    1e176, 1e177, 1e178, 1e179, 1e180, 1e181, 1e182, 1e183, 1e184, 1e185, 1e186,
-    1e187, 1e188, 1e189, 1e190, 1e191, 1e192, 1e193, 1e194, 1e195, 1e196, 1e197,
-    1e198, 1e199, 1e200, 1e201, 1e202, 1e203, 1e204, 1e205, 1e206, 1e207, 1e208,
-    1e209, 1e210, 1e211, 1e212, 1e213, 1e214, 1e215, 1e216, 1e217, 1e218, 1e219,
-    1e220, 1e221, 1e222, 1e223, 1e224, 1e225, 1e226, 1e227, 1e228, 1e229, 1e230,
-    1e231, 1e232, 1e233, 1e234, 1e235, 1e236, 1e237, 1e238, 1e239, 1e240, 1e241,
-    1e242, 1e243, 1e244, 1e245, 1e246, 1e247, 1e248, 1e249, 1e250, 1e251, 1e252,
-    1e253, 1e254, 1e255, 1e256, 1e257, 1e258, 1e259, 1e260, 1e261, 1e262, 1e263,
-    1e264, 1e265, 1e266, 1e267, 1e268, 1e269, 1e270, 1e271, 1e272, 1e273, 1e274,
-    1e275, 1e276, 1e277, 1e278, 1e279, 1e280, 1e281, 1e282, 1e283, 1e284, 1e285,
-    1e286, 1e287, 1e288, 1e289, 1e290, 1e291, 1e292, 1e293, 1e294, 1e295, 1e296,
-    1e297, 1e298, 1e299, 1e300, 1e301, 1e302, 1e303, 1e304, 1e305, 1e306, 1e307,
-    1e308
+static const bytes_kernels bytes_kernels_avx2 = {
+    bytes_diff_index_avx2,
+    bytes_index_of_byte_avx2,
+    bytes_last_index_of_byte_avx2,
+    bytes_count_byte_avx2,
+    bytes_index_of_nth_byte_avx2,
+    bytes_index_of_short_avx2,
+    bytes_index_of_set_avx2,
+    bytes_to_hex_avx2,
+    bytes_from_hex_avx2,
 };
 
-static const ullong pow10_ullong[] = {
-    1e0L,
-    1e1L,
-    1e2L,
-    1e3L,
-    1e4L,
-    1e5L,
-    1e6L,
-    1e7L,
-    1e8L,
-    1e9L,
-    1e10L,
-    1e11L,
-    1e12L,
-    1e13L,
-    1e14L,
-    1e15L,
-    1e16L,
-    1e17L,
-    1e18L
+static const bytes_kernels bytes_kernels_avx512 = {
+    bytes_diff_index_avx2,
+    bytes_index_of_byte_avx512,
+    bytes_last_index_of_byte_avx512,
+    bytes_count_byte_avx512,
+    bytes_index_of_nth_byte_avx512,
+    bytes_index_of_short_avx2,
+    bytes_index_of_set_avx2,
+    bytes_to_hex_avx2,
+    bytes_from_hex_avx2,
 };
 
-size_t cstr_to_float(const char *s, size_t len, float *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
-        return 0;
-    }
-    ullong integer = 0;
-    ullong decimals = 0;
-    float fraction = 0.0;
-    float sign = 1.0;
-    ullong exp = 0;
-    size_t i = 0;
+#endif // JP_SIMD_X86
+
+static const cpu_dispatch_variant bytes_variants[] = {
+#ifdef JP_SIMD_X86
+    {cpu_feature_avx512 | cpu_feature_avx2 | cpu_feature_popcnt,
+     &bytes_kernels_avx512},
+    {cpu_feature_avx2 | cpu_feature_popcnt, &bytes_kernels_avx2},
+    {cpu_feature_sse2 | cpu_feature_ssse3, &bytes_kernels_ssse3},
+    {cpu_feature_sse2, &bytes_kernels_sse2},
+#endif
+    {0, &bytes_kernels_scalar},
+};
 
-    if (i < len && s[0] == '-') {
-        i += 1;
-        sign = -1.0;
-    } else if (i < len && s[0] == '+') {
-        i += 1;
-    }
+static inline const bytes_kernels *bytes_kernels_get(void) {
+    return cpu_dispatch_get(
+        cpu_dispatch_bytes, bytes_variants, countof(bytes_variants)
+    );
+}
 
-    // integer part
-    for (; i < len && char_is_digit(s[i]); i += 1) {
-        ullong n = (uchar)s[i] - '0';
-        if ((INT64_MAX - n) / 10 < integer) {
-            // exceeds int size
-            return 0;
-        }
-        integer *= 10;
-        integer += n;
+llong bytes_diff_index(const void *a, const void *b, size_t start, size_t len) {
+    if (len == 0 || (uintptr_t)a == (uintptr_t)b) {
+        return -1LL;
     }
-
-    // decimals
-    if (i < len && s[i] == '.') {
-        i += 1;
-        float divisor = 10.0;
-        for (; i < len && char_is_digit(s[i]); i += 1) {
-            ullong n = (uchar)s[i] - '0';
-            if ((INT64_MAX - n) / 10 < integer) {
-                // exceeds int size, use fractions instead
-                fraction += (float)(s[i] - '0') / divisor;
-                divisor *= 10.0f;
-                return 0;
-            } else {
-                integer *= 10;
-                integer += n;
-                decimals += 1;
-            }
-        }
+    if (!a || !b) {
+        return 0LL;
     }
+    assert(start < len && "start must be lower than or equal to length");
+    assert(len < LLONG_MAX && "len must be smaller than llong max");
 
-    // exponent
-    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
-        i += 1;
-
-        int exp_sign = 1;
-        if (i < len && s[i] == '-') {
-            exp_sign = -1;
-            i += 1;
-        } else if (i < len && s[i] == '+') {
-            i += 1;
-        }
-
-        for (; i < len && char_is_digit(s[i]); i += 1) {
-            ullong n = (uchar)s[i] - '0';
-            if ((INT64_MAX - n) / 10 < exp) {
-                // exceeds int size
-                return 0;
-            }
-            exp *= 10;
-            exp += n;
-        }
-
-        assert(exp_sign != 0 && "exp_sign must not be zero");
-        if (exp_sign > 0) {
-            ullong decimals_to_reduce = min(decimals, exp);
-            decimals -= decimals_to_reduce;
-            exp -= decimals_to_reduce;
-        } else if (exp_sign < 0) {
-            if ((INT64_MAX - exp < decimals)) {
-                // exceeds int size
-                return 0;
-            }
-            decimals += exp;
-            exp = 0;
-        }
+    return bytes_kernels_get()->diff_index(a, b, start, len);
+}
 
-        if (exp > FLT_MAX_10_EXP) {
-            // exceeds max exponent
-            return 0;
-        }
+bool bytes_eq(const void *a, const void *b, size_t len) {
+    if (bytes_diff_index(a, b, 0, len) >= 0) {
+        return false;
     }
+    return true;
+}
 
-    // collect results
-    float v_ = (float)integer;
-    if (v_ > FLT_MAX / (float)pow10_double[exp]) {
-        // exceeds float max
+int bytes_cmp(const void *a, const void *b, size_t len) {
+    if (len == 0 || (uintptr_t)a == (uintptr_t)b) {
         return 0;
     }
-    v_ *= (float)pow10_double[exp];
-    v_ /= (float)pow10_double[decimals];
-    if (v_ > FLT_MAX - fraction) {
-        // exceeds float max
+    if (!a || !b) {
+        return a ? 1 : -1;
+    }
+    llong i = bytes_diff_index(a, b, 0, len);
+    if (i < 0) {
         return 0;
     }
-    v_ += fraction;
-    v_ *= sign;
+    const uchar *a_ = a, *b_ = b;
+    return (int)a_[i] - (int)b_[i];
+}
 
-    *v = v_;
-    return i;
+llong bytes_index_of_byte(const uchar *buffer, size_t len, uchar byte) {
+    assert(len < LLONG_MAX && "len must be less than llong max");
+    return bytes_kernels_get()->index_of_byte(buffer, len, byte);
 }
 
-size_t cstr_to_double(const char *s, size_t len, double *v) {
-    assert(s && "string must not be null");
-    assert(len && "length must be 1 or more");
-    assert(v && "value storage must not be null");
-    if (!s || !len || !v) {
+llong bytes_last_index_of_byte(const uchar *buffer, size_t len, uchar byte) {
+    assert(len < LLONG_MAX && "len must be less than llong max");
+    return bytes_kernels_get()->last_index_of_byte(buffer, len, byte);
+}
+
+size_t bytes_count_byte(const uchar *buffer, size_t len, uchar byte) {
+    return bytes_kernels_get()->count_byte(buffer, len, byte);
+}
+
+size_t bytes_count_lines(const uchar *buffer, size_t len) {
+    if (len == 0) {
         return 0;
     }
-    ullong integer = 0;
-    ullong decimals = 0;
-    double fraction = 0.0;
-    float sign = 1.0;
-    ullong exp = 0;
-    size_t i = 0;
+    size_t lines = bytes_count_byte(buffer, len, '\n');
+    return buffer[len - 1] == '\n' ? lines : lines + 1;
+}
 
-    if (i < len && s[0] == '-') {
-        i += 1;
-        sign = -1.0;
-    } else if (i < len && s[0] == '+') {
-        i += 1;
+llong
+bytes_index_of_nth_byte(const uchar *buffer, size_t len, uchar byte, size_t n) {
+    assert(len < LLONG_MAX && "len must be less than llong max");
+    assert(n > 0 && "n must be >0");
+    return bytes_kernels_get()->index_of_nth_byte(buffer, len, byte, n);
+}
+
+void byteset_init(byteset *set, const void *bytes, size_t len) {
+    assert(set && "byte set must not be null");
+    assert((bytes || len == 0) && "bytes must not be null");
+    bytes_set(set, 0, sizeof(*set));
+    const uchar *b = bytes;
+    for (size_t i = 0; i < len; i += 1) {
+        byteset_add(set, b[i]);
     }
+}
 
-    // integer part
-    for (; i < len && char_is_digit(s[i]); i += 1) {
-        ullong n = (uchar)s[i] - '0';
-        if ((INT64_MAX - n) / 10 < integer) {
-            // exceeds int size
-            return 0;
-        }
-        integer *= 10;
-        integer += n;
+llong bytes_index_of_any(const uchar *buffer, size_t len, const byteset *set) {
+    assert(set && "byte set must not be null");
+    assert(len < LLONG_MAX && "len must be less than llong max");
+    return bytes_kernels_get()->index_of_set(buffer, len, set, true);
+}
+
+llong
+bytes_index_not_of_any(const uchar *buffer, size_t len, const byteset *set) {
+    assert(set && "byte set must not be null");
+    assert(len < LLONG_MAX && "len must be less than llong max");
+    return bytes_kernels_get()->index_of_set(buffer, len, set, false);
+}
+
+static llong bytes_index_of_short(
+    const uchar *haystack, size_t len, const uchar *needle, size_t needle_len
+) {
+    assert(needle_len > 0 && "needle len must be >0");
+    if (needle_len == 1) {
+        return bytes_index_of_byte(haystack, len, *needle);
     }
+    return bytes_kernels_get()->index_of_short(
+        haystack, len, needle, needle_len
+    );
+}
 
-    // decimals
-    if (i < len && s[i] == '.') {
-        i += 1;
-        double divisor = 10.0;
-        for (; i < len && char_is_digit(s[i]); i += 1) {
-            ullong n = (uchar)s[i] - '0';
-            if ((INT64_MAX - n) / 10 < integer) {
-                // exceeds int size, use fractions instead
-                fraction += (double)(s[i] - '0') / divisor;
-                divisor *= 10.0;
-                return 0;
-            } else {
-                integer *= 10;
-                integer += n;
-                decimals += 1;
-            }
+// Horspool: compare the last byte of the window first, and on mismatch shift
+// the window based on where the last byte of the window occurs in the needle.
+static llong bytes_index_of_horspool(
+    const bytes_finder *finder, const uchar *haystack, size_t len
+) {
+    const uchar *needle = finder->needle;
+    size_t needle_len = finder->len;
+    uchar last = needle[needle_len - 1];
+    size_t i = 0;
+    while (i + needle_len <= len) {
+        uchar c = haystack[i + needle_len - 1];
+        if (c == last && bytes_eq(haystack + i, needle, needle_len - 1)) {
+            return (llong)i;
         }
+        i += finder->skip[c];
     }
+    return -1;
+}
 
-    // exponent
-    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
-        i += 1;
-
-        int exp_sign = 1;
-        if (i < len && s[i] == '-') {
-            exp_sign = -1;
-            i += 1;
-        } else if (i < len && s[i] == '+') {
-            i += 1;
-        }
+void bytes_finder_init(bytes_finder *finder, const void *needle, size_t len) {
+    assert(finder && "finder must not be null");
+    assert((needle || !len) && "needle must not be null");
 
-        for (; i < len && char_is_digit(s[i]); i += 1) {
-            ullong n = (uchar)s[i] - '0';
-            if ((INT64_MAX - n) / 10 < exp) {
-                // exceeds int size
-                return 0;
-            }
-            exp *= 10;
-            exp += n;
-        }
+    finder->needle = needle;
+    finder->len = len;
+    if (len <= bytes_finder_short_needle_max) {
+        return; // skip table is not used
+    }
+    for (size_t i = 0; i < countof(finder->skip); i += 1) {
+        finder->skip[i] = len;
+    }
+    for (size_t i = 0; i + 1 < len; i += 1) {
+        finder->skip[finder->needle[i]] = len - 1 - i;
+    }
+}
 
-        assert(exp_sign != 0 && "exp_sign must not be zero");
-        if (exp_sign > 0) {
-            ullong decimals_to_reduce = min(decimals, exp);
-            decimals -= decimals_to_reduce;
-            exp -= decimals_to_reduce;
-        } else if (exp_sign < 0) {
-            if ((INT64_MAX - exp < decimals)) {
-                // exceeds int size
-                return 0;
-            }
-            decimals += exp;
-            exp = 0;
-        }
+llong bytes_finder_find(
+    const bytes_finder *finder, const void *haystack, size_t len
+) {
+    assert(finder && "finder must not be null");
+    assert(len < LLONG_MAX && "len must be smaller than llong max");
 
-        if (exp > DBL_MAX_10_EXP) {
-            // exceeds max exponent
-            return 0;
-        }
+    // same as bytes_index_of: an empty needle is found only in a non-empty
+    // haystack
+    if (!haystack || len == 0 || len < finder->len) {
+        return -1LL;
     }
-
-    // collect results
-    double v_ = (double)integer;
-    if (v_ > DBL_MAX / pow10_double[exp]) {
-        // exceeds double max
-        return 0;
+    if (finder->len == 0) {
+        return 0LL;
     }
-    v_ *= pow10_double[exp];
-    v_ /= pow10_double[decimals];
-    if (v_ > DBL_MAX - fraction) {
-        // exceeds double max
-        return 0;
+    if (finder->len <= bytes_finder_short_needle_max) {
+        return bytes_index_of_short(haystack, len, finder->needle, finder->len);
     }
-    v_ += fraction;
-    v_ *= sign;
-
-    *v = v_;
-    return i;
+    return bytes_index_of_horspool(finder, haystack, len);
 }
 
-#define cstr_int_max_len 16
-#define cstr_uint_max_len 16
-#define cstr_llong_max_len 32
-#define cstr_ullong_max_len 32
+llong bytes_index_of(const void *a, size_t a_len, const void *b, size_t b_len) {
+    assert(a_len < LLONG_MAX && "len must be smaller than llong max");
 
-static size_t cstr_from_int_unsafe(char *cursor, int src) {
-    char *start = cursor;
-    bool is_neg = src < 0;
-    if (is_neg) {
-        src = -src;
+    if (a_len == 0 || a_len < b_len || !a || !b) {
+        return -1LL;
+    }
+    if (b_len == 0 || (uintptr_t)a == (uintptr_t)b) {
+        return 0LL;
+    }
+    if (b_len <= bytes_finder_short_needle_max) {
+        return bytes_index_of_short(a, a_len, b, b_len);
     }
+    bytes_finder finder;
+    bytes_finder_init(&finder, b, b_len);
+    return bytes_index_of_horspool(&finder, a, a_len);
+}
 
-    do {
-        cursor -= 1;
-        *cursor = '0' + (char)(src % 10);
-        src /= 10;
-    } while (src > 0);
-    if (is_neg) {
-        cursor -= 1;
-        *cursor = '-';
+size_t
+bytes_to_hex(char *dest, size_t dest_len, const char *src, size_t src_len) {
+    assert(dest && "dest must not be null");
+    assert((src || src_len == 0) && "src must not be null");
+
+    size_t len = min(src_len, dest_len / 2);
+    if (len > 0) {
+        bytes_kernels_get()->to_hex(dest, (const uchar *)src, len);
     }
 
-    return (size_t)(start - cursor);
+    size_t j = len * 2;
+    if (j < dest_len) {
+        // null terminate if possible
+        dest[j] = 0;
+    }
+    return j;
 }
 
-size_t cstr_from_int(char *dest, size_t len, int src) {
+llong
+bytes_from_hex(void *dest, size_t dest_len, const char *src, size_t src_len) {
     assert(dest && "dest must not be null");
-    assert(len > 0 && "len must be more than 0");
-
-    char tmp[cstr_int_max_len];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_int_unsafe(end, src);
+    assert((src || src_len == 0) && "src must not be null");
+    assert(src_len / 2 < LLONG_MAX && "len must be less than llong max");
 
-    if (len < bytes_to_copy) {
+    if (src_len % 2 != 0) {
+        return -1;
+    }
+    size_t len = min(src_len / 2, dest_len);
+    if (len == 0) {
         return 0;
     }
-
-    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
-    return bytes_to_copy;
+    if (!bytes_kernels_get()->from_hex(dest, src, len)) {
+        return -1;
+    }
+    return (llong)len;
 }
 
-static size_t cstr_from_uint_unsafe(char *cursor, uint src) {
-    char *start = cursor;
+////////////////////////
+// Allocator
+////////////////////////
 
-    do {
-        cursor -= 1;
-        *cursor = '0' + (char)(src % 10);
-        src /= 10;
-    } while (src > 0);
+static size_t mmap_page_size(void) {
+    long page_size_signed = sysconf(_SC_PAGE_SIZE);
+    assert(page_size_signed > 0 && "expected a page size >0");
+    return (size_t)page_size_signed;
+}
 
-    return (size_t)(start - cursor);
+static uint mmap_options_flags(const void *ctx) {
+    const mmap_options *options = ctx;
+    return options ? options->flags : 0;
 }
 
-size_t cstr_from_uint(char *dest, size_t len, uint src) {
-    assert(dest && "dest must not be null");
-    assert(len > 0 && "len must be more than 0");
+static size_t mmap_options_alignment(const void *ctx, size_t alignment) {
+    const mmap_options *options = ctx;
+    return options ? max(alignment, options->alignment) : alignment;
+}
 
-    char tmp[cstr_uint_max_len];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_uint_unsafe(end, src);
+static void *mmap_map(size_t size, int flags) {
+    void *ptr = mmap(
+        0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags,
+        -1, 0
+    );
+    return ptr == MAP_FAILED ? NULL : ptr;
+}
 
-    if (len < bytes_to_copy) {
-        return 0;
+// Map memory with an alignment larger than the page size by mapping extra
+// memory and unmapping the misaligned head and the unused tail.
+static void *
+mmap_map_aligned(size_t size, size_t alignment, size_t page_size, int flags) {
+    if (alignment <= page_size) {
+        return mmap_map(size, flags);
     }
-
-    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
-    return bytes_to_copy;
+    size_t extra = alignment - page_size;
+    if (size > SIZE_MAX - extra) {
+        return NULL;
+    }
+    uchar *base = mmap_map(size + extra, flags);
+    if (!base) {
+        return NULL;
+    }
+    uchar *aligned = (uchar *)align_to_nearest((uintptr_t)base, alignment);
+    size_t head = (size_t)(aligned - base);
+    size_t tail = extra - head;
+    if (head > 0) {
+        munmap(base, head);
+    }
+    if (tail > 0) {
+        munmap(aligned + size, tail);
+    }
+    return aligned;
 }
 
-static size_t cstr_from_llong_unsafe(char *cursor, llong src) {
-    char *start = cursor;
-    bool is_neg = src < 0;
-    if (is_neg) {
-        src = -src;
+// Fault in the pages of a mapping
+static void mmap_prefault(void *ptr, size_t size, size_t page_size) {
+#ifdef MADV_POPULATE_WRITE
+    if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+        return;
     }
-
-    do {
-        cursor -= 1;
-        *cursor = '0' + (char)(src % 10);
-        src /= 10;
-    } while (src > 0);
-    if (is_neg) {
-        cursor -= 1;
-        *cursor = '-';
+#endif
+    // anonymous memory is zeroed, so writing a zero keeps the contents
+    volatile uchar *bytes = ptr;
+    for (size_t i = 0; i < size; i += page_size) {
+        bytes[i] = bytes[i];
     }
+}
 
-    return (size_t)(start - cursor);
+// Apply the options that take effect after the memory is mapped
+static void
+mmap_advise(void *ptr, size_t size, size_t page_size, uint flags) {
+#ifdef MADV_HUGEPAGE
+    if (flags & mmap_flag_transparent_huge_pages) {
+        // advisory only, the memory works the same without huge pages
+        madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#endif
+    if (flags & mmap_flag_populate) {
+        mmap_prefault(ptr, size, page_size);
+    }
 }
 
-size_t cstr_from_llong(char *dest, size_t len, llong src) {
-    assert(dest && "dest must not be null");
-    assert(len > 0 && "len must be more than 0");
+allocation mmap_malloc(size_t size, size_t alignment, void *ctx) {
+    assert(size > 0 && "size must be greater than 0");
+    uint flags = mmap_options_flags(ctx);
+    alignment = mmap_options_alignment(ctx, alignment);
+    assert(
+        (alignment == 0 || is_power_of_two(alignment))
+        && "alignment must be power of two"
+    );
+    size_t page_size = mmap_page_size();
+    if (size > SIZE_MAX - mmap_huge_page_size) {
+        return (allocation) {0};
+    }
 
-    char tmp[cstr_llong_max_len];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_llong_unsafe(end, src);
+#ifdef MAP_HUGETLB
+    if (flags & mmap_flag_huge_pages) {
+        size_t huge_size = (size_t)round_up_multiple_ullong(
+            (ullong)size, (ullong)mmap_huge_page_size
+        );
+        int map_flags = MAP_HUGETLB;
+#ifdef MAP_POPULATE
+        if (flags & mmap_flag_populate) {
+            map_flags |= MAP_POPULATE;
+        }
+#endif
+        void *ptr = mmap_map_aligned(
+            huge_size, alignment, mmap_huge_page_size, map_flags
+        );
+        if (ptr) {
+            return (allocation) {
+                .ptr = ptr,
+                .len = huge_size,
+            };
+        }
+        // no huge pages reserved
+        flags |= mmap_flag_transparent_huge_pages;
+    }
+#endif
 
-    if (len < bytes_to_copy) {
-        return 0;
+    size = (size_t)round_up_multiple_ullong((ullong)size, (ullong)page_size);
+    int map_flags = 0;
+    if (flags & mmap_flag_transparent_huge_pages) {
+        if (size >= mmap_huge_page_size) {
+            alignment = max(alignment, mmap_huge_page_size);
+        }
+    } else {
+#ifdef MAP_POPULATE
+        // populating before madvise would fault in small pages, so the
+        // transparent huge page mappings are prefaulted after madvise
+        if (flags & mmap_flag_populate) {
+            map_flags |= MAP_POPULATE;
+            flags &= ~mmap_flag_populate;
+        }
+#endif
     }
 
-    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
-    return bytes_to_copy;
+    void *ptr = mmap_map_aligned(size, alignment, page_size, map_flags);
+    if (!ptr) {
+        return (allocation) {0};
+    }
+    mmap_advise(ptr, size, page_size, flags);
+    return (allocation) {
+        .ptr = ptr,
+        .len = size,
+    };
 }
 
-static size_t cstr_from_ullong_unsafe(char *cursor, ullong src) {
-    char *start = cursor;
-
-    do {
-        cursor -= 1;
-        *cursor = '0' + (char)(src % 10);
-        src /= 10;
-    } while (src > 0);
+void mmap_free(allocation a, void *ctx) {
+    assert(a.ptr && "ptr must not be null");
+    (void)ctx;
+    munmap(a.ptr, a.len);
+}
 
-    return (size_t)(start - cursor);
+// Resize by copying to a new mapping
+static allocation
+mmap_realloc_copy(allocation a, size_t size, size_t alignment, void *ctx) {
+    allocation resized = mmap_malloc(size, alignment, ctx);
+    if (!allocation_exists(resized)) {
+        return resized;
+    }
+    bytes_copy(resized.ptr, a.ptr, min(a.len, resized.len));
+    mmap_free(a, ctx);
+    return resized;
 }
 
-size_t cstr_from_ullong(char *dest, size_t len, ullong src) {
-    assert(dest && "dest must not be null");
-    assert(len > 0 && "len must be more than 0");
+allocation
+mmap_realloc(allocation a, size_t size, size_t alignment, void *ctx) {
+    assert(a.ptr && "ptr must not be null");
+    assert(size > 0 && "size must be greater than 0");
 
-    char tmp[cstr_ullong_max_len];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_ullong_unsafe(end, src);
+    uint flags = mmap_options_flags(ctx);
+    size_t page_size = mmap_page_size();
+    if (flags & mmap_flag_huge_pages
+        || mmap_options_alignment(ctx, alignment) > page_size) {
+        // the mapping granularity and alignment are not kept by mremap
+        return mmap_realloc_copy(a, size, alignment, ctx);
+    }
 
-    if (len < bytes_to_copy) {
-        return 0;
+    size = (size_t)round_up_multiple_ullong((ullong)size, (ullong)page_size);
+    if (size == a.len) {
+        return a;
     }
 
-    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
-    return bytes_to_copy;
-}
+#ifdef MREMAP_MAYMOVE
+    void *ptr = mremap(a.ptr, a.len, size, MREMAP_MAYMOVE);
+    if (ptr == MAP_FAILED) {
+        return (allocation) {0};
+    }
+    if (size > a.len) {
+        mmap_advise((uchar *)ptr + a.len, size - a.len, page_size, flags);
+    }
+    return (allocation) {
+        .ptr = ptr,
+        .len = size,
+    };
+#else
+    if (size < a.len) {
+        munmap((uchar *)a.ptr + size, a.len - size);
+        return (allocation) {
+            .ptr = a.ptr,
+            .len = size,
+        };
+    }
+    return mmap_realloc_copy(a, size, alignment, ctx);
+#endif
+}
 
-struct cstr_from_real_parts {
-    char *integer_cursor;
-    char *fractional_cursor;
-    size_t integer_len;
-    size_t fractional_len;
-    uint decimal_zeros;
-    bool is_neg;
-    bool is_inf;
-};
+////////////////////////
+// Slices
+////////////////////////
 
-static size_t cstr_from_real_parts_len(struct cstr_from_real_parts *parts) {
-    size_t neg_len = parts->is_neg ? 1UL : 0UL;
-    if (parts->is_inf) {
-        return neg_len + 3; // len('inf') == 3
+slice slice_span(void *start, void *end) {
+    assert(start && "start must not be null");
+    assert(end && "end must not be null");
+
+    uchar *temp;
+    if ((uintptr_t)start > (uintptr_t)end) {
+        temp = start;
+        start = end;
+        end = temp;
     }
 
-    return neg_len + parts->integer_len + 1 + parts->decimal_zeros
-        + parts->fractional_len;
+    slice s = {0};
+    s.ptr = start;
+    s.len = (size_t)((uintptr_t)end - (uintptr_t)start);
+    return s;
 }
 
-static void
-cstr_from_real_parts_to_buf(struct cstr_from_real_parts *parts, char *dest) {
-    if (parts->is_inf) {
-        const char *text = "inf";
-        size_t bytes_to_write = sizeof("inf") - 1;
-        if (parts->is_neg) {
-            text = "-inf";
-            bytes_to_write = sizeof("-inf") - 1;
-        }
-        bytes_copy(dest, text, bytes_to_write);
-        return;
+bool slice_const_eq(const slice_const a, const slice_const b) {
+    if (a.len != b.len) {
+        return 0;
     }
+    return bytes_eq(a.ptr, b.ptr, a.len);
+}
 
-    char *cursor = dest;
-    if (parts->is_neg) {
-        cursor[0] = '-';
-        cursor += 1;
+bool slice_eq(const slice a, const slice b) {
+    if (a.len != b.len) {
+        return 0;
     }
-    bytes_copy(
-        cursor, parts->integer_cursor - parts->integer_len, parts->integer_len
-    );
-    cursor += parts->integer_len;
-    cursor[0] = '.';
-    cursor += 1;
-    for (uint i = 0; i < parts->decimal_zeros; i += 1) { cursor[i] = '0'; }
-    cursor += parts->decimal_zeros;
-    bytes_copy(
-        cursor,
-        parts->fractional_cursor - parts->fractional_len,
-        parts->fractional_len
-    );
-    cursor += parts->fractional_len;
-
-    assert((size_t)(cursor - dest) == cstr_from_real_parts_len(parts));
-    return;
+    return bytes_eq(a.ptr, b.ptr, a.len);
 }
 
-static uint count_decimal_zeros(ullong fractional, uint decimals) {
-    ullong precision_ullong = pow10_ullong[decimals];
-    uint decimal_zeros = 0;
-    for (ullong i = precision_ullong / 10; i > 1; i /= 10) {
-        if (i > fractional) {
-            decimal_zeros += 1;
-        } else {
-            break;
-        }
+int slice_const_cmp(const slice_const a, const slice_const b) {
+    int cmp = bytes_cmp(a.ptr, b.ptr, min(a.len, b.len));
+    if (cmp != 0) {
+        return cmp;
     }
-    return decimal_zeros;
+    return (a.len > b.len) - (a.len < b.len);
 }
 
-static void cstr_from_float_parts(
-    struct cstr_from_real_parts *parts, float src, uint decimals
-) {
-    assert(parts->integer_cursor && "integer cursor must not be null");
-    assert(parts->fractional_cursor && "integer cursor must not be null");
-    assert(decimals <= 9 && "decimals up to 9 are supported");
+int slice_cmp(const slice a, const slice b) {
+    return slice_const_cmp(
+        slice_const_new(a.ptr, a.len), slice_const_new(b.ptr, b.len)
+    );
+}
 
-    if (decimals > 9) {
-        decimals = 9;
-    }
+void slice_copy(slice dest, const slice src) {
+    size_t amount = min(src.len, dest.len);
+    bytes_copy(dest.ptr, src.ptr, amount);
+}
 
-    if (src < 0) {
-        parts->is_neg = 1;
-        src = -src;
-    }
+void slice_move(slice dest, const slice src) {
+    size_t amount = min(src.len, dest.len);
+    bytes_move(dest.ptr, src.ptr, amount);
+}
 
-    double precision_d = pow10_double[decimals];
-    src += (float)(0.5 / precision_d);
+slice_const slice_const_from_cstr_unsafe(const char *str) {
+    slice_const slice = {0};
+    slice.ptr = (const uchar *)str;
+    slice.len = (str == NULL) ? 0 : cstr_byte_len_unsafe(str);
+    return slice;
+}
 
-    // infinity check
-    if (src >= (float)(-1UL >> 1)) {
-        parts->is_inf = 1;
-        return;
-    }
+slice slice_from_cstr_unsafe(char *str) {
+    slice slice = {0};
+    slice.ptr = (uchar *)str;
+    slice.len = cstr_byte_len_unsafe(str);
+    return slice;
+}
 
-    // integer part
-    ullong integer = (ullong)src;
-    parts->integer_len =
-        cstr_from_ullong_unsafe(parts->integer_cursor, integer);
+////////////////////////
+// Hashing
+////////////////////////
 
-    // fractional part
-    ullong fractional = (ullong)(((double)src - (double)integer) * precision_d);
-    parts->decimal_zeros = count_decimal_zeros(fractional, decimals);
-    parts->fractional_len =
-        cstr_from_ullong_unsafe(parts->fractional_cursor, fractional);
+// wyhash secrets
+#define hash_secret0 0x2d358dccaa6c78a5ULL
+#define hash_secret1 0x8bb84b93962eacc9ULL
+#define hash_secret2 0x4b33a62ed433d4a3ULL
+#define hash_secret3 0x4d5a2da51de1aa47ULL
+
+// Long keys keep more than 16 bytes for the tail, so that the tail can always
+// be read without going back to consumed bytes.
+#define hash_block_size 48
+
+// Full 64x64 -> 128-bit multiply, returned as the low and high halves
+static inline void hash_mum(ullong *a, ullong *b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 u128;
+    u128 r = (u128)*a * *b;
+    *a = (ullong)r;
+    *b = (ullong)(r >> 64);
+#else
+    ullong ha = *a >> 32, la = (uint)*a, hb = *b >> 32, lb = (uint)*b;
+    ullong rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    ullong t = rl + (rm0 << 32);
+    ullong c = (ullong)(t < rl);
+    ullong lo = t + (rm1 << 32);
+    c += (ullong)(lo < t);
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
 }
 
-size_t cstr_from_float(char *dest, size_t len, float src, uint decimals) {
-    assert(dest && "dest must not be null");
-    assert(len > 2 && "len must be more than 2");
+static inline ullong hash_mix(ullong a, ullong b) {
+    hash_mum(&a, &b);
+    return a ^ b;
+}
 
-    if (len < 3) {
-        return 0;
-    }
+// Little-endian loads, so that hashes do not depend on the byte order
+static inline ullong hash_read64(const uchar *p) {
+    ullong v = bytes_load_ullong(p);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
 
-    char integer_cstr[cstr_ullong_max_len];
-    char fractional_cstr[cstr_ullong_max_len];
-    struct cstr_from_real_parts parts = {0};
-    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
-    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
-    cstr_from_float_parts(&parts, src, decimals);
-    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+static inline ullong hash_read32(const uchar *p) {
+    return (ullong)p[0] | (ullong)p[1] << 8 | (ullong)p[2] << 16
+        | (ullong)p[3] << 24;
+}
 
-    if (bytes_to_write > len) {
-        return 0;
+static inline ullong hash_seed(ullong seed) {
+    return seed ^ hash_mix(seed ^ hash_secret0, hash_secret1);
+}
+
+static inline void
+hash_block(ullong *restrict lanes, const uchar *restrict p) {
+    lanes[0] =
+        hash_mix(hash_read64(p) ^ hash_secret1, hash_read64(p + 8) ^ lanes[0]);
+    lanes[1] = hash_mix(
+        hash_read64(p + 16) ^ hash_secret2, hash_read64(p + 24) ^ lanes[1]
+    );
+    lanes[2] = hash_mix(
+        hash_read64(p + 32) ^ hash_secret3, hash_read64(p + 40) ^ lanes[2]
+    );
+}
+
+// Hash the tail of the input. The tail is the whole input when it is at most
+// 16 bytes, and 17 to 64 bytes otherwise.
+static ullong
+hash_tail(ullong seed, const uchar *p, size_t i, ullong len) {
+    ullong a = 0, b = 0;
+    if (i <= 16) {
+        if (i >= 4) {
+            size_t mid = (i >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + mid);
+            b = (hash_read32(p + i - 4) << 32) | hash_read32(p + i - 4 - mid);
+        } else if (i > 0) {
+            a = ((ullong)p[0] << 16) | ((ullong)p[i >> 1] << 8) | p[i - 1];
+        }
+    } else {
+        for (; i > 16; i -= 16, p += 16) {
+            seed = hash_mix(
+                hash_read64(p) ^ hash_secret1, hash_read64(p + 8) ^ seed
+            );
+        }
+        a = hash_read64(p + i - 16);
+        b = hash_read64(p + i - 8);
     }
+    a ^= hash_secret1;
+    b ^= seed;
+    hash_mum(&a, &b);
+    return hash_mix(a ^ hash_secret0 ^ len, b ^ hash_secret1);
+}
 
-    cstr_from_real_parts_to_buf(&parts, dest);
-    return bytes_to_write;
+static ullong hash_final64(
+    const ullong *lanes, const uchar *tail, size_t tail_len, ullong len
+) {
+    return hash_tail(lanes[0] ^ lanes[1] ^ lanes[2], tail, tail_len, len);
 }
 
-static void cstr_from_double_parts(
-    struct cstr_from_real_parts *parts, double src, uint decimals
+static hash128 hash_final128(
+    const ullong *lanes, const uchar *tail, size_t tail_len, ullong len
 ) {
-    assert(parts->integer_cursor && "integer cursor must not be null");
-    assert(parts->fractional_cursor && "integer cursor must not be null");
-    assert(decimals <= 18 && "decimals up to 18 are supported");
+    ullong hi_seed =
+        hash_mix(lanes[1] ^ hash_secret2, lanes[2] ^ hash_secret3) + lanes[0];
+    hash128 h = {
+        .lo = hash_final64(lanes, tail, tail_len, len),
+        .hi = hash_tail(hi_seed, tail, tail_len, len),
+    };
+    return h;
+}
 
-    if (decimals > 18) {
-        decimals = 18;
+// Consume blocks while more than the buffer size is left
+static size_t
+hash_blocks(ullong *restrict lanes, const uchar *restrict p, size_t len) {
+    size_t i = 0;
+    for (; len - i > slice_hash_buffer_size; i += hash_block_size) {
+        hash_block(lanes, p + i);
     }
+    return i;
+}
 
-    if (src < 0) {
-        parts->is_neg = 1;
-        src = -src;
+ullong slice_hash64(slice_const s, ullong seed) {
+    assert((s.ptr || s.len == 0) && "slice must not be null");
+    seed = hash_seed(seed);
+    if (s.len <= slice_hash_buffer_size) {
+        // the lanes would all be equal to the seed
+        return hash_tail(seed, s.ptr, s.len, s.len);
     }
+    ullong lanes[3] = {seed, seed, seed};
+    size_t i = hash_blocks(lanes, s.ptr, s.len);
+    return hash_final64(lanes, s.ptr + i, s.len - i, s.len);
+}
 
-    double precision_d = pow10_double[decimals];
-    src += 0.5 / precision_d;
+hash128 slice_hash128(slice_const s, ullong seed) {
+    assert((s.ptr || s.len == 0) && "slice must not be null");
+    seed = hash_seed(seed);
+    ullong lanes[3] = {seed, seed, seed};
+    size_t i = hash_blocks(lanes, s.ptr, s.len);
+    return hash_final128(lanes, s.ptr + i, s.len - i, s.len);
+}
 
-    // infinity check
-    if (src >= (double)(-1UL >> 1)) {
-        parts->is_inf = 1;
-        return;
+void slice_hash_init(slice_hash_state *h, ullong seed) {
+    assert(h && "hash state must not be null");
+    seed = hash_seed(seed);
+    h->lanes[0] = seed;
+    h->lanes[1] = seed;
+    h->lanes[2] = seed;
+    h->len = 0;
+    h->buffered = 0;
+}
+
+void slice_hash_update(slice_hash_state *h, slice_const s) {
+    assert(h && "hash state must not be null");
+    assert((s.ptr || s.len == 0) && "slice must not be null");
+    const uchar *p = s.ptr;
+    size_t len = s.len;
+    h->len += len;
+
+    // A block is only consumed when more than the buffer size is left, so
+    // that the tail stays in the buffer just like in the one-shot hash.
+    while (h->buffered && h->buffered + len > slice_hash_buffer_size) {
+        if (h->buffered < hash_block_size) {
+            size_t fill = hash_block_size - h->buffered;
+            bytes_copy(h->buffer + h->buffered, p, fill);
+            h->buffered += fill;
+            p += fill;
+            len -= fill;
+        }
+        hash_block(h->lanes, h->buffer);
+        h->buffered -= hash_block_size;
+        bytes_move(h->buffer, h->buffer + hash_block_size, h->buffered);
     }
+    if (!h->buffered) {
+        size_t consumed = hash_blocks(h->lanes, p, len);
+        p += consumed;
+        len -= consumed;
+    }
+    if (len) {
+        bytes_copy(h->buffer + h->buffered, p, len);
+        h->buffered += len;
+    }
+}
 
-    // integer part
-    ullong integer = (ullong)src;
-    parts->integer_len =
-        cstr_from_ullong_unsafe(parts->integer_cursor, integer);
+ullong slice_hash_final64(const slice_hash_state *h) {
+    assert(h && "hash state must not be null");
+    return hash_final64(h->lanes, h->buffer, h->buffered, h->len);
+}
 
-    // fractional part
-    ullong fractional = (ullong)((src - (double)integer) * precision_d);
-    parts->decimal_zeros = count_decimal_zeros(fractional, decimals);
-    parts->fractional_len =
-        cstr_from_ullong_unsafe(parts->fractional_cursor, fractional);
+hash128 slice_hash_final128(const slice_hash_state *h) {
+    assert(h && "hash state must not be null");
+    return hash_final128(h->lanes, h->buffer, h->buffered, h->len);
 }
 
-size_t cstr_from_double(char *dest, size_t len, double src, uint decimals) {
-    assert(dest && "dest must not be null");
-    assert(len > 2 && "len must be more than 2");
+// CRC-32C tables for slice-by-8: table[0] is the CRC of a single byte and
+// table[k] is the CRC of a byte followed by k zero bytes.
+static const uint crc32c_table[8][256] = {
+    {
+        0x00000000, 0xF26B8303, 0xE13B70F7, 0x1350F3F4, 0xC79A971F, 0x35F1141C,
+        0x26A1E7E8, 0xD4CA64EB, 0x8AD958CF, 0x78B2DBCC, 0x6BE22838, 0x9989AB3B,
+        0x4D43CFD0, 0xBF284CD3, 0xAC78BF27, 0x5E133C24, 0x105EC76F, 0xE235446C,
+        0xF165B798, 0x030E349B, 0xD7C45070, 0x25AFD373, 0x36FF2087, 0xC494A384,
+        0x9A879FA0, 0x68EC1CA3, 0x7BBCEF57, 0x89D76C54, 0x5D1D08BF, 0xAF768BBC,
+        0xBC267848, 0x4E4DFB4B, 0x20BD8EDE, 0xD2D60DDD, 0xC186FE29, 0x33ED7D2A,
+        0xE72719C1, 0x154C9AC2, 0x061C6936, 0xF477EA35, 0xAA64D611, 0x580F5512,
+        0x4B5FA6E6, 0xB93425E5, 0x6DFE410E, 0x9F95C20D, 0x8CC531F9, 0x7EAEB2FA,
+        0x30E349B1, 0xC288CAB2, 0xD1D83946, 0x23B3BA45, 0xF779DEAE, 0x05125DAD,
+        0x1642AE59, 0xE4292D5A, 0xBA3A117E, 0x4851927D, 0x5B016189, 0xA96AE28A,
+        0x7DA08661, 0x8FCB0562, 0x9C9BF696, 0x6EF07595, 0x417B1DBC, 0xB3109EBF,
+        0xA0406D4B, 0x522BEE48, 0x86E18AA3, 0x748A09A0, 0x67DAFA54, 0x95B17957,
+        0xCBA24573, 0x39C9C670, 0x2A993584, 0xD8F2B687, 0x0C38D26C, 0xFE53516F,
+        0xED03A29B, 0x1F682198, 0x5125DAD3, 0xA34E59D0, 0xB01EAA24, 0x42752927,
+        0x96BF4DCC, 0x64D4CECF, 0x77843D3B, 0x85EFBE38, 0xDBFC821C, 0x2997011F,
+        0x3AC7F2EB, 0xC8AC71E8, 0x1C661503, 0xEE0D9600, 0xFD5D65F4, 0x0F36E6F7,
+        0x61C69362, 0x93AD1061, 0x80FDE395, 0x72966096, 0xA65C047D, 0x5437877E,
+        0x4767748A, 0xB50CF789, 0xEB1FCBAD, 0x197448AE, 0x0A24BB5A, 0xF84F3859,
+        0x2C855CB2, 0xDEEEDFB1, 0xCDBE2C45, 0x3FD5AF46, 0x7198540D, 0x83F3D70E,
+        0x90A324FA, 0x62C8A7F9, 0xB602C312, 0x44694011, 0x5739B3E5, 0xA55230E6,
+        0xFB410CC2, 0x092A8FC1, 0x1A7A7C35, 0xE811FF36, 0x3CDB9BDD, 0xCEB018DE,
+        0xDDE0EB2A, 0x2F8B6829, 0x82F63B78, 0x709DB87B, 0x63CD4B8F, 0x91A6C88C,
+        0x456CAC67, 0xB7072F64, 0xA457DC90, 0x563C5F93, 0x082F63B7, 0xFA44E0B4,
+        0xE9141340, 0x1B7F9043, 0xCFB5F4A8, 0x3DDE77AB, 0x2E8E845F, 0xDCE5075C,
+        0x92A8FC17, 0x60C37F14, 0x73938CE0, 0x81F80FE3, 0x55326B08, 0xA759E80B,
+        0xB4091BFF, 0x466298FC, 0x1871A4D8, 0xEA1A27DB, 0xF94AD42F, 0x0B21572C,
+        0xDFEB33C7, 0x2D80B0C4, 0x3ED04330, 0xCCBBC033, 0xA24BB5A6, 0x502036A5,
+        0x4370C551, 0xB11B4652, 0x65D122B9, 0x97BAA1BA, 0x84EA524E, 0x7681D14D,
+        0x2892ED69, 0xDAF96E6A, 0xC9A99D9E, 0x3BC21E9D, 0xEF087A76, 0x1D63F975,
+        0x0E330A81, 0xFC588982, 0xB21572C9, 0x407EF1CA, 0x532E023E, 0xA145813D,
+        0x758FE5D6, 0x87E466D5, 0x94B49521, 0x66DF1622, 0x38CC2A06, 0xCAA7A905,
+        0xD9F75AF1, 0x2B9CD9F2, 0xFF56BD19, 0x0D3D3E1A, 0x1E6DCDEE, 0xEC064EED,
+        0xC38D26C4, 0x31E6A5C7, 0x22B65633, 0xD0DDD530, 0x0417B1DB, 0xF67C32D8,
+        0xE52CC12C, 0x1747422F, 0x49547E0B, 0xBB3FFD08, 0xA86F0EFC, 0x5A048DFF,
+        0x8ECEE914, 0x7CA56A17, 0x6FF599E3, 0x9D9E1AE0, 0xD3D3E1AB, 0x21B862A8,
+        0x32E8915C, 0xC083125F, 0x144976B4, 0xE622F5B7, 0xF5720643, 0x07198540,
+        0x590AB964, 0xAB613A67, 0xB831C993, 0x4A5A4A90, 0x9E902E7B, 0x6CFBAD78,
+        0x7FAB5E8C, 0x8DC0DD8F, 0xE330A81A, 0x115B2B19, 0x020BD8ED, 0xF0605BEE,
+        0x24AA3F05, 0xD6C1BC06, 0xC5914FF2, 0x37FACCF1, 0x69E9F0D5, 0x9B8273D6,
+        0x88D28022, 0x7AB90321, 0xAE7367CA, 0x5C18E4C9, 0x4F48173D, 0xBD23943E,
+        0xF36E6F75, 0x0105EC76, 0x12551F82, 0xE03E9C81, 0x34F4F86A, 0xC69F7B69,
+        0xD5CF889D, 0x27A40B9E, 0x79B737BA, 0x8BDCB4B9, 0x988C474D, 0x6AE7C44E,
+        0xBE2DA0A5, 0x4C4623A6, 0x5F16D052, 0xAD7D5351,
+    },
+    {
+        0x00000000, 0x13A29877, 0x274530EE, 0x34E7A899, 0x4E8A61DC, 0x5D28F9AB,
+        0x69CF5132, 0x7A6DC945, 0x9D14C3B8, 0x8EB65BCF, 0xBA51F356, 0xA9F36B21,
+        0xD39EA264, 0xC03C3A13, 0xF4DB928A, 0xE7790AFD, 0x3FC5F181, 0x2C6769F6,
+        0x1880C16F, 0x0B225918, 0x714F905D, 0x62ED082A, 0x560AA0B3, 0x45A838C4,
+        0xA2D13239, 0xB173AA4E, 0x859402D7, 0x96369AA0, 0xEC5B53E5, 0xFFF9CB92,
+        0xCB1E630B, 0xD8BCFB7C, 0x7F8BE302, 0x6C297B75, 0x58CED3EC, 0x4B6C4B9B,
+        0x310182DE, 0x22A31AA9, 0x1644B230, 0x05E62A47, 0xE29F20BA, 0xF13DB8CD,
+        0xC5DA1054, 0xD6788823, 0xAC154166, 0xBFB7D911, 0x8B507188, 0x98F2E9FF,
+        0x404E1283, 0x53EC8AF4, 0x670B226D, 0x74A9BA1A, 0x0EC4735F, 0x1D66EB28,
+        0x298143B1, 0x3A23DBC6, 0xDD5AD13B, 0xCEF8494C, 0xFA1FE1D5, 0xE9BD79A2,
+        0x93D0B0E7, 0x80722890, 0xB4958009, 0xA737187E, 0xFF17C604, 0xECB55E73,
+        0xD852F6EA, 0xCBF06E9D, 0xB19DA7D8, 0xA23F3FAF, 0x96D89736, 0x857A0F41,
+        0x620305BC, 0x71A19DCB, 0x45463552, 0x56E4AD25, 0x2C896460, 0x3F2BFC17,
+        0x0BCC548E, 0x186ECCF9, 0xC0D23785, 0xD370AFF2, 0xE797076B, 0xF4359F1C,
+        0x8E585659, 0x9DFACE2E, 0xA91D66B7, 0xBABFFEC0, 0x5DC6F43D, 0x4E646C4A,
+        0x7A83C4D3, 0x69215CA4, 0x134C95E1, 0x00EE0D96, 0x3409A50F, 0x27AB3D78,
+        0x809C2506, 0x933EBD71, 0xA7D915E8, 0xB47B8D9F, 0xCE1644DA, 0xDDB4DCAD,
+        0xE9537434, 0xFAF1EC43, 0x1D88E6BE, 0x0E2A7EC9, 0x3ACDD650, 0x296F4E27,
+        0x53028762, 0x40A01F15, 0x7447B78C, 0x67E52FFB, 0xBF59D487, 0xACFB4CF0,
+        0x981CE469, 0x8BBE7C1E, 0xF1D3B55B, 0xE2712D2C, 0xD69685B5, 0xC5341DC2,
+        0x224D173F, 0x31EF8F48, 0x050827D1, 0x16AABFA6, 0x6CC776E3, 0x7F65EE94,
+        0x4B82460D, 0x5820DE7A, 0xFBC3FAF9, 0xE861628E, 0xDC86CA17, 0xCF245260,
+        0xB5499B25, 0xA6EB0352, 0x920CABCB, 0x81AE33BC, 0x66D73941, 0x7575A136,
+        0x419209AF, 0x523091D8, 0x285D589D, 0x3BFFC0EA, 0x0F186873, 0x1CBAF004,
+        0xC4060B78, 0xD7A4930F, 0xE3433B96, 0xF0E1A3E1, 0x8A8C6AA4, 0x992EF2D3,
+        0xADC95A4A, 0xBE6BC23D, 0x5912C8C0, 0x4AB050B7, 0x7E57F82E, 0x6DF56059,
+        0x1798A91C, 0x043A316B, 0x30DD99F2, 0x237F0185, 0x844819FB, 0x97EA818C,
+        0xA30D2915, 0xB0AFB162, 0xCAC27827, 0xD960E050, 0xED8748C9, 0xFE25D0BE,
+        0x195CDA43, 0x0AFE4234, 0x3E19EAAD, 0x2DBB72DA, 0x57D6BB9F, 0x447423E8,
+        0x70938B71, 0x63311306, 0xBB8DE87A, 0xA82F700D, 0x9CC8D894, 0x8F6A40E3,
+        0xF50789A6, 0xE6A511D1, 0xD242B948, 0xC1E0213F, 0x26992BC2, 0x353BB3B5,
+        0x01DC1B2C, 0x127E835B, 0x68134A1E, 0x7BB1D269, 0x4F567AF0, 0x5CF4E287,
+        0x04D43CFD, 0x1776A48A, 0x23910C13, 0x30339464, 0x4A5E5D21, 0x59FCC556,
+        0x6D1B6DCF, 0x7EB9F5B8, 0x99C0FF45, 0x8A626732, 0xBE85CFAB, 0xAD2757DC,
+        0xD74A9E99, 0xC4E806EE, 0xF00FAE77, 0xE3AD3600, 0x3B11CD7C, 0x28B3550B,
+        0x1C54FD92, 0x0FF665E5, 0x759BACA0, 0x663934D7, 0x52DE9C4E, 0x417C0439,
+        0xA6050EC4, 0xB5A796B3, 0x81403E2A, 0x92E2A65D, 0xE88F6F18, 0xFB2DF76F,
+        0xCFCA5FF6, 0xDC68C781, 0x7B5FDFFF, 0x68FD4788, 0x5C1AEF11, 0x4FB87766,
+        0x35D5BE23, 0x26772654, 0x12908ECD, 0x013216BA, 0xE64B1C47, 0xF5E98430,
+        0xC10E2CA9, 0xD2ACB4DE, 0xA8C17D9B, 0xBB63E5EC, 0x8F844D75, 0x9C26D502,
+        0x449A2E7E, 0x5738B609, 0x63DF1E90, 0x707D86E7, 0x0A104FA2, 0x19B2D7D5,
+        0x2D557F4C, 0x3EF7E73B, 0xD98EEDC6, 0xCA2C75B1, 0xFECBDD28, 0xED69455F,
+        0x97048C1A, 0x84A6146D, 0xB041BCF4, 0xA3E32483,
+    },
+    {
+        0x00000000, 0xA541927E, 0x4F6F520D, 0xEA2EC073, 0x9EDEA41A, 0x3B9F3664,
+        0xD1B1F617, 0x74F06469, 0x38513EC5, 0x9D10ACBB, 0x773E6CC8, 0xD27FFEB6,
+        0xA68F9ADF, 0x03CE08A1, 0xE9E0C8D2, 0x4CA15AAC, 0x70A27D8A, 0xD5E3EFF4,
+        0x3FCD2F87, 0x9A8CBDF9, 0xEE7CD990, 0x4B3D4BEE, 0xA1138B9D, 0x045219E3,
+        0x48F3434F, 0xEDB2D131, 0x079C1142, 0xA2DD833C, 0xD62DE755, 0x736C752B,
+        0x9942B558, 0x3C032726, 0xE144FB14, 0x4405696A, 0xAE2BA919, 0x0B6A3B67,
+        0x7F9A5F0E, 0xDADBCD70, 0x30F50D03, 0x95B49F7D, 0xD915C5D1, 0x7C5457AF,
+        0x967A97DC, 0x333B05A2, 0x47CB61CB, 0xE28AF3B5, 0x08A433C6, 0xADE5A1B8,
+        0x91E6869E, 0x34A714E0, 0xDE89D493, 0x7BC846ED, 0x0F382284, 0xAA79B0FA,
+        0x40577089, 0xE516E2F7, 0xA9B7B85B, 0x0CF62A25, 0xE6D8EA56, 0x43997828,
+        0x37691C41, 0x92288E3F, 0x78064E4C, 0xDD47DC32, 0xC76580D9, 0x622412A7,
+        0x880AD2D4, 0x2D4B40AA, 0x59BB24C3, 0xFCFAB6BD, 0x16D476CE, 0xB395E4B0,
+        0xFF34BE1C, 0x5A752C62, 0xB05BEC11, 0x151A7E6F, 0x61EA1A06, 0xC4AB8878,
+        0x2E85480B, 0x8BC4DA75, 0xB7C7FD53, 0x12866F2D, 0xF8A8AF5E, 0x5DE93D20,
+        0x29195949, 0x8C58CB37, 0x66760B44, 0xC337993A, 0x8F96C396, 0x2AD751E8,
+        0xC0F9919B, 0x65B803E5, 0x1148678C, 0xB409F5F2, 0x5E273581, 0xFB66A7FF,
+        0x26217BCD, 0x8360E9B3, 0x694E29C0, 0xCC0FBBBE, 0xB8FFDFD7, 0x1DBE4DA9,
+        0xF7908DDA, 0x52D11FA4, 0x1E704508, 0xBB31D776, 0x511F1705, 0xF45E857B,
+        0x80AEE112, 0x25EF736C, 0xCFC1B31F, 0x6A802161, 0x56830647, 0xF3C29439,
+        0x19EC544A, 0xBCADC634, 0xC85DA25D, 0x6D1C3023, 0x8732F050, 0x2273622E,
+        0x6ED23882, 0xCB93AAFC, 0x21BD6A8F, 0x84FCF8F1, 0xF00C9C98, 0x554D0EE6,
+        0xBF63CE95, 0x1A225CEB, 0x8B277743, 0x2E66E53D, 0xC448254E, 0x6109B730,
+        0x15F9D359, 0xB0B84127, 0x5A968154, 0xFFD7132A, 0xB3764986, 0x1637DBF8,
+        0xFC191B8B, 0x595889F5, 0x2DA8ED9C, 0x88E97FE2, 0x62C7BF91, 0xC7862DEF,
+        0xFB850AC9, 0x5EC498B7, 0xB4EA58C4, 0x11ABCABA, 0x655BAED3, 0xC01A3CAD,
+        0x2A34FCDE, 0x8F756EA0, 0xC3D4340C, 0x6695A672, 0x8CBB6601, 0x29FAF47F,
+        0x5D0A9016, 0xF84B0268, 0x1265C21B, 0xB7245065, 0x6A638C57, 0xCF221E29,
+        0x250CDE5A, 0x804D4C24, 0xF4BD284D, 0x51FCBA33, 0xBBD27A40, 0x1E93E83E,
+        0x5232B292, 0xF77320EC, 0x1D5DE09F, 0xB81C72E1, 0xCCEC1688, 0x69AD84F6,
+        0x83834485, 0x26C2D6FB, 0x1AC1F1DD, 0xBF8063A3, 0x55AEA3D0, 0xF0EF31AE,
+        0x841F55C7, 0x215EC7B9, 0xCB7007CA, 0x6E3195B4, 0x2290CF18, 0x87D15D66,
+        0x6DFF9D15, 0xC8BE0F6B, 0xBC4E6B02, 0x190FF97C, 0xF321390F, 0x5660AB71,
+        0x4C42F79A, 0xE90365E4, 0x032DA597, 0xA66C37E9, 0xD29C5380, 0x77DDC1FE,
+        0x9DF3018D, 0x38B293F3, 0x7413C95F, 0xD1525B21, 0x3B7C9B52, 0x9E3D092C,
+        0xEACD6D45, 0x4F8CFF3B, 0xA5A23F48, 0x00E3AD36, 0x3CE08A10, 0x99A1186E,
+        0x738FD81D, 0xD6CE4A63, 0xA23E2E0A, 0x077FBC74, 0xED517C07, 0x4810EE79,
+        0x04B1B4D5, 0xA1F026AB, 0x4BDEE6D8, 0xEE9F74A6, 0x9A6F10CF, 0x3F2E82B1,
+        0xD50042C2, 0x7041D0BC, 0xAD060C8E, 0x08479EF0, 0xE2695E83, 0x4728CCFD,
+        0x33D8A894, 0x96993AEA, 0x7CB7FA99, 0xD9F668E7, 0x9557324B, 0x3016A035,
+        0xDA386046, 0x7F79F238, 0x0B899651, 0xAEC8042F, 0x44E6C45C, 0xE1A75622,
+        0xDDA47104, 0x78E5E37A, 0x92CB2309, 0x378AB177, 0x437AD51E, 0xE63B4760,
+        0x0C158713, 0xA954156D, 0xE5F54FC1, 0x40B4DDBF, 0xAA9A1DCC, 0x0FDB8FB2,
+        0x7B2BEBDB, 0xDE6A79A5, 0x3444B9D6, 0x91052BA8,
+    },
+    {
+        0x00000000, 0xDD45AAB8, 0xBF672381, 0x62228939, 0x7B2231F3, 0xA6679B4B,
+        0xC4451272, 0x1900B8CA, 0xF64463E6, 0x2B01C95E, 0x49234067, 0x9466EADF,
+        0x8D665215, 0x5023F8AD, 0x32017194, 0xEF44DB2C, 0xE964B13D, 0x34211B85,
+        0x560392BC, 0x8B463804, 0x924680CE, 0x4F032A76, 0x2D21A34F, 0xF06409F7,
+        0x1F20D2DB, 0xC2657863, 0xA047F15A, 0x7D025BE2, 0x6402E328, 0xB9474990,
+        0xDB65C0A9, 0x06206A11, 0xD725148B, 0x0A60BE33, 0x6842370A, 0xB5079DB2,
+        0xAC072578, 0x71428FC0, 0x136006F9, 0xCE25AC41, 0x2161776D, 0xFC24DDD5,
+        0x9E0654EC, 0x4343FE54, 0x5A43469E, 0x8706EC26, 0xE524651F, 0x3861CFA7,
+        0x3E41A5B6, 0xE3040F0E, 0x81268637, 0x5C632C8F, 0x45639445, 0x98263EFD,
+        0xFA04B7C4, 0x27411D7C, 0xC805C650, 0x15406CE8, 0x7762E5D1, 0xAA274F69,
+        0xB327F7A3, 0x6E625D1B, 0x0C40D422, 0xD1057E9A, 0xABA65FE7, 0x76E3F55F,
+        0x14C17C66, 0xC984D6DE, 0xD0846E14, 0x0DC1C4AC, 0x6FE34D95, 0xB2A6E72D,
+        0x5DE23C01, 0x80A796B9, 0xE2851F80, 0x3FC0B538, 0x26C00DF2, 0xFB85A74A,
+        0x99A72E73, 0x44E284CB, 0x42C2EEDA, 0x9F874462, 0xFDA5CD5B, 0x20E067E3,
+        0x39E0DF29, 0xE4A57591, 0x8687FCA8, 0x5BC25610, 0xB4868D3C, 0x69C32784,
+        0x0BE1AEBD, 0xD6A40405, 0xCFA4BCCF, 0x12E11677, 0x70C39F4E, 0xAD8635F6,
+        0x7C834B6C, 0xA1C6E1D4, 0xC3E468ED, 0x1EA1C255, 0x07A17A9F, 0xDAE4D027,
+        0xB8C6591E, 0x6583F3A6, 0x8AC7288A, 0x57828232, 0x35A00B0B, 0xE8E5A1B3,
+        0xF1E51979, 0x2CA0B3C1, 0x4E823AF8, 0x93C79040, 0x95E7FA51, 0x48A250E9,
+        0x2A80D9D0, 0xF7C57368, 0xEEC5CBA2, 0x3380611A, 0x51A2E823, 0x8CE7429B,
+        0x63A399B7, 0xBEE6330F, 0xDCC4BA36, 0x0181108E, 0x1881A844, 0xC5C402FC,
+        0xA7E68BC5, 0x7AA3217D, 0x52A0C93F, 0x8FE56387, 0xEDC7EABE, 0x30824006,
+        0x2982F8CC, 0xF4C75274, 0x96E5DB4D, 0x4BA071F5, 0xA4E4AAD9, 0x79A10061,
+        0x1B838958, 0xC6C623E0, 0xDFC69B2A, 0x02833192, 0x60A1B8AB, 0xBDE41213,
+        0xBBC47802, 0x6681D2BA, 0x04A35B83, 0xD9E6F13B, 0xC0E649F1, 0x1DA3E349,
+        0x7F816A70, 0xA2C4C0C8, 0x4D801BE4, 0x90C5B15C, 0xF2E73865, 0x2FA292DD,
+        0x36A22A17, 0xEBE780AF, 0x89C50996, 0x5480A32E, 0x8585DDB4, 0x58C0770C,
+        0x3AE2FE35, 0xE7A7548D, 0xFEA7EC47, 0x23E246FF, 0x41C0CFC6, 0x9C85657E,
+        0x73C1BE52, 0xAE8414EA, 0xCCA69DD3, 0x11E3376B, 0x08E38FA1, 0xD5A62519,
+        0xB784AC20, 0x6AC10698, 0x6CE16C89, 0xB1A4C631, 0xD3864F08, 0x0EC3E5B0,
+        0x17C35D7A, 0xCA86F7C2, 0xA8A47EFB, 0x75E1D443, 0x9AA50F6F, 0x47E0A5D7,
+        0x25C22CEE, 0xF8878656, 0xE1873E9C, 0x3CC29424, 0x5EE01D1D, 0x83A5B7A5,
+        0xF90696D8, 0x24433C60, 0x4661B559, 0x9B241FE1, 0x8224A72B, 0x5F610D93,
+        0x3D4384AA, 0xE0062E12, 0x0F42F53E, 0xD2075F86, 0xB025D6BF, 0x6D607C07,
+        0x7460C4CD, 0xA9256E75, 0xCB07E74C, 0x16424DF4, 0x106227E5, 0xCD278D5D,
+        0xAF050464, 0x7240AEDC, 0x6B401616, 0xB605BCAE, 0xD4273597, 0x09629F2F,
+        0xE6264403, 0x3B63EEBB, 0x59416782, 0x8404CD3A, 0x9D0475F0, 0x4041DF48,
+        0x22635671, 0xFF26FCC9, 0x2E238253, 0xF36628EB, 0x9144A1D2, 0x4C010B6A,
+        0x5501B3A0, 0x88441918, 0xEA669021, 0x37233A99, 0xD867E1B5, 0x05224B0D,
+        0x6700C234, 0xBA45688C, 0xA345D046, 0x7E007AFE, 0x1C22F3C7, 0xC167597F,
+        0xC747336E, 0x1A0299D6, 0x782010EF, 0xA565BA57, 0xBC65029D, 0x6120A825,
+        0x0302211C, 0xDE478BA4, 0x31035088, 0xEC46FA30, 0x8E647309, 0x5321D9B1,
+        0x4A21617B, 0x9764CBC3, 0xF54642FA, 0x2803E842,
+    },
+    {
+        0x00000000, 0x38116FAC, 0x7022DF58, 0x4833B0F4, 0xE045BEB0, 0xD854D11C,
+        0x906761E8, 0xA8760E44, 0xC5670B91, 0xFD76643D, 0xB545D4C9, 0x8D54BB65,
+        0x2522B521, 0x1D33DA8D, 0x55006A79, 0x6D1105D5, 0x8F2261D3, 0xB7330E7F,
+        0xFF00BE8B, 0xC711D127, 0x6F67DF63, 0x5776B0CF, 0x1F45003B, 0x27546F97,
+        0x4A456A42, 0x725405EE, 0x3A67B51A, 0x0276DAB6, 0xAA00D4F2, 0x9211BB5E,
+        0xDA220BAA, 0xE2336406, 0x1BA8B557, 0x23B9DAFB, 0x6B8A6A0F, 0x539B05A3,
+        0xFBED0BE7, 0xC3FC644B, 0x8BCFD4BF, 0xB3DEBB13, 0xDECFBEC6, 0xE6DED16A,
+        0xAEED619E, 0x96FC0E32, 0x3E8A0076, 0x069B6FDA, 0x4EA8DF2E, 0x76B9B082,
+        0x948AD484, 0xAC9BBB28, 0xE4A80BDC, 0xDCB96470, 0x74CF6A34, 0x4CDE0598,
+        0x04EDB56C, 0x3CFCDAC0, 0x51EDDF15, 0x69FCB0B9, 0x21CF004D, 0x19DE6FE1,
+        0xB1A861A5, 0x89B90E09, 0xC18ABEFD, 0xF99BD151, 0x37516AAE, 0x0F400502,
+        0x4773B5F6, 0x7F62DA5A, 0xD714D41E, 0xEF05BBB2, 0xA7360B46, 0x9F2764EA,
+        0xF236613F, 0xCA270E93, 0x8214BE67, 0xBA05D1CB, 0x1273DF8F, 0x2A62B023,
+        0x625100D7, 0x5A406F7B, 0xB8730B7D, 0x806264D1, 0xC851D425, 0xF040BB89,
+        0x5836B5CD, 0x6027DA61, 0x28146A95, 0x10050539, 0x7D1400EC, 0x45056F40,
+        0x0D36DFB4, 0x3527B018, 0x9D51BE5C, 0xA540D1F0, 0xED736104, 0xD5620EA8,
+        0x2CF9DFF9, 0x14E8B055, 0x5CDB00A1, 0x64CA6F0D, 0xCCBC6149, 0xF4AD0EE5,
+        0xBC9EBE11, 0x848FD1BD, 0xE99ED468, 0xD18FBBC4, 0x99BC0B30, 0xA1AD649C,
+        0x09DB6AD8, 0x31CA0574, 0x79F9B580, 0x41E8DA2C, 0xA3DBBE2A, 0x9BCAD186,
+        0xD3F96172, 0xEBE80EDE, 0x439E009A, 0x7B8F6F36, 0x33BCDFC2, 0x0BADB06E,
+        0x66BCB5BB, 0x5EADDA17, 0x169E6AE3, 0x2E8F054F, 0x86F90B0B, 0xBEE864A7,
+        0xF6DBD453, 0xCECABBFF, 0x6EA2D55C, 0x56B3BAF0, 0x1E800A04, 0x269165A8,
+        0x8EE76BEC, 0xB6F60440, 0xFEC5B4B4, 0xC6D4DB18, 0xABC5DECD, 0x93D4B161,
+        0xDBE70195, 0xE3F66E39, 0x4B80607D, 0x73910FD1, 0x3BA2BF25, 0x03B3D089,
+        0xE180B48F, 0xD991DB23, 0x91A26BD7, 0xA9B3047B, 0x01C50A3F, 0x39D46593,
+        0x71E7D567, 0x49F6BACB, 0x24E7BF1E, 0x1CF6D0B2, 0x54C56046, 0x6CD40FEA,
+        0xC4A201AE, 0xFCB36E02, 0xB480DEF6, 0x8C91B15A, 0x750A600B, 0x4D1B0FA7,
+        0x0528BF53, 0x3D39D0FF, 0x954FDEBB, 0xAD5EB117, 0xE56D01E3, 0xDD7C6E4F,
+        0xB06D6B9A, 0x887C0436, 0xC04FB4C2, 0xF85EDB6E, 0x5028D52A, 0x6839BA86,
+        0x200A0A72, 0x181B65DE, 0xFA2801D8, 0xC2396E74, 0x8A0ADE80, 0xB21BB12C,
+        0x1A6DBF68, 0x227CD0C4, 0x6A4F6030, 0x525E0F9C, 0x3F4F0A49, 0x075E65E5,
+        0x4F6DD511, 0x777CBABD, 0xDF0AB4F9, 0xE71BDB55, 0xAF286BA1, 0x9739040D,
+        0x59F3BFF2, 0x61E2D05E, 0x29D160AA, 0x11C00F06, 0xB9B60142, 0x81A76EEE,
+        0xC994DE1A, 0xF185B1B6, 0x9C94B463, 0xA485DBCF, 0xECB66B3B, 0xD4A70497,
+        0x7CD10AD3, 0x44C0657F, 0x0CF3D58B, 0x34E2BA27, 0xD6D1DE21, 0xEEC0B18D,
+        0xA6F30179, 0x9EE26ED5, 0x36946091, 0x0E850F3D, 0x46B6BFC9, 0x7EA7D065,
+        0x13B6D5B0, 0x2BA7BA1C, 0x63940AE8, 0x5B856544, 0xF3F36B00, 0xCBE204AC,
+        0x83D1B458, 0xBBC0DBF4, 0x425B0AA5, 0x7A4A6509, 0x3279D5FD, 0x0A68BA51,
+        0xA21EB415, 0x9A0FDBB9, 0xD23C6B4D, 0xEA2D04E1, 0x873C0134, 0xBF2D6E98,
+        0xF71EDE6C, 0xCF0FB1C0, 0x6779BF84, 0x5F68D028, 0x175B60DC, 0x2F4A0F70,
+        0xCD796B76, 0xF56804DA, 0xBD5BB42E, 0x854ADB82, 0x2D3CD5C6, 0x152DBA6A,
+        0x5D1E0A9E, 0x650F6532, 0x081E60E7, 0x300F0F4B, 0x783CBFBF, 0x402DD013,
+        0xE85BDE57, 0xD04AB1FB, 0x9879010F, 0xA0686EA3,
+    },
+    {
+        0x00000000, 0xEF306B19, 0xDB8CA0C3, 0x34BCCBDA, 0xB2F53777, 0x5DC55C6E,
+        0x697997B4, 0x8649FCAD, 0x6006181F, 0x8F367306, 0xBB8AB8DC, 0x54BAD3C5,
+        0xD2F32F68, 0x3DC34471, 0x097F8FAB, 0xE64FE4B2, 0xC00C303E, 0x2F3C5B27,
+        0x1B8090FD, 0xF4B0FBE4, 0x72F90749, 0x9DC96C50, 0xA975A78A, 0x4645CC93,
+        0xA00A2821, 0x4F3A4338, 0x7B8688E2, 0x94B6E3FB, 0x12FF1F56, 0xFDCF744F,
+        0xC973BF95, 0x2643D48C, 0x85F4168D, 0x6AC47D94, 0x5E78B64E, 0xB148DD57,
+        0x370121FA, 0xD8314AE3, 0xEC8D8139, 0x03BDEA20, 0xE5F20E92, 0x0AC2658B,
+        0x3E7EAE51, 0xD14EC548, 0x570739E5, 0xB83752FC, 0x8C8B9926, 0x63BBF23F,
+        0x45F826B3, 0xAAC84DAA, 0x9E748670, 0x7144ED69, 0xF70D11C4, 0x183D7ADD,
+        0x2C81B107, 0xC3B1DA1E, 0x25FE3EAC, 0xCACE55B5, 0xFE729E6F, 0x1142F576,
+        0x970B09DB, 0x783B62C2, 0x4C87A918, 0xA3B7C201, 0x0E045BEB, 0xE13430F2,
+        0xD588FB28, 0x3AB89031, 0xBCF16C9C, 0x53C10785, 0x677DCC5F, 0x884DA746,
+        0x6E0243F4, 0x813228ED, 0xB58EE337, 0x5ABE882E, 0xDCF77483, 0x33C71F9A,
+        0x077BD440, 0xE84BBF59, 0xCE086BD5, 0x213800CC, 0x1584CB16, 0xFAB4A00F,
+        0x7CFD5CA2, 0x93CD37BB, 0xA771FC61, 0x48419778, 0xAE0E73CA, 0x413E18D3,
+        0x7582D309, 0x9AB2B810, 0x1CFB44BD, 0xF3CB2FA4, 0xC777E47E, 0x28478F67,
+        0x8BF04D66, 0x64C0267F, 0x507CEDA5, 0xBF4C86BC, 0x39057A11, 0xD6351108,
+        0xE289DAD2, 0x0DB9B1CB, 0xEBF65579, 0x04C63E60, 0x307AF5BA, 0xDF4A9EA3,
+        0x5903620E, 0xB6330917, 0x828FC2CD, 0x6DBFA9D4, 0x4BFC7D58, 0xA4CC1641,
+        0x9070DD9B, 0x7F40B682, 0xF9094A2F, 0x16392136, 0x2285EAEC, 0xCDB581F5,
+        0x2BFA6547, 0xC4CA0E5E, 0xF076C584, 0x1F46AE9D, 0x990F5230, 0x763F3929,
+        0x4283F2F3, 0xADB399EA, 0x1C08B7D6, 0xF338DCCF, 0xC7841715, 0x28B47C0C,
+        0xAEFD80A1, 0x41CDEBB8, 0x75712062, 0x9A414B7B, 0x7C0EAFC9, 0x933EC4D0,
+        0xA7820F0A, 0x48B26413, 0xCEFB98BE, 0x21CBF3A7, 0x1577387D, 0xFA475364,
+        0xDC0487E8, 0x3334ECF1, 0x0788272B, 0xE8B84C32, 0x6EF1B09F, 0x81C1DB86,
+        0xB57D105C, 0x5A4D7B45, 0xBC029FF7, 0x5332F4EE, 0x678E3F34, 0x88BE542D,
+        0x0EF7A880, 0xE1C7C399, 0xD57B0843, 0x3A4B635A, 0x99FCA15B, 0x76CCCA42,
+        0x42700198, 0xAD406A81, 0x2B09962C, 0xC439FD35, 0xF08536EF, 0x1FB55DF6,
+        0xF9FAB944, 0x16CAD25D, 0x22761987, 0xCD46729E, 0x4B0F8E33, 0xA43FE52A,
+        0x90832EF0, 0x7FB345E9, 0x59F09165, 0xB6C0FA7C, 0x827C31A6, 0x6D4C5ABF,
+        0xEB05A612, 0x0435CD0B, 0x308906D1, 0xDFB96DC8, 0x39F6897A, 0xD6C6E263,
+        0xE27A29B9, 0x0D4A42A0, 0x8B03BE0D, 0x6433D514, 0x508F1ECE, 0xBFBF75D7,
+        0x120CEC3D, 0xFD3C8724, 0xC9804CFE, 0x26B027E7, 0xA0F9DB4A, 0x4FC9B053,
+        0x7B757B89, 0x94451090, 0x720AF422, 0x9D3A9F3B, 0xA98654E1, 0x46B63FF8,
+        0xC0FFC355, 0x2FCFA84C, 0x1B736396, 0xF443088F, 0xD200DC03, 0x3D30B71A,
+        0x098C7CC0, 0xE6BC17D9, 0x60F5EB74, 0x8FC5806D, 0xBB794BB7, 0x544920AE,
+        0xB206C41C, 0x5D36AF05, 0x698A64DF, 0x86BA0FC6, 0x00F3F36B, 0xEFC39872,
+        0xDB7F53A8, 0x344F38B1, 0x97F8FAB0, 0x78C891A9, 0x4C745A73, 0xA344316A,
+        0x250DCDC7, 0xCA3DA6DE, 0xFE816D04, 0x11B1061D, 0xF7FEE2AF, 0x18CE89B6,
+        0x2C72426C, 0xC3422975, 0x450BD5D8, 0xAA3BBEC1, 0x9E87751B, 0x71B71E02,
+        0x57F4CA8E, 0xB8C4A197, 0x8C786A4D, 0x63480154, 0xE501FDF9, 0x0A3196E0,
+        0x3E8D5D3A, 0xD1BD3623, 0x37F2D291, 0xD8C2B988, 0xEC7E7252, 0x034E194B,
+        0x8507E5E6, 0x6A378EFF, 0x5E8B4525, 0xB1BB2E3C,
+    },
+    {
+        0x00000000, 0x68032CC8, 0xD0065990, 0xB8057558, 0xA5E0C5D1, 0xCDE3E919,
+        0x75E69C41, 0x1DE5B089, 0x4E2DFD53, 0x262ED19B, 0x9E2BA4C3, 0xF628880B,
+        0xEBCD3882, 0x83CE144A, 0x3BCB6112, 0x53C84DDA, 0x9C5BFAA6, 0xF458D66E,
+        0x4C5DA336, 0x245E8FFE, 0x39BB3F77, 0x51B813BF, 0xE9BD66E7, 0x81BE4A2F,
+        0xD27607F5, 0xBA752B3D, 0x02705E65, 0x6A7372AD, 0x7796C224, 0x1F95EEEC,
+        0xA7909BB4, 0xCF93B77C, 0x3D5B83BD, 0x5558AF75, 0xED5DDA2D, 0x855EF6E5,
+        0x98BB466C, 0xF0B86AA4, 0x48BD1FFC, 0x20BE3334, 0x73767EEE, 0x1B755226,
+        0xA370277E, 0xCB730BB6, 0xD696BB3F, 0xBE9597F7, 0x0690E2AF, 0x6E93CE67,
+        0xA100791B, 0xC90355D3, 0x7106208B, 0x19050C43, 0x04E0BCCA, 0x6CE39002,
+        0xD4E6E55A, 0xBCE5C992, 0xEF2D8448, 0x872EA880, 0x3F2BDDD8, 0x5728F110,
+        0x4ACD4199, 0x22CE6D51, 0x9ACB1809, 0xF2C834C1, 0x7AB7077A, 0x12B42BB2,
+        0xAAB15EEA, 0xC2B27222, 0xDF57C2AB, 0xB754EE63, 0x0F519B3B, 0x6752B7F3,
+        0x349AFA29, 0x5C99D6E1, 0xE49CA3B9, 0x8C9F8F71, 0x917A3FF8, 0xF9791330,
+        0x417C6668, 0x297F4AA0, 0xE6ECFDDC, 0x8EEFD114, 0x36EAA44C, 0x5EE98884,
+        0x430C380D, 0x2B0F14C5, 0x930A619D, 0xFB094D55, 0xA8C1008F, 0xC0C22C47,
+        0x78C7591F, 0x10C475D7, 0x0D21C55E, 0x6522E996, 0xDD279CCE, 0xB524B006,
+        0x47EC84C7, 0x2FEFA80F, 0x97EADD57, 0xFFE9F19F, 0xE20C4116, 0x8A0F6DDE,
+        0x320A1886, 0x5A09344E, 0x09C17994, 0x61C2555C, 0xD9C72004, 0xB1C40CCC,
+        0xAC21BC45, 0xC422908D, 0x7C27E5D5, 0x1424C91D, 0xDBB77E61, 0xB3B452A9,
+        0x0BB127F1, 0x63B20B39, 0x7E57BBB0, 0x16549778, 0xAE51E220, 0xC652CEE8,
+        0x959A8332, 0xFD99AFFA, 0x459CDAA2, 0x2D9FF66A, 0x307A46E3, 0x58796A2B,
+        0xE07C1F73, 0x887F33BB, 0xF56E0EF4, 0x9D6D223C, 0x25685764, 0x4D6B7BAC,
+        0x508ECB25, 0x388DE7ED, 0x808892B5, 0xE88BBE7D, 0xBB43F3A7, 0xD340DF6F,
+        0x6B45AA37, 0x034686FF, 0x1EA33676, 0x76A01ABE, 0xCEA56FE6, 0xA6A6432E,
+        0x6935F452, 0x0136D89A, 0xB933ADC2, 0xD130810A, 0xCCD53183, 0xA4D61D4B,
+        0x1CD36813, 0x74D044DB, 0x27180901, 0x4F1B25C9, 0xF71E5091, 0x9F1D7C59,
+        0x82F8CCD0, 0xEAFBE018, 0x52FE9540, 0x3AFDB988, 0xC8358D49, 0xA036A181,
+        0x1833D4D9, 0x7030F811, 0x6DD54898, 0x05D66450, 0xBDD31108, 0xD5D03DC0,
+        0x8618701A, 0xEE1B5CD2, 0x561E298A, 0x3E1D0542, 0x23F8B5CB, 0x4BFB9903,
+        0xF3FEEC5B, 0x9BFDC093, 0x546E77EF, 0x3C6D5B27, 0x84682E7F, 0xEC6B02B7,
+        0xF18EB23E, 0x998D9EF6, 0x2188EBAE, 0x498BC766, 0x1A438ABC, 0x7240A674,
+        0xCA45D32C, 0xA246FFE4, 0xBFA34F6D, 0xD7A063A5, 0x6FA516FD, 0x07A63A35,
+        0x8FD9098E, 0xE7DA2546, 0x5FDF501E, 0x37DC7CD6, 0x2A39CC5F, 0x423AE097,
+        0xFA3F95CF, 0x923CB907, 0xC1F4F4DD, 0xA9F7D815, 0x11F2AD4D, 0x79F18185,
+        0x6414310C, 0x0C171DC4, 0xB412689C, 0xDC114454, 0x1382F328, 0x7B81DFE0,
+        0xC384AAB8, 0xAB878670, 0xB66236F9, 0xDE611A31, 0x66646F69, 0x0E6743A1,
+        0x5DAF0E7B, 0x35AC22B3, 0x8DA957EB, 0xE5AA7B23, 0xF84FCBAA, 0x904CE762,
+        0x2849923A, 0x404ABEF2, 0xB2828A33, 0xDA81A6FB, 0x6284D3A3, 0x0A87FF6B,
+        0x17624FE2, 0x7F61632A, 0xC7641672, 0xAF673ABA, 0xFCAF7760, 0x94AC5BA8,
+        0x2CA92EF0, 0x44AA0238, 0x594FB2B1, 0x314C9E79, 0x8949EB21, 0xE14AC7E9,
+        0x2ED97095, 0x46DA5C5D, 0xFEDF2905, 0x96DC05CD, 0x8B39B544, 0xE33A998C,
+        0x5B3FECD4, 0x333CC01C, 0x60F48DC6, 0x08F7A10E, 0xB0F2D456, 0xD8F1F89E,
+        0xC5144817, 0xAD1764DF, 0x15121187, 0x7D113D4F,
+    },
+    {
+        0x00000000, 0x493C7D27, 0x9278FA4E, 0xDB448769, 0x211D826D, 0x6821FF4A,
+        0xB3657823, 0xFA590504, 0x423B04DA, 0x0B0779FD, 0xD043FE94, 0x997F83B3,
+        0x632686B7, 0x2A1AFB90, 0xF15E7CF9, 0xB86201DE, 0x847609B4, 0xCD4A7493,
+        0x160EF3FA, 0x5F328EDD, 0xA56B8BD9, 0xEC57F6FE, 0x37137197, 0x7E2F0CB0,
+        0xC64D0D6E, 0x8F717049, 0x5435F720, 0x1D098A07, 0xE7508F03, 0xAE6CF224,
+        0x7528754D, 0x3C14086A, 0x0D006599, 0x443C18BE, 0x9F789FD7, 0xD644E2F0,
+        0x2C1DE7F4, 0x65219AD3, 0xBE651DBA, 0xF759609D, 0x4F3B6143, 0x06071C64,
+        0xDD439B0D, 0x947FE62A, 0x6E26E32E, 0x271A9E09, 0xFC5E1960, 0xB5626447,
+        0x89766C2D, 0xC04A110A, 0x1B0E9663, 0x5232EB44, 0xA86BEE40, 0xE1579367,
+        0x3A13140E, 0x732F6929, 0xCB4D68F7, 0x827115D0, 0x593592B9, 0x1009EF9E,
+        0xEA50EA9A, 0xA36C97BD, 0x782810D4, 0x31146DF3, 0x1A00CB32, 0x533CB615,
+        0x8878317C, 0xC1444C5B, 0x3B1D495F, 0x72213478, 0xA965B311, 0xE059CE36,
+        0x583BCFE8, 0x1107B2CF, 0xCA4335A6, 0x837F4881, 0x79264D85, 0x301A30A2,
+        0xEB5EB7CB, 0xA262CAEC, 0x9E76C286, 0xD74ABFA1, 0x0C0E38C8, 0x453245EF,
+        0xBF6B40EB, 0xF6573DCC, 0x2D13BAA5, 0x642FC782, 0xDC4DC65C, 0x9571BB7B,
+        0x4E353C12, 0x07094135, 0xFD504431, 0xB46C3916, 0x6F28BE7F, 0x2614C358,
+        0x1700AEAB, 0x5E3CD38C, 0x857854E5, 0xCC4429C2, 0x361D2CC6, 0x7F2151E1,
+        0xA465D688, 0xED59ABAF, 0x553BAA71, 0x1C07D756, 0xC743503F, 0x8E7F2D18,
+        0x7426281C, 0x3D1A553B, 0xE65ED252, 0xAF62AF75, 0x9376A71F, 0xDA4ADA38,
+        0x010E5D51, 0x48322076, 0xB26B2572, 0xFB575855, 0x2013DF3C, 0x692FA21B,
+        0xD14DA3C5, 0x9871DEE2, 0x4335598B, 0x0A0924AC, 0xF05021A8, 0xB96C5C8F,
+        0x6228DBE6, 0x2B14A6C1, 0x34019664, 0x7D3DEB43, 0xA6796C2A, 0xEF45110D,
+        0x151C1409, 0x5C20692E, 0x8764EE47, 0xCE589360, 0x763A92BE, 0x3F06EF99,
+        0xE44268F0, 0xAD7E15D7, 0x572710D3, 0x1E1B6DF4, 0xC55FEA9D, 0x8C6397BA,
+        0xB0779FD0, 0xF94BE2F7, 0x220F659E, 0x6B3318B9, 0x916A1DBD, 0xD856609A,
+        0x0312E7F3, 0x4A2E9AD4, 0xF24C9B0A, 0xBB70E62D, 0x60346144, 0x29081C63,
+        0xD3511967, 0x9A6D6440, 0x4129E329, 0x08159E0E, 0x3901F3FD, 0x703D8EDA,
+        0xAB7909B3, 0xE2457494, 0x181C7190, 0x51200CB7, 0x8A648BDE, 0xC358F6F9,
+        0x7B3AF727, 0x32068A00, 0xE9420D69, 0xA07E704E, 0x5A27754A, 0x131B086D,
+        0xC85F8F04, 0x8163F223, 0xBD77FA49, 0xF44B876E, 0x2F0F0007, 0x66337D20,
+        0x9C6A7824, 0xD5560503, 0x0E12826A, 0x472EFF4D, 0xFF4CFE93, 0xB67083B4,
+        0x6D3404DD, 0x240879FA, 0xDE517CFE, 0x976D01D9, 0x4C2986B0, 0x0515FB97,
+        0x2E015D56, 0x673D2071, 0xBC79A718, 0xF545DA3F, 0x0F1CDF3B, 0x4620A21C,
+        0x9D642575, 0xD4585852, 0x6C3A598C, 0x250624AB, 0xFE42A3C2, 0xB77EDEE5,
+        0x4D27DBE1, 0x041BA6C6, 0xDF5F21AF, 0x96635C88, 0xAA7754E2, 0xE34B29C5,
+        0x380FAEAC, 0x7133D38B, 0x8B6AD68F, 0xC256ABA8, 0x19122CC1, 0x502E51E6,
+        0xE84C5038, 0xA1702D1F, 0x7A34AA76, 0x3308D751, 0xC951D255, 0x806DAF72,
+        0x5B29281B, 0x1215553C, 0x230138CF, 0x6A3D45E8, 0xB179C281, 0xF845BFA6,
+        0x021CBAA2, 0x4B20C785, 0x906440EC, 0xD9583DCB, 0x613A3C15, 0x28064132,
+        0xF342C65B, 0xBA7EBB7C, 0x4027BE78, 0x091BC35F, 0xD25F4436, 0x9B633911,
+        0xA777317B, 0xEE4B4C5C, 0x350FCB35, 0x7C33B612, 0x866AB316, 0xCF56CE31,
+        0x14124958, 0x5D2E347F, 0xE54C35A1, 0xAC704886, 0x7734CFEF, 0x3E08B2C8,
+        0xC451B7CC, 0x8D6DCAEB, 0x56294D82, 0x1F1530A5,
+    },
+};
 
-    if (len < 3) {
-        return 0;
-    }
+// Little-endian load of 32 bits
+static inline uint crc32c_read32(const uchar *p) {
+    return (uint)p[0] | (uint)p[1] << 8 | (uint)p[2] << 16 | (uint)p[3] << 24;
+}
 
-    char integer_cstr[cstr_ullong_max_len];
-    char fractional_cstr[cstr_ullong_max_len];
-    struct cstr_from_real_parts parts = {0};
-    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
-    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
-    cstr_from_double_parts(&parts, src, decimals);
-    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+// The kernels work on the raw CRC register. The inversion before and after is
+// done by slice_crc32c.
+static uint crc32c_scalar(uint crc, const uchar *p, size_t len) {
+    for (; len >= 8; len -= 8, p += 8) {
+        uint lo = crc ^ crc32c_read32(p);
+        uint hi = crc32c_read32(p + 4);
+        crc = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF]
+            ^ crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24]
+            ^ crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF]
+            ^ crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+    }
+    for (; len > 0; len -= 1, p += 1) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p) & 0xFF];
+    }
+    return crc;
+}
 
-    if (bytes_to_write > len) {
-        return 0;
+#ifdef JP_SIMD_X86
+
+__attribute__((target("sse4.2"))) static uint
+crc32c_sse42(uint crc, const uchar *p, size_t len) {
+    ullong c = crc;
+    for (; len >= 8; len -= 8, p += 8) {
+        c = _mm_crc32_u64(c, bytes_load_ullong(p));
     }
+    for (; len > 0; len -= 1, p += 1) {
+        c = _mm_crc32_u8((uint)c, *p);
+    }
+    return (uint)c;
+}
 
-    cstr_from_real_parts_to_buf(&parts, dest);
-    return bytes_to_write;
+// Large buffers are split into three lanes that are checksummed in parallel to
+// hide the latency of the crc32 instruction. The lane CRCs are then combined
+// by shifting them over the following lanes: for the reflected polynomial,
+// crc32(0, clmul(crc, x^(8n - 33) mod P)) is the CRC register after n more
+// zero bytes.
+#define crc32c_long_lane 2048
+#define crc32c_long_shift1 0xA51B6135ULL // x^(8 * 2048 - 33) mod P
+#define crc32c_long_shift2 0x82F89C77ULL // x^(8 * 4096 - 33) mod P
+#define crc32c_short_lane 256
+#define crc32c_short_shift1 0xB9E02B86ULL // x^(8 * 256 - 33) mod P
+#define crc32c_short_shift2 0xDD7E3B0CULL // x^(8 * 512 - 33) mod P
+
+__attribute__((target("sse4.2,pclmul"))) static inline uint
+crc32c_lanes_sse42(
+    uint crc, const uchar *p, size_t lane, ullong shift1, ullong shift2
+) {
+    ullong a = crc, b = 0, c = 0;
+    for (size_t i = 0; i < lane; i += 8) {
+        a = _mm_crc32_u64(a, bytes_load_ullong(p + i));
+        b = _mm_crc32_u64(b, bytes_load_ullong(p + lane + i));
+        c = _mm_crc32_u64(c, bytes_load_ullong(p + 2 * lane + i));
+    }
+    __m128i shifted = _mm_xor_si128(
+        _mm_clmulepi64_si128(
+            _mm_cvtsi64_si128((llong)a), _mm_cvtsi64_si128((llong)shift2), 0
+        ),
+        _mm_clmulepi64_si128(
+            _mm_cvtsi64_si128((llong)b), _mm_cvtsi64_si128((llong)shift1), 0
+        )
+    );
+    return (uint)(_mm_crc32_u64(0, (ullong)_mm_cvtsi128_si64(shifted)) ^ c);
 }
 
-size_t cstr_len_int(int src) {
-    size_t len = 0;
-    if (src < 0) {
-        len += 1;
-        src = -src;
+__attribute__((target("sse4.2,pclmul"))) static uint
+crc32c_sse42_pclmul(uint crc, const uchar *p, size_t len) {
+    for (; len >= 3 * crc32c_long_lane; len -= 3 * crc32c_long_lane) {
+        crc = crc32c_lanes_sse42(
+            crc, p, crc32c_long_lane, crc32c_long_shift1, crc32c_long_shift2
+        );
+        p += 3 * crc32c_long_lane;
     }
-    do {
-        len += 1;
-        src /= 10;
-    } while (src > 0);
-    return len;
+    for (; len >= 3 * crc32c_short_lane; len -= 3 * crc32c_short_lane) {
+        crc = crc32c_lanes_sse42(
+            crc, p, crc32c_short_lane, crc32c_short_shift1, crc32c_short_shift2
+        );
+        p += 3 * crc32c_short_lane;
+    }
+    return crc32c_sse42(crc, p, len);
 }
 
-size_t cstr_len_uint(uint src) {
-    size_t len = 0;
-    do {
-        len += 1;
-        src /= 10;
-    } while (src > 0);
-    return len;
+#endif // JP_SIMD_X86
+
+typedef struct {
+    uint (*update)(uint, const uchar *, size_t);
+} crc32c_kernels;
+
+static const crc32c_kernels crc32c_kernels_scalar = {crc32c_scalar};
+
+#ifdef JP_SIMD_X86
+static const crc32c_kernels crc32c_kernels_sse42 = {crc32c_sse42};
+static const crc32c_kernels crc32c_kernels_pclmul = {crc32c_sse42_pclmul};
+#endif
+
+static const cpu_dispatch_variant crc32c_variants[] = {
+#ifdef JP_SIMD_X86
+    {cpu_feature_sse42 | cpu_feature_pclmul, &crc32c_kernels_pclmul},
+    {cpu_feature_sse42, &crc32c_kernels_sse42},
+#endif
+    {0, &crc32c_kernels_scalar},
+};
+
+uint slice_crc32c(slice_const s, uint crc) {
+    assert((s.ptr || s.len == 0) && "slice must not be null");
+    const crc32c_kernels *k = cpu_dispatch_get(
+        cpu_dispatch_crc32c, crc32c_variants, countof(crc32c_variants)
+    );
+    return ~k->update(~crc, s.ptr, s.len);
 }
 
-size_t cstr_len_llong(llong src) {
-    size_t len = 0;
-    if (src < 0) {
-        len += 1;
-        src = -src;
+////////////////////////
+// Arena allocator
+////////////////////////
+
+// Header of a chained arena block, followed by the block memory
+typedef struct arena_block {
+    struct arena_block *prev;
+    size_t alloc_size;
+} arena_block;
+
+// Alignment of the block memory, enough for any scalar type
+#define arena_block_align (size_t)(16)
+
+#define arena_block_header_size \
+    align_to_nearest(sizeof(arena_block), arena_block_align)
+
+arena arena_new(void *buffer, size_t size) {
+    arena arena = {.buffer = (uchar *)buffer, .size = size, .used = 0};
+    return arena;
+}
+
+arena arena_new_chained(allocator *backing, size_t block_size) {
+    assert(backing && "backing allocator must not be null");
+    arena arena = {
+        .backing = backing,
+        .next_block_size = block_size ? block_size : arena_default_block_size,
+    };
+    return arena;
+}
+
+arena arena_new_reserved(size_t reserve_size, uint flags) {
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    assert(page_size > 0 && "expected a page size >0");
+    reserve_size = (size_t)round_up_multiple_ullong(
+        (ullong)(reserve_size ? reserve_size : arena_default_reserve_size),
+        (ullong)max((ullong)page_size, (ullong)arena_commit_size)
+    );
+
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+    map_flags |= MAP_NORESERVE;
+#endif
+    void *ptr = mmap(0, reserve_size, PROT_NONE, map_flags, -1, 0);
+    arena arena = {.flags = flags};
+    if (ptr != MAP_FAILED) {
+        arena.buffer = ptr;
+        arena.reserved = reserve_size;
     }
-    do {
-        len += 1;
-        src /= 10;
-    } while (src > 0);
-    return len;
+    return arena;
 }
 
-size_t cstr_len_ullong(ullong src) {
-    size_t len = 0;
-    do {
-        len += 1;
-        src /= 10;
-    } while (src > 0);
-    return len;
+// Commit the pages of a virtual memory arena up to the given size
+static bool arena_commit(arena *arena, size_t size) {
+    if (size > arena->reserved) {
+        return 0;
+    }
+    size_t committed = (size_t)round_up_multiple_ullong(
+        (ullong)size, (ullong)arena_commit_size
+    );
+    committed = min(committed, arena->reserved);
+    if (mprotect(
+            arena->buffer + arena->size,
+            committed - arena->size,
+            PROT_READ | PROT_WRITE
+        )
+        != 0) {
+        return 0;
+    }
+    arena->size = committed;
+    return 1;
 }
 
-size_t cstr_len_float(float src, uint decimals) {
-    assert(decimals < 19 && "decimals up to 19 are supported");
+static arena_block *arena_block_new(arena *arena, size_t size) {
+    allocation a = alloc_malloc(
+        arena->backing, arena_block_header_size + size, arena_block_align
+    );
+    if (!allocation_exists(a)) {
+        return NULL;
+    }
+    arena_block *block = a.ptr;
+    block->alloc_size = a.len;
+    return block;
+}
 
-    size_t len = 0;
-    if (src < 0) {
-        len += 1;
-        src = -src;
+static void arena_block_free(arena *arena, arena_block *block) {
+    allocation a = {
+        .ptr = block,
+        .len = block->alloc_size,
+    };
+    alloc_free(arena->backing, a);
+}
+
+static inline uchar *arena_block_memory(arena_block *block) {
+    return (uchar *)block + arena_block_header_size;
+}
+
+// Slow path of arena_alloc_bytes: the allocation does not fit the current
+// block
+static void *arena_alloc_block(arena *arena, size_t size, size_t alignment) {
+    if (arena->reserved) {
+        size_t aligned_used = align_to_nearest(
+                                  (uintptr_t)arena->buffer + arena->used,
+                                  alignment
+                              )
+                              - (uintptr_t)arena->buffer;
+        if (aligned_used > arena->reserved
+            || size > arena->reserved - aligned_used
+            || !arena_commit(arena, aligned_used + size)) {
+            return NULL;
+        }
+        arena->used = aligned_used + size;
+        return arena->buffer + aligned_used;
+    }
+    if (!arena->backing) {
+        return NULL;
     }
+    assert(
+        SIZE_MAX - arena_block_header_size - alignment > size
+        && "size + block header + alignment must not exceed size max"
+    );
+    // room for aligning the start of the allocation
+    size_t needed = size + alignment - 1;
 
-    double precision_d = pow10_double[decimals];
+    if (arena->blocks && needed > arena->next_block_size / 2) {
+        // dedicated block, the current block stays in use
+        arena_block *block = arena_block_new(arena, needed);
+        if (!block) {
+            return NULL;
+        }
+        block->prev = arena->oversized;
+        arena->oversized = block;
+        return (void *)align_to_nearest(
+            (uintptr_t)arena_block_memory(block), alignment
+        );
+    }
 
-    src += 0.5f / (float)precision_d;
-    if (src >= (float)(-1UL >> 1)) {
-        return len + sizeof("inf") - 1;
+    size_t block_size = max(arena->next_block_size, needed);
+    arena_block *block = arena_block_new(arena, block_size);
+    if (!block) {
+        return NULL;
     }
+    block->prev = arena->blocks;
+    arena->blocks = block;
+    arena->buffer = arena_block_memory(block);
+    arena->size = block_size;
+    arena->used = 0;
+    if (arena->next_block_size <= arena_max_block_size / 2) {
+        arena->next_block_size *= 2;
+    }
+    return arena_alloc_bytes(arena, size, alignment);
+}
 
-    // integer part
-    ullong integer = (ullong)src;
-    len += cstr_len_ullong(integer);
+void *arena_alloc_bytes(arena *arena, size_t size, size_t alignment) {
+    assert(arena && "arena must not be null");
 
-    // decimal point
-    len += 1;
+    // align the address rather than the offset, so that alignments larger
+    // than the alignment of the buffer are honoured too
+    uintptr_t start = (uintptr_t)arena->buffer;
+    size_t aligned_used = align_to_nearest(start + arena->used, alignment)
+        - start;
+    assert(
+        SIZE_MAX - aligned_used > size
+        && "size + aligned_used must not exceed size max"
+    );
 
-    // fractional part
-    ullong fractional = (ullong)((src - (double)integer) * precision_d);
-    len += count_decimal_zeros(fractional, decimals);
-    len += cstr_len_ullong(fractional);
+    if (arena->size < size + aligned_used) {
+        return arena_alloc_block(arena, size, alignment);
+    }
+    void *p = arena->buffer + aligned_used;
+    arena->used = aligned_used + size;
+    return p;
+}
 
-    return len;
+// Free the blocks of a chain up to (not including) the given block
+static void
+arena_blocks_free(arena *arena, arena_block *block, const arena_block *until) {
+    while (block != until) {
+        assert(block && "block must be in the chain");
+        arena_block *prev = block->prev;
+        arena_block_free(arena, block);
+        block = prev;
+    }
 }
 
-size_t cstr_len_double(double src, uint decimals) {
-    assert(decimals < 19 && "decimals up to 19 are supported");
+void arena_clear(arena *arena) {
+    arena->used = 0;
+#ifdef MADV_DONTNEED
+    if (arena->reserved && arena->size > 0
+        && arena->flags & arena_flag_decommit_on_clear) {
+        madvise(arena->buffer, arena->size, MADV_DONTNEED);
+    }
+#endif
+    arena_blocks_free(arena, arena->oversized, NULL);
+    arena->oversized = NULL;
+    arena_block *current = arena->blocks;
+    if (!current) {
+        return;
+    }
+    arena_blocks_free(arena, current->prev, NULL);
+    current->prev = NULL;
+}
 
-    size_t len = 0;
-    if (src < 0) {
-        len += 1;
-        src = -src;
+void arena_release(arena *arena) {
+    if (arena->reserved) {
+        munmap(arena->buffer, arena->reserved);
+        arena->reserved = 0;
+        arena->buffer = NULL;
+        arena->size = 0;
+        arena->used = 0;
+        return;
+    }
+    arena_clear(arena);
+    if (!arena->blocks) {
+        return;
     }
+    arena_block_free(arena, arena->blocks);
+    arena->blocks = NULL;
+    arena->buffer = NULL;
+    arena->size = 0;
+}
 
-    double precision_d = pow10_double[decimals];
+arena_marker arena_mark(const arena *arena) {
+    assert(arena && "arena must not be null");
+    arena_marker mark = {
+        .block = arena->blocks,
+        .oversized = arena->oversized,
+        .used = arena->used,
+    };
+    return mark;
+}
 
-    src += 0.5 / precision_d;
-    if (src >= (double)(-1UL >> 1)) {
-        return len + sizeof("inf") - 1;
+void arena_reset_to(arena *arena, arena_marker mark) {
+    assert(arena && "arena must not be null");
+    if (!mark.block) {
+        // before the first block, or a fixed buffer
+        if (arena->blocks) {
+            arena_clear(arena);
+            return;
+        }
+        assert(mark.used <= arena->used && "mark must be before the position");
+        arena->used = mark.used;
+        return;
     }
 
-    // integer part
-    ullong integer = (ullong)src;
-    len += cstr_len_ullong(integer);
+    arena_blocks_free(arena, arena->oversized, mark.oversized);
+    arena->oversized = mark.oversized;
 
-    // decimal point
-    len += 1;
+    arena_block *block = mark.block;
+    arena_blocks_free(arena, arena->blocks, block);
+    if (arena->blocks != block) {
+        arena->blocks = block;
+        arena->buffer = arena_block_memory(block);
+        arena->size = block->alloc_size - arena_block_header_size;
+    }
+    assert(mark.used <= arena->size && "mark must be within the block");
+    arena->used = mark.used;
+}
 
-    // fractional part
-    ullong fractional = (ullong)((src - (double)integer) * precision_d);
-    len += count_decimal_zeros(fractional, decimals);
-    len += cstr_len_ullong(fractional);
+// Scratch arenas of the calling thread
+#if __STDC_VERSION__ >= 201112L
+static _Thread_local arena arena_scratch_pool[arena_scratch_count];
+#else
+static __thread arena arena_scratch_pool[arena_scratch_count];
+#endif
 
-    return len;
+arena_scratch
+arena_scratch_begin(arena *const *conflicts, size_t conflict_count) {
+    assert(
+        conflict_count < arena_scratch_count
+        && "there must be a scratch arena left without conflicts"
+    );
+    assert((conflicts || conflict_count == 0) && "conflicts must not be null");
+
+    arena *found = NULL;
+    for (size_t i = 0; i < arena_scratch_count && !found; i += 1) {
+        arena *candidate = &arena_scratch_pool[i];
+        bool conflict = false;
+        for (size_t c = 0; c < conflict_count; c += 1) {
+            conflict |= conflicts[c] == candidate;
+        }
+        if (!conflict) {
+            found = candidate;
+        }
+    }
+    if (!found) {
+        found = &arena_scratch_pool[0];
+    }
+    if (!found->backing) {
+        *found = arena_new_chained(&std_allocator, 0);
+    }
+
+    arena_scratch scratch = {
+        .arena = found,
+        .mark = arena_mark(found),
+    };
+    return scratch;
 }
 
-cstr_fmt_result cstr_fmt_va(
-    char *restrict dest,
-    size_t len,
-    const char *restrict format,
-    va_list va_args
-) {
-    assert(dest && "dest must not be null");
-    assert(len > 0 && "len must be higher than 0");
-    assert(format && "format must not be null");
+void arena_scratch_end(arena_scratch scratch) {
+    assert(scratch.arena && "scratch arena must not be null");
+    arena_reset_to(scratch.arena, scratch.mark);
+}
 
-    cstr_fmt_result res = {
-        .ok = 1,
-        .len = 0,
+void arena_scratch_release(void) {
+    for (size_t i = 0; i < arena_scratch_count; i += 1) {
+        if (arena_scratch_pool[i].backing) {
+            arena_release(&arena_scratch_pool[i]);
+        }
+    }
+}
+
+allocation arena_malloc(size_t size, size_t alignment, void *ctx) {
+    arena *arena = ctx;
+    void *ptr = arena_alloc_bytes(arena, size, alignment);
+    if (ptr == NULL) {
+        return (allocation) {0};
+    }
+    return (allocation) {
+        .ptr = ptr,
+        .len = size,
     };
-    size_t bytes_written = 0;
+}
 
-    if (!format || !len) {
-        res.ok = 0;
-        return res;
+void arena_free(allocation a, void *ctx) {
+    (void)ctx;
+    (void)a;
+}
+
+allocation
+arena_realloc(allocation a, size_t size, size_t alignment, void *ctx) {
+    arena *arena = ctx;
+    assert(arena && "arena must not be null");
+    assert(a.ptr && "ptr must not be null");
+
+    uchar *ptr = a.ptr;
+    if ((uintptr_t)ptr + a.len == (uintptr_t)(arena->buffer + arena->used)) {
+        size_t offset = (size_t)(ptr - arena->buffer);
+        // last allocation: move the end of the used area
+        if (arena->size - offset >= size
+            || (arena->reserved && size <= arena->reserved - offset
+                && arena_commit(arena, offset + size))) {
+            arena->used = offset + size;
+            return (allocation) {
+                .ptr = ptr,
+                .len = size,
+            };
+        }
+        if (!arena->backing) {
+            return (allocation) {0};
+        }
     }
 
-    slice_const s;
-    size_t field_bytes = 0;
-    cstr_fmt_float fmt_float;
-    while (res.ok && bytes_written < len && *format != '\0') {
-        switch (*format) {
-        case 'c':
-            dest[bytes_written] = (char)va_arg(va_args, int);
-            field_bytes = 1;
-            break;
-        case 's':
-            s = va_arg(va_args, slice_const);
-            field_bytes = min(s.len, len - bytes_written);
-            bytes_copy(dest + bytes_written, s.ptr, field_bytes);
-            res.ok = s.len <= len - bytes_written;
-            break;
-        case 'S':
-            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
-            field_bytes = min(s.len, len - bytes_written);
-            bytes_copy(dest + bytes_written, s.ptr, field_bytes);
-            res.ok = s.len <= len - bytes_written;
-            break;
-        case 'h':
-            s = va_arg(va_args, slice_const);
-            field_bytes = bytes_to_hex(
-                dest + bytes_written,
-                len - bytes_written,
-                (const char *)s.ptr,
-                s.len
-            );
-            res.ok = s.len <= len - bytes_written;
-            break;
-        case 'H':
-            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
-            field_bytes = bytes_to_hex(
-                dest + bytes_written,
-                len - bytes_written,
-                (const char *)s.ptr,
-                s.len
-            );
-            res.ok = s.len <= len - bytes_written;
-            break;
-        case 'f':
-            fmt_float.v = va_arg(va_args, double);
-            fmt_float.precision = 6;
-            field_bytes = cstr_from_double(
-                dest + bytes_written,
-                len - bytes_written,
-                fmt_float.v,
-                fmt_float.precision
-            );
-            if (field_bytes == 0) {
-                res.ok = 0;
-            }
+    // other allocations shrink in place when they are aligned already
+    if (size <= a.len
+        && align_to_nearest((uintptr_t)ptr, alignment) == (uintptr_t)ptr) {
+        return (allocation) {
+            .ptr = ptr,
+            .len = size,
+        };
+    }
+
+    void *resized = arena_alloc_bytes(arena, size, alignment);
+    if (resized == NULL) {
+        return (allocation) {0};
+    }
+    bytes_copy(resized, ptr, min(a.len, size));
+    return (allocation) {
+        .ptr = resized,
+        .len = size,
+    };
+}
+
+allocator arena_allocator_new(arena *arena) {
+    allocator a = {
+        .ctx = arena,
+        .malloc = arena_malloc,
+        .free = arena_free,
+        .realloc = arena_realloc,
+    };
+    return a;
+}
+
+////////////////////////
+// Pool allocator
+////////////////////////
+
+typedef struct pool_page {
+    struct pool_page *next;
+    size_t alloc_size;
+} pool_page;
+
+// Slots are aligned for pointers, so the free list link is stored directly
+static inline void *pool_slot_next(void *slot) {
+    return *(void **)slot;
+}
+
+static inline void pool_slot_set_next(void *slot, void *next) {
+    *(void **)slot = next;
+}
+
+void pool_init(
+    pool *p,
+    size_t slot_size,
+    size_t slot_align,
+    size_t page_size,
+    uint flags,
+    allocator *backing
+) {
+    assert(p && "pool must not be null");
+    assert(backing && "backing allocator must not be null");
+    assert(is_power_of_two(slot_align) && "alignment must be power of two");
+
+    slot_align = max(slot_align, alignof(void *));
+    if (flags & pool_flag_cache_aligned) {
+        slot_align = max(slot_align, pool_cache_line_size);
+    }
+    slot_size = align_to_nearest(max(slot_size, sizeof(void *)), slot_align);
+    page_size = page_size ? page_size : pool_default_page_size;
+
+    p->free_list = NULL;
+    p->pages = NULL;
+    p->bump = NULL;
+    p->bump_end = NULL;
+    p->slot_size = slot_size;
+    p->slot_align = slot_align;
+    p->page_count = 0;
+    p->used = 0;
+    p->backing = backing;
+
+    page_size = max(page_size, sizeof(pool_page) + slot_size);
+    p->page_size = page_size;
+    p->slots_per_page = (page_size - sizeof(pool_page)) / slot_size;
+}
+
+static bool pool_add_page(pool *p) {
+    // backing allocators may ignore the alignment, so the page is padded for
+    // aligning the slots after the page header
+    allocation a = alloc_malloc(
+        p->backing, p->page_size + p->slot_align - 1, p->slot_align
+    );
+    if (!allocation_exists(a)) {
+        return false;
+    }
+    pool_page *page = a.ptr;
+    page->next = p->pages;
+    page->alloc_size = a.len;
+    p->pages = page;
+    p->page_count += 1;
+    p->bump = (uchar *)align_to_nearest(
+        (uintptr_t)page + sizeof(pool_page), p->slot_align
+    );
+    p->bump_end = p->bump + p->slots_per_page * p->slot_size;
+    assert(
+        p->bump_end <= (uchar *)page + a.len && "slots must fit in the page"
+    );
+    return true;
+}
+
+void *pool_alloc_slot(pool *p) {
+    assert(p && "pool must not be null");
+    void *slot = p->free_list;
+    if (slot) {
+        p->free_list = pool_slot_next(slot);
+    } else {
+        // slots of the newest page are handed out in order, so a new page
+        // is not touched before it is used
+        if (p->bump == p->bump_end && !pool_add_page(p)) {
+            return NULL;
+        }
+        slot = p->bump;
+        p->bump += p->slot_size;
+    }
+    p->used += 1;
+    return slot;
+}
+
+void pool_free_slot(pool *p, void *slot) {
+    assert(p && "pool must not be null");
+    if (!slot) {
+        return;
+    }
+    assert(p->used > 0 && "pool must have slots in use");
+    pool_slot_set_next(slot, p->free_list);
+    p->free_list = slot;
+    p->used -= 1;
+}
+
+// Index of the page (in ascending address order) that holds the slot
+static size_t
+pool_page_index(const ullong *starts, size_t len, const void *slot) {
+    ullong addr = (ullong)(uintptr_t)slot;
+    size_t lo = 0;
+    size_t hi = len;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (starts[mid] <= addr) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+size_t pool_trim(pool *p) {
+    assert(p && "pool must not be null");
+    size_t pages = p->page_count;
+    if (!pages) {
+        return 0;
+    }
+    if (!p->used) {
+        pool_release(p);
+        return pages;
+    }
+
+    // page start addresses in ascending order and the free slots per page
+    allocation a = alloc_malloc(
+        p->backing, pages * (sizeof(ullong) + sizeof(uint)), alignof(ullong)
+    );
+    if (!allocation_exists(a)) {
+        return 0;
+    }
+    ullong *starts = a.ptr;
+    uint *free_counts = (uint *)(void *)(starts + pages);
+    size_t i = 0;
+    for (pool_page *page = p->pages; page; page = page->next, i += 1) {
+        starts[i] = (ullong)(uintptr_t)page;
+        free_counts[i] = 0;
+    }
+    if (!sort_radix_ullong(starts, NULL, pages, p->backing)) {
+        alloc_free(p->backing, a);
+        return 0;
+    }
+
+    for (void *slot = p->free_list; slot; slot = pool_slot_next(slot)) {
+        free_counts[pool_page_index(starts, pages, slot)] += 1;
+    }
+    // the never used slots of the newest page are free too
+    pool_page *newest = p->pages;
+    size_t unused = (size_t)(p->bump_end - p->bump) / p->slot_size;
+    free_counts[pool_page_index(starts, pages, newest)] += (uint)unused;
+
+    size_t empty = 0;
+    for (i = 0; i < pages; i += 1) {
+        empty += free_counts[i] == p->slots_per_page;
+    }
+    if (!empty) {
+        alloc_free(p->backing, a);
+        return 0;
+    }
+
+    // drop the free slots of the empty pages
+    void *head = NULL;
+    void *tail = NULL;
+    for (void *slot = p->free_list; slot; slot = pool_slot_next(slot)) {
+        size_t page = pool_page_index(starts, pages, slot);
+        if (free_counts[page] == p->slots_per_page) {
+            continue;
+        }
+        if (tail) {
+            pool_slot_set_next(tail, slot);
+        } else {
+            head = slot;
+        }
+        tail = slot;
+    }
+    if (tail) {
+        pool_slot_set_next(tail, NULL);
+    }
+    p->free_list = head;
+
+    // return the empty pages
+    pool_page *kept_head = NULL;
+    pool_page *kept_tail = NULL;
+    pool_page *page = p->pages;
+    while (page) {
+        pool_page *next = page->next;
+        size_t index = pool_page_index(starts, pages, page);
+        if (free_counts[index] != p->slots_per_page) {
+            if (kept_tail) {
+                kept_tail->next = page;
+            } else {
+                kept_head = page;
+            }
+            kept_tail = page;
+        } else {
+            if (page == newest) {
+                p->bump = NULL;
+                p->bump_end = NULL;
+            }
+            allocation page_alloc = {
+                .ptr = page,
+                .len = page->alloc_size,
+            };
+            alloc_free(p->backing, page_alloc);
+            p->page_count -= 1;
+        }
+        page = next;
+    }
+    if (kept_tail) {
+        kept_tail->next = NULL;
+    }
+    p->pages = kept_head;
+
+    alloc_free(p->backing, a);
+    return empty;
+}
+
+void pool_release(pool *p) {
+    assert(p && "pool must not be null");
+    pool_page *page = p->pages;
+    while (page) {
+        pool_page *next = page->next;
+        allocation a = {
+            .ptr = page,
+            .len = page->alloc_size,
+        };
+        alloc_free(p->backing, a);
+        page = next;
+    }
+    p->free_list = NULL;
+    p->pages = NULL;
+    p->bump = NULL;
+    p->bump_end = NULL;
+    p->page_count = 0;
+    p->used = 0;
+}
+
+allocation pool_malloc(size_t size, size_t alignment, void *ctx) {
+    pool *p = ctx;
+    assert(p && "pool must not be null");
+    if (size > p->slot_size || alignment > p->slot_align) {
+        return (allocation) {0};
+    }
+    void *slot = pool_alloc_slot(p);
+    if (!slot) {
+        return (allocation) {0};
+    }
+    return (allocation) {
+        .ptr = slot,
+        .len = p->slot_size,
+    };
+}
+
+void pool_free(allocation a, void *ctx) {
+    pool_free_slot(ctx, a.ptr);
+}
+
+allocation
+pool_realloc(allocation a, size_t size, size_t alignment, void *ctx) {
+    pool *p = ctx;
+    assert(p && "pool must not be null");
+    assert(a.ptr && "ptr must not be null");
+    if (size > p->slot_size || alignment > p->slot_align) {
+        return (allocation) {0};
+    }
+    return a;
+}
+
+allocator pool_allocator_new(pool *p) {
+    allocator a = {
+        .ctx = p,
+        .malloc = pool_malloc,
+        .free = pool_free,
+        .realloc = pool_realloc,
+    };
+    return a;
+}
+
+////////////////////////
+// TLSF allocator
+////////////////////////
+
+// Block header. The free list links are only valid in free blocks and
+// overlap the memory returned for blocks in use.
+typedef struct tlsf_block {
+    struct tlsf_block *prev_phys;
+    size_t size;
+    struct tlsf_block *next_free;
+    struct tlsf_block *prev_free;
+} tlsf_block;
+
+// Bytes in front of the memory of a block
+#define tlsf_header_size tlsf_block_align
+
+// Smallest block size, large enough for the free list links
+#define tlsf_min_block_size tlsf_block_align
+
+// Flag in the block size for free blocks
+#define tlsf_block_free_bit (size_t)(1)
+
+// Sizes below this are mapped linearly to the second-level classes of the
+// first first-level class
+#define tlsf_sl_log2 5
+#define tlsf_small_size ((size_t)tlsf_sl_count * tlsf_block_align)
+
+static size_t tlsf_block_size(const tlsf_block *block) {
+    return block->size & ~tlsf_block_free_bit;
+}
+
+static bool tlsf_block_is_free(const tlsf_block *block) {
+    return (block->size & tlsf_block_free_bit) != 0;
+}
+
+static void *tlsf_block_memory(tlsf_block *block) {
+    return (uchar *)block + tlsf_header_size;
+}
+
+static tlsf_block *tlsf_block_from_memory(void *ptr) {
+    return (tlsf_block *)((uchar *)ptr - tlsf_header_size);
+}
+
+static tlsf_block *tlsf_block_next(tlsf_block *block) {
+    return (tlsf_block *)((uchar *)tlsf_block_memory(block)
+                          + tlsf_block_size(block));
+}
+
+static void tlsf_mapping(size_t size, uint *fl, uint *sl) {
+    if (size < tlsf_small_size) {
+        *fl = 0;
+        *sl = (uint)(size / tlsf_block_align);
+        return;
+    }
+    uint msb = bits_most_significant((ullong)size);
+    *sl = (uint)(size >> (msb - tlsf_sl_log2)) ^ (uint)tlsf_sl_count;
+    *fl = msb - (bits_most_significant(tlsf_small_size) - 1);
+}
+
+static void tlsf_insert(tlsf *t, tlsf_block *block) {
+    uint fl, sl;
+    tlsf_mapping(tlsf_block_size(block), &fl, &sl);
+    tlsf_block *head = t->free_lists[fl][sl];
+    block->next_free = head;
+    block->prev_free = NULL;
+    if (head) {
+        head->prev_free = block;
+    }
+    t->free_lists[fl][sl] = block;
+    t->fl_bitmap |= 1U << fl;
+    t->sl_bitmap[fl] |= 1U << sl;
+}
+
+static void tlsf_remove(tlsf *t, tlsf_block *block) {
+    uint fl, sl;
+    tlsf_mapping(tlsf_block_size(block), &fl, &sl);
+    if (block->next_free) {
+        block->next_free->prev_free = block->prev_free;
+    }
+    if (block->prev_free) {
+        block->prev_free->next_free = block->next_free;
+        return;
+    }
+    t->free_lists[fl][sl] = block->next_free;
+    if (!block->next_free) {
+        t->sl_bitmap[fl] &= ~(1U << sl);
+        if (!t->sl_bitmap[fl]) {
+            t->fl_bitmap &= ~(1U << fl);
+        }
+    }
+}
+
+// Take a free block of at least the given size from the free lists
+static tlsf_block *tlsf_find(tlsf *t, size_t size) {
+    size_t class_size = size;
+    if (size >= tlsf_small_size) {
+        // round up to the next class so that any block in it is large enough
+        uint msb = bits_most_significant((ullong)size);
+        class_size += ((size_t)1 << (msb - tlsf_sl_log2)) - 1;
+    }
+    uint fl, sl;
+    tlsf_mapping(class_size, &fl, &sl);
+
+    uint sl_map = fl < tlsf_fl_count ? t->sl_bitmap[fl] & (~0U << sl) : 0;
+    if (!sl_map) {
+        uint fl_map =
+            fl + 1 < tlsf_fl_count ? t->fl_bitmap & (~0U << (fl + 1)) : 0;
+        if (fl_map) {
+            fl = bits_least_significant(fl_map);
+            sl_map = t->sl_bitmap[fl];
+        }
+    }
+    if (!sl_map) {
+        // the first block of the size's own class may still be large enough
+        tlsf_mapping(size, &fl, &sl);
+        tlsf_block *block =
+            fl < tlsf_fl_count ? t->free_lists[fl][sl] : NULL;
+        if (!block || tlsf_block_size(block) < size) {
+            return NULL;
+        }
+        tlsf_remove(t, block);
+        return block;
+    }
+    sl = bits_least_significant(sl_map);
+    tlsf_block *block = t->free_lists[fl][sl];
+    tlsf_remove(t, block);
+    return block;
+}
+
+// Merge a block with the next block, which must be free
+static void tlsf_absorb_next(tlsf *t, tlsf_block *block) {
+    tlsf_block *next = tlsf_block_next(block);
+    tlsf_remove(t, next);
+    block->size += tlsf_header_size + tlsf_block_size(next);
+    tlsf_block_next(block)->prev_phys = block;
+}
+
+// Shrink a block to the given size and return the rest as a free block
+static void tlsf_trim(tlsf *t, tlsf_block *block, size_t size) {
+    size_t block_size = tlsf_block_size(block);
+    if (block_size < size + tlsf_header_size + tlsf_min_block_size) {
+        return;
+    }
+    tlsf_block *rest =
+        (tlsf_block *)((uchar *)tlsf_block_memory(block) + size);
+    rest->prev_phys = block;
+    rest->size = (block_size - size - tlsf_header_size) | tlsf_block_free_bit;
+    block->size = size | (block->size & tlsf_block_free_bit);
+    tlsf_block_next(rest)->prev_phys = rest;
+    if (tlsf_block_is_free(tlsf_block_next(rest))) {
+        tlsf_absorb_next(t, rest);
+    }
+    tlsf_insert(t, rest);
+}
+
+static size_t tlsf_request_size(size_t size) {
+    return max(align_to_nearest(size, tlsf_block_align), tlsf_min_block_size);
+}
+
+bool tlsf_init(tlsf *t, slice memory) {
+    assert(t && "tlsf must not be null");
+    assert(memory.ptr && "memory must not be null");
+    bytes_set(t, 0, sizeof(*t));
+
+    uchar *start =
+        (uchar *)align_to_nearest((uintptr_t)memory.ptr, tlsf_block_align);
+    size_t skipped = (size_t)(start - memory.ptr);
+    size_t overhead = 2 * tlsf_header_size + tlsf_min_block_size;
+    if (memory.len < skipped || memory.len - skipped < overhead) {
+        return 0;
+    }
+
+    // one free block over the region followed by an empty block in use, which
+    // stops the coalescing at the end of the region
+    size_t block_size = (memory.len - skipped - 2 * tlsf_header_size)
+                        & ~(tlsf_block_align - 1);
+    ullong max_block_size =
+        (1ULL << (tlsf_fl_count + bits_most_significant(tlsf_small_size) - 1))
+        - tlsf_block_align;
+    if ((ullong)block_size > max_block_size) {
+        block_size = (size_t)max_block_size;
+    }
+    tlsf_block *block = (tlsf_block *)start;
+    block->prev_phys = NULL;
+    block->size = block_size | tlsf_block_free_bit;
+    tlsf_block *sentinel = tlsf_block_next(block);
+    sentinel->prev_phys = block;
+    sentinel->size = 0;
+    tlsf_insert(t, block);
+    t->size = tlsf_header_size + block_size;
+    return 1;
+}
+
+void *tlsf_alloc_bytes(tlsf *t, size_t size, size_t alignment) {
+    assert(t && "tlsf must not be null");
+    assert(is_power_of_two(alignment) && "alignment must be power of two");
+    if (size > t->size || alignment > t->size) {
+        return NULL;
+    }
+    size_t block_size = tlsf_request_size(size);
+    size_t search_size = block_size;
+    if (alignment > tlsf_block_align) {
+        // room for splitting off the unaligned start as a free block
+        search_size += alignment + tlsf_header_size + tlsf_min_block_size;
+    }
+
+    tlsf_block *block = tlsf_find(t, search_size);
+    if (!block) {
+        return NULL;
+    }
+
+    if (alignment > tlsf_block_align) {
+        uchar *memory = tlsf_block_memory(block);
+        uchar *aligned =
+            (uchar *)align_to_nearest((uintptr_t)memory, alignment);
+        if (aligned != memory
+            && (size_t)(aligned - memory)
+                   < tlsf_header_size + tlsf_min_block_size) {
+            aligned = (uchar *)align_to_nearest(
+                (uintptr_t)(memory + tlsf_header_size + tlsf_min_block_size),
+                alignment
+            );
+        }
+        size_t gap = (size_t)(aligned - memory);
+        if (gap > 0) {
+            // the previous block is in use, as free blocks are coalesced
+            tlsf_block *rest = (tlsf_block *)((uchar *)block + gap);
+            rest->prev_phys = block;
+            rest->size = tlsf_block_size(block) - gap;
+            block->size = (gap - tlsf_header_size) | tlsf_block_free_bit;
+            tlsf_block_next(rest)->prev_phys = rest;
+            tlsf_insert(t, block);
+            block = rest;
+        }
+    }
+
+    block->size &= ~tlsf_block_free_bit;
+    tlsf_trim(t, block, block_size);
+    t->used += tlsf_header_size + tlsf_block_size(block);
+    return tlsf_block_memory(block);
+}
+
+void tlsf_free_bytes(tlsf *t, void *ptr) {
+    assert(t && "tlsf must not be null");
+    if (!ptr) {
+        return;
+    }
+    tlsf_block *block = tlsf_block_from_memory(ptr);
+    assert(!tlsf_block_is_free(block) && "memory must not be freed twice");
+    t->used -= tlsf_header_size + tlsf_block_size(block);
+    block->size |= tlsf_block_free_bit;
+
+    tlsf_block *prev = block->prev_phys;
+    if (prev && tlsf_block_is_free(prev)) {
+        tlsf_remove(t, prev);
+        prev->size += tlsf_header_size + tlsf_block_size(block);
+        tlsf_block_next(prev)->prev_phys = prev;
+        block = prev;
+    }
+    if (tlsf_block_is_free(tlsf_block_next(block))) {
+        tlsf_absorb_next(t, block);
+    }
+    tlsf_insert(t, block);
+}
+
+void *tlsf_realloc_bytes(tlsf *t, void *ptr, size_t size, size_t alignment) {
+    assert(t && "tlsf must not be null");
+    assert(is_power_of_two(alignment) && "alignment must be power of two");
+    if (!ptr) {
+        return tlsf_alloc_bytes(t, size, alignment);
+    }
+    if (size > t->size) {
+        return NULL;
+    }
+
+    tlsf_block *block = tlsf_block_from_memory(ptr);
+    size_t block_size = tlsf_request_size(size);
+    size_t current_size = tlsf_block_size(block);
+    tlsf_block *next = tlsf_block_next(block);
+    bool fits = block_size <= current_size
+                || (tlsf_block_is_free(next)
+                    && current_size + tlsf_header_size + tlsf_block_size(next)
+                           >= block_size);
+    if (fits && (uintptr_t)ptr % alignment == 0) {
+        if (block_size > current_size) {
+            tlsf_absorb_next(t, block);
+        }
+        tlsf_trim(t, block, block_size);
+        t->used = t->used - current_size + tlsf_block_size(block);
+        return ptr;
+    }
+
+    void *moved = tlsf_alloc_bytes(t, size, alignment);
+    if (!moved) {
+        return NULL;
+    }
+    bytes_copy(moved, ptr, min(current_size, size));
+    tlsf_free_bytes(t, ptr);
+    return moved;
+}
+
+size_t tlsf_usable_size(const void *ptr) {
+    assert(ptr && "ptr must not be null");
+    const tlsf_block *block =
+        (const tlsf_block *)((const uchar *)ptr - tlsf_header_size);
+    return tlsf_block_size(block);
+}
+
+allocation tlsf_malloc(size_t size, size_t alignment, void *ctx) {
+    void *ptr = tlsf_alloc_bytes(ctx, size, alignment);
+    if (!ptr) {
+        return (allocation) {0};
+    }
+    return (allocation) {
+        .ptr = ptr,
+        .len = tlsf_usable_size(ptr),
+    };
+}
+
+void tlsf_free(allocation a, void *ctx) {
+    tlsf_free_bytes(ctx, a.ptr);
+}
+
+allocation
+tlsf_realloc(allocation a, size_t size, size_t alignment, void *ctx) {
+    void *ptr = tlsf_realloc_bytes(ctx, a.ptr, size, alignment);
+    if (!ptr) {
+        return (allocation) {0};
+    }
+    return (allocation) {
+        .ptr = ptr,
+        .len = tlsf_usable_size(ptr),
+    };
+}
+
+allocator tlsf_allocator_new(tlsf *t) {
+    allocator a = {
+        .ctx = t,
+        .malloc = tlsf_malloc,
+        .free = tlsf_free,
+        .realloc = tlsf_realloc,
+    };
+    return a;
+}
+
+////////////////////////
+// Dynamic array
+////////////////////////
+
+void *dynarr_new_sized(
+    ullong capacity, size_t item_size, size_t alignment, allocator *allocator
+) {
+    alignment = max(alignment, alignof(dynarr_header));
+    allocation a = alloc_malloc(
+        allocator, dynarr_count_to_bytes(capacity, item_size), alignment
+    );
+    if (!allocation_exists(a)) {
+        return NULL;
+    }
+
+    dynarr_header *header = (dynarr_header *)a.ptr;
+    header->len = 0;
+    header->capacity = (a.len - sizeof(dynarr_header)) / item_size;
+    header->alloc_size = a.len;
+    header->allocator = allocator;
+
+    return (uchar *)(a.ptr) + sizeof(dynarr_header);
+}
+
+void dynarr_free(void *array) {
+    dynarr_header *header = dynarr_get_header(array);
+    if (!header) {
+        return;
+    }
+    allocation a = {
+        .ptr = header,
+        .len = header->alloc_size,
+    };
+    alloc_free(header->allocator, a);
+}
+
+void *dynarr_grow_ut(
+    void *array, ullong capacity_increase, size_t item_size, size_t alignment
+) {
+    if (!array) {
+        return NULL;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    assert(header && "Header must not be null");
+
+    assert(
+        ULLONG_MAX - header->capacity > capacity_increase
+        && "new capacity must not exceed ullong max"
+    );
+    ullong capacity = capacity_increase + header->capacity;
+    alignment = max(alignment, alignof(dynarr_header));
+    allocation old_data = {
+        .ptr = header,
+        .len = header->alloc_size,
+    };
+
+    allocation new_data = alloc_realloc(
+        header->allocator,
+        old_data,
+        dynarr_count_to_bytes(capacity, item_size),
+        alignment
+    );
+    if (!allocation_exists(new_data)) {
+        return NULL;
+    }
+
+    dynarr_header *new_header = (dynarr_header *)new_data.ptr;
+    new_header->capacity = (new_data.len - sizeof(dynarr_header)) / item_size;
+    new_header->alloc_size = new_data.len;
+    return (uchar *)(new_data.ptr) + sizeof(dynarr_header);
+}
+
+void *dynarr_clone_ut(
+    void *array, ullong capacity_increase, size_t item_size, size_t alignment
+) {
+    if (!array) {
+        return NULL;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    assert(header && "Header must not be null");
+
+    assert(
+        ULLONG_MAX - header->capacity > capacity_increase
+        && "new capacity must not exceed ullong max"
+    );
+    ullong capacity = capacity_increase + header->capacity;
+    void *new_array =
+        dynarr_new_sized(capacity, item_size, alignment, header->allocator);
+    if (!new_array) {
+        return NULL;
+    }
+
+    dynarr_header *new_header = dynarr_get_header(new_array);
+    new_header->len = header->len;
+
+    bytes_copy(new_array, array, new_header->len * item_size);
+    return new_array;
+}
+
+bool dynarr_push_ut(
+    void *array, const void *items, ullong count, size_t item_size
+) {
+    if (count == 0) {
+        return 0;
+    }
+    if (!array) {
+        return 0;
+    }
+
+    dynarr_header *header = dynarr_get_header(array);
+    assert(header && "Header must not be null");
+
+    assert(
+        ULLONG_MAX - header->len > count
+        && "len + count must not exceed ullong max"
+    );
+    if (header->len + count > header->capacity) {
+        // out of capacity
+        return 0;
+    }
+
+    bytes_copy(
+        ((uchar *)array) + header->len * item_size, items, count * item_size
+    );
+    header->len += count;
+    return 1;
+}
+
+void *dynarr_push_grow_ut(
+    void *array,
+    const void *items,
+    ullong count,
+    size_t item_size,
+    size_t alignment
+) {
+    if (count == 0) {
+        return array;
+    }
+
+    assert(array && "array must not be null");
+    if (!array) {
+        return NULL;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    assert(header && "header must not be null");
+
+    assert(
+        ULLONG_MAX - header->len > count + 8
+        && "len + count + 8 must not exceed ullong max"
+    );
+    if (header->len + count > header->capacity) {
+        ullong capacity_increase = header->capacity + count + 8;
+        void *new_array =
+            dynarr_grow_ut(array, capacity_increase, item_size, alignment);
+        if (!new_array) {
+            return NULL;
+        }
+        array = new_array;
+        header = dynarr_get_header(new_array);
+        assert(header && "header must not be null");
+    }
+
+    void *dest = ((uchar *)array) + header->len * item_size;
+    bytes_copy(dest, items, count * item_size);
+    header->len += count;
+    return array;
+}
+
+bool dynarr_pop_ut(void *array, void *out, size_t item_size) {
+    if (!array) {
+        return 0;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    if (header->len == 0) {
+        return 0;
+    }
+    uchar *item = ((uchar *)array) + (header->len - 1) * item_size;
+    bytes_copy(out, item, item_size);
+    header->len -= 1;
+    return 1;
+}
+
+bool dynarr_remove_ut(void *array, ullong index, size_t item_size) {
+    if (!array) {
+        return 0;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    if (header->len <= index) {
+        return 0;
+    }
+    uchar *data = (uchar *)array;
+    uchar *data_dst = data + index * item_size;
+    uchar *data_src = data_dst + item_size;
+    size_t bytes = (size_t)(header->len - index - 1) * item_size;
+    bytes_move(data_dst, data_src, bytes);
+    header->len -= 1;
+    return 1;
+}
+
+bool dynarr_remove_uo_ut(void *array, ullong index, size_t item_size) {
+    if (!array) {
+        return 0;
+    }
+    dynarr_header *header = dynarr_get_header(array);
+    if (header->len <= index) {
+        return 0;
+    }
+    uchar *data = (uchar *)array;
+    uchar *data_dst = data + index * item_size;
+    uchar *data_src = data + (header->len - 1) * item_size;
+    bytes_copy(data_dst, data_src, item_size);
+    header->len -= 1;
+    return 1;
+}
+
+////////////////////////
+// Hash map
+////////////////////////
+
+#define hashmap_ctrl_empty (uchar)(0x80)
+#define hashmap_not_found SIZE_MAX
+#define hashmap_default_seed 0x9E3779B97F4A7C15ULL
+
+// Control bytes of occupied slots hold the low 7 bits of the hash, and the
+// rest of the hash picks the home slot.
+#define hashmap_h1(hash) ((size_t)((hash) >> 7))
+#define hashmap_h2(hash) ((uchar)((hash) & 0x7F))
+
+#ifdef JP_SIMD_X86
+
+// SSE2 is part of x86-64, so the group probes do not need dispatching.
+static inline uint hashmap_group_match(const uchar *ctrl, uchar h2) {
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (uint)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2))
+    );
+}
+
+// Only empty control bytes have the high bit set
+static inline uint hashmap_group_empty(const uchar *ctrl) {
+    return (uint)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+
+#else
+
+static inline uint hashmap_group_match(const uchar *ctrl, uchar h2) {
+    uint mask = 0;
+    for (uint i = 0; i < hashmap_group_size; i += 1) {
+        mask |= (uint)(ctrl[i] == h2) << i;
+    }
+    return mask;
+}
+
+static inline uint hashmap_group_empty(const uchar *ctrl) {
+    uint mask = 0;
+    for (uint i = 0; i < hashmap_group_size; i += 1) {
+        mask |= (uint)(ctrl[i] >> 7) << i;
+    }
+    return mask;
+}
+
+#endif // JP_SIMD_X86
+
+// Maximum number of entries for a capacity (load factor of 7/8)
+static inline size_t hashmap_max_len(size_t capacity) {
+    return capacity - capacity / 8;
+}
+
+static inline hashmap_slot *hashmap_slot_at(const hashmap *map, size_t i) {
+    return (hashmap_slot *)(map->entries + i * map->entry_size);
+}
+
+static inline void *hashmap_value_at(const hashmap *map, size_t i) {
+    return map->entries + i * map->entry_size + map->value_offset;
+}
+
+// The first group of control bytes is mirrored after the last slot, so that
+// a group can be loaded from any slot without wrapping around.
+static inline void hashmap_set_ctrl(hashmap *map, size_t i, uchar c) {
+    map->ctrl[i] = c;
+    if (i < hashmap_group_size) {
+        map->ctrl[map->capacity + i] = c;
+    }
+}
+
+static size_t
+hashmap_find(const hashmap *map, slice_const key, ullong hash) {
+    if (!map->capacity) {
+        return hashmap_not_found;
+    }
+    size_t mask = map->capacity - 1;
+    size_t pos = hashmap_h1(hash) & mask;
+    uchar h2 = hashmap_h2(hash);
+    for (;;) {
+        uint match = hashmap_group_match(map->ctrl + pos, h2);
+        while (match) {
+            size_t i = (pos + bits_least_significant(match)) & mask;
+            hashmap_slot *slot = hashmap_slot_at(map, i);
+            if (slot->hash == hash && slice_const_eq(slot->key, key)) {
+                return i;
+            }
+            match &= match - 1;
+        }
+        // Entries are never placed past an empty slot of their probe sequence
+        if (hashmap_group_empty(map->ctrl + pos)) {
+            return hashmap_not_found;
+        }
+        pos = (pos + hashmap_group_size) & mask;
+    }
+}
+
+static size_t hashmap_find_empty(const hashmap *map, ullong hash) {
+    size_t mask = map->capacity - 1;
+    size_t pos = hashmap_h1(hash) & mask;
+    for (;;) {
+        uint empty = hashmap_group_empty(map->ctrl + pos);
+        if (empty) {
+            return (pos + bits_least_significant(empty)) & mask;
+        }
+        pos = (pos + hashmap_group_size) & mask;
+    }
+}
+
+// Smallest capacity that holds the given number of entries or zero when the
+// table would not fit in memory
+static size_t hashmap_capacity_for(size_t count) {
+    size_t capacity = hashmap_group_size;
+    while (hashmap_max_len(capacity) < count) {
+        if (capacity > SIZE_MAX / 2) {
+            return 0;
+        }
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+bool hashmap_init_ut(
+    hashmap *map,
+    size_t capacity,
+    size_t value_size,
+    size_t value_align,
+    allocator *allocator
+) {
+    assert(map && "map must not be null");
+    assert(allocator && "allocator must not be null");
+    assert(is_power_of_two(value_align) && "alignment must be power of two");
+
+    map->ctrl = NULL;
+    map->entries = NULL;
+    map->capacity = 0;
+    map->len = 0;
+    map->value_offset = align_to_nearest(sizeof(hashmap_slot), value_align);
+    map->value_size = value_size;
+    map->entry_align = max(value_align, alignof(hashmap_slot));
+    map->entry_size =
+        align_to_nearest(map->value_offset + value_size, map->entry_align);
+    map->seed = hashmap_default_seed;
+    map->alloc_size = 0;
+    map->allocator = allocator;
+
+    if (capacity == 0) {
+        return true;
+    }
+    return hashmap_rehash(map, capacity);
+}
+
+static void hashmap_free_table(hashmap *map) {
+    if (!map->ctrl) {
+        return;
+    }
+    allocation a = {
+        .ptr = map->ctrl,
+        .len = map->alloc_size,
+    };
+    alloc_free(map->allocator, a);
+}
+
+void hashmap_free(hashmap *map) {
+    assert(map && "map must not be null");
+    hashmap_free_table(map);
+    map->ctrl = NULL;
+    map->entries = NULL;
+    map->capacity = 0;
+    map->len = 0;
+    map->alloc_size = 0;
+}
+
+void hashmap_clear(hashmap *map) {
+    assert(map && "map must not be null");
+    if (map->capacity) {
+        bytes_set(
+            map->ctrl, hashmap_ctrl_empty, map->capacity + hashmap_group_size
+        );
+    }
+    map->len = 0;
+}
+
+bool hashmap_reserve(hashmap *map, size_t count) {
+    assert(map && "map must not be null");
+    if (count <= hashmap_max_len(map->capacity)) {
+        return true;
+    }
+    return hashmap_rehash(map, count);
+}
+
+bool hashmap_rehash(hashmap *map, size_t count) {
+    assert(map && "map must not be null");
+    size_t capacity = hashmap_capacity_for(max(count, map->len));
+    if (!capacity) {
+        return false;
+    }
+
+    size_t ctrl_size =
+        align_to_nearest(capacity + hashmap_group_size, map->entry_align);
+    if (capacity > (SIZE_MAX - ctrl_size) / map->entry_size) {
+        return false;
+    }
+    allocation a = alloc_malloc(
+        map->allocator,
+        ctrl_size + capacity * map->entry_size,
+        max(map->entry_align, (size_t)hashmap_group_size)
+    );
+    if (!allocation_exists(a)) {
+        return false;
+    }
+
+    hashmap old = *map;
+    map->ctrl = a.ptr;
+    map->entries = map->ctrl + ctrl_size;
+    map->capacity = capacity;
+    map->alloc_size = a.len;
+    bytes_set(map->ctrl, hashmap_ctrl_empty, capacity + hashmap_group_size);
+
+    for (size_t i = 0; i < old.capacity; i += 1) {
+        if (old.ctrl[i] == hashmap_ctrl_empty) {
+            continue;
+        }
+        hashmap_slot *slot = hashmap_slot_at(&old, i);
+        size_t j = hashmap_find_empty(map, slot->hash);
+        bytes_copy(hashmap_slot_at(map, j), slot, map->entry_size);
+        hashmap_set_ctrl(map, j, old.ctrl[i]);
+    }
+
+    hashmap_free_table(&old);
+    return true;
+}
+
+void *hashmap_get(const hashmap *map, slice_const key) {
+    assert(map && "map must not be null");
+    size_t i = hashmap_find(map, key, slice_hash64(key, map->seed));
+    return i == hashmap_not_found ? NULL : hashmap_value_at(map, i);
+}
+
+void *hashmap_put(hashmap *map, slice_const key, bool *inserted) {
+    assert(map && "map must not be null");
+    ullong hash = slice_hash64(key, map->seed);
+    size_t i = hashmap_find(map, key, hash);
+    if (i != hashmap_not_found) {
+        if (inserted) {
+            *inserted = false;
+        }
+        return hashmap_value_at(map, i);
+    }
+
+    if (map->len + 1 > hashmap_max_len(map->capacity)
+        && !hashmap_rehash(map, map->len + 1)) {
+        return NULL;
+    }
+    i = hashmap_find_empty(map, hash);
+    hashmap_slot *slot = hashmap_slot_at(map, i);
+    slot->key = key;
+    slot->hash = hash;
+    void *value = hashmap_value_at(map, i);
+    bytes_set(value, 0, map->value_size);
+    hashmap_set_ctrl(map, i, hashmap_h2(hash));
+    map->len += 1;
+    if (inserted) {
+        *inserted = true;
+    }
+    return value;
+}
+
+bool hashmap_remove(hashmap *map, slice_const key) {
+    assert(map && "map must not be null");
+    size_t i = hashmap_find(map, key, slice_hash64(key, map->seed));
+    if (i == hashmap_not_found) {
+        return false;
+    }
+
+    // Backward shift: move every following entry that may live in the freed
+    // slot back by one, until an empty slot ends the run of entries.
+    size_t mask = map->capacity - 1;
+    for (size_t j = (i + 1) & mask; map->ctrl[j] != hashmap_ctrl_empty;
+         j = (j + 1) & mask) {
+        size_t home = hashmap_h1(hashmap_slot_at(map, j)->hash) & mask;
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            bytes_copy(
+                hashmap_slot_at(map, i),
+                hashmap_slot_at(map, j),
+                map->entry_size
+            );
+            hashmap_set_ctrl(map, i, map->ctrl[j]);
+            i = j;
+        }
+    }
+    hashmap_set_ctrl(map, i, hashmap_ctrl_empty);
+    map->len -= 1;
+    return true;
+}
+
+void hashmap_iter_init(hashmap_iter *it, const hashmap *map) {
+    assert(it && "iterator must not be null");
+    assert(map && "map must not be null");
+    it->map = map;
+    it->index = 0;
+    it->key = slice_null;
+    it->value = NULL;
+}
+
+bool hashmap_iter_next(hashmap_iter *it) {
+    assert(it && "iterator must not be null");
+    const hashmap *map = it->map;
+    while (it->index < map->capacity) {
+        size_t i = it->index;
+        uint full = ~hashmap_group_empty(map->ctrl + i)
+            & ((1U << hashmap_group_size) - 1);
+        if (map->capacity - i < hashmap_group_size) {
+            // do not visit the mirrored control bytes
+            full &= (1U << (map->capacity - i)) - 1;
+        }
+        if (!full) {
+            it->index += hashmap_group_size;
+            continue;
+        }
+        i += bits_least_significant(full);
+        it->index = i + 1;
+        it->key = hashmap_slot_at(map, i)->key;
+        it->value = hashmap_value_at(map, i);
+        return true;
+    }
+    return false;
+}
+
+////////////////////////
+// String interning
+////////////////////////
+
+bool interner_init(
+    interner *in, size_t capacity, arena *arena, allocator *allocator
+) {
+    assert(in && "interner must not be null");
+    assert(arena && "arena must not be null");
+    in->arena = arena;
+    in->strings = dynarr_new(max(capacity, (size_t)8), slice_const, allocator);
+    if (!in->strings) {
+        return false;
+    }
+    if (!hashmap_init(&in->ids, capacity, uint, allocator)) {
+        dynarr_free(in->strings);
+        in->strings = NULL;
+        return false;
+    }
+    return true;
+}
+
+void interner_free(interner *in) {
+    assert(in && "interner must not be null");
+    hashmap_free(&in->ids);
+    dynarr_free(in->strings);
+    in->strings = NULL;
+}
+
+static uint interner_add(interner *in, slice_const s) {
+    size_t len = interner_len(in);
+    assert(len < interner_id_none && "too many interned strings");
+    if (len >= interner_id_none || !hashmap_reserve(&in->ids, len + 1)) {
+        return interner_id_none;
+    }
+
+    uchar *copy = arena_alloc(in->arena, uchar, s.len + 1);
+    if (!copy) {
+        return interner_id_none;
+    }
+    if (s.len) {
+        bytes_copy(copy, s.ptr, s.len);
+    }
+    copy[s.len] = '\0';
+    slice_const canonical = slice_const_new(copy, s.len);
+
+    slice_const *strings =
+        dynarr_push_grow(in->strings, &canonical, 1, slice_const);
+    if (!strings) {
+        return interner_id_none;
+    }
+    in->strings = strings;
+
+    // room was reserved above, so the put can not fail
+    uint *id = hashmap_put(&in->ids, canonical, NULL);
+    assert(id && "hash map must have room");
+    *id = (uint)len;
+    return *id;
+}
+
+uint interner_intern(interner *in, slice_const s) {
+    assert(in && "interner must not be null");
+    uint *id = hashmap_get(&in->ids, s);
+    if (id) {
+        return *id;
+    }
+    return interner_add(in, s);
+}
+
+slice_const interner_intern_slice(interner *in, slice_const s) {
+    uint id = interner_intern(in, s);
+    if (id == interner_id_none) {
+        return slice_null;
+    }
+    return in->strings[id];
+}
+
+bool interner_intern_all(
+    interner *in,
+    const slice_const *strings,
+    size_t count,
+    uint *ids,
+    interner_stats *stats
+) {
+    assert(in && "interner must not be null");
+    assert((strings || count == 0) && "strings must not be null");
+    interner_stats st = {0};
+    bool ok = true;
+
+    for (size_t i = 0; i < count; i += 1) {
+        slice_const s = strings[i];
+        uint *found = hashmap_get(&in->ids, s);
+        uint id;
+        if (found) {
+            id = *found;
+        } else {
+            id = interner_add(in, s);
+            if (id == interner_id_none) {
+                ok = false;
+                break;
+            }
+            st.added += 1;
+            st.added_bytes += s.len;
+        }
+        if (ids) {
+            ids[i] = id;
+        }
+        st.count += 1;
+        st.bytes += s.len;
+    }
+
+    if (stats) {
+        *stats = st;
+    }
+    return ok;
+}
+
+uint interner_find(const interner *in, slice_const s) {
+    assert(in && "interner must not be null");
+    const uint *id = hashmap_get(&in->ids, s);
+    return id ? *id : interner_id_none;
+}
+
+////////////////////////
+// Sorting
+////////////////////////
+
+#define sort_radix_bits 8
+#define sort_radix_buckets (1 << sort_radix_bits)
+
+// Copies floating point bits in a single load or store
+#if defined(__GNUC__) || defined(__clang__)
+#define sort_copy_bits(dest, src, n) __builtin_memcpy((dest), (src), (n))
+#else
+#define sort_copy_bits(dest, src, n) bytes_copy((dest), (src), (n))
+#endif
+
+// Turn the digit counts of a pass into bucket offsets. Returns false when all
+// keys fall into the same bucket, in which case the pass can be skipped.
+static bool sort_radix_offsets(size_t *counts, size_t len) {
+    size_t offset = 0;
+    for (size_t b = 0; b < sort_radix_buckets; b += 1) {
+        size_t count = counts[b];
+        if (count == len) {
+            return false;
+        }
+        counts[b] = offset;
+        offset += count;
+    }
+    return true;
+}
+
+// Sort unsigned keys; the sorted keys end up in keys
+static void sort_radix32(
+    uint *keys, uint *keys_tmp, uint *payload, uint *payload_tmp, size_t len
+) {
+    size_t counts[sizeof(uint)][sort_radix_buckets] = {{0}};
+    for (size_t i = 0; i < len; i += 1) {
+        uint k = keys[i];
+        for (size_t d = 0; d < sizeof(uint); d += 1) {
+            counts[d][(k >> (d * sort_radix_bits)) & 0xFF] += 1;
+        }
+    }
+
+    uint *src = keys, *dst = keys_tmp;
+    uint *src_payload = payload, *dst_payload = payload_tmp;
+    for (size_t d = 0; d < sizeof(uint); d += 1) {
+        size_t *offsets = counts[d];
+        if (!sort_radix_offsets(offsets, len)) {
+            continue;
+        }
+        uint shift = (uint)(d * sort_radix_bits);
+        if (payload) {
+            for (size_t i = 0; i < len; i += 1) {
+                size_t pos = offsets[(src[i] >> shift) & 0xFF]++;
+                dst[pos] = src[i];
+                dst_payload[pos] = src_payload[i];
+            }
+            uint *swap = src_payload;
+            src_payload = dst_payload;
+            dst_payload = swap;
+        } else {
+            for (size_t i = 0; i < len; i += 1) {
+                dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+            }
+        }
+        uint *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != keys) {
+        bytes_copy(keys, src, len * sizeof(uint));
+        if (payload) {
+            bytes_copy(payload, src_payload, len * sizeof(uint));
+        }
+    }
+}
+
+// Sort unsigned keys; the sorted keys end up in keys
+static void sort_radix64(
+    ullong *keys,
+    ullong *keys_tmp,
+    uint *payload,
+    uint *payload_tmp,
+    size_t len
+) {
+    size_t counts[sizeof(ullong)][sort_radix_buckets] = {{0}};
+    for (size_t i = 0; i < len; i += 1) {
+        ullong k = keys[i];
+        for (size_t d = 0; d < sizeof(ullong); d += 1) {
+            counts[d][(k >> (d * sort_radix_bits)) & 0xFF] += 1;
+        }
+    }
+
+    ullong *src = keys, *dst = keys_tmp;
+    uint *src_payload = payload, *dst_payload = payload_tmp;
+    for (size_t d = 0; d < sizeof(ullong); d += 1) {
+        size_t *offsets = counts[d];
+        if (!sort_radix_offsets(offsets, len)) {
+            continue;
+        }
+        uint shift = (uint)(d * sort_radix_bits);
+        if (payload) {
+            for (size_t i = 0; i < len; i += 1) {
+                size_t pos = offsets[(src[i] >> shift) & 0xFF]++;
+                dst[pos] = src[i];
+                dst_payload[pos] = src_payload[i];
+            }
+            uint *swap = src_payload;
+            src_payload = dst_payload;
+            dst_payload = swap;
+        } else {
+            for (size_t i = 0; i < len; i += 1) {
+                dst[offsets[(src[i] >> shift) & 0xFF]++] = src[i];
+            }
+        }
+        ullong *swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != keys) {
+        bytes_copy(keys, src, len * sizeof(ullong));
+        if (payload) {
+            bytes_copy(payload, src_payload, len * sizeof(uint));
+        }
+    }
+}
+
+// Map IEEE 754 bits to unsigned integers of the same order: negative numbers
+// are inverted and positive numbers get the sign bit set.
+static inline uint sort_float_to_key(uint bits) {
+    return bits ^ ((0U - (bits >> 31)) | 0x80000000U);
+}
+
+static inline uint sort_key_to_float(uint key) {
+    return key ^ (((key >> 31) - 1U) | 0x80000000U);
+}
+
+static inline ullong sort_double_to_key(ullong bits) {
+    return bits ^ ((0ULL - (bits >> 63)) | 0x8000000000000000ULL);
+}
+
+static inline ullong sort_key_to_double(ullong key) {
+    return key ^ (((key >> 63) - 1ULL) | 0x8000000000000000ULL);
+}
+
+static void sort_radix_keys32(
+    void *keys, uint *payload, size_t len, uint key_kind, uchar *scratch
+) {
+    uint *payload_tmp = (uint *)(void *)(scratch + len * sizeof(uint));
+    if (key_kind != sort_key_float) {
+        // int and uint keys can be accessed through the same type
+        uint *k = keys;
+        uint *keys_tmp = (uint *)(void *)scratch;
+        if (key_kind == sort_key_signed) {
+            for (size_t i = 0; i < len; i += 1) {
+                k[i] ^= 0x80000000U;
+            }
+        }
+        sort_radix32(k, keys_tmp, payload, payload_tmp, len);
+        if (key_kind == sort_key_signed) {
+            for (size_t i = 0; i < len; i += 1) {
+                k[i] ^= 0x80000000U;
+            }
+        }
+        return;
+    }
+
+    // float keys are copied to the scratch memory as integers
+    uint *k = (uint *)(void *)scratch;
+    uint *keys_tmp = k + len;
+    payload_tmp = keys_tmp + len;
+    uchar *bytes = keys;
+    for (size_t i = 0; i < len; i += 1) {
+        uint bits;
+        sort_copy_bits(&bits, bytes + i * sizeof(uint), sizeof(uint));
+        k[i] = sort_float_to_key(bits);
+    }
+    sort_radix32(k, keys_tmp, payload, payload_tmp, len);
+    for (size_t i = 0; i < len; i += 1) {
+        uint bits = sort_key_to_float(k[i]);
+        sort_copy_bits(bytes + i * sizeof(uint), &bits, sizeof(uint));
+    }
+}
+
+static void sort_radix_keys64(
+    void *keys, uint *payload, size_t len, uint key_kind, uchar *scratch
+) {
+    uint *payload_tmp = (uint *)(void *)(scratch + len * sizeof(ullong));
+    if (key_kind != sort_key_float) {
+        // llong and ullong keys can be accessed through the same type
+        ullong *k = keys;
+        ullong *keys_tmp = (ullong *)(void *)scratch;
+        if (key_kind == sort_key_signed) {
+            for (size_t i = 0; i < len; i += 1) {
+                k[i] ^= 0x8000000000000000ULL;
+            }
+        }
+        sort_radix64(k, keys_tmp, payload, payload_tmp, len);
+        if (key_kind == sort_key_signed) {
+            for (size_t i = 0; i < len; i += 1) {
+                k[i] ^= 0x8000000000000000ULL;
+            }
+        }
+        return;
+    }
+
+    // double keys are copied to the scratch memory as integers
+    ullong *k = (ullong *)(void *)scratch;
+    ullong *keys_tmp = k + len;
+    payload_tmp = (uint *)(void *)(keys_tmp + len);
+    uchar *bytes = keys;
+    for (size_t i = 0; i < len; i += 1) {
+        ullong bits;
+        sort_copy_bits(&bits, bytes + i * sizeof(ullong), sizeof(ullong));
+        k[i] = sort_double_to_key(bits);
+    }
+    sort_radix64(k, keys_tmp, payload, payload_tmp, len);
+    for (size_t i = 0; i < len; i += 1) {
+        ullong bits = sort_key_to_double(k[i]);
+        sort_copy_bits(bytes + i * sizeof(ullong), &bits, sizeof(ullong));
+    }
+}
+
+bool sort_radix_ut(
+    void *keys,
+    uint *payload,
+    size_t len,
+    size_t key_size,
+    uint key_kind,
+    allocator *allocator
+) {
+    assert((keys || len == 0) && "keys must not be null");
+    assert(
+        (key_size == sizeof(uint) || key_size == sizeof(ullong))
+        && "key size must be 4 or 8"
+    );
+    assert(key_kind <= sort_key_float && "unknown key kind");
+    if (len < 2) {
+        return true;
+    }
+
+    size_t key_count = key_kind == sort_key_float ? 2 : 1;
+    size_t item_size = key_count * key_size + (payload ? sizeof(uint) : 0);
+    assert(SIZE_MAX / item_size >= len && "scratch size must fit in size_t");
+    allocation scratch =
+        alloc_malloc(allocator, len * item_size, alignof(ullong));
+    if (!allocation_exists(scratch)) {
+        return false;
+    }
+
+    if (key_size == sizeof(uint)) {
+        sort_radix_keys32(keys, payload, len, key_kind, scratch.ptr);
+    } else {
+        sort_radix_keys64(keys, payload, len, key_kind, scratch.ptr);
+    }
+    alloc_free(allocator, scratch);
+    return true;
+}
+
+////////////////////////
+// Bit vector
+////////////////////////
+
+#define bitvec_op_and 0
+#define bitvec_op_or 1
+#define bitvec_op_xor 2
+#define bitvec_op_andnot 3
+
+// Combine the words from index i onwards
+static void bitvec_combine_from(
+    ullong *dest, const ullong *src, size_t len, uint op, size_t i
+) {
+    switch (op) {
+    case bitvec_op_and:
+        for (; i < len; i += 1) {
+            dest[i] &= src[i];
+        }
+        break;
+    case bitvec_op_or:
+        for (; i < len; i += 1) {
+            dest[i] |= src[i];
+        }
+        break;
+    case bitvec_op_xor:
+        for (; i < len; i += 1) {
+            dest[i] ^= src[i];
+        }
+        break;
+    case bitvec_op_andnot:
+        for (; i < len; i += 1) {
+            dest[i] &= ~src[i];
+        }
+        break;
+    default:
+        assert(false && "unknown bit vector operation");
+        break;
+    }
+}
+
+#ifndef JP_SIMD_X86
+static void
+bitvec_combine_scalar(ullong *dest, const ullong *src, size_t len, uint op) {
+    bitvec_combine_from(dest, src, len, op, 0);
+}
+#endif
+
+static size_t bitvec_count_scalar(const ullong *words, size_t len) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i += 1) {
+        count += bits_count_ones(words[i]);
+    }
+    return count;
+}
+
+#ifdef JP_SIMD_X86
+
+__attribute__((target("sse2"))) static void
+bitvec_combine_sse2(ullong *dest, const ullong *src, size_t len, uint op) {
+    size_t i = 0;
+    for (; i + 2 <= len; i += 2) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(dest + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + i));
+        switch (op) {
+        case bitvec_op_and:
+            a = _mm_and_si128(a, b);
+            break;
+        case bitvec_op_or:
+            a = _mm_or_si128(a, b);
+            break;
+        case bitvec_op_xor:
+            a = _mm_xor_si128(a, b);
+            break;
+        case bitvec_op_andnot:
+            a = _mm_andnot_si128(b, a);
+            break;
+        default:
+            break;
+        }
+        _mm_storeu_si128((__m128i *)(dest + i), a);
+    }
+    bitvec_combine_from(dest, src, len, op, i);
+}
+
+__attribute__((target("popcnt"))) static size_t
+bitvec_count_popcnt(const ullong *words, size_t len) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; i += 1) {
+        count += (size_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+__attribute__((target("avx2"))) static void
+bitvec_combine_avx2(ullong *dest, const ullong *src, size_t len, uint op) {
+    size_t i = 0;
+    for (; i + 4 <= len; i += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(dest + i));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(src + i));
+        switch (op) {
+        case bitvec_op_and:
+            a = _mm256_and_si256(a, b);
+            break;
+        case bitvec_op_or:
+            a = _mm256_or_si256(a, b);
+            break;
+        case bitvec_op_xor:
+            a = _mm256_xor_si256(a, b);
+            break;
+        case bitvec_op_andnot:
+            a = _mm256_andnot_si256(b, a);
+            break;
+        default:
+            break;
+        }
+        _mm256_storeu_si256((__m256i *)(dest + i), a);
+    }
+    bitvec_combine_from(dest, src, len, op, i);
+}
+
+// Counts the bits of every byte with two nibble lookups and sums the byte
+// counts with SAD. The byte counters can hold 31 blocks (31 * 8 < 256).
+__attribute__((target("avx2,popcnt"))) static size_t
+bitvec_count_avx2(const ullong *words, size_t len) {
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, //
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+    );
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0F);
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sums = zero;
+    size_t i = 0;
+    while (i + 4 <= len) {
+        size_t blocks = (len - i) / 4;
+        blocks = blocks > 31 ? 31 : blocks;
+        __m256i counters = zero;
+        for (size_t b = 0; b < blocks; b += 1, i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i *)(words + i));
+            __m256i lo = _mm256_and_si256(v, low_nibbles);
+            __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+            counters = _mm256_add_epi8(
+                counters,
+                _mm256_add_epi8(
+                    _mm256_shuffle_epi8(lookup, lo),
+                    _mm256_shuffle_epi8(lookup, hi)
+                )
+            );
+        }
+        sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counters, zero));
+    }
+    size_t count = (size_t)_mm256_extract_epi64(sums, 0)
+        + (size_t)_mm256_extract_epi64(sums, 1)
+        + (size_t)_mm256_extract_epi64(sums, 2)
+        + (size_t)_mm256_extract_epi64(sums, 3);
+    for (; i < len; i += 1) {
+        count += (size_t)__builtin_popcountll(words[i]);
+    }
+    return count;
+}
+
+#endif // JP_SIMD_X86
+
+typedef struct {
+    void (*combine)(ullong *, const ullong *, size_t, uint);
+    size_t (*count)(const ullong *, size_t);
+} bitvec_kernels;
+
+#ifdef JP_SIMD_X86
+static const bitvec_kernels bitvec_kernels_avx2 = {
+    bitvec_combine_avx2, bitvec_count_avx2
+};
+static const bitvec_kernels bitvec_kernels_popcnt = {
+    bitvec_combine_sse2, bitvec_count_popcnt
+};
+static const bitvec_kernels bitvec_kernels_sse2 = {
+    bitvec_combine_sse2, bitvec_count_scalar
+};
+#else
+static const bitvec_kernels bitvec_kernels_scalar = {
+    bitvec_combine_scalar, bitvec_count_scalar
+};
+#endif
+
+static const cpu_dispatch_variant bitvec_variants[] = {
+#ifdef JP_SIMD_X86
+    {cpu_feature_avx2 | cpu_feature_popcnt, &bitvec_kernels_avx2},
+    {cpu_feature_popcnt, &bitvec_kernels_popcnt},
+    {0, &bitvec_kernels_sse2},
+#else
+    {0, &bitvec_kernels_scalar},
+#endif
+};
+
+static inline const bitvec_kernels *bitvec_kernels_get(void) {
+    return cpu_dispatch_get(
+        cpu_dispatch_bitvec, bitvec_variants, countof(bitvec_variants)
+    );
+}
+
+bool bitvec_init(bitvec *b, size_t len, allocator *allocator) {
+    assert(b && "bit vector must not be null");
+    b->words = NULL;
+    b->len = len;
+    b->alloc_size = 0;
+    b->allocator = allocator;
+    size_t words = bitvec_word_count(len);
+    if (!words) {
+        return true;
+    }
+
+    allocation a = alloc_new(allocator, ullong, words);
+    if (!allocation_exists(a)) {
+        b->len = 0;
+        return false;
+    }
+    b->words = a.ptr;
+    b->alloc_size = a.len;
+    bytes_set(b->words, 0, words * sizeof(ullong));
+    return true;
+}
+
+void bitvec_free(bitvec *b) {
+    assert(b && "bit vector must not be null");
+    if (b->words) {
+        allocation a = {
+            .ptr = b->words,
+            .len = b->alloc_size,
+        };
+        alloc_free(b->allocator, a);
+    }
+    b->words = NULL;
+    b->len = 0;
+    b->alloc_size = 0;
+}
+
+void bitvec_fill(bitvec *b, bool value) {
+    assert(b && "bit vector must not be null");
+    size_t words = bitvec_word_count(b->len);
+    if (!words) {
+        return;
+    }
+    bytes_set(b->words, value ? 0xFF : 0, words * sizeof(ullong));
+    size_t tail = b->len % bitvec_word_bits;
+    if (value && tail) {
+        b->words[words - 1] = (1ULL << tail) - 1;
+    }
+}
+
+static void bitvec_combine(bitvec *dest, const bitvec *src, uint op) {
+    assert(dest && "destination must not be null");
+    assert(src && "source must not be null");
+    assert(dest->len == src->len && "bit vectors must have the same length");
+    size_t words = bitvec_word_count(min(dest->len, src->len));
+    if (words) {
+        bitvec_kernels_get()->combine(dest->words, src->words, words, op);
+    }
+}
+
+void bitvec_and(bitvec *dest, const bitvec *src) {
+    bitvec_combine(dest, src, bitvec_op_and);
+}
+
+void bitvec_or(bitvec *dest, const bitvec *src) {
+    bitvec_combine(dest, src, bitvec_op_or);
+}
+
+void bitvec_xor(bitvec *dest, const bitvec *src) {
+    bitvec_combine(dest, src, bitvec_op_xor);
+}
+
+void bitvec_andnot(bitvec *dest, const bitvec *src) {
+    bitvec_combine(dest, src, bitvec_op_andnot);
+}
+
+size_t bitvec_count(const bitvec *b) {
+    assert(b && "bit vector must not be null");
+    size_t words = bitvec_word_count(b->len);
+    if (!words) {
+        return 0;
+    }
+    return bitvec_kernels_get()->count(b->words, words);
+}
+
+llong bitvec_next_set(const bitvec *b, size_t from) {
+    assert(b && "bit vector must not be null");
+    if (from >= b->len) {
+        return -1;
+    }
+    size_t words = bitvec_word_count(b->len);
+    size_t i = from / bitvec_word_bits;
+    // ignore the bits before the start bit
+    ullong word = b->words[i] & (~0ULL << (from % bitvec_word_bits));
+    while (!word) {
+        i += 1;
+        if (i >= words) {
+            return -1;
+        }
+        word = b->words[i];
+    }
+    return (llong)(i * bitvec_word_bits + bits_least_significant(word));
+}
+
+////////////////////////
+// C strings
+////////////////////////
+
+bool cstr_eq_unsafe(const char *s1, const char *s2) {
+    if (s1 == s2) {
+        return 1;
+    }
+    if (!s1 || !s2) {
+        return 0;
+    }
+
+    size_t len = 0;
+    while (s1[len] && s2[len]) {
+        if (s1[len] != s2[len]) {
+            return 0;
+        }
+        len += 1;
+    }
+    if (s1[len] != s2[len]) {
+        return 0;
+    }
+
+    return 1;
+}
+
+bool cstr_eq(const char *s1, const char *s2, size_t len) {
+    if (s1 == s2) {
+        return 1;
+    }
+    if (!s1 || !s2) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < len; i += 1) {
+        if (s1[i] != s2[i]) {
+            return 0;
+        }
+        if (!s1[i] && !s2[i]) {
+            break;
+        }
+    }
+
+    return 1;
+}
+
+size_t cstr_byte_len_unsafe(const char *str) {
+    if (!str) {
+        return 0;
+    }
+    size_t len = 0;
+    while (str[len]) { len += 1; }
+    return len;
+}
+
+size_t cstr_byte_len(const char *str, size_t capacity) {
+    if (!str) {
+        return 0;
+    }
+    size_t len = 0;
+    while (str[len] && len < capacity) { len += 1; }
+    if (len + 1 < capacity) {
+        len += 1;
+    }
+    return len;
+}
+
+void cstr_split_init_chars(
+    cstr_split *s, slice str, slice_const *split_chars, uint flags
+) {
+    assert(s && "split struct must not be null");
+
+    assert(split_chars && "split chars must not be null");
+
+    bytes_set(s, 0, sizeof(*s));
+    s->str = str;
+    s->flags = flags;
+
+    // Multi-byte UTF-8 characters never contain ASCII bytes, so scanning
+    // bytes for ASCII split characters finds the same character breaks.
+    bool ascii_only = bitset_is_set(flags, cstr_split_flag_utf8);
+    for (size_t i = 0; i < split_chars->len; i += 1) {
+        uchar c = split_chars->ptr[i];
+        if (!ascii_only || c < 0x80) {
+            byteset_add(&s->split_set, c);
+        }
+    }
+}
+
+void cstr_split_init(
+    cstr_split *split,
+    slice str,
+    cstr_split_predicate fn,
+    void *fn_state,
+    uint flags
+) {
+    assert(split && "split struct must not be null");
+
+    bytes_set(split, 0, sizeof(*split));
+    split->str = str;
+    split->predicate = fn;
+    split->predicate_data = fn_state;
+    split->flags = flags;
+}
+
+slice_const cstr_split_next(cstr_split *s) {
+    assert(s && "split struct must not be null");
+    assert(s->str.ptr && "string must not be null");
+
+    if (!slice_is_set(s->str) || s->index >= s->str.len) {
+        return slice_null;
+    }
+
+    size_t start_index = s->index;
+    uchar *ptr = s->str.ptr + start_index;
+
+    size_t split_at = 0;
+    bool found = false;
+    if (s->predicate == NULL) {
+        llong i = bytes_index_of_any(
+            ptr, s->str.len - start_index, &s->split_set
+        );
+        if (i >= 0) {
+            found = true;
+            split_at = start_index + (size_t)i;
+            s->index = split_at + 1;
+        } else {
+            s->index = s->str.len;
+        }
+    } else if (bitset_is_set(s->flags, cstr_split_flag_utf8)) {
+        while (s->index < s->str.len) {
+            uchar *ch = s->str.ptr + s->index;
+            size_t ch_len = utf8_next_char_break(ch, s->str.len - s->index);
+            if (!ch_len) {
+                return slice_null;
+            }
+            bool ok = s->predicate(ch, ch_len, s->predicate_data);
+            if (ok) {
+                found = true;
+                split_at = s->index;
+                s->index += ch_len;
+                break;
+            }
+            s->index += ch_len;
+        }
+    } else {
+        while (s->index < s->str.len) {
+            uchar ch = s->str.ptr[s->index];
+            bool ok = s->predicate(&ch, sizeof(ch), s->predicate_data);
+            if (ok) {
+                found = true;
+                split_at = s->index;
+                s->index += 1;
+                break;
+            }
+            s->index += 1;
+        }
+    }
+
+    size_t len;
+    if (!found) {
+        len = s->str.len - start_index;
+    } else {
+        len = split_at - start_index;
+        if (bitset_is_set(s->flags, cstr_split_flag_null_terminate)) {
+            s->str.ptr[split_at] = '\0';
+        }
+    }
+
+    return slice_const_new(ptr, len);
+}
+
+size_t cstr_split_collect(cstr_split *s, slice_const *arr, size_t len) {
+    assert(arr && "array must not be null");
+    assert(s && "split must not be null");
+
+    size_t i = 0;
+    for (; i < len; i += 1) {
+        slice_const slice = cstr_split_next(s);
+        if (!slice.ptr) {
+            break;
+        }
+        arr[i] = slice;
+    }
+    return i;
+}
+
+size_t cstr_split_collect_strings(cstr_split *s, const char **strings, size_t len) {
+    assert(strings && "strings must not be null");
+    assert(s && "split must not be null");
+
+    uint flags = s->flags;
+    bitset_set_mut(s->flags, cstr_split_flag_null_terminate);
+
+    size_t i = 0;
+    for (; i < len; i += 1) {
+        slice_const slice = cstr_split_next(s);
+        if (!slice.ptr) {
+            break;
+        }
+        strings[i] = (const char *)slice.ptr;
+    }
+
+    s->flags = flags;
+    return i;
+}
+
+bool cstr_split_predicate_chars_ascii(const uchar *c, size_t len, void *state) {
+    assert(c && "character must not be null");
+    assert(state && "state must not be null (expected split chars)");
+    if (len == 0 || len > 1) {
+        return false;
+    }
+    slice_const *split_chars = state;
+    return bytes_index_of_byte(split_chars->ptr, split_chars->len, *c) >= 0;
+}
+
+bool cstr_split_predicate_ascii_whitespace(
+    const uchar *c, size_t len, void *state
+) {
+    assert(c && "string must not be null");
+    (void)state;
+
+    if (len > sizeof(char)) {
+        return false;
+    }
+    switch (*c) {
+    case ' ':
+    case '\n':
+    case '\t':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool cstr_split_predicate_ascii_punctuation(
+    const uchar *c, size_t len, void *state
+) {
+    assert(c && "string must not be null");
+    (void)state;
+
+    if (len > sizeof(char)) {
+        return false;
+    }
+    if (*c >= ' ' && *c <= '/') {
+        return true;
+    }
+    if (*c >= ':' && *c <= '@') {
+        return true;
+    }
+    if (*c >= '[' && *c <= '`') {
+        return true;
+    }
+    if (*c >= '{' && *c <= '~') {
+        return true;
+    }
+    return false;
+}
+
+bool cstr_match_wild_ascii(
+    const char *txt, size_t txt_len, const char *pat, size_t pat_len
+) {
+    size_t i = 0, j = 0, start_index = 0, match = 0;
+    bool start_index_set = 0;
+
+    while (i < txt_len) {
+        if (j < pat_len && (pat[j] == '?' || pat[j] == txt[i])) {
+            i += 1;
+            j += 1;
+        } else if (j < pat_len && pat[j] == '*') {
+            start_index = j;
+            start_index_set = 1;
+            match = i;
+            j += 1;
+        } else if (start_index_set) {
+            j = start_index + 1;
+            match += 1;
+            i = match;
+        } else {
+            return 0;
+        }
+    }
+
+    while (j < pat_len && pat[j] == '*') { j += 1; }
+
+    return j == pat_len;
+}
+
+bool char_is_digit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+size_t cstr_to_int(const char *s, size_t len, int *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    size_t bytes_parsed = 0;
+    size_t i = 0;
+    int v_ = 0;
+    int sign = 1;
+
+    if (s[0] == '-') {
+        i += 1;
+        sign = -1;
+        bytes_parsed += 1;
+    }
+
+    for (; i < len && char_is_digit(s[i]); i += 1) {
+        int n = s[i] - '0';
+        if ((INT_MAX - n) / 10 < v_) {
+            // exceeds int size
+            return 0;
+        }
+        v_ *= 10;
+        v_ += n;
+        bytes_parsed += 1;
+    }
+
+    *v = sign * v_;
+    return bytes_parsed;
+}
+
+size_t cstr_to_uint(const char *s, size_t len, uint *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    size_t bytes_parsed = 0;
+    uint v_ = 0;
+
+    for (size_t i = 0; i < len && char_is_digit(s[i]); i += 1) {
+        uint n = (uchar)s[i] - '0';
+        if ((UINT_MAX - n) / 10 < v_) {
+            // exceeds int size
+            return 0;
+        }
+        v_ *= 10;
+        v_ += n;
+        bytes_parsed += 1;
+    }
+
+    *v = v_;
+    return bytes_parsed;
+}
+
+size_t cstr_to_llong(const char *s, size_t len, llong *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    size_t bytes_parsed = 0;
+    size_t i = 0;
+    llong v_ = 0;
+    llong sign = 1;
+
+    if (s[0] == '-') {
+        i += 1;
+        sign = -1;
+        bytes_parsed += 1;
+    }
+
+    for (; i < len && char_is_digit(s[i]); i += 1) {
+        llong n = s[i] - '0';
+        if ((LLONG_MAX - n) / 10 < v_) {
+            // exceeds int size
+            return 0;
+        }
+        v_ *= 10;
+        v_ += n;
+        bytes_parsed += 1;
+    }
+
+    *v = sign * v_;
+    return bytes_parsed;
+}
+
+size_t cstr_to_ullong(const char *s, size_t len, ullong *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    size_t bytes_parsed = 0;
+    ullong v_ = 0;
+
+    for (size_t i = 0; i < len && char_is_digit(s[i]); i += 1) {
+        ullong n = (uchar)s[i] - '0';
+        if ((ULLONG_MAX - n) / 10 < v_) {
+            // exceeds int size
+            return 0;
+        }
+        v_ *= 10;
+        v_ += n;
+        bytes_parsed += 1;
+    }
+
+    *v = v_;
+    return bytes_parsed;
+}
+
+static const double pow10_double[] = {
+    1e0,   1e1,   1e2,   1e3,   1e4,   1e5,   1e6,   1e7,   1e8,   1e9,   1e10,
+    1e11,  1e12,  1e13,  1e14,  1e15,  1e16,  1e17,  1e18,  1e19,  1e20,  1e21,
+    1e22,  1e23,  1e24,  1e25,  1e26,  1e27,  1e28,  1e29,  1e30,  1e31,  1e32,
+    1e33,  1e34,  1e35,  1e36,  1e37,  1e38,  1e39,  1e40,  1e41,  1e42,  1e43,
+    1e44,  1e45,  1e46,  1e47,  1e48,  1e49,  1e50,  1e51,  1e52,  1e53,  1e54,
+    1e55,  1e56,  1e57,  1e58,  1e59,  1e60,  1e61,  1e62,  1e63,  1e64,  1e65,
+    1e66,  1e67,  1e68,  1e69,  1e70,  1e71,  1e72,  1e73,  1e74,  1e75,  1e76,
+    1e77,  1e78,  1e79,  1e80,  1e81,  1e82,  1e83,  1e84,  1e85,  1e86,  1e87,
+    1e88,  1e89,  1e90,  1e91,  1e92,  1e93,  1e94,  1e95,  1e96,  1e97,  1e98,
+    1e99,  1e100, 1e101, 1e102, 1e103, 1e104, 1e105, 1e106, 1e107, 1e108, 1e109,
+    1e110, 1e111, 1e112, 1e113, 1e114, 1e115, 1e116, 1e117, 1e118, 1e119, 1e120,
+    1e121, 1e122, 1e123, 1e124, 1e125, 1e126, 1e127, 1e128, 1e129, 1e130, 1e131,
+    1e132, 1e133, 1e134, 1e135, 1e136, 1e137, 1e138, 1e139, 1e140, 1e141, 1e142,
+    1e143, 1e144, 1e145, 1e146, 1e147, 1e148, 1e149, 1e150, 1e151, 1e152, 1e153,
+    1e154, 1e155, 1e156, 1e157, 1e158, 1e159, 1e160, 1e161, 1e162, 1e163, 1e164,
+    1e165, 1e166, 1e167, 1e168, 1e169, 1e170, 1e171, 1e172, 1e173, 1e174, 1e175,
+    1e176, 1e177, 1e178, 1e179, 1e180, 1e181, 1e182, 1e183, 1e184, 1e185, 1e186,
+    1e187, 1e188, 1e189, 1e190, 1e191, 1e192, 1e193, 1e194, 1e195, 1e196, 1e197,
+    1e198, 1e199, 1e200, 1e201, 1e202, 1e203, 1e204, 1e205, 1e206, 1e207, 1e208,
+    1e209, 1e210, 1e211, 1e212, 1e213, 1e214, 1e215, 1e216, 1e217, 1e218, 1e219,
+    1e220, 1e221, 1e222, 1e223, 1e224, 1e225, 1e226, 1e227, 1e228, 1e229, 1e230,
+    1e231, 1e232, 1e233, 1e234, 1e235, 1e236, 1e237, 1e238, 1e239, 1e240, 1e241,
+    1e242, 1e243, 1e244, 1e245, 1e246, 1e247, 1e248, 1e249, 1e250, 1e251, 1e252,
+    1e253, 1e254, 1e255, 1e256, 1e257, 1e258, 1e259, 1e260, 1e261, 1e262, 1e263,
+    1e264, 1e265, 1e266, 1e267, 1e268, 1e269, 1e270, 1e271, 1e272, 1e273, 1e274,
+    1e275, 1e276, 1e277, 1e278, 1e279, 1e280, 1e281, 1e282, 1e283, 1e284, 1e285,
+    1e286, 1e287, 1e288, 1e289, 1e290, 1e291, 1e292, 1e293, 1e294, 1e295, 1e296,
+    1e297, 1e298, 1e299, 1e300, 1e301, 1e302, 1e303, 1e304, 1e305, 1e306, 1e307,
+    1e308
+};
+
+static const ullong pow10_ullong[] = {
+    1e0L,
+    1e1L,
+    1e2L,
+    1e3L,
+    1e4L,
+    1e5L,
+    1e6L,
+    1e7L,
+    1e8L,
+    1e9L,
+    1e10L,
+    1e11L,
+    1e12L,
+    1e13L,
+    1e14L,
+    1e15L,
+    1e16L,
+    1e17L,
+    1e18L
+};
+
+size_t cstr_to_float(const char *s, size_t len, float *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    ullong integer = 0;
+    ullong decimals = 0;
+    float fraction = 0.0;
+    float sign = 1.0;
+    ullong exp = 0;
+    size_t i = 0;
+
+    if (i < len && s[0] == '-') {
+        i += 1;
+        sign = -1.0;
+    } else if (i < len && s[0] == '+') {
+        i += 1;
+    }
+
+    // integer part
+    for (; i < len && char_is_digit(s[i]); i += 1) {
+        ullong n = (uchar)s[i] - '0';
+        if ((INT64_MAX - n) / 10 < integer) {
+            // exceeds int size
+            return 0;
+        }
+        integer *= 10;
+        integer += n;
+    }
+
+    // decimals
+    if (i < len && s[i] == '.') {
+        i += 1;
+        float divisor = 10.0;
+        for (; i < len && char_is_digit(s[i]); i += 1) {
+            ullong n = (uchar)s[i] - '0';
+            if ((INT64_MAX - n) / 10 < integer) {
+                // exceeds int size, use fractions instead
+                fraction += (float)(s[i] - '0') / divisor;
+                divisor *= 10.0f;
+                return 0;
+            } else {
+                integer *= 10;
+                integer += n;
+                decimals += 1;
+            }
+        }
+    }
+
+    // exponent
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i += 1;
+
+        int exp_sign = 1;
+        if (i < len && s[i] == '-') {
+            exp_sign = -1;
+            i += 1;
+        } else if (i < len && s[i] == '+') {
+            i += 1;
+        }
+
+        for (; i < len && char_is_digit(s[i]); i += 1) {
+            ullong n = (uchar)s[i] - '0';
+            if ((INT64_MAX - n) / 10 < exp) {
+                // exceeds int size
+                return 0;
+            }
+            exp *= 10;
+            exp += n;
+        }
+
+        assert(exp_sign != 0 && "exp_sign must not be zero");
+        if (exp_sign > 0) {
+            ullong decimals_to_reduce = min(decimals, exp);
+            decimals -= decimals_to_reduce;
+            exp -= decimals_to_reduce;
+        } else if (exp_sign < 0) {
+            if ((INT64_MAX - exp < decimals)) {
+                // exceeds int size
+                return 0;
+            }
+            decimals += exp;
+            exp = 0;
+        }
+
+        if (exp > FLT_MAX_10_EXP) {
+            // exceeds max exponent
+            return 0;
+        }
+    }
+
+    // collect results
+    float v_ = (float)integer;
+    if (v_ > FLT_MAX / (float)pow10_double[exp]) {
+        // exceeds float max
+        return 0;
+    }
+    v_ *= (float)pow10_double[exp];
+    v_ /= (float)pow10_double[decimals];
+    if (v_ > FLT_MAX - fraction) {
+        // exceeds float max
+        return 0;
+    }
+    v_ += fraction;
+    v_ *= sign;
+
+    *v = v_;
+    return i;
+}
+
+size_t cstr_to_double(const char *s, size_t len, double *v) {
+    assert(s && "string must not be null");
+    assert(len && "length must be 1 or more");
+    assert(v && "value storage must not be null");
+    if (!s || !len || !v) {
+        return 0;
+    }
+    ullong integer = 0;
+    ullong decimals = 0;
+    double fraction = 0.0;
+    float sign = 1.0;
+    ullong exp = 0;
+    size_t i = 0;
+
+    if (i < len && s[0] == '-') {
+        i += 1;
+        sign = -1.0;
+    } else if (i < len && s[0] == '+') {
+        i += 1;
+    }
+
+    // integer part
+    for (; i < len && char_is_digit(s[i]); i += 1) {
+        ullong n = (uchar)s[i] - '0';
+        if ((INT64_MAX - n) / 10 < integer) {
+            // exceeds int size
+            return 0;
+        }
+        integer *= 10;
+        integer += n;
+    }
+
+    // decimals
+    if (i < len && s[i] == '.') {
+        i += 1;
+        double divisor = 10.0;
+        for (; i < len && char_is_digit(s[i]); i += 1) {
+            ullong n = (uchar)s[i] - '0';
+            if ((INT64_MAX - n) / 10 < integer) {
+                // exceeds int size, use fractions instead
+                fraction += (double)(s[i] - '0') / divisor;
+                divisor *= 10.0;
+                return 0;
+            } else {
+                integer *= 10;
+                integer += n;
+                decimals += 1;
+            }
+        }
+    }
+
+    // exponent
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i += 1;
+
+        int exp_sign = 1;
+        if (i < len && s[i] == '-') {
+            exp_sign = -1;
+            i += 1;
+        } else if (i < len && s[i] == '+') {
+            i += 1;
+        }
+
+        for (; i < len && char_is_digit(s[i]); i += 1) {
+            ullong n = (uchar)s[i] - '0';
+            if ((INT64_MAX - n) / 10 < exp) {
+                // exceeds int size
+                return 0;
+            }
+            exp *= 10;
+            exp += n;
+        }
+
+        assert(exp_sign != 0 && "exp_sign must not be zero");
+        if (exp_sign > 0) {
+            ullong decimals_to_reduce = min(decimals, exp);
+            decimals -= decimals_to_reduce;
+            exp -= decimals_to_reduce;
+        } else if (exp_sign < 0) {
+            if ((INT64_MAX - exp < decimals)) {
+                // exceeds int size
+                return 0;
+            }
+            decimals += exp;
+            exp = 0;
+        }
+
+        if (exp > DBL_MAX_10_EXP) {
+            // exceeds max exponent
+            return 0;
+        }
+    }
+
+    // collect results
+    double v_ = (double)integer;
+    if (v_ > DBL_MAX / pow10_double[exp]) {
+        // exceeds double max
+        return 0;
+    }
+    v_ *= pow10_double[exp];
+    v_ /= pow10_double[decimals];
+    if (v_ > DBL_MAX - fraction) {
+        // exceeds double max
+        return 0;
+    }
+    v_ += fraction;
+    v_ *= sign;
+
+    *v = v_;
+    return i;
+}
+
+#define cstr_int_max_len 16
+#define cstr_uint_max_len 16
+#define cstr_llong_max_len 32
+#define cstr_ullong_max_len 32
+
+static size_t cstr_from_int_unsafe(char *cursor, int src) {
+    char *start = cursor;
+    bool is_neg = src < 0;
+    if (is_neg) {
+        src = -src;
+    }
+
+    do {
+        cursor -= 1;
+        *cursor = '0' + (char)(src % 10);
+        src /= 10;
+    } while (src > 0);
+    if (is_neg) {
+        cursor -= 1;
+        *cursor = '-';
+    }
+
+    return (size_t)(start - cursor);
+}
+
+size_t cstr_from_int(char *dest, size_t len, int src) {
+    assert(dest && "dest must not be null");
+    assert(len > 0 && "len must be more than 0");
+
+    char tmp[cstr_int_max_len];
+    char *end = tmp + sizeof(tmp);
+    size_t bytes_to_copy = cstr_from_int_unsafe(end, src);
+
+    if (len < bytes_to_copy) {
+        return 0;
+    }
+
+    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
+    return bytes_to_copy;
+}
+
+static size_t cstr_from_uint_unsafe(char *cursor, uint src) {
+    char *start = cursor;
+
+    do {
+        cursor -= 1;
+        *cursor = '0' + (char)(src % 10);
+        src /= 10;
+    } while (src > 0);
+
+    return (size_t)(start - cursor);
+}
+
+size_t cstr_from_uint(char *dest, size_t len, uint src) {
+    assert(dest && "dest must not be null");
+    assert(len > 0 && "len must be more than 0");
+
+    char tmp[cstr_uint_max_len];
+    char *end = tmp + sizeof(tmp);
+    size_t bytes_to_copy = cstr_from_uint_unsafe(end, src);
+
+    if (len < bytes_to_copy) {
+        return 0;
+    }
+
+    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
+    return bytes_to_copy;
+}
+
+static size_t cstr_from_llong_unsafe(char *cursor, llong src) {
+    char *start = cursor;
+    bool is_neg = src < 0;
+    if (is_neg) {
+        src = -src;
+    }
+
+    do {
+        cursor -= 1;
+        *cursor = '0' + (char)(src % 10);
+        src /= 10;
+    } while (src > 0);
+    if (is_neg) {
+        cursor -= 1;
+        *cursor = '-';
+    }
+
+    return (size_t)(start - cursor);
+}
+
+size_t cstr_from_llong(char *dest, size_t len, llong src) {
+    assert(dest && "dest must not be null");
+    assert(len > 0 && "len must be more than 0");
+
+    char tmp[cstr_llong_max_len];
+    char *end = tmp + sizeof(tmp);
+    size_t bytes_to_copy = cstr_from_llong_unsafe(end, src);
+
+    if (len < bytes_to_copy) {
+        return 0;
+    }
+
+    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
+    return bytes_to_copy;
+}
+
+static size_t cstr_from_ullong_unsafe(char *cursor, ullong src) {
+    char *start = cursor;
+
+    do {
+        cursor -= 1;
+        *cursor = '0' + (char)(src % 10);
+        src /= 10;
+    } while (src > 0);
+
+    return (size_t)(start - cursor);
+}
+
+size_t cstr_from_ullong(char *dest, size_t len, ullong src) {
+    assert(dest && "dest must not be null");
+    assert(len > 0 && "len must be more than 0");
+
+    char tmp[cstr_ullong_max_len];
+    char *end = tmp + sizeof(tmp);
+    size_t bytes_to_copy = cstr_from_ullong_unsafe(end, src);
+
+    if (len < bytes_to_copy) {
+        return 0;
+    }
+
+    bytes_copy(dest, end - bytes_to_copy, bytes_to_copy);
+    return bytes_to_copy;
+}
+
+struct cstr_from_real_parts {
+    char *integer_cursor;
+    char *fractional_cursor;
+    size_t integer_len;
+    size_t fractional_len;
+    uint decimal_zeros;
+    bool is_neg;
+    bool is_inf;
+};
+
+static size_t cstr_from_real_parts_len(struct cstr_from_real_parts *parts) {
+    size_t neg_len = parts->is_neg ? 1UL : 0UL;
+    if (parts->is_inf) {
+        return neg_len + 3; // len('inf') == 3
+    }
+
+    return neg_len + parts->integer_len + 1 + parts->decimal_zeros
+        + parts->fractional_len;
+}
+
+static void
+cstr_from_real_parts_to_buf(struct cstr_from_real_parts *parts, char *dest) {
+    if (parts->is_inf) {
+        const char *text = "inf";
+        size_t bytes_to_write = sizeof("inf") - 1;
+        if (parts->is_neg) {
+            text = "-inf";
+            bytes_to_write = sizeof("-inf") - 1;
+        }
+        bytes_copy(dest, text, bytes_to_write);
+        return;
+    }
+
+    char *cursor = dest;
+    if (parts->is_neg) {
+        cursor[0] = '-';
+        cursor += 1;
+    }
+    bytes_copy(
+        cursor, parts->integer_cursor - parts->integer_len, parts->integer_len
+    );
+    cursor += parts->integer_len;
+    cursor[0] = '.';
+    cursor += 1;
+    for (uint i = 0; i < parts->decimal_zeros; i += 1) { cursor[i] = '0'; }
+    cursor += parts->decimal_zeros;
+    bytes_copy(
+        cursor,
+        parts->fractional_cursor - parts->fractional_len,
+        parts->fractional_len
+    );
+    cursor += parts->fractional_len;
+
+    assert((size_t)(cursor - dest) == cstr_from_real_parts_len(parts));
+    return;
+}
+
+static uint count_decimal_zeros(ullong fractional, uint decimals) {
+    ullong precision_ullong = pow10_ullong[decimals];
+    uint decimal_zeros = 0;
+    for (ullong i = precision_ullong / 10; i > 1; i /= 10) {
+        if (i > fractional) {
+            decimal_zeros += 1;
+        } else {
+            break;
+        }
+    }
+    return decimal_zeros;
+}
+
+static void cstr_from_float_parts(
+    struct cstr_from_real_parts *parts, float src, uint decimals
+) {
+    assert(parts->integer_cursor && "integer cursor must not be null");
+    assert(parts->fractional_cursor && "integer cursor must not be null");
+    assert(decimals <= 9 && "decimals up to 9 are supported");
+
+    if (decimals > 9) {
+        decimals = 9;
+    }
+
+    if (src < 0) {
+        parts->is_neg = 1;
+        src = -src;
+    }
+
+    double precision_d = pow10_double[decimals];
+    src += (float)(0.5 / precision_d);
+
+    // infinity check
+    if (src >= (float)(-1UL >> 1)) {
+        parts->is_inf = 1;
+        return;
+    }
+
+    // integer part
+    ullong integer = (ullong)src;
+    parts->integer_len =
+        cstr_from_ullong_unsafe(parts->integer_cursor, integer);
+
+    // fractional part
+    ullong fractional = (ullong)(((double)src - (double)integer) * precision_d);
+    parts->decimal_zeros = count_decimal_zeros(fractional, decimals);
+    parts->fractional_len =
+        cstr_from_ullong_unsafe(parts->fractional_cursor, fractional);
+}
+
+size_t cstr_from_float(char *dest, size_t len, float src, uint decimals) {
+    assert(dest && "dest must not be null");
+    assert(len > 2 && "len must be more than 2");
+
+    if (len < 3) {
+        return 0;
+    }
+
+    char integer_cstr[cstr_ullong_max_len];
+    char fractional_cstr[cstr_ullong_max_len];
+    struct cstr_from_real_parts parts = {0};
+    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
+    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
+    cstr_from_float_parts(&parts, src, decimals);
+    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+
+    if (bytes_to_write > len) {
+        return 0;
+    }
+
+    cstr_from_real_parts_to_buf(&parts, dest);
+    return bytes_to_write;
+}
+
+static void cstr_from_double_parts(
+    struct cstr_from_real_parts *parts, double src, uint decimals
+) {
+    assert(parts->integer_cursor && "integer cursor must not be null");
+    assert(parts->fractional_cursor && "integer cursor must not be null");
+    assert(decimals <= 18 && "decimals up to 18 are supported");
+
+    if (decimals > 18) {
+        decimals = 18;
+    }
+
+    if (src < 0) {
+        parts->is_neg = 1;
+        src = -src;
+    }
+
+    double precision_d = pow10_double[decimals];
+    src += 0.5 / precision_d;
+
+    // infinity check
+    if (src >= (double)(-1UL >> 1)) {
+        parts->is_inf = 1;
+        return;
+    }
+
+    // integer part
+    ullong integer = (ullong)src;
+    parts->integer_len =
+        cstr_from_ullong_unsafe(parts->integer_cursor, integer);
+
+    // fractional part
+    ullong fractional = (ullong)((src - (double)integer) * precision_d);
+    parts->decimal_zeros = count_decimal_zeros(fractional, decimals);
+    parts->fractional_len =
+        cstr_from_ullong_unsafe(parts->fractional_cursor, fractional);
+}
+
+size_t cstr_from_double(char *dest, size_t len, double src, uint decimals) {
+    assert(dest && "dest must not be null");
+    assert(len > 2 && "len must be more than 2");
+
+    if (len < 3) {
+        return 0;
+    }
+
+    char integer_cstr[cstr_ullong_max_len];
+    char fractional_cstr[cstr_ullong_max_len];
+    struct cstr_from_real_parts parts = {0};
+    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
+    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
+    cstr_from_double_parts(&parts, src, decimals);
+    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+
+    if (bytes_to_write > len) {
+        return 0;
+    }
+
+    cstr_from_real_parts_to_buf(&parts, dest);
+    return bytes_to_write;
+}
+
+size_t cstr_len_int(int src) {
+    size_t len = 0;
+    if (src < 0) {
+        len += 1;
+        src = -src;
+    }
+    do {
+        len += 1;
+        src /= 10;
+    } while (src > 0);
+    return len;
+}
+
+size_t cstr_len_uint(uint src) {
+    size_t len = 0;
+    do {
+        len += 1;
+        src /= 10;
+    } while (src > 0);
+    return len;
+}
+
+size_t cstr_len_llong(llong src) {
+    size_t len = 0;
+    if (src < 0) {
+        len += 1;
+        src = -src;
+    }
+    do {
+        len += 1;
+        src /= 10;
+    } while (src > 0);
+    return len;
+}
+
+size_t cstr_len_ullong(ullong src) {
+    size_t len = 0;
+    do {
+        len += 1;
+        src /= 10;
+    } while (src > 0);
+    return len;
+}
+
+size_t cstr_len_float(float src, uint decimals) {
+    assert(decimals < 19 && "decimals up to 19 are supported");
+
+    size_t len = 0;
+    if (src < 0) {
+        len += 1;
+        src = -src;
+    }
+
+    double precision_d = pow10_double[decimals];
+
+    src += 0.5f / (float)precision_d;
+    if (src >= (float)(-1UL >> 1)) {
+        return len + sizeof("inf") - 1;
+    }
+
+    // integer part
+    ullong integer = (ullong)src;
+    len += cstr_len_ullong(integer);
+
+    // decimal point
+    len += 1;
+
+    // fractional part
+    ullong fractional = (ullong)((src - (double)integer) * precision_d);
+    len += count_decimal_zeros(fractional, decimals);
+    len += cstr_len_ullong(fractional);
+
+    return len;
+}
+
+size_t cstr_len_double(double src, uint decimals) {
+    assert(decimals < 19 && "decimals up to 19 are supported");
+
+    size_t len = 0;
+    if (src < 0) {
+        len += 1;
+        src = -src;
+    }
+
+    double precision_d = pow10_double[decimals];
+
+    src += 0.5 / precision_d;
+    if (src >= (double)(-1UL >> 1)) {
+        return len + sizeof("inf") - 1;
+    }
+
+    // integer part
+    ullong integer = (ullong)src;
+    len += cstr_len_ullong(integer);
+
+    // decimal point
+    len += 1;
+
+    // fractional part
+    ullong fractional = (ullong)((src - (double)integer) * precision_d);
+    len += count_decimal_zeros(fractional, decimals);
+    len += cstr_len_ullong(fractional);
+
+    return len;
+}
+
+cstr_fmt_result cstr_fmt_va(
+    char *restrict dest,
+    size_t len,
+    const char *restrict format,
+    va_list va_args
+) {
+    assert(dest && "dest must not be null");
+    assert(len > 0 && "len must be higher than 0");
+    assert(format && "format must not be null");
+
+    cstr_fmt_result res = {
+        .ok = 1,
+        .len = 0,
+    };
+    size_t bytes_written = 0;
+
+    if (!format || !len) {
+        res.ok = 0;
+        return res;
+    }
+
+    slice_const s;
+    size_t field_bytes = 0;
+    cstr_fmt_float fmt_float;
+    while (res.ok && bytes_written < len && *format != '\0') {
+        switch (*format) {
+        case 'c':
+            dest[bytes_written] = (char)va_arg(va_args, int);
+            field_bytes = 1;
+            break;
+        case 's':
+            s = va_arg(va_args, slice_const);
+            field_bytes = min(s.len, len - bytes_written);
+            bytes_copy(dest + bytes_written, s.ptr, field_bytes);
+            res.ok = s.len <= len - bytes_written;
+            break;
+        case 'S':
+            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
+            field_bytes = min(s.len, len - bytes_written);
+            bytes_copy(dest + bytes_written, s.ptr, field_bytes);
+            res.ok = s.len <= len - bytes_written;
+            break;
+        case 'h':
+            s = va_arg(va_args, slice_const);
+            field_bytes = bytes_to_hex(
+                dest + bytes_written,
+                len - bytes_written,
+                (const char *)s.ptr,
+                s.len
+            );
+            res.ok = s.len * 2 <= len - bytes_written;
+            break;
+        case 'H':
+            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
+            field_bytes = bytes_to_hex(
+                dest + bytes_written,
+                len - bytes_written,
+                (const char *)s.ptr,
+                s.len
+            );
+            res.ok = s.len * 2 <= len - bytes_written;
+            break;
+        case 'f':
+            fmt_float.v = va_arg(va_args, double);
+            fmt_float.precision = 6;
+            field_bytes = cstr_from_double(
+                dest + bytes_written,
+                len - bytes_written,
+                fmt_float.v,
+                fmt_float.precision
+            );
+            if (field_bytes == 0) {
+                res.ok = 0;
+            }
             break;
         case 'F':
             fmt_float = va_arg(va_args, cstr_fmt_float);
@@ -1631,371 +6276,769 @@ cstr_fmt_result cstr_fmt_va(
             }
             break;
         case 'i':
-            field_bytes = cstr_from_int(
-                dest + bytes_written, len - bytes_written, va_arg(va_args, int)
-            );
-            if (field_bytes == 0) {
-                res.ok = 0;
-            }
+            field_bytes = cstr_from_int(
+                dest + bytes_written, len - bytes_written, va_arg(va_args, int)
+            );
+            if (field_bytes == 0) {
+                res.ok = 0;
+            }
+            break;
+        case 'u':
+            field_bytes = cstr_from_uint(
+                dest + bytes_written, len - bytes_written, va_arg(va_args, uint)
+            );
+            if (field_bytes == 0) {
+                res.ok = 0;
+            }
+            break;
+        case 'I':
+            field_bytes = cstr_from_llong(
+                dest + bytes_written,
+                len - bytes_written,
+                va_arg(va_args, llong)
+            );
+            if (field_bytes == 0) {
+                res.ok = 0;
+            }
+            break;
+        case 'U':
+            field_bytes = cstr_from_ullong(
+                dest + bytes_written,
+                len - bytes_written,
+                va_arg(va_args, ullong)
+            );
+            if (field_bytes == 0) {
+                res.ok = 0;
+            }
+            break;
+        default:
+            dest[bytes_written] = *format;
+            field_bytes = 1;
+            break;
+        }
+        assert(
+            SIZE_MAX - field_bytes > bytes_written
+            && "bytes written must not exceed size max"
+        );
+        bytes_written += field_bytes;
+        format += 1;
+    }
+
+    // null termination
+    assert(
+        SIZE_MAX - 1 > bytes_written && "bytes written must not exceed size max"
+    );
+    if (bytes_written + 1 < len) {
+        // null termination is not included in length
+        dest[bytes_written] = '\0';
+    } else {
+        // always null terminate
+        dest[len - 1] = '\0';
+        bytes_written -= 1;
+        res.ok = 0; // truncated
+    }
+
+    res.len = bytes_written;
+    return res;
+}
+
+size_t cstr_fmt_len_va(const char *restrict format, va_list va_args) {
+    assert(format && "format must not be null");
+
+    if (!format) {
+        return 0;
+    }
+
+    slice_const s;
+    size_t len = 0;
+    cstr_fmt_float fmt_float;
+    while (*format != '\0') {
+        switch (*format) {
+        case 'c':
+            len += 1;
+            break;
+        case 's':
+            s = va_arg(va_args, slice_const);
+            len += s.len;
+            break;
+        case 'S':
+            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
+            len += s.len;
+            break;
+        case 'h':
+            s = va_arg(va_args, slice_const);
+            len += s.len * 2;
+            break;
+        case 'H':
+            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
+            len += s.len * 2;
+            break;
+        case 'f':
+            fmt_float.v = va_arg(va_args, double);
+            fmt_float.precision = 6;
+            len += cstr_len_double(fmt_float.v, fmt_float.precision);
+            break;
+        case 'F':
+            fmt_float = va_arg(va_args, cstr_fmt_float);
+            len += cstr_len_double(fmt_float.v, fmt_float.precision);
+            break;
+        case 'i':
+            len += cstr_len_int(va_arg(va_args, int));
             break;
         case 'u':
-            field_bytes = cstr_from_uint(
-                dest + bytes_written, len - bytes_written, va_arg(va_args, uint)
-            );
-            if (field_bytes == 0) {
-                res.ok = 0;
-            }
+            len += cstr_len_uint(va_arg(va_args, uint));
             break;
         case 'I':
-            field_bytes = cstr_from_llong(
-                dest + bytes_written,
-                len - bytes_written,
-                va_arg(va_args, llong)
-            );
-            if (field_bytes == 0) {
-                res.ok = 0;
-            }
+            len += cstr_len_llong(va_arg(va_args, llong));
             break;
         case 'U':
-            field_bytes = cstr_from_ullong(
-                dest + bytes_written,
-                len - bytes_written,
-                va_arg(va_args, ullong)
-            );
-            if (field_bytes == 0) {
-                res.ok = 0;
-            }
+            len += cstr_len_ullong(va_arg(va_args, ullong));
             break;
         default:
-            dest[bytes_written] = *format;
-            field_bytes = 1;
+            len += 1;
             break;
         }
-        assert(
-            SIZE_MAX - field_bytes > bytes_written
-            && "bytes written must not exceed size max"
-        );
-        bytes_written += field_bytes;
         format += 1;
     }
 
-    // null termination
-    assert(
-        SIZE_MAX - 1 > bytes_written && "bytes written must not exceed size max"
-    );
-    if (bytes_written + 1 < len) {
-        // null termination is not included in length
-        dest[bytes_written] = '\0';
-    } else {
-        // always null terminate
-        dest[len - 1] = '\0';
-        bytes_written -= 1;
-        res.ok = 0; // truncated
+    return len;
+}
+
+////////////////////////
+// Byte buffer
+////////////////////////
+
+void bytebuf_init(bytebuf *bbuf, size_t capacity, allocator *allocator) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(allocator && "allocator must not be null");
+    assert(capacity > 0 && "capacity must be larger than 0");
+    bytes_set(bbuf, 0, sizeof(*bbuf));
+    bbuf->allocator = allocator;
+    allocation a = alloc_malloc(allocator, capacity, alignof(uchar));
+    if (allocation_exists(a)) {
+        bbuf->buffer = a.ptr;
+        bbuf->cap = a.len;
+    }
+}
+
+void bytebuf_init_fixed(bytebuf *bbuf, slice buffer, size_t offset) {
+    assert(bbuf && "bytebuf must not be null");
+    bytes_set(bbuf, 0, sizeof(*bbuf));
+    bbuf->buffer = buffer.ptr;
+    bbuf->len = offset;
+    bbuf->cap = buffer.len;
+}
+
+void bytebuf_free(bytebuf *bbuf) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+    assert(bbuf->allocator && "allocator must not be null");
+    if (!bbuf && !bbuf->buffer) {
+        return;
+    }
+    if (bbuf->allocator) {
+        allocation a = {
+            .ptr = bbuf->buffer,
+            .len = bbuf->cap,
+        };
+        alloc_free(bbuf->allocator, a);
+    }
+    bbuf->cap = 0;
+    bbuf->len = 0;
+    bbuf->buffer = 0;
+}
+
+bool bytebuf_grow(bytebuf *bbuf, size_t capacity_increase) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(bbuf->allocator && "allocator must not be null");
+    assert(capacity_increase > 0 && "capacity increase must be >0");
+    assert(
+        SIZE_MAX - bbuf->cap > capacity_increase
+        && "capacity increase must not exceed size max"
+    );
+    if (capacity_increase == 0) {
+        return 1;
+    }
+    if (!bbuf->allocator) {
+        return 0;
+    }
+
+    allocation newbuf = alloc_malloc(
+        bbuf->allocator, bbuf->cap + capacity_increase, alignof(uchar)
+    );
+    if (!allocation_exists(newbuf)) {
+        return 0;
+    }
+
+    allocation oldbuf = {
+        .ptr = bbuf->buffer,
+        .len = bbuf->cap,
+    };
+
+    if (oldbuf.ptr) {
+        bytes_copy(newbuf.ptr, bbuf->buffer, bbuf->len);
+    }
+    bbuf->buffer = newbuf.ptr;
+    bbuf->cap = newbuf.len;
+
+    if (oldbuf.ptr) {
+        alloc_free(bbuf->allocator, oldbuf);
+    }
+
+    return 1;
+}
+
+bytebuf bytebuf_clone(bytebuf *bbuf, size_t capacity_increase) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+    assert(bbuf->allocator && "allocator must not be null");
+    assert(
+        SIZE_MAX - bbuf->cap > capacity_increase
+        && "capacity increase must not exceed size max"
+    );
+
+    bytebuf newbbuf =
+        bytebuf_new(bbuf->cap + capacity_increase, bbuf->allocator);
+    if (!newbbuf.buffer) {
+        return newbbuf; // failed new
+    }
+    bytes_copy(newbbuf.buffer, bbuf->buffer, bbuf->len);
+    newbbuf.len = bbuf->len;
+    return newbbuf;
+}
+
+static bool bytebuf_ensure_space_available(
+    bytebuf *bbuf, size_t len, size_t cap_increase_coeff
+) {
+    if (len <= bytebuf_bytes_available(bbuf)) {
+        return 1; // enough space is available
+    }
+    if (!bytebuf_is_growable(bbuf)) {
+        return 0; // static buffer: no space available
+    }
+
+    assert(
+        cap_increase_coeff > 0 && "capacity increase coefficient must be >0"
+    );
+    assert(
+        (SIZE_MAX - bbuf->cap) / cap_increase_coeff > len
+        && "capacity increase must not exceed size max"
+    );
+    size_t capacity_increase = bbuf->cap + len * cap_increase_coeff;
+    return bytebuf_grow(bbuf, capacity_increase);
+}
+
+bytebuf_result bytebuf_skip(bytebuf *bbuf, size_t len) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(
+        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
+    );
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    if (len == 0) {
+        res.ok = 1;
+        return res;
+    }
+
+    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+        return res;
+    }
+    bbuf->len += len;
+    res.len = len;
+    res.ok = 1;
+    return res;
+}
+
+bytebuf_result bytebuf_fill(bytebuf *bbuf, uchar pattern, size_t len) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+    assert(
+        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
+    );
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    if (len == 0) {
+        res.ok = 1; // nothing to write
+        return res;
+    }
+    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+        return res;
+    }
+    bytes_set(bbuf->buffer + bbuf->len, (int)pattern, len);
+    bbuf->len += len;
+    res.len = len;
+    res.ok = 1;
+    return res;
+}
+
+bytebuf_result bytebuf_write(bytebuf *bbuf, const void *src, size_t len) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+    assert(
+        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
+    );
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    if (!src || len == 0) {
+        res.ok = 1; // nothing to write
+        return res;
+    }
+    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+        return res;
+    }
+    bytes_copy(bbuf->buffer + bbuf->len, src, len);
+    bbuf->len += len;
+    res.len = len;
+    res.ok = 1;
+    return res;
+}
+
+uchar *bytebuf_reserve(bytebuf *bbuf, size_t len) {
+    assert(bbuf && "bytebuf must not be null");
+    assert(
+        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
+    );
+    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+        return NULL;
+    }
+    return bbuf->buffer + bbuf->len;
+}
+
+/**
+ * Commit bytes written to the reserved space and describe them as a write
+ */
+static bytebuf_result bytebuf_commit_result(bytebuf *bbuf, size_t len) {
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+    res.len = len;
+    res.ok = 1;
+    bytebuf_commit(bbuf, len);
+    return res;
+}
+
+bytebuf_result bytebuf_write_int(bytebuf *bbuf, int src) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+
+    size_t len = cstr_len_int(src);
+    uchar *dest = bytebuf_reserve(bbuf, len);
+    if (!dest) {
+        bytebuf_result res = {.offset = bbuf->len};
+        return res;
+    }
+    cstr_from_int_unsafe((char *)dest + len, src);
+    return bytebuf_commit_result(bbuf, len);
+}
+
+bytebuf_result bytebuf_write_uint(bytebuf *bbuf, uint src) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+
+    size_t len = cstr_len_uint(src);
+    uchar *dest = bytebuf_reserve(bbuf, len);
+    if (!dest) {
+        bytebuf_result res = {.offset = bbuf->len};
+        return res;
     }
+    cstr_from_uint_unsafe((char *)dest + len, src);
+    return bytebuf_commit_result(bbuf, len);
+}
 
-    res.len = bytes_written;
-    return res;
+bytebuf_result bytebuf_write_llong(bytebuf *bbuf, llong src) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+
+    size_t len = cstr_len_llong(src);
+    uchar *dest = bytebuf_reserve(bbuf, len);
+    if (!dest) {
+        bytebuf_result res = {.offset = bbuf->len};
+        return res;
+    }
+    cstr_from_llong_unsafe((char *)dest + len, src);
+    return bytebuf_commit_result(bbuf, len);
 }
 
-size_t cstr_fmt_len_va(const char *restrict format, va_list va_args) {
-    assert(format && "format must not be null");
+bytebuf_result bytebuf_write_ullong(bytebuf *bbuf, ullong src) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
 
-    if (!format) {
-        return 0;
+    size_t len = cstr_len_ullong(src);
+    uchar *dest = bytebuf_reserve(bbuf, len);
+    if (!dest) {
+        bytebuf_result res = {.offset = bbuf->len};
+        return res;
+    }
+    cstr_from_ullong_unsafe((char *)dest + len, src);
+    return bytebuf_commit_result(bbuf, len);
+}
+
+bytebuf_result bytebuf_write_float(bytebuf *bbuf, float src, uint decimals) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    char integer_cstr[32];
+    char fractional_cstr[32];
+    struct cstr_from_real_parts parts = {0};
+    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
+    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
+    cstr_from_float_parts(&parts, src, decimals);
+    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+
+    uchar *dest = bytebuf_reserve(bbuf, bytes_to_write);
+    if (!dest) {
+        return res;
+    }
+    cstr_from_real_parts_to_buf(&parts, (char *)dest);
+    return bytebuf_commit_result(bbuf, bytes_to_write);
+}
+
+bytebuf_result bytebuf_write_double(bytebuf *bbuf, double src, uint decimals) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    char integer_cstr[32];
+    char fractional_cstr[32];
+    struct cstr_from_real_parts parts = {0};
+    parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
+    parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
+    cstr_from_double_parts(&parts, src, decimals);
+    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
+
+    uchar *dest = bytebuf_reserve(bbuf, bytes_to_write);
+    if (!dest) {
+        return res;
+    }
+    cstr_from_real_parts_to_buf(&parts, (char *)dest);
+    return bytebuf_commit_result(bbuf, bytes_to_write);
+}
+
+static bytebuf_result bytebuf_write_hex(bytebuf *bbuf, slice_const hex) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bbuf's buffer must not be null");
+
+    bytebuf_result res = {0};
+    res.offset = bbuf->len;
+
+    assert(SIZE_MAX / 2 > hex.len && "hex length must not exceed size max");
+    uchar *dest = bytebuf_reserve(bbuf, hex.len * 2);
+    if (!dest) {
+        return res;
     }
 
+    size_t len = bytes_to_hex(
+        (char *)dest, hex.len * 2, (const char *)hex.ptr, hex.len
+    );
+    return bytebuf_commit_result(bbuf, len);
+}
+
+bytebuf_result
+bytebuf_fmt_va(bytebuf *bbuf, const char *restrict format, va_list va_args) {
+    assert(bbuf && "bbuf must not be null");
+    assert(bbuf->buffer && "bbuf's buffer must not be null");
+    assert(format && "format must not be null");
+
+    bytebuf_result res = {0};
+    bytebuf_result partial_res = {.ok = 1};
     slice_const s;
-    size_t len = 0;
     cstr_fmt_float fmt_float;
-    while (*format != '\0') {
+    char c;
+
+    if (!format) {
+        return res;
+    }
+
+    res.offset = bbuf->len;
+
+    while (partial_res.ok && *format != '\0') {
         switch (*format) {
         case 'c':
-            len += 1;
+            c = (char)va_arg(va_args, int);
+            partial_res = bytebuf_write(bbuf, (const uchar *)&c, 1);
             break;
         case 's':
             s = va_arg(va_args, slice_const);
-            len += s.len;
+            partial_res = bytebuf_write(bbuf, s.ptr, s.len);
             break;
         case 'S':
             s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
-            len += s.len;
+            partial_res = bytebuf_write(bbuf, s.ptr, s.len);
             break;
         case 'h':
             s = va_arg(va_args, slice_const);
-            len += s.len * 2;
+            partial_res = bytebuf_write_hex(bbuf, s);
+            break;
+        case 'H':
+            s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
+            partial_res = bytebuf_write_hex(bbuf, s);
             break;
         case 'f':
             fmt_float.v = va_arg(va_args, double);
             fmt_float.precision = 6;
-            len += cstr_len_double(fmt_float.v, fmt_float.precision);
+            partial_res =
+                bytebuf_write_double(bbuf, fmt_float.v, fmt_float.precision);
             break;
         case 'F':
             fmt_float = va_arg(va_args, cstr_fmt_float);
-            len += cstr_len_double(fmt_float.v, fmt_float.precision);
+            partial_res =
+                bytebuf_write_double(bbuf, fmt_float.v, fmt_float.precision);
             break;
         case 'i':
-            len += cstr_len_int(va_arg(va_args, int));
+            partial_res = bytebuf_write_int(bbuf, va_arg(va_args, int));
             break;
         case 'u':
-            len += cstr_len_uint(va_arg(va_args, uint));
+            partial_res = bytebuf_write_uint(bbuf, va_arg(va_args, uint));
             break;
         case 'I':
-            len += cstr_len_llong(va_arg(va_args, llong));
+            partial_res = bytebuf_write_llong(bbuf, va_arg(va_args, llong));
             break;
         case 'U':
-            len += cstr_len_ullong(va_arg(va_args, ullong));
+            partial_res = bytebuf_write_ullong(bbuf, va_arg(va_args, ullong));
             break;
         default:
-            len += 1;
+            partial_res = bytebuf_write(bbuf, (const uchar *)format, 1);
             break;
         }
+        assert(
+            SIZE_MAX - res.len > partial_res.len
+            && "len increase must not exceed size max"
+        );
+        res.len += partial_res.len;
         format += 1;
     }
+    res.ok = partial_res.ok;
 
-    return len;
-}
-
-////////////////////////
-// Byte buffer
-////////////////////////
-
-void bytebuf_init(bytebuf *bbuf, size_t capacity, allocator *allocator) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(allocator && "allocator must not be null");
-    assert(capacity > 0 && "capacity must be larger than 0");
-    bytes_set(bbuf, 0, sizeof(*bbuf));
-    bbuf->allocator = allocator;
-    allocation a = alloc_malloc(allocator, capacity, alignof(uchar));
-    if (allocation_exists(a)) {
-        bbuf->buffer = a.ptr;
-        bbuf->cap = a.len;
-    }
-}
-
-void bytebuf_init_fixed(bytebuf *bbuf, slice buffer, size_t offset) {
-    assert(bbuf && "bytebuf must not be null");
-    bytes_set(bbuf, 0, sizeof(*bbuf));
-    bbuf->buffer = buffer.ptr;
-    bbuf->len = offset;
-    bbuf->cap = buffer.len;
-}
-
-void bytebuf_free(bytebuf *bbuf) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
-    assert(bbuf->allocator && "allocator must not be null");
-    if (!bbuf && !bbuf->buffer) {
-        return;
-    }
-    if (bbuf->allocator) {
-        allocation a = {
-            .ptr = bbuf->buffer,
-            .len = bbuf->cap,
-        };
-        alloc_free(bbuf->allocator, a);
-    }
-    bbuf->cap = 0;
-    bbuf->len = 0;
-    bbuf->buffer = 0;
-}
-
-bool bytebuf_grow(bytebuf *bbuf, size_t capacity_increase) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(bbuf->allocator && "allocator must not be null");
-    assert(capacity_increase > 0 && "capacity increase must be >0");
-    assert(
-        SIZE_MAX - bbuf->cap > capacity_increase
-        && "capacity increase must not exceed size max"
-    );
-    if (capacity_increase == 0) {
-        return 1;
-    }
-    if (!bbuf->allocator) {
-        return 0;
-    }
-
-    allocation newbuf = alloc_malloc(
-        bbuf->allocator, bbuf->cap + capacity_increase, alignof(uchar)
-    );
-    if (!allocation_exists(newbuf)) {
-        return 0;
-    }
-
-    allocation oldbuf = {
-        .ptr = bbuf->buffer,
-        .len = bbuf->cap,
-    };
-
-    if (oldbuf.ptr) {
-        bytes_copy(newbuf.ptr, bbuf->buffer, bbuf->len);
-    }
-    bbuf->buffer = newbuf.ptr;
-    bbuf->cap = newbuf.len;
-
-    if (oldbuf.ptr) {
-        alloc_free(bbuf->allocator, oldbuf);
-    }
-
-    return 1;
-}
-
-bytebuf bytebuf_clone(bytebuf *bbuf, size_t capacity_increase) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
-    assert(bbuf->allocator && "allocator must not be null");
-    assert(
-        SIZE_MAX - bbuf->cap > capacity_increase
-        && "capacity increase must not exceed size max"
-    );
-
-    bytebuf newbbuf =
-        bytebuf_new(bbuf->cap + capacity_increase, bbuf->allocator);
-    if (!newbbuf.buffer) {
-        return newbbuf; // failed new
+    // null termination
+    partial_res = bytebuf_write(bbuf, (const uchar *)"\0", 1);
+    if (partial_res.ok) {
+        // null termination is not included in length
+        bbuf->len -= 1;
+    } else {
+        // always null terminate
+        bbuf->buffer[bbuf->len - 1] = '\0';
+        bbuf->len -= 1;
+        res.len -= 1;
     }
-    bytes_copy(newbbuf.buffer, bbuf->buffer, bbuf->len);
-    newbbuf.len = bbuf->len;
-    return newbbuf;
+    res.ok &= partial_res.ok;
+
+    return res;
 }
 
-static bool bytebuf_ensure_space_available(
-    bytebuf *bbuf, size_t len, size_t cap_increase_coeff
-) {
-    if (len <= bytebuf_bytes_available(bbuf)) {
-        return 1; // enough space is available
-    }
-    if (!bytebuf_is_growable(bbuf)) {
-        return 0; // static buffer: no space available
-    }
+////////////////////////
+// Segmented byte buffer
+////////////////////////
 
-    assert(
-        cap_increase_coeff > 0 && "capacity increase coefficient must be >0"
-    );
-    assert(
-        (SIZE_MAX - bbuf->cap) / cap_increase_coeff > len
-        && "capacity increase must not exceed size max"
-    );
-    size_t capacity_increase = bbuf->cap + len * cap_increase_coeff;
-    return bytebuf_grow(bbuf, capacity_increase);
+static uchar *segbuf_chunk_bytes(segbuf_chunk *chunk) {
+    return (uchar *)(chunk + 1);
 }
 
-bytebuf_result bytebuf_skip(bytebuf *bbuf, size_t len) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(
-        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
-    );
+void segbuf_init(segbuf *sbuf, size_t chunk_size, allocator *allocator) {
+    assert(sbuf && "segbuf must not be null");
+    assert(allocator && "allocator must not be null");
+    bytes_set(sbuf, 0, sizeof(*sbuf));
+    sbuf->chunk_size = chunk_size ? chunk_size : segbuf_default_chunk_size;
+    sbuf->allocator = allocator;
+}
 
-    bytebuf_result res = {0};
-    res.offset = bbuf->len;
+void segbuf_free(segbuf *sbuf) {
+    assert(sbuf && "segbuf must not be null");
+    segbuf_chunk *chunk = sbuf->head;
+    while (chunk) {
+        segbuf_chunk *next = chunk->next;
+        allocation a = {
+            .ptr = chunk,
+            .len = sizeof(*chunk) + chunk->cap,
+        };
+        alloc_free(sbuf->allocator, a);
+        chunk = next;
+    }
+    sbuf->head = NULL;
+    sbuf->current = NULL;
+    sbuf->last = NULL;
+    sbuf->len = 0;
+    sbuf->cap = 0;
+    sbuf->chunk_count = 0;
+}
 
-    if (len == 0) {
-        res.ok = 1;
-        return res;
+void segbuf_clear(segbuf *sbuf) {
+    assert(sbuf && "segbuf must not be null");
+    for (segbuf_chunk *chunk = sbuf->head; chunk; chunk = chunk->next) {
+        if (chunk->len == 0) {
+            break; // the rest of the chunks are empty
+        }
+        chunk->len = 0;
     }
+    sbuf->current = sbuf->head;
+    sbuf->len = 0;
+}
 
-    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
-        return res;
+bool segbuf_reserve(segbuf *sbuf, size_t len) {
+    assert(sbuf && "segbuf must not be null");
+    assert(sbuf->allocator && "allocator must not be null");
+    assert(
+        SIZE_MAX - sbuf->len > len && "len increase must not exceed size max"
+    );
+    while (sbuf->cap - sbuf->len < len) {
+        assert(
+            SIZE_MAX - sizeof(segbuf_chunk) > sbuf->chunk_size
+            && "chunk size must not exceed size max"
+        );
+        allocation a = alloc_malloc(
+            sbuf->allocator,
+            sizeof(segbuf_chunk) + sbuf->chunk_size,
+            alignof(segbuf_chunk)
+        );
+        if (!allocation_exists(a)) {
+            return 0;
+        }
+        segbuf_chunk *chunk = a.ptr;
+        chunk->next = NULL;
+        chunk->len = 0;
+        chunk->cap = a.len - sizeof(*chunk);
+        if (sbuf->last) {
+            sbuf->last->next = chunk;
+        } else {
+            sbuf->head = chunk;
+            sbuf->current = chunk;
+        }
+        sbuf->last = chunk;
+        sbuf->cap += chunk->cap;
+        sbuf->chunk_count += 1;
     }
-    bbuf->len += len;
-    res.len = len;
-    res.ok = 1;
-    return res;
+    return 1;
 }
 
-bytebuf_result bytebuf_fill(bytebuf *bbuf, uchar pattern, size_t len) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
-    assert(
-        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
+/**
+ * Get the space left in the current chunk, moving to the next chunk when the
+ * current one is full. The space must have been reserved beforehand.
+ */
+static slice segbuf_next_space(segbuf *sbuf) {
+    segbuf_chunk *chunk = sbuf->current;
+    assert(chunk && "space must be reserved before writing");
+    if (chunk->len == chunk->cap) {
+        chunk = chunk->next;
+        assert(chunk && "space must be reserved before writing");
+        sbuf->current = chunk;
+    }
+    return slice_new(
+        segbuf_chunk_bytes(chunk) + chunk->len, chunk->cap - chunk->len
     );
+}
+
+static void segbuf_commit(segbuf *sbuf, size_t len) {
+    sbuf->current->len += len;
+    sbuf->len += len;
+}
+
+bytebuf_result segbuf_fill(segbuf *sbuf, uchar pattern, size_t len) {
+    assert(sbuf && "segbuf must not be null");
 
     bytebuf_result res = {0};
-    res.offset = bbuf->len;
+    res.offset = sbuf->len;
 
     if (len == 0) {
         res.ok = 1; // nothing to write
         return res;
     }
-    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+    if (!segbuf_reserve(sbuf, len)) {
         return res;
     }
-    bytes_set(bbuf->buffer + bbuf->len, (int)pattern, len);
-    bbuf->len += len;
-    res.len = len;
+    while (res.len < len) {
+        slice space = segbuf_next_space(sbuf);
+        size_t bytes_to_write = min(space.len, len - res.len);
+        bytes_set(space.ptr, (int)pattern, bytes_to_write);
+        segbuf_commit(sbuf, bytes_to_write);
+        res.len += bytes_to_write;
+    }
     res.ok = 1;
     return res;
 }
 
-bytebuf_result bytebuf_write(bytebuf *bbuf, const void *src, size_t len) {
-    assert(bbuf && "bytebuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
-    assert(
-        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
-    );
+bytebuf_result segbuf_write(segbuf *sbuf, const void *src, size_t len) {
+    assert(sbuf && "segbuf must not be null");
 
     bytebuf_result res = {0};
-    res.offset = bbuf->len;
+    res.offset = sbuf->len;
 
     if (!src || len == 0) {
         res.ok = 1; // nothing to write
         return res;
     }
-    if (!bytebuf_ensure_space_available(bbuf, len, 1)) {
+    if (!segbuf_reserve(sbuf, len)) {
         return res;
     }
-    bytes_copy(bbuf->buffer + bbuf->len, src, len);
-    bbuf->len += len;
-    res.len = len;
+    const uchar *src_ = src;
+    while (res.len < len) {
+        slice space = segbuf_next_space(sbuf);
+        size_t bytes_to_write = min(space.len, len - res.len);
+        bytes_copy(space.ptr, src_ + res.len, bytes_to_write);
+        segbuf_commit(sbuf, bytes_to_write);
+        res.len += bytes_to_write;
+    }
     res.ok = 1;
     return res;
 }
 
-bytebuf_result bytebuf_write_int(bytebuf *bbuf, int src) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+bytebuf_result segbuf_write_int(segbuf *sbuf, int src) {
+    assert(sbuf && "sbuf must not be null");
 
     char tmp[16];
     char *end = tmp + sizeof(tmp);
     size_t bytes_to_copy = cstr_from_int_unsafe(end, src);
-    return bytebuf_write(bbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
+    return segbuf_write(sbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
 }
 
-bytebuf_result bytebuf_write_uint(bytebuf *bbuf, uint src) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+bytebuf_result segbuf_write_uint(segbuf *sbuf, uint src) {
+    assert(sbuf && "sbuf must not be null");
 
     char tmp[16];
     char *end = tmp + sizeof(tmp);
     size_t bytes_to_copy = cstr_from_uint_unsafe(end, src);
-    return bytebuf_write(bbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
+    return segbuf_write(sbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
 }
 
-bytebuf_result bytebuf_write_llong(bytebuf *bbuf, llong src) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+bytebuf_result segbuf_write_llong(segbuf *sbuf, llong src) {
+    assert(sbuf && "sbuf must not be null");
 
     char tmp[32];
     char *end = tmp + sizeof(tmp);
     size_t bytes_to_copy = cstr_from_llong_unsafe(end, src);
-    return bytebuf_write(bbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
+    return segbuf_write(sbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
 }
 
-bytebuf_result bytebuf_write_ullong(bytebuf *bbuf, ullong src) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+bytebuf_result segbuf_write_ullong(segbuf *sbuf, ullong src) {
+    assert(sbuf && "sbuf must not be null");
 
     char tmp[32];
     char *end = tmp + sizeof(tmp);
     size_t bytes_to_copy = cstr_from_ullong_unsafe(end, src);
-    return bytebuf_write(bbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
+    return segbuf_write(sbuf, (uchar *)end - bytes_to_copy, bytes_to_copy);
 }
 
-bytebuf_result bytebuf_write_float(bytebuf *bbuf, float src, uint decimals) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
+static bytebuf_result cstr_from_real_parts_to_segbuf(
+    struct cstr_from_real_parts *parts, segbuf *sbuf
+) {
+    // sign, integer, decimal point, decimal zeros, and fractional part
+    char tmp[128];
+    size_t bytes_to_write = cstr_from_real_parts_len(parts);
+    assert(bytes_to_write <= sizeof(tmp) && "real number must fit the buffer");
+    cstr_from_real_parts_to_buf(parts, tmp);
+    return segbuf_write(sbuf, tmp, bytes_to_write);
+}
 
-    bytebuf_result res = {0};
-    res.offset = bbuf->len;
+bytebuf_result segbuf_write_float(segbuf *sbuf, float src, uint decimals) {
+    assert(sbuf && "sbuf must not be null");
 
     char integer_cstr[32];
     char fractional_cstr[32];
@@ -2003,29 +7046,11 @@ bytebuf_result bytebuf_write_float(bytebuf *bbuf, float src, uint decimals) {
     parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
     parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
     cstr_from_float_parts(&parts, src, decimals);
-    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
-
-    if (!bytebuf_ensure_space_available(bbuf, bytes_to_write, 2)) {
-        return res;
-    }
-
-    assert(
-        SIZE_MAX - bbuf->len > bytes_to_write
-        && "len increase must not exceed size max"
-    );
-    cstr_from_real_parts_to_buf(&parts, (char *)bbuf->buffer + bbuf->len);
-    bbuf->len += bytes_to_write;
-    res.len = bytes_to_write;
-    res.ok = 1;
-    return res;
+    return cstr_from_real_parts_to_segbuf(&parts, sbuf);
 }
 
-bytebuf_result bytebuf_write_double(bytebuf *bbuf, double src, uint decimals) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bytebuf's buffer must not be null");
-
-    bytebuf_result res = {0};
-    res.offset = bbuf->len;
+bytebuf_result segbuf_write_double(segbuf *sbuf, double src, uint decimals) {
+    assert(sbuf && "sbuf must not be null");
 
     char integer_cstr[32];
     char fractional_cstr[32];
@@ -2033,53 +7058,47 @@ bytebuf_result bytebuf_write_double(bytebuf *bbuf, double src, uint decimals) {
     parts.integer_cursor = integer_cstr + sizeof(integer_cstr);
     parts.fractional_cursor = fractional_cstr + sizeof(fractional_cstr);
     cstr_from_double_parts(&parts, src, decimals);
-    size_t bytes_to_write = cstr_from_real_parts_len(&parts);
-
-    if (!bytebuf_ensure_space_available(bbuf, bytes_to_write, 2)) {
-        return res;
-    }
-
-    assert(
-        SIZE_MAX - bbuf->len > bytes_to_write
-        && "len increase must not exceed size max"
-    );
-    cstr_from_real_parts_to_buf(&parts, (char *)bbuf->buffer + bbuf->len);
-    bbuf->len += bytes_to_write;
-    res.len = bytes_to_write;
-    res.ok = 1;
-    return res;
+    return cstr_from_real_parts_to_segbuf(&parts, sbuf);
 }
 
-static bytebuf_result bytebuf_write_hex(bytebuf *bbuf, slice_const hex) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bbuf's buffer must not be null");
+static bytebuf_result segbuf_write_hex(segbuf *sbuf, slice_const hex) {
+    assert(sbuf && "sbuf must not be null");
 
     bytebuf_result res = {0};
-    res.offset = bbuf->len;
+    res.offset = sbuf->len;
 
-    if (!bytebuf_ensure_space_available(bbuf, hex.len, 4)) {
+    assert(SIZE_MAX / 2 > hex.len && "hex length must not exceed size max");
+    if (!segbuf_reserve(sbuf, hex.len * 2)) {
         return res;
     }
 
-    size_t len = bytes_to_hex(
-        (char *)bbuf->buffer + bbuf->len,
-        bytebuf_bytes_available(bbuf),
-        (const char *)hex.ptr,
-        hex.len
-    );
-    assert(
-        SIZE_MAX - bbuf->len > len && "len increase must not exceed size max"
-    );
-    bbuf->len += len;
-    res.len = len;
+    // hex is written to the chunks directly, except for the byte pairs that
+    // would be split between two chunks
+    size_t bytes_processed = 0;
+    while (bytes_processed < hex.len) {
+        slice space = segbuf_next_space(sbuf);
+        const char *src = (const char *)hex.ptr + bytes_processed;
+        size_t bytes_to_process = min(space.len / 2, hex.len - bytes_processed);
+        if (bytes_to_process == 0) {
+            char pair[3];
+            bytes_to_hex(pair, sizeof(pair), src, 1);
+            segbuf_write(sbuf, pair, 2);
+            bytes_processed += 1;
+            continue;
+        }
+        size_t len =
+            bytes_to_hex((char *)space.ptr, space.len, src, bytes_to_process);
+        segbuf_commit(sbuf, len);
+        bytes_processed += bytes_to_process;
+    }
+    res.len = hex.len * 2;
     res.ok = 1;
     return res;
 }
 
 bytebuf_result
-bytebuf_fmt_va(bytebuf *bbuf, const char *restrict format, va_list va_args) {
-    assert(bbuf && "bbuf must not be null");
-    assert(bbuf->buffer && "bbuf's buffer must not be null");
+segbuf_fmt_va(segbuf *sbuf, const char *restrict format, va_list va_args) {
+    assert(sbuf && "sbuf must not be null");
     assert(format && "format must not be null");
 
     bytebuf_result res = {0};
@@ -2092,55 +7111,55 @@ bytebuf_fmt_va(bytebuf *bbuf, const char *restrict format, va_list va_args) {
         return res;
     }
 
-    res.offset = bbuf->len;
+    res.offset = sbuf->len;
 
     while (partial_res.ok && *format != '\0') {
         switch (*format) {
         case 'c':
             c = (char)va_arg(va_args, int);
-            partial_res = bytebuf_write(bbuf, (const uchar *)&c, 1);
+            partial_res = segbuf_write(sbuf, (const uchar *)&c, 1);
             break;
         case 's':
             s = va_arg(va_args, slice_const);
-            partial_res = bytebuf_write(bbuf, s.ptr, s.len);
+            partial_res = segbuf_write(sbuf, s.ptr, s.len);
             break;
         case 'S':
             s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
-            partial_res = bytebuf_write(bbuf, s.ptr, s.len);
+            partial_res = segbuf_write(sbuf, s.ptr, s.len);
             break;
         case 'h':
             s = va_arg(va_args, slice_const);
-            partial_res = bytebuf_write_hex(bbuf, s);
+            partial_res = segbuf_write_hex(sbuf, s);
             break;
         case 'H':
             s = slice_const_from_cstr_unsafe(va_arg(va_args, char *));
-            partial_res = bytebuf_write_hex(bbuf, s);
+            partial_res = segbuf_write_hex(sbuf, s);
             break;
         case 'f':
             fmt_float.v = va_arg(va_args, double);
             fmt_float.precision = 6;
             partial_res =
-                bytebuf_write_double(bbuf, fmt_float.v, fmt_float.precision);
+                segbuf_write_double(sbuf, fmt_float.v, fmt_float.precision);
             break;
         case 'F':
             fmt_float = va_arg(va_args, cstr_fmt_float);
             partial_res =
-                bytebuf_write_double(bbuf, fmt_float.v, fmt_float.precision);
+                segbuf_write_double(sbuf, fmt_float.v, fmt_float.precision);
             break;
         case 'i':
-            partial_res = bytebuf_write_int(bbuf, va_arg(va_args, int));
+            partial_res = segbuf_write_int(sbuf, va_arg(va_args, int));
             break;
         case 'u':
-            partial_res = bytebuf_write_uint(bbuf, va_arg(va_args, uint));
+            partial_res = segbuf_write_uint(sbuf, va_arg(va_args, uint));
             break;
         case 'I':
-            partial_res = bytebuf_write_llong(bbuf, va_arg(va_args, llong));
+            partial_res = segbuf_write_llong(sbuf, va_arg(va_args, llong));
             break;
         case 'U':
-            partial_res = bytebuf_write_ullong(bbuf, va_arg(va_args, ullong));
+            partial_res = segbuf_write_ullong(sbuf, va_arg(va_args, ullong));
             break;
         default:
-            partial_res = bytebuf_write(bbuf, (const uchar *)format, 1);
+            partial_res = segbuf_write(sbuf, (const uchar *)format, 1);
             break;
         }
         assert(
@@ -2152,20 +7171,53 @@ bytebuf_fmt_va(bytebuf *bbuf, const char *restrict format, va_list va_args) {
     }
     res.ok = partial_res.ok;
 
-    // null termination
-    partial_res = bytebuf_write(bbuf, (const uchar *)"\0", 1);
-    if (partial_res.ok) {
-        // null termination is not included in length
-        bbuf->len -= 1;
-    } else {
-        // always null terminate
-        bbuf->buffer[bbuf->len - 1] = '\0';
-        bbuf->len -= 1;
-        res.len -= 1;
+    return res;
+}
+
+size_t segbuf_iovec_count(segbuf *sbuf) {
+    assert(sbuf && "segbuf must not be null");
+    size_t count = 0;
+    for (segbuf_chunk *chunk = sbuf->head; chunk && chunk->len > 0;
+         chunk = chunk->next) {
+        count += 1;
     }
-    res.ok &= partial_res.ok;
+    return count;
+}
 
-    return res;
+size_t segbuf_iovec(
+    segbuf *sbuf, struct iovec *iov, size_t iov_len, size_t offset
+) {
+    assert(sbuf && "segbuf must not be null");
+    assert((iov || iov_len == 0) && "iovecs must not be null");
+
+    size_t count = 0;
+    segbuf_chunk *chunk = sbuf->head;
+    for (; chunk && chunk->len > 0 && count < iov_len; chunk = chunk->next) {
+        if (offset >= chunk->len) {
+            offset -= chunk->len;
+            continue;
+        }
+        iov[count].iov_base = segbuf_chunk_bytes(chunk) + offset;
+        iov[count].iov_len = chunk->len - offset;
+        offset = 0;
+        count += 1;
+    }
+    return count;
+}
+
+size_t segbuf_copy(segbuf *sbuf, void *dest, size_t dest_len) {
+    assert(sbuf && "segbuf must not be null");
+    assert((dest || dest_len == 0) && "destination must not be null");
+
+    uchar *dest_ = dest;
+    size_t copied = 0;
+    segbuf_chunk *chunk = sbuf->head;
+    for (; chunk && chunk->len > 0 && copied < dest_len; chunk = chunk->next) {
+        size_t bytes_to_copy = min(chunk->len, dest_len - copied);
+        bytes_copy(dest_ + copied, segbuf_chunk_bytes(chunk), bytes_to_copy);
+        copied += bytes_to_copy;
+    }
+    return copied;
 }
 
 ////////////////////////
@@ -2192,12 +7244,24 @@ bytesink_result bufstream_flush(bufstream *bstream) {
     }
 
     // partial write --> move remaining bytes to beginning of buffer
-    bytes_move(bstream->buffer, bstream->buffer + res.len, 0);
+    bytes_move(
+        bstream->buffer, bstream->buffer + res.len, bstream->len - res.len
+    );
     bstream->len -= res.len;
 
     return res;
 }
 
+bytesink_result
+crc32c_bytesink_fn(void *context, const uchar *bytes, size_t len) {
+    crc32c_bytesink_context *ctx = context;
+    assert(ctx && "context must not be null");
+    bytesink_result res = ctx->sink.fn(ctx->sink.context, bytes, len);
+    size_t accepted = min(res.len, len);
+    ctx->crc = slice_crc32c(slice_const_new(bytes, accepted), ctx->crc);
+    return res;
+}
+
 bufstream_write_result
 bufstream_write(bufstream *bstream, const void *src, size_t len) {
     assert(bstream && "bstream must not be null");
@@ -2253,52 +7317,101 @@ bufstream_write(bufstream *bstream, const void *src, size_t len) {
     return res;
 }
 
+bufstream_reserve_result bufstream_reserve(bufstream *bstream, size_t len) {
+    assert(bstream && "bstream must not be null");
+    assert(bstream->buffer && "bstream's buffer must not be null");
+
+    bufstream_reserve_result res = {0};
+
+    if (len > bstream->cap) {
+        return res; // never fits the buffer
+    }
+    if (bstream->cap - bstream->len < len) {
+        bytesink_result bs_res = bufstream_flush(bstream);
+        res.err_code = bs_res.err_code;
+        if (res.err_code || bstream->cap - bstream->len < len) {
+            return res;
+        }
+    }
+
+    res.ptr = bstream->buffer + bstream->len;
+    res.len = bstream->cap - bstream->len;
+    return res;
+}
+
+/**
+ * Commit a number formatted to the reserved space, or write it from the
+ * temporary buffer it was formatted to when the space was not reserved.
+ */
+static bufstream_write_result bufstream_commit_or_write(
+    bufstream *bstream,
+    bufstream_reserve_result reserved,
+    const char *src,
+    size_t len
+) {
+    bufstream_write_result res = {0};
+    if (reserved.err_code) {
+        res.err_code = reserved.err_code;
+        return res;
+    }
+    if (!reserved.ptr) {
+        return bufstream_write(bstream, src, len);
+    }
+    bufstream_commit(bstream, len);
+    res.len = len;
+    return res;
+}
+
 bufstream_write_result bufstream_write_int(bufstream *bstream, int src) {
     assert(bstream && "bstream must not be null");
     assert(bstream->buffer && "bufstream's buffer must not be null");
 
-    char tmp[16];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_int_unsafe(end, src);
-    return bufstream_write(
-        bstream, (uchar *)end - bytes_to_copy, bytes_to_copy
-    );
+    // formatted in place unless the number does not fit the buffer
+    char tmp[cstr_int_max_len];
+    size_t len = cstr_len_int(src);
+    bufstream_reserve_result reserved = bufstream_reserve(bstream, len);
+    char *dest = reserved.ptr ? (char *)reserved.ptr : tmp;
+    cstr_from_int_unsafe(dest + len, src);
+    return bufstream_commit_or_write(bstream, reserved, dest, len);
 }
 
 bufstream_write_result bufstream_write_uint(bufstream *bstream, uint src) {
     assert(bstream && "bstream must not be null");
     assert(bstream->buffer && "bufstream's buffer must not be null");
 
-    char tmp[16];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_uint_unsafe(end, src);
-    return bufstream_write(
-        bstream, (uchar *)end - bytes_to_copy, bytes_to_copy
-    );
+    // formatted in place unless the number does not fit the buffer
+    char tmp[cstr_uint_max_len];
+    size_t len = cstr_len_uint(src);
+    bufstream_reserve_result reserved = bufstream_reserve(bstream, len);
+    char *dest = reserved.ptr ? (char *)reserved.ptr : tmp;
+    cstr_from_uint_unsafe(dest + len, src);
+    return bufstream_commit_or_write(bstream, reserved, dest, len);
 }
 
 bufstream_write_result bufstream_write_llong(bufstream *bstream, llong src) {
     assert(bstream && "bstream must not be null");
     assert(bstream->buffer && "bufstream's buffer must not be null");
 
-    char tmp[32];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_llong_unsafe(end, src);
-    return bufstream_write(
-        bstream, (uchar *)end - bytes_to_copy, bytes_to_copy
-    );
+    // formatted in place unless the number does not fit the buffer
+    char tmp[cstr_llong_max_len];
+    size_t len = cstr_len_llong(src);
+    bufstream_reserve_result reserved = bufstream_reserve(bstream, len);
+    char *dest = reserved.ptr ? (char *)reserved.ptr : tmp;
+    cstr_from_llong_unsafe(dest + len, src);
+    return bufstream_commit_or_write(bstream, reserved, dest, len);
 }
 
 bufstream_write_result bufstream_write_ullong(bufstream *bstream, ullong src) {
     assert(bstream && "bstream must not be null");
     assert(bstream->buffer && "bufstream's buffer must not be null");
 
-    char tmp[32];
-    char *end = tmp + sizeof(tmp);
-    size_t bytes_to_copy = cstr_from_ullong_unsafe(end, src);
-    return bufstream_write(
-        bstream, (uchar *)end - bytes_to_copy, bytes_to_copy
-    );
+    // formatted in place unless the number does not fit the buffer
+    char tmp[cstr_ullong_max_len];
+    size_t len = cstr_len_ullong(src);
+    bufstream_reserve_result reserved = bufstream_reserve(bstream, len);
+    char *dest = reserved.ptr ? (char *)reserved.ptr : tmp;
+    cstr_from_ullong_unsafe(dest + len, src);
+    return bufstream_commit_or_write(bstream, reserved, dest, len);
 }
 
 static bufstream_write_result cstr_from_real_parts_to_bufstream(
@@ -2315,8 +7428,23 @@ static bufstream_write_result cstr_from_real_parts_to_bufstream(
         return bufstream_write(bstream, (const uchar *)text, bytes_to_write);
     }
 
+    // formatted in place when the whole number fits the buffer
+    bufstream_write_result res = {0};
+    size_t len = cstr_from_real_parts_len(parts);
+    bufstream_reserve_result reserved = bufstream_reserve(bstream, len);
+    if (reserved.err_code) {
+        res.err_code = reserved.err_code;
+        return res;
+    }
+    if (reserved.ptr) {
+        cstr_from_real_parts_to_buf(parts, (char *)reserved.ptr);
+        bufstream_commit(bstream, len);
+        res.len = len;
+        return res;
+    }
+
     // negative sign
-    bufstream_write_result res;
+    bufstream_write_result partial_res;
     size_t integer_len = parts->integer_len;
     if (parts->is_neg) {
         // inject the negative sign to the integer buffer
@@ -2338,14 +7466,21 @@ static bufstream_write_result cstr_from_real_parts_to_bufstream(
     for (uint i = 0; i < parts->decimal_zeros; i += 1) {
         decimals[i + 1] = '0';
     }
-    res = bufstream_write(bstream, decimals, parts->decimal_zeros + 1);
+    partial_res = bufstream_write(bstream, decimals, parts->decimal_zeros + 1);
+    res.len += partial_res.len;
+    res.err_code = partial_res.err_code;
+    if (res.err_code) {
+        return res;
+    }
 
     // fractional part
-    res = bufstream_write(
+    partial_res = bufstream_write(
         bstream,
         (uchar *)parts->fractional_cursor - parts->fractional_len,
         parts->fractional_len
     );
+    res.len += partial_res.len;
+    res.err_code = partial_res.err_code;
 
     return res;
 }
@@ -2380,31 +7515,51 @@ bufstream_write_double(bufstream *bstream, double src, uint decimals) {
 
 static bufstream_write_result
 bufstream_write_hex(bufstream *bstream, slice_const hex) {
-    // Kind of ugly way to do this for now since it ends up double buffering the
-    // data. This could be later replaced with a function that directly writes
-    // to the underlying buffer.
+    // Hex is written directly to the stream buffer, and the buffer is flushed
+    // whenever it fills up.
     assert(bstream && "bstream must not be null");
     assert(bstream->buffer && "bstream's buffer must not be null");
 
     bufstream_write_result res = {0};
-    uchar buffer[1024];
     size_t bytes_processed = 0;
 
     while (bytes_processed < hex.len) {
-        size_t len = bytes_to_hex(
-            (char *)buffer,
-            sizeof(buffer),
+        size_t bytes_available = bstream->cap - bstream->len;
+        if (bytes_available < 2 && bstream->len > 0) {
+            bytesink_result bs_res = bufstream_flush(bstream);
+            res.err_code = bs_res.err_code;
+            if (res.err_code) {
+                return res;
+            }
+            continue;
+        }
+        if (bytes_available < 2) {
+            // buffer too small to fit a single byte in hex
+            char pair[3];
+            bytes_to_hex(
+                pair, sizeof(pair), (const char *)hex.ptr + bytes_processed, 1
+            );
+            bufstream_write_result partial_res =
+                bufstream_write(bstream, pair, 2);
+            res.len += partial_res.len;
+            if (partial_res.err_code) {
+                res.err_code = partial_res.err_code;
+                return res;
+            }
+            bytes_processed += 1;
+            continue;
+        }
+
+        size_t len = min(hex.len - bytes_processed, bytes_available / 2);
+        len = bytes_to_hex(
+            (char *)bstream->buffer + bstream->len,
+            len * 2,
             (const char *)hex.ptr + bytes_processed,
-            hex.len - bytes_processed
+            len
         );
+        bstream->len += len;
+        res.len += len;
         bytes_processed += len / 2;
-        bufstream_write_result partial_res =
-            bufstream_write(bstream, buffer, len);
-        res.len += partial_res.len;
-        if (partial_res.err_code) {
-            res.err_code = partial_res.err_code;
-            return res;
-        }
     }
 
     return res;
@@ -0,0 +1,176 @@
+#include "mt.h"
+#include "std.h"
+#include "testr.h"
+#include <pthread.h>
+#include <stddef.h>
+
+#define thread_count 4
+#define allocs_per_thread 1000
+
+void test_alloc_stats_classes(test *t) {
+    assert_eq_uint(t, alloc_stats_size_class(0), 0, "size 0");
+    assert_eq_uint(t, alloc_stats_size_class(1), 0, "size 1");
+    assert_eq_uint(t, alloc_stats_size_class(2), 1, "size 2");
+    assert_eq_uint(t, alloc_stats_size_class(3), 2, "size 3");
+    assert_eq_uint(t, alloc_stats_size_class(64), 6, "size 64");
+    assert_eq_uint(t, alloc_stats_size_class(65), 7, "size 65");
+    assert_eq_uint(
+        t,
+        alloc_stats_size_class(SIZE_MAX),
+        alloc_stats_size_classes - 1,
+        "huge sizes go to the last class"
+    );
+    assert_eq_uint(t, alloc_stats_align_class(1), 0, "alignment 1");
+    assert_eq_uint(t, alloc_stats_align_class(16), 4, "alignment 16");
+    assert_eq_uint(
+        t,
+        alloc_stats_align_class((size_t)1 << 20),
+        alloc_stats_align_classes - 1,
+        "large alignments go to the last class"
+    );
+}
+
+void test_alloc_stats_counts(test *t) {
+    alignas(max_align_t) uchar buffer[256];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator inner = arena_allocator_new(&arena);
+    alloc_stats stats;
+    alloc_stats_init(&stats, &inner);
+    allocator alloc = alloc_stats_allocator_new(&stats);
+
+    allocation a = alloc_malloc(&alloc, 16, 8);
+    allocation b = alloc_malloc(&alloc, 100, 1);
+    assert_eq_uint(t, stats.allocs, 2, "allocs");
+    assert_eq_uint(t, stats.live_bytes, 116, "live bytes");
+    assert_eq_uint(t, stats.size_classes[4], 1, "16 byte allocation");
+    assert_eq_uint(t, stats.size_classes[7], 1, "100 byte allocation");
+    assert_eq_uint(t, stats.align_classes[3], 1, "8 byte alignment");
+
+    allocation b2 = alloc_realloc(&alloc, b, 120, 1);
+    assert_true(t, allocation_exists(b2), "realloc must succeed");
+    assert_eq_uint(t, stats.reallocs, 1, "reallocs");
+    assert_eq_uint(t, stats.live_bytes, 136, "live bytes after realloc");
+    assert_eq_uint(t, stats.peak_bytes, 136, "peak bytes after realloc");
+
+    allocation c = alloc_malloc(&alloc, 1000, 1);
+    assert_false(t, allocation_exists(c), "overallocation must fail");
+    assert_eq_uint(t, stats.failures, 1, "failures");
+
+    alloc_free(&alloc, a);
+    alloc_free(&alloc, b2);
+    assert_eq_uint(t, stats.frees, 2, "frees");
+    assert_eq_uint(t, stats.live_bytes, 0, "no live bytes after free");
+    assert_eq_uint(t, stats.peak_bytes, 136, "peak bytes are kept");
+    assert_eq_uint(t, stats.total_bytes, 136, "total bytes");
+}
+
+static void *alloc_stats_thread_f(void *ctx) {
+    allocator *alloc = ctx;
+    void *ptrs[8] = {0};
+    size_t lens[8] = {0};
+    for (size_t i = 0; i < allocs_per_thread; i += 1) {
+        size_t slot = i % countof(ptrs);
+        if (ptrs[slot]) {
+            allocation a = {.ptr = ptrs[slot], .len = lens[slot]};
+            alloc_free(alloc, a);
+        }
+        allocation a = alloc_malloc(alloc, 8 + i % 64, 8);
+        ptrs[slot] = a.ptr;
+        lens[slot] = a.len;
+    }
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        allocation a = {.ptr = ptrs[i], .len = lens[i]};
+        alloc_free(alloc, a);
+    }
+    return NULL;
+}
+
+void test_alloc_stats_threads(test *t) {
+    alloc_stats stats;
+    alloc_stats_init(&stats, &std_allocator);
+    allocator alloc = alloc_stats_allocator_new(&stats);
+
+    pthread_t threads[thread_count];
+    for (size_t i = 0; i < thread_count; i += 1) {
+        int err =
+            pthread_create(&threads[i], NULL, alloc_stats_thread_f, &alloc);
+        assert_eq_sint(t, err, 0, "thread creation must succeed");
+    }
+    for (size_t i = 0; i < thread_count; i += 1) {
+        int err = pthread_join(threads[i], NULL);
+        assert_eq_sint(t, err, 0, "thread join must succeed");
+    }
+
+    size_t expected = thread_count * allocs_per_thread;
+    assert_eq_uint(t, stats.allocs, expected, "all allocations are counted");
+    assert_eq_uint(t, stats.frees, expected, "all frees are counted");
+    assert_eq_uint(t, stats.live_bytes, 0, "no live bytes");
+    assert_ge_uint(t, stats.peak_bytes, 8 * 8, "peak covers a thread");
+    assert_eq_uint(t, stats.align_classes[3], expected, "alignments");
+}
+
+static bytesink_result
+bytebuf_collect(void *context, const uchar *src, size_t len) {
+    bytesink_result res = {0};
+    bytebuf_result bbuf_res = bytebuf_write(context, src, len);
+    if (bbuf_res.ok) {
+        res.len = bbuf_res.len;
+    } else {
+        res.err_code = 1;
+    }
+    return res;
+}
+
+void test_alloc_stats_report(test *t) {
+    alloc_stats stats;
+    alloc_stats_init(&stats, &std_allocator);
+    allocator alloc = alloc_stats_allocator_new(&stats);
+    allocation a = alloc_malloc(&alloc, 48, 16);
+    alloc_free(&alloc, a);
+
+    uchar report_buf[512];
+    uchar bstream_buf[32];
+    bytebuf report = bytebuf_new_fixed(slice_arr(report_buf), 0);
+    bufstream bstream = {
+        .buffer = bstream_buf,
+        .cap = sizeof(bstream_buf),
+        .len = 0,
+        .sink = {
+            .fn = bytebuf_collect,
+            .context = &report,
+        },
+    };
+    bufstream_write_result res = alloc_stats_report(&stats, &bstream);
+    bytesink_result flush_res = bufstream_flush(&bstream);
+    assert_eq_sint(t, res.err_code, 0, "no error");
+    assert_eq_sint(t, flush_res.err_code, 0, "no flush error");
+
+    const char expected[] = "allocs: 1\n"
+                            "frees: 1\n"
+                            "reallocs: 0\n"
+                            "failures: 0\n"
+                            "live bytes: 0\n"
+                            "peak bytes: 48\n"
+                            "total bytes: 48\n"
+                            "sizes:\n"
+                            "  <=64: 1\n"
+                            "alignments:\n"
+                            "  16: 1\n";
+    assert_eq_uint(t, res.len, lengthof(expected), "report length");
+    assert_eq_bytes(
+        t,
+        report.buffer,
+        (const uchar *)expected,
+        lengthof(expected),
+        "report contents"
+    );
+}
+
+static test_case tests[] = {
+    {"Allocator statistics classes", test_alloc_stats_classes},
+    {"Allocator statistics counts", test_alloc_stats_counts},
+    {"Allocator statistics threads", test_alloc_stats_threads},
+    {"Allocator statistics report", test_alloc_stats_report},
+};
+
+setup_tests(NULL, tests)
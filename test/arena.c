@@ -1,5 +1,6 @@
 #include "std.h"
 #include "testr.h"
+#include <pthread.h>
 #include <stddef.h>
 
 void test_arena(test *t) {
@@ -41,6 +42,262 @@ void test_arena(test *t) {
     assert_false(t, allocation_exists(s_buf3), "overallocation must fail");
 }
 
-static test_case tests[] = {{"Arena", test_arena}};
+void test_arena_realloc(test *t) {
+    alignas(max_align_t) uchar buffer[64] = {0};
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+
+    allocation a = alloc_malloc(&alloc, 8, 1);
+    bytes_set(a.ptr, 'a', a.len);
+
+    // the last allocation is extended in place
+    allocation a2 = alloc_realloc(&alloc, a, 16, 1);
+    assert_true(t, a2.ptr == a.ptr, "last allocation is extended in place");
+    assert_eq_uint(t, a2.len, 16, "extended size");
+    assert_eq_uint(t, arena.used, 16, "arena used after extend");
+
+    // and shrunk in place
+    allocation a3 = alloc_realloc(&alloc, a2, 12, 1);
+    assert_true(t, a3.ptr == a.ptr, "last allocation is shrunk in place");
+    assert_eq_uint(t, arena.used, 12, "arena used after shrink");
+
+    // other allocations are copied
+    allocation b = alloc_malloc(&alloc, 4, 1);
+    allocation a4 = alloc_realloc(&alloc, a3, 20, 1);
+    assert_true(t, a4.ptr != a.ptr, "allocation is moved");
+    assert_eq_uint(t, arena.used, 36, "arena used after move");
+    assert_eq_sint(t, ((char *)a4.ptr)[7], 'a', "contents are copied");
+
+    // but shrunk in place
+    allocation b2 = alloc_realloc(&alloc, b, 2, 1);
+    assert_true(t, b2.ptr == b.ptr, "other allocation is shrunk in place");
+    assert_eq_uint(t, b2.len, 2, "shrunk size");
+    assert_eq_uint(t, arena.used, 36, "arena used after shrink");
+
+    // extending beyond the arena fails
+    allocation a5 = alloc_realloc(&alloc, a4, 60, 1);
+    assert_false(t, allocation_exists(a5), "extending too much must fail");
+    assert_eq_uint(t, arena.used, 36, "arena used after failed extend");
+}
+
+void test_arena_chained(test *t) {
+    arena arena = arena_new_chained(&std_allocator, 256);
+    assert_true(t, arena.blocks == NULL, "no blocks before allocating");
+
+    // fill a few blocks with small allocations
+    uint misaligned = 0, failures = 0;
+    for (size_t i = 0; i < 100; i += 1) {
+        ullong *p = arena_alloc(&arena, ullong, 3);
+        failures += p == NULL;
+        misaligned += (uintptr_t)p % alignof(ullong) != 0;
+        if (p) {
+            p[0] = p[1] = p[2] = i;
+        }
+    }
+    assert_eq_uint(t, failures, 0, "allocations must succeed");
+    assert_eq_uint(t, misaligned, 0, "allocations are aligned");
+    assert_ge_uint(t, arena.size, 1024, "block sizes grow");
+
+    // an oversized allocation gets its own block
+    uchar *current = arena.buffer;
+    size_t used = arena.used;
+    uchar *big = arena_alloc(&arena, uchar, arena.next_block_size);
+    assert_true(t, big != NULL, "oversized allocation must succeed");
+    assert_true(t, arena.buffer == current, "current block is kept");
+    assert_eq_uint(t, arena.used, used, "current block usage is kept");
+    bytes_set(big, 1, arena.next_block_size);
+
+    // large alignments are honoured
+    void *aligned = arena_alloc_bytes(&arena, 8, 256);
+    assert_eq_uint(t, (uintptr_t)aligned % 256, 0, "allocation is aligned");
+
+    // realloc moves the last allocation to a new block when it does not fit
+    allocator alloc = arena_allocator_new(&arena);
+    allocation a = alloc_malloc(&alloc, 16, 1);
+    bytes_set(a.ptr, 'a', 16);
+    allocation b = alloc_realloc(&alloc, a, arena.size * 2, 1);
+    assert_true(t, allocation_exists(b), "realloc must succeed");
+    assert_eq_sint(t, ((char *)b.ptr)[15], 'a', "contents are copied");
+
+    arena_clear(&arena);
+    assert_eq_uint(t, arena.used, 0, "clear resets usage");
+    assert_true(t, arena.blocks != NULL, "clear keeps the current block");
+    assert_true(t, arena_alloc(&arena, int, 1) != NULL, "arena is reused");
+
+    arena_release(&arena);
+    assert_true(t, arena.blocks == NULL, "release returns all blocks");
+    assert_eq_uint(t, arena.size, 0, "release empties the arena");
+    assert_true(t, arena_alloc(&arena, int, 1) != NULL, "arena grows again");
+    arena_release(&arena);
+}
+
+void test_arena_mark(test *t) {
+    // fixed buffer
+    alignas(max_align_t) uchar buffer[64] = {0};
+    arena fixed = arena_new(buffer, sizeof(buffer));
+    (void)arena_alloc(&fixed, uchar, 10);
+    arena_marker fixed_mark = arena_mark(&fixed);
+    (void)arena_alloc(&fixed, uchar, 30);
+    arena_reset_to(&fixed, fixed_mark);
+    assert_eq_uint(t, fixed.used, 10, "fixed arena usage is restored");
+
+    // chained arena across blocks
+    arena arena = arena_new_chained(&std_allocator, 256);
+    arena_marker empty = arena_mark(&arena);
+    ullong *first = arena_alloc(&arena, ullong, 4);
+    assert_true(t, first != NULL, "first allocation must succeed");
+    first[3] = 42;
+
+    arena_marker mark = arena_mark(&arena);
+    uchar *block = arena.buffer;
+    size_t used = arena.used;
+    for (size_t i = 0; i < 100; i += 1) {
+        (void)arena_alloc(&arena, ullong, 4);
+    }
+    uchar *big = arena_alloc(&arena, uchar, arena.next_block_size);
+    assert_true(t, big != NULL, "oversized allocation must succeed");
+    assert_true(t, arena.buffer != block, "arena moved to a new block");
+
+    arena_reset_to(&arena, mark);
+    assert_true(t, arena.buffer == block, "marked block is current again");
+    assert_eq_uint(t, arena.used, used, "marked usage is restored");
+    assert_true(t, arena.oversized == NULL, "oversized blocks are freed");
+    assert_eq_uint(t, first[3], 42, "memory before the mark is kept");
+
+    // nested marks
+    arena_marker outer = arena_mark(&arena);
+    (void)arena_alloc(&arena, int, 8);
+    arena_marker inner = arena_mark(&arena);
+    (void)arena_alloc(&arena, int, 8);
+    arena_reset_to(&arena, inner);
+    assert_eq_uint(t, arena.used, inner.used, "inner mark is restored");
+    arena_reset_to(&arena, outer);
+    assert_eq_uint(t, arena.used, outer.used, "outer mark is restored");
+
+    // mark before the first block
+    arena_reset_to(&arena, empty);
+    assert_eq_uint(t, arena.used, 0, "reset to empty clears the arena");
+    assert_true(t, arena.blocks != NULL, "current block is kept");
+    arena_release(&arena);
+}
+
+void test_arena_reserved(test *t) {
+    size_t reserve = 64 * arena_commit_size;
+    arena arena = arena_new_reserved(reserve, arena_flag_decommit_on_clear);
+    if (!assert_true(t, arena.buffer != NULL, "reservation must succeed")) {
+        return;
+    }
+    assert_eq_uint(t, arena.reserved, reserve, "reserved size");
+    assert_eq_uint(t, arena.size, 0, "nothing is committed up front");
+
+    uchar *a = arena_alloc(&arena, uchar, 100);
+    assert_true(t, a == arena.buffer, "first allocation at the start");
+    assert_eq_uint(t, arena.size, arena_commit_size, "first commit");
+    a[99] = 'a';
+
+    // crossing the committed size commits more without moving anything
+    uchar *b = arena_alloc(&arena, uchar, arena_commit_size * 3);
+    assert_true(t, b == a + 100, "allocations are contiguous");
+    assert_eq_uint(t, arena.size, arena_commit_size * 4, "more is committed");
+    b[arena_commit_size * 3 - 1] = 'b';
+
+    // a dynamic array at the end grows in place
+    allocator alloc = arena_allocator_new(&arena);
+    int *arr = dynarr_new(16, int, &alloc);
+    int *first = arr;
+    uint moved = 0;
+    for (int i = 0; i < 100000; i += 1) {
+        arr = dynarr_push_grow(arr, &i, 1, int);
+        moved += arr != first;
+    }
+    assert_eq_uint(t, moved, 0, "array is grown in place");
+    assert_eq_sint(t, arr[99999], 99999, "array contents");
+
+    // the reservation is the limit
+    void *too_big = arena_alloc_bytes(&arena, reserve, 1);
+    assert_true(t, too_big == NULL, "allocation beyond the reservation fails");
+
+    // cleared memory is returned to the system and reads back as zero
+    arena_clear(&arena);
+    assert_eq_uint(t, arena.used, 0, "clear resets usage");
+    uchar *c = arena_alloc(&arena, uchar, 100);
+    assert_true(t, c == a, "memory is reused from the start");
+    assert_eq_uint(t, c[99], 0, "decommitted memory is zeroed");
+
+    arena_release(&arena);
+    assert_true(t, arena.buffer == NULL, "release returns the reservation");
+    assert_eq_uint(t, arena.reserved, 0, "nothing is reserved");
+}
+
+static uint scratch_use(arena *caller) {
+    arena_scratch scratch = arena_scratch_begin(&caller, 1);
+    uint *p = arena_alloc(scratch.arena, uint, 16);
+    uint aliased = scratch.arena == caller;
+    if (p) {
+        p[0] = 1;
+    }
+    arena_scratch_end(scratch);
+    return aliased;
+}
+
+void test_arena_scratch(test *t) {
+    arena_scratch outer = arena_scratch_begin(NULL, 0);
+    assert_true(t, outer.arena != NULL, "scratch arena is available");
+    uint *values = arena_alloc(outer.arena, uint, 4);
+    assert_true(t, values != NULL, "scratch allocation must succeed");
+    values[0] = 7;
+
+    // a callee borrowing with the caller's arena as a conflict gets another
+    uint aliased = scratch_use(outer.arena);
+    assert_eq_uint(t, aliased, 0, "scratch arena must not alias the caller");
+    assert_eq_uint(t, values[0], 7, "caller memory is intact");
+
+    // borrowing recursively from the same arena releases only the inner use
+    size_t used = outer.arena->used;
+    arena_scratch inner = arena_scratch_begin(NULL, 0);
+    assert_true(t, inner.arena == outer.arena, "first free arena is reused");
+    (void)arena_alloc(inner.arena, uint, 1000);
+    arena_scratch_end(inner);
+    assert_eq_uint(t, outer.arena->used, used, "inner use is released");
+
+    arena_scratch_end(outer);
+    arena_scratch_release();
+}
+
+static void *scratch_thread_f(void *ctx) {
+    arena **result = ctx;
+    arena_scratch scratch = arena_scratch_begin(NULL, 0);
+    *result = scratch.arena;
+    arena_scratch_end(scratch);
+    arena_scratch_release();
+    return NULL;
+}
+
+void test_arena_scratch_threads(test *t) {
+    arena *other = NULL;
+    pthread_t thread;
+    int err = pthread_create(&thread, NULL, scratch_thread_f, &other);
+    assert_eq_sint(t, err, 0, "thread creation must succeed");
+    err = pthread_join(thread, NULL);
+    assert_eq_sint(t, err, 0, "thread join must succeed");
+
+    arena_scratch scratch = arena_scratch_begin(NULL, 0);
+    assert_true(t, other != NULL, "thread got a scratch arena");
+    assert_true(
+        t, scratch.arena != other, "threads have their own scratch arenas"
+    );
+    arena_scratch_end(scratch);
+    arena_scratch_release();
+}
+
+static test_case tests[] = {
+    {"Arena", test_arena},
+    {"Arena realloc", test_arena_realloc},
+    {"Chained arena", test_arena_chained},
+    {"Arena mark", test_arena_mark},
+    {"Reserved arena", test_arena_reserved},
+    {"Scratch arena", test_arena_scratch},
+    {"Scratch arena threads", test_arena_scratch_threads},
+};
 
 setup_tests(NULL, tests)
@@ -0,0 +1,161 @@
+#include "std.h"
+#include "testr.h"
+
+static const uint feature_levels[] = {
+    ~0U,
+    cpu_feature_popcnt | cpu_feature_sse2,
+    0,
+};
+
+void test_bitvec_bits(test *t) {
+    bitvec b;
+    if (!assert_true(t, bitvec_init(&b, 130, &std_allocator), "init")) {
+        return;
+    }
+    assert_eq_uint(t, bitvec_count(&b), 0, "new vector is empty");
+    assert_eq_sint(t, bitvec_next_set(&b, 0), -1, "no bits are set");
+
+    bitvec_set(&b, 0);
+    bitvec_set(&b, 63);
+    bitvec_set(&b, 64);
+    bitvec_set(&b, 129);
+    assert_true(t, bitvec_get(&b, 63), "bit 63 is set");
+    assert_false(t, bitvec_get(&b, 62), "bit 62 is not set");
+    assert_eq_uint(t, bitvec_count(&b), 4, "count after set");
+    assert_eq_sint(t, bitvec_next_set(&b, 0), 0, "first bit");
+    assert_eq_sint(t, bitvec_next_set(&b, 1), 63, "next bit");
+    assert_eq_sint(t, bitvec_next_set(&b, 65), 129, "bit in the last word");
+    assert_eq_sint(t, bitvec_next_set(&b, 130), -1, "past the end");
+
+    bitvec_unset(&b, 63);
+    assert_false(t, bitvec_get(&b, 63), "bit 63 is unset");
+    assert_eq_sint(t, bitvec_next_set(&b, 1), 64, "next bit after unset");
+
+    bitvec_fill(&b, true);
+    assert_eq_uint(t, bitvec_count(&b), 130, "all bits are set");
+    assert_eq_uint(t, b.words[2], 3, "bits past the end stay unset");
+    bitvec_fill(&b, false);
+    assert_eq_uint(t, bitvec_count(&b), 0, "all bits are unset");
+    bitvec_free(&b);
+
+    assert_true(t, bitvec_init(&b, 0, &std_allocator), "empty vector");
+    assert_eq_uint(t, bitvec_count(&b), 0, "empty vector has no bits");
+    assert_eq_sint(t, bitvec_next_set(&b, 0), -1, "empty vector search");
+    bitvec_iter it;
+    size_t bit;
+    bitvec_iter_init(&it, &b);
+    assert_false(t, bitvec_iter_next(&it, &bit), "empty vector iteration");
+    bitvec_free(&b);
+}
+
+void test_bitvec_ops(test *t) {
+    // lengths around the SIMD block sizes
+    const size_t lens[] = {1, 64, 200, 256, 1000, 4096 * 8 + 77};
+
+    for (size_t l = 0; l < countof(lens); l += 1) {
+        size_t len = lens[l];
+        bitvec a, b, c;
+        bitvec_init(&a, len, &std_allocator);
+        bitvec_init(&b, len, &std_allocator);
+        bitvec_init(&c, len, &std_allocator);
+
+        ullong state = len;
+        size_t count_a = 0, count_b = 0, count_and = 0, count_or = 0;
+        for (size_t i = 0; i < len; i += 1) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            bool in_a = (state >> 40) & 1;
+            bool in_b = (state >> 50) & 1;
+            if (in_a) {
+                bitvec_set(&a, i);
+            }
+            if (in_b) {
+                bitvec_set(&b, i);
+            }
+            count_a += in_a;
+            count_b += in_b;
+            count_and += in_a && in_b;
+            count_or += in_a || in_b;
+        }
+
+        uint failures = 0;
+        for (size_t f = 0; f < countof(feature_levels); f += 1) {
+            cpu_features_limit(feature_levels[f]);
+            failures += bitvec_count(&a) != count_a;
+            failures += bitvec_count(&b) != count_b;
+
+            bitvec_fill(&c, false);
+            bitvec_or(&c, &a);
+            bitvec_and(&c, &b);
+            failures += bitvec_count(&c) != count_and;
+
+            bitvec_fill(&c, false);
+            bitvec_or(&c, &a);
+            bitvec_or(&c, &b);
+            failures += bitvec_count(&c) != count_or;
+
+            bitvec_fill(&c, false);
+            bitvec_or(&c, &a);
+            bitvec_xor(&c, &b);
+            failures += bitvec_count(&c) != count_or - count_and;
+
+            bitvec_fill(&c, false);
+            bitvec_or(&c, &a);
+            bitvec_andnot(&c, &b);
+            failures += bitvec_count(&c) != count_a - count_and;
+            for (size_t i = 0; i < len; i += 1) {
+                bool expected = bitvec_get(&a, i) && !bitvec_get(&b, i);
+                failures += bitvec_get(&c, i) != expected;
+            }
+        }
+        cpu_features_limit(~0U);
+        assert_eq_uint(t, failures, 0, "operations match the reference");
+
+        bitvec_free(&a);
+        bitvec_free(&b);
+        bitvec_free(&c);
+    }
+}
+
+void test_bitvec_iter(test *t) {
+    bitvec b;
+    bitvec_init(&b, 5000, &std_allocator);
+    for (size_t i = 0; i < 5000; i += 7) {
+        bitvec_set(&b, i);
+    }
+    bitvec_set(&b, 4999);
+
+    bitvec_iter it;
+    bitvec_iter_init(&it, &b);
+    size_t bit = 0, count = 0;
+    llong search = bitvec_next_set(&b, 0);
+    uint mismatches = 0;
+    while (bitvec_iter_next(&it, &bit)) {
+        mismatches += (llong)bit != search;
+        search = bitvec_next_set(&b, bit + 1);
+        count += 1;
+    }
+    assert_eq_uint(t, mismatches, 0, "iteration matches the search");
+    assert_eq_uint(t, count, bitvec_count(&b), "every bit is visited");
+    assert_eq_uint(t, bit, 4999, "last bit");
+    assert_eq_sint(t, search, -1, "nothing left after the last bit");
+    bitvec_free(&b);
+}
+
+void test_bitvec_arena(test *t) {
+    ullong buffer[4];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+    bitvec b;
+    assert_true(t, bitvec_init(&b, 256, &alloc), "bits fit the arena");
+    assert_false(t, bitvec_init(&b, 1, &alloc), "arena is full");
+    assert_eq_uint(t, b.len, 0, "failed vector is empty");
+}
+
+static test_case tests[] = {
+    {"Bit vector bits", test_bitvec_bits},
+    {"Bit vector operations", test_bitvec_ops},
+    {"Bit vector iteration", test_bitvec_iter},
+    {"Bit vector with arena", test_bitvec_arena},
+};
+
+setup_tests(NULL, tests)
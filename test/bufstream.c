@@ -36,6 +36,20 @@ bytebuf_collect(void *context, const uchar *src, size_t len) {
     return res;
 }
 
+// Accepts at most a few bytes per call like a slow file or a socket
+static bytesink_result
+bytebuf_collect_partial(void *context, const uchar *src, size_t len) {
+    bytesink_result res = {0};
+    bytebuf *bbuf = context;
+    bytebuf_result bbuf_res = bytebuf_write(bbuf, src, min(len, (size_t)3));
+    if (bbuf_res.ok) {
+        res.len = bbuf_res.len;
+    } else {
+        res.err_code = 1;
+    }
+    return res;
+}
+
 void test_buffered_stream_short_writes(test *t) {
     uchar bytebuf_buf[1024];
     uchar bstream_buf[10];
@@ -149,10 +163,208 @@ void test_buffered_stream_failing_writes(test *t) {
     );
 }
 
+void test_buffered_stream_hex(test *t) {
+    uchar bytebuf_buf[1024];
+    uchar src[200];
+    char expected[sizeof(src) * 2 + 1];
+    for (size_t i = 0; i < sizeof(src); i += 1) {
+        src[i] = (uchar)i;
+    }
+    bytes_to_hex(expected, sizeof(expected), (const char *)src, sizeof(src));
+
+    // odd capacities leave a single byte free before flushing
+    size_t caps[] = {1, 2, 7, 10, 64};
+    for (size_t i = 0; i < countof(caps); i += 1) {
+        uchar bstream_buf[64];
+        struct bytesink_ctx_bytebuf context = {0};
+        bytebuf_init_fixed(&context.bbuf, slice_arr(bytebuf_buf), 0);
+        bufstream bstream = {
+            .buffer = bstream_buf,
+            .cap = caps[i],
+            .len = 0,
+            .sink = {
+                .fn = bytebuf_collect,
+                .context = &context,
+            },
+        };
+
+        bufstream_write_result res = bufstream_fmt(
+            &bstream, "h", slice_const_new(src, sizeof(src))
+        );
+        assert_eq_sint(t, res.err_code, 0, "no error");
+        assert_eq_uint(t, res.len, sizeof(src) * 2, "length of hex");
+        bufstream_flush(&bstream);
+        assert_eq_uint(
+            t, context.bbuf.len, sizeof(src) * 2, "sink length of hex"
+        );
+        assert_eq_bytes(
+            t, context.bbuf.buffer, expected, sizeof(src) * 2, "hex contents"
+        );
+    }
+}
+
+void test_buffered_stream_crc32c(test *t) {
+    uchar bytebuf_buf[1024];
+    uchar bstream_buf[16];
+
+    bytebuf bbuf;
+    bytebuf_init_fixed(&bbuf, slice_arr(bytebuf_buf), 0);
+    crc32c_bytesink_context crc_ctx = {
+        .sink = {.fn = bytebuf_collect_partial, .context = &bbuf},
+        .crc = 0,
+    };
+    bufstream bstream = {
+        .buffer = bstream_buf,
+        .cap = sizeof(bstream_buf),
+        .len = 0,
+        .sink = crc32c_bytesink(&crc_ctx),
+    };
+
+    for (uint i = 0; i < 50; i += 1) {
+        bufstream_write_result res = bufstream_write_uint(&bstream, i * 7919);
+        if (!assert_eq_sint(t, res.err_code, 0, "no error")) {
+            return;
+        }
+        bufstream_write_sstr(&bstream, ",");
+    }
+    while (bstream.len) {
+        bufstream_flush(&bstream);
+    }
+
+    assert_eq_uint(
+        t,
+        crc_ctx.crc,
+        slice_crc32c(slice_const_new(bbuf.buffer, bbuf.len), 0),
+        "checksum of the flushed bytes"
+    );
+    assert_true(
+        t,
+        bytes_eq(bbuf.buffer, "0,7919,15838,", lengthof("0,7919,15838,")),
+        "partially written bytes are kept in order"
+    );
+}
+
+void test_buffered_stream_reserve(test *t) {
+    uchar bytebuf_buf[1024];
+    uchar bstream_buf[8];
+
+    struct bytesink_ctx_bytebuf context = {0};
+    bytebuf_init_fixed(&context.bbuf, slice_arr(bytebuf_buf), 0);
+    bufstream bstream = {
+        .buffer = bstream_buf,
+        .cap = sizeof(bstream_buf),
+        .len = 0,
+        .sink = {
+            .fn = bytebuf_collect,
+            .context = &context,
+        },
+    };
+
+    bufstream_write_sstr(&bstream, "abcde");
+    bufstream_reserve_result reserved = bufstream_reserve(&bstream, 3);
+    assert_true(t, reserved.ptr == bstream_buf + 5, "space after the content");
+    assert_eq_uint(t, context.bbuf.len, 0, "no flush when space is left");
+    bytes_copy(reserved.ptr, "fg", 2);
+    bufstream_commit(&bstream, 2);
+
+    reserved = bufstream_reserve(&bstream, 4);
+    assert_true(t, reserved.ptr == bstream_buf, "buffer is flushed");
+    assert_eq_uint(t, reserved.len, sizeof(bstream_buf), "whole buffer");
+    assert_eq_uint(t, context.bbuf.len, 7, "sink len = 7");
+
+    reserved = bufstream_reserve(&bstream, sizeof(bstream_buf) + 1);
+    assert_true(t, reserved.ptr == NULL, "space larger than the buffer");
+    assert_eq_sint(t, reserved.err_code, 0, "no error");
+}
+
+void test_buffered_stream_numbers(test *t) {
+    uchar bytebuf_buf[1024];
+    const char expected[] = "-123456 4294967295 -9223372036854775807 "
+                            "18446744073709551615 -2.50";
+
+    // numbers are formatted in place or written through a temporary buffer
+    // when they do not fit the stream buffer
+    size_t caps[] = {1, 3, 8, 64};
+    for (size_t i = 0; i < countof(caps); i += 1) {
+        uchar bstream_buf[64];
+        struct bytesink_ctx_bytebuf context = {0};
+        bytebuf_init_fixed(&context.bbuf, slice_arr(bytebuf_buf), 0);
+        bufstream bstream = {
+            .buffer = bstream_buf,
+            .cap = caps[i],
+            .len = 0,
+            .sink = {
+                .fn = bytebuf_collect,
+                .context = &context,
+            },
+        };
+
+        cstr_fmt_float f = {-2.5, 2};
+        bufstream_write_result res = bufstream_fmt(
+            &bstream,
+            "i u I U F",
+            -123456,
+            UINT_MAX,
+            -LLONG_MAX,
+            ULLONG_MAX,
+            f
+        );
+        assert_eq_sint(t, res.err_code, 0, "no error");
+        assert_eq_uint(t, res.len, lengthof(expected), "length of numbers");
+        bufstream_flush(&bstream);
+        assert_eq_uint(
+            t, context.bbuf.len, lengthof(expected), "sink length of numbers"
+        );
+        assert_eq_bytes(
+            t,
+            context.bbuf.buffer,
+            (const uchar *)expected,
+            lengthof(expected),
+            "number contents"
+        );
+    }
+}
+
+void test_byte_buffer_reserve(test *t) {
+    bytebuf bbuf = bytebuf_new(4, &std_allocator);
+    bytebuf_write_sstr(&bbuf, "ab");
+
+    uchar *dest = bytebuf_reserve(&bbuf, 10);
+    if (!assert_true(t, dest != NULL, "buffer grows for the space")) {
+        return;
+    }
+    assert_true(t, dest == bbuf.buffer + 2, "space after the content");
+    assert_ge_uint(t, bytebuf_bytes_available(&bbuf), 10, "space available");
+    bytes_copy(dest, "cdef", 4);
+    bytebuf_commit(&bbuf, 4);
+    assert_eq_uint(t, bbuf.len, 6, "committed bytes are added");
+
+    bytebuf_result res = bytebuf_write_llong(&bbuf, -42);
+    assert_eq_uint(t, res.offset, 6, "number offset");
+    assert_eq_uint(t, res.len, 3, "number length");
+    bytebuf_write_double(&bbuf, 1.5, 1);
+    assert_eq_bytes(
+        t, bbuf.buffer, (const uchar *)"abcdef-421.5", 12, "contents"
+    );
+    bytebuf_free(&bbuf);
+
+    uchar fixed_buf[4];
+    bytebuf fixed = bytebuf_new_fixed(slice_arr(fixed_buf), 0);
+    assert_true(t, bytebuf_reserve(&fixed, 5) == NULL, "fixed buffer is full");
+    res = bytebuf_write_uint(&fixed, 12345);
+    assert_false(t, res.ok, "number does not fit");
+    assert_eq_uint(t, fixed.len, 0, "nothing is written");
+}
+
 static test_case tests[] = {
     {"Buffered stream short writes", test_buffered_stream_short_writes},
     {"Buffered stream long writes", test_buffered_stream_long_writes},
-    {"Buffered stream failing writes", test_buffered_stream_failing_writes}
+    {"Buffered stream failing writes", test_buffered_stream_failing_writes},
+    {"Buffered stream hex", test_buffered_stream_hex},
+    {"Buffered stream checksum", test_buffered_stream_crc32c},
+    {"Buffered stream reserve", test_buffered_stream_reserve},
+    {"Buffered stream numbers", test_buffered_stream_numbers},
+    {"Byte buffer reserve", test_byte_buffer_reserve},
 };
 
 setup_tests(NULL, tests)
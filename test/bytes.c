@@ -128,6 +128,141 @@ void test_bytes_zero(test *t) {
     assert_eq_bytes(t, arr, expected_arr, sizeof(arr), "array must be zeroed");
 }
 
+void test_bytes_copy_sizes(test *t) {
+    uchar src[300];
+    uchar dest[320];
+    for (size_t i = 0; i < sizeof(src); i += 1) {
+        src[i] = (uchar)(i * 7 + 1);
+    }
+
+    // cover word and block sizes, unaligned offsets, and partial tails
+    uint mismatches = 0;
+    for (size_t len = 0; len + 4 <= sizeof(src); len += 1) {
+        for (size_t offset = 0; offset < 4; offset += 1) {
+            set_n(dest, 0xEE, countof(dest));
+            bytes_copy(dest + offset + 8, src + offset, len);
+            if (!bytes_eq(dest + offset + 8, src + offset, len)) {
+                mismatches += 1;
+            }
+            for (size_t i = 0; i < sizeof(dest); i += 1) {
+                if ((i < offset + 8 || i >= offset + 8 + len)
+                    && dest[i] != 0xEE) {
+                    mismatches += 1;
+                }
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "copy of every length");
+}
+
+void test_bytes_move_overlap_sizes(test *t) {
+    uchar buffer[600];
+    uchar expected[600];
+    const size_t shifts[] = {
+        1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127, 200
+    };
+
+    uint mismatches = 0;
+    for (size_t len = 0; len <= 300; len += 1) {
+        for (size_t i = 0; i < countof(shifts); i += 1) {
+            size_t shift = shifts[i];
+            for (int forward = 0; forward < 2; forward += 1) {
+                for (size_t j = 0; j < sizeof(buffer); j += 1) {
+                    buffer[j] = (uchar)(j * 13 + 5);
+                }
+                size_t from = forward ? 50 + shift : 50;
+                size_t to = forward ? 50 : 50 + shift;
+                // reference: copy through a temporary buffer
+                uchar tmp[300];
+                for (size_t j = 0; j < len; j += 1) {
+                    tmp[j] = buffer[from + j];
+                }
+                for (size_t j = 0; j < sizeof(buffer); j += 1) {
+                    expected[j] = buffer[j];
+                }
+                for (size_t j = 0; j < len; j += 1) {
+                    expected[to + j] = tmp[j];
+                }
+
+                bytes_move(buffer + to, buffer + from, len);
+                if (!bytes_eq(buffer, expected, sizeof(buffer))) {
+                    mismatches += 1;
+                }
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "overlapping move of every length");
+}
+
+void test_bytes_set_sizes(test *t) {
+    uchar dest[320];
+
+    uint mismatches = 0;
+    for (size_t len = 0; len + 12 <= sizeof(dest); len += 1) {
+        for (size_t offset = 0; offset < 4; offset += 1) {
+            set_n(dest, 0xEE, countof(dest));
+            bytes_set(dest + offset + 8, 0x5A, len);
+            for (size_t i = 0; i < sizeof(dest); i += 1) {
+                bool inside = i >= offset + 8 && i < offset + 8 + len;
+                if (dest[i] != (inside ? 0x5A : 0xEE)) {
+                    mismatches += 1;
+                }
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "set of every length");
+}
+
+void test_bytes_copy_large(test *t) {
+    // large enough to use rep movsb/stosb and non-temporal stores
+    const size_t sizes[] = {3000 + 5, (5 << 20) + 77};
+    const size_t cap = (5 << 20) + 77 + 64;
+    allocation a = alloc_new(&std_allocator, uchar, cap);
+    allocation b = alloc_new(&std_allocator, uchar, cap);
+    if (!assert_true(t, a.ptr && b.ptr, "malloc must succeed")) {
+        if (a.ptr) {
+            alloc_free(&std_allocator, a);
+        }
+        if (b.ptr) {
+            alloc_free(&std_allocator, b);
+        }
+        return;
+    }
+    uchar *src = a.ptr;
+    uchar *dest = b.ptr;
+    for (size_t j = 0; j < cap; j += 1) {
+        src[j] = (uchar)(j * 31 + (j >> 12));
+    }
+
+    for (size_t i = 0; i < countof(sizes); i += 1) {
+        size_t len = sizes[i];
+
+        // unaligned destination
+        bytes_copy(dest + 3, src + 1, len);
+        assert_true(t, bytes_eq(dest + 3, src + 1, len), "large copy");
+
+        bytes_set(dest + 5, 0xA5, len);
+        uint mismatches = 0;
+        for (size_t j = 0; j < len; j += 1) {
+            if (dest[j + 5] != 0xA5) {
+                mismatches += 1;
+            }
+        }
+        assert_eq_uint(t, mismatches, 0, "large set");
+
+        // overlapping moves in both directions
+        bytes_copy(dest, src, len + 64);
+        bytes_move(dest + 33, dest, len);
+        assert_true(t, bytes_eq(dest + 33, src, len), "large move right");
+        bytes_copy(dest, src, len + 64);
+        bytes_move(dest, dest + 33, len);
+        assert_true(t, bytes_eq(dest, src + 33, len), "large move left");
+    }
+
+    alloc_free(&std_allocator, a);
+    alloc_free(&std_allocator, b);
+}
+
 void test_bytes_to_hex(test *t) {
     const char *str = "hello world!";
     const char *expected_str = "68656c6c6f20776f726c6421";
@@ -139,13 +274,547 @@ void test_bytes_to_hex(test *t) {
     assert_eq_uint(t, len, 24, "length of the converted string");
 }
 
+void test_bytes_to_hex_blocks(test *t) {
+    const char digits[] = "0123456789abcdef";
+    uchar src[100];
+    char expected[sizeof(src) * 2];
+    for (size_t i = 0; i < sizeof(src); i += 1) {
+        src[i] = (uchar)(i * 37 + 128);
+        expected[i * 2] = digits[src[i] >> 4];
+        expected[i * 2 + 1] = digits[src[i] & 15];
+    }
+
+    // cover block sizes and partial tail blocks
+    uint mismatches = 0;
+    for (size_t len = 0; len <= sizeof(src); len += 1) {
+        char dest[sizeof(expected) + 2];
+        set_n((uchar *)dest, 'x', sizeof(dest));
+        size_t written =
+            bytes_to_hex(dest, len * 2 + 1, (const char *)src, len);
+        if (written != len * 2 || !bytes_eq(dest, expected, len * 2)
+            || dest[len * 2] != '\0' || dest[len * 2 + 1] != 'x') {
+            mismatches += 1;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "hex of every length");
+
+    // only whole bytes are written to a short buffer
+    char dest[5] = "xxxx";
+    size_t len = bytes_to_hex(dest, 3, (const char *)src, sizeof(src));
+    assert_eq_uint(t, len, 2, "length of truncated hex");
+    assert_eq_bytes(t, dest, expected, 2, "truncated hex contents");
+    assert_eq_sint(t, dest[2], '\0', "truncated hex is null terminated");
+    assert_eq_sint(t, dest[3], 'x', "no write past the buffer");
+}
+
+void test_bytes_from_hex(test *t) {
+    uchar src[100];
+    char hex[sizeof(src) * 2 + 1];
+    for (size_t i = 0; i < sizeof(src); i += 1) {
+        src[i] = (uchar)(i * 37 + 128);
+    }
+    bytes_to_hex(hex, sizeof(hex), (const char *)src, sizeof(src));
+
+    uchar dest[sizeof(src)];
+    uint mismatches = 0;
+    for (size_t len = 0; len <= sizeof(src); len += 1) {
+        bytes_set(dest, 0, sizeof(dest));
+        llong decoded = bytes_from_hex(dest, sizeof(dest), hex, len * 2);
+        if (decoded != (llong)len || !bytes_eq(dest, src, len)) {
+            mismatches += 1;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "decode every length");
+
+    // an invalid character at any position is detected
+    const char invalid[] = {'/', ':', '@', 'G', '`', 'g', ' ', (char)0xC3};
+    mismatches = 0;
+    for (size_t i = 0; i < sizeof(hex) - 1; i += 1) {
+        char c = hex[i];
+        for (size_t j = 0; j < sizeof(invalid); j += 1) {
+            hex[i] = invalid[j];
+            if (bytes_from_hex(dest, sizeof(dest), hex, sizeof(hex) - 1)
+                != -1) {
+                mismatches += 1;
+            }
+        }
+        hex[i] = c;
+    }
+    assert_eq_uint(t, mismatches, 0, "invalid characters");
+
+    const char *upper = "DEADbeef0123456789ABCDEFabcdef";
+    uchar upper_dest[15];
+    const uchar upper_expected[] = {
+        0xDE, 0xAD, 0xBE, 0xEF, 0x01, 0x23, 0x45, 0x67,
+        0x89, 0xAB, 0xCD, 0xEF, 0xAB, 0xCD, 0xEF,
+    };
+    assert_eq_sint(
+        t,
+        bytes_from_hex(upper_dest, sizeof(upper_dest), upper, 30),
+        15,
+        "mixed case length"
+    );
+    assert_eq_bytes(
+        t, upper_dest, upper_expected, sizeof(upper_expected), "mixed case"
+    );
+    assert_eq_sint(
+        t, bytes_from_hex(upper_dest, sizeof(upper_dest), upper, 3), -1, "odd"
+    );
+    assert_eq_sint(
+        t, bytes_from_hex(upper_dest, 2, upper, 30), 2, "short destination"
+    );
+}
+
+void test_bytes_index_of_byte(test *t) {
+    uchar buffer[300];
+    set_n(buffer, 'a', countof(buffer));
+
+    assert_eq_sint(
+        t, bytes_index_of_byte(buffer, 0, 'a'), -1, "empty buffer"
+    );
+    assert_eq_sint(
+        t,
+        bytes_index_of_byte(buffer, sizeof(buffer), 'b'),
+        -1,
+        "byte not found"
+    );
+    assert_eq_sint(
+        t, bytes_index_of_byte(buffer, sizeof(buffer), 'a'), 0, "first byte"
+    );
+
+    // cover block sizes, block boundaries, and partial tail blocks
+    uint mismatches = 0;
+    for (size_t len = 1; len <= sizeof(buffer); len += 1) {
+        for (size_t i = 0; i < len; i += 1) {
+            buffer[i] = 'x';
+            if (len - 1 > i) {
+                buffer[len - 1] = 'x';
+            }
+            if (bytes_index_of_byte(buffer, len, 'x') != (llong)i) {
+                mismatches += 1;
+            }
+            buffer[i] = 'a';
+            buffer[len - 1] = 'a';
+        }
+        // a match right after the end must not be found
+        if (len < sizeof(buffer)) {
+            buffer[len] = 'x';
+            if (bytes_index_of_byte(buffer, len, 'x') != -1) {
+                mismatches += 1;
+            }
+            buffer[len] = 'a';
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "index of byte at every position");
+}
+
+void test_bytes_last_index_of_byte(test *t) {
+    uchar buffer[300];
+    set_n(buffer, 'a', countof(buffer));
+
+    assert_eq_sint(
+        t, bytes_last_index_of_byte(buffer, 0, 'a'), -1, "empty buffer"
+    );
+    assert_eq_sint(
+        t,
+        bytes_last_index_of_byte(buffer, sizeof(buffer), 'b'),
+        -1,
+        "byte not found"
+    );
+    assert_eq_sint(
+        t,
+        bytes_last_index_of_byte(buffer, sizeof(buffer), 'a'),
+        (llong)sizeof(buffer) - 1,
+        "last byte"
+    );
+
+    // cover block sizes, block boundaries, and partial head blocks
+    uint mismatches = 0;
+    for (size_t len = 1; len < sizeof(buffer); len += 1) {
+        for (size_t i = 0; i < len; i += 1) {
+            buffer[1] = 'x';
+            buffer[i + 1] = 'x';
+            if (bytes_last_index_of_byte(buffer + 1, len, 'x') != (llong)i) {
+                mismatches += 1;
+            }
+            buffer[1] = 'a';
+            buffer[i + 1] = 'a';
+        }
+        // a match right before the start must not be found
+        buffer[0] = 'x';
+        if (bytes_last_index_of_byte(buffer + 1, len, 'x') != -1) {
+            mismatches += 1;
+        }
+        buffer[0] = 'a';
+    }
+    assert_eq_uint(t, mismatches, 0, "last index of byte at every position");
+}
+
+void test_bytes_index_of(test *t) {
+    const char *text = "the quick brown fox jumps over the lazy dog";
+    size_t text_len = cstr_byte_len_unsafe(text);
+
+    assert_eq_sint(
+        t, bytes_index_of(text, text_len, "the", 3), 0, "match at start"
+    );
+    assert_eq_sint(
+        t, bytes_index_of(text, text_len, "fox", 3), 16, "match in middle"
+    );
+    assert_eq_sint(
+        t, bytes_index_of(text, text_len, "dog", 3), 40, "match at end"
+    );
+    assert_eq_sint(
+        t, bytes_index_of(text, text_len, "o", 1), 12, "single byte match"
+    );
+    assert_eq_sint(
+        t, bytes_index_of(text, text_len, "cat", 3), -1, "no match"
+    );
+    assert_eq_sint(
+        t,
+        bytes_index_of(text, text_len, "dogs", 4),
+        -1,
+        "no partial match past the end"
+    );
+    assert_eq_sint(t, bytes_index_of(text, text_len, "", 0), 0, "empty needle");
+    assert_eq_sint(
+        t, bytes_index_of(text, 3, "the quick", 9), -1, "needle too long"
+    );
+}
+
+void test_bytes_index_of_positions(test *t) {
+    uchar haystack[200];
+    const uchar needle[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJ";
+
+    // cover the short needle filter and the skip table for every position
+    uint mismatches = 0;
+    for (size_t needle_len = 2; needle_len < sizeof(needle); needle_len += 1) {
+        for (size_t i = 0; i + needle_len <= sizeof(haystack); i += 1) {
+            set_n(haystack, 'a', countof(haystack));
+            copy_n(haystack + i, needle, needle_len);
+            // near-miss before the actual match
+            if (i >= needle_len) {
+                copy_n(haystack + i - needle_len, needle, needle_len - 1);
+            }
+            llong index = bytes_index_of(
+                haystack, sizeof(haystack), needle, needle_len
+            );
+            if (index != (llong)i) {
+                mismatches += 1;
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "index of needle at every position");
+}
+
+void test_bytes_finder(test *t) {
+    const char *text = "0123456789abcdefghijklmnopqrstuvwxyz"
+                       "0123456789abcdefghijklmnopqrstuvwxyz"
+                       "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    size_t text_len = cstr_byte_len_unsafe(text);
+    const char *needle = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    size_t needle_len = cstr_byte_len_unsafe(needle);
+
+    bytes_finder finder;
+    bytes_finder_init(&finder, needle, needle_len);
+    assert_eq_sint(
+        t, bytes_finder_find(&finder, text, text_len), 72, "long needle found"
+    );
+    assert_eq_sint(
+        t,
+        bytes_finder_find(&finder, text, text_len - 1),
+        -1,
+        "long needle not found"
+    );
+    assert_eq_sint(
+        t,
+        bytes_finder_find(&finder, text + 73, text_len - 73),
+        -1,
+        "repeated search with the same finder"
+    );
+
+    bytes_finder_init(&finder, "xyz", 3);
+    assert_eq_sint(
+        t, bytes_finder_find(&finder, text, text_len), 33, "short needle found"
+    );
+    assert_eq_sint(
+        t,
+        bytes_finder_find(&finder, text + 34, text_len - 34),
+        35,
+        "short needle found again"
+    );
+
+    // empty needles agree with bytes_index_of
+    bytes_finder_init(&finder, "", 0);
+    assert_eq_sint(
+        t, bytes_finder_find(&finder, text, text_len), 0, "empty needle"
+    );
+    assert_eq_sint(
+        t,
+        bytes_finder_find(&finder, "", 0),
+        bytes_index_of("", 0, "", 0),
+        "empty needle in an empty haystack"
+    );
+    assert_eq_sint(
+        t,
+        bytes_finder_find(&finder, NULL, 0),
+        -1,
+        "empty needle in a null haystack"
+    );
+}
+
+void test_bytes_diff_index(test *t) {
+    uchar a[200], b[200];
+    set_n(a, 7, countof(a));
+    set_n(b, 7, countof(b));
+
+    assert_eq_sint(t, bytes_diff_index(a, b, 0, 0), -1, "empty buffers");
+    assert_eq_sint(
+        t, bytes_diff_index(a, b, 0, sizeof(a)), -1, "equal buffers"
+    );
+    assert_true(t, bytes_eq(a, b, sizeof(a)), "equal buffers");
+
+    // cover word/block sizes, unaligned heads and partial tails
+    uint mismatches = 0;
+    for (size_t start = 0; start < 40; start += 1) {
+        for (size_t len = start + 1; len + 2 <= sizeof(a); len += 1) {
+            for (size_t i = start; i < len; i += 1) {
+                b[i + 1] = 8;
+                if (bytes_diff_index(a + 1, b + 1, start, len) != (llong)i) {
+                    mismatches += 1;
+                }
+                b[i + 1] = 7;
+            }
+            // a difference past the end must not be found
+            b[len + 1] = 8;
+            if (bytes_diff_index(a + 1, b + 1, start, len) != -1) {
+                mismatches += 1;
+            }
+            b[len + 1] = 7;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "diff index at every position");
+}
+
+void test_bytes_cmp(test *t) {
+    const uchar a[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+    uchar b[sizeof(a)];
+    copy_n(b, a, countof(a));
+
+    assert_eq_sint(t, bytes_cmp(a, b, sizeof(a)), 0, "equal");
+    b[30] = '0';
+    assert_gt_sint(t, bytes_cmp(a, b, sizeof(a)), 0, "greater");
+    assert_lt_sint(t, bytes_cmp(b, a, sizeof(a)), 0, "less");
+    assert_eq_sint(t, bytes_cmp(a, b, 30), 0, "equal prefix");
+    b[30] = 0xFF;
+    assert_lt_sint(t, bytes_cmp(a, b, sizeof(a)), 0, "bytes are unsigned");
+}
+
+void test_byteset(test *t) {
+    const uchar members[] = {0x00, ',', ';', 0x7F, 0x80, 0xAB, 0xFF};
+    byteset set;
+    byteset_init(&set, members, sizeof(members));
+
+    uint mismatches = 0;
+    for (uint c = 0; c < 256; c += 1) {
+        bool expected =
+            bytes_index_of_byte(members, sizeof(members), (uchar)c) >= 0;
+        if (byteset_contains(&set, (uchar)c) != expected) {
+            mismatches += 1;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "set membership");
+}
+
+void test_bytes_index_of_any(test *t) {
+    const uchar members[] = {0x00, ',', 0x80, 0xFF};
+    byteset set;
+    byteset_init(&set, members, sizeof(members));
+
+    uchar buffer[100];
+    set_n(buffer, 'a', countof(buffer));
+
+    assert_eq_sint(t, bytes_index_of_any(buffer, 0, &set), -1, "empty buffer");
+    assert_eq_sint(
+        t, bytes_index_of_any(buffer, sizeof(buffer), &set), -1, "no match"
+    );
+    assert_eq_sint(
+        t, bytes_index_not_of_any(buffer, sizeof(buffer), &set), 0, "not of any"
+    );
+
+    // every member at every position for every length
+    uint mismatches = 0;
+    for (size_t len = 1; len <= sizeof(buffer); len += 1) {
+        for (size_t i = 0; i < len; i += 1) {
+            for (size_t m = 0; m < sizeof(members); m += 1) {
+                buffer[i] = members[m];
+                if (bytes_index_of_any(buffer, len, &set) != (llong)i) {
+                    mismatches += 1;
+                }
+            }
+            buffer[i] = 'a';
+        }
+        // a match right after the end must not be found
+        if (len < sizeof(buffer)) {
+            buffer[len] = ',';
+            if (bytes_index_of_any(buffer, len, &set) != -1) {
+                mismatches += 1;
+            }
+            buffer[len] = 'a';
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "index of any at every position");
+
+    // inverse search over a buffer full of members
+    set_n(buffer, ',', countof(buffer));
+    mismatches = 0;
+    for (size_t len = 1; len <= sizeof(buffer); len += 1) {
+        if (bytes_index_not_of_any(buffer, len, &set) != -1) {
+            mismatches += 1;
+        }
+        for (size_t i = 0; i < len; i += 1) {
+            buffer[i] = 0x81;
+            if (bytes_index_not_of_any(buffer, len, &set) != (llong)i) {
+                mismatches += 1;
+            }
+            buffer[i] = ',';
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "index not of any at every position");
+}
+
+void test_bytes_count_byte(test *t) {
+    uchar buffer[300];
+    for (size_t i = 0; i < sizeof(buffer); i += 1) {
+        buffer[i] = (uchar)(i % 7 == 0 ? '\n' : 'a' + i % 5);
+    }
+
+    assert_eq_uint(t, bytes_count_byte(buffer, 0, '\n'), 0, "empty buffer");
+    assert_eq_uint(
+        t, bytes_count_byte(buffer, sizeof(buffer), 'z'), 0, "no matches"
+    );
+
+    // every length against a byte-at-a-time count
+    uint mismatches = 0;
+    for (size_t len = 1; len <= sizeof(buffer); len += 1) {
+        for (size_t start = 0; start < 3 && start < len; start += 1) {
+            size_t expected = 0;
+            for (size_t i = start; i < len; i += 1) {
+                expected += buffer[i] == '\n';
+            }
+            if (bytes_count_byte(buffer + start, len - start, '\n')
+                != expected) {
+                mismatches += 1;
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "count at every length");
+
+    // enough matches to overflow byte sized counters
+    size_t len = 100000;
+    allocation a = alloc_new(&std_allocator, uchar, len);
+    uchar *big = a.ptr;
+    if (!assert_true(t, big, "malloc must succeed")) {
+        return;
+    }
+    set_n(big, 0xFF, len);
+    assert_eq_uint(t, bytes_count_byte(big, len, 0xFF), len, "all match");
+    big[0] = 0;
+    big[len / 2] = 0;
+    big[len - 1] = 0;
+    assert_eq_uint(t, bytes_count_byte(big, len, 0), 3, "sparse matches");
+    assert_eq_uint(
+        t, bytes_count_byte(big, len, 0xFF), len - 3, "dense matches"
+    );
+    alloc_free(&std_allocator, a);
+}
+
+void test_bytes_count_lines(test *t) {
+    assert_eq_uint(t, bytes_count_lines(NULL, 0), 0, "empty");
+    assert_eq_uint(
+        t, bytes_count_lines((const uchar *)"a", 1), 1, "no newline"
+    );
+    assert_eq_uint(
+        t, bytes_count_lines((const uchar *)"\n", 1), 1, "single newline"
+    );
+    assert_eq_uint(
+        t, bytes_count_lines((const uchar *)"a\nb", 3), 2, "unterminated"
+    );
+    assert_eq_uint(
+        t, bytes_count_lines((const uchar *)"a\nb\n", 4), 2, "terminated"
+    );
+    assert_eq_uint(
+        t, bytes_count_lines((const uchar *)"\n\n\n", 3), 3, "empty lines"
+    );
+}
+
+void test_bytes_index_of_nth_byte(test *t) {
+    uchar buffer[200];
+    set_n(buffer, 'a', countof(buffer));
+
+    assert_eq_sint(
+        t, bytes_index_of_nth_byte(buffer, 0, ',', 1), -1, "empty buffer"
+    );
+    assert_eq_sint(
+        t,
+        bytes_index_of_nth_byte(buffer, sizeof(buffer), 'a', 1),
+        0,
+        "first occurrence"
+    );
+    assert_eq_sint(
+        t,
+        bytes_index_of_nth_byte(buffer, sizeof(buffer), 'a', 200),
+        199,
+        "last occurrence"
+    );
+    assert_eq_sint(
+        t,
+        bytes_index_of_nth_byte(buffer, sizeof(buffer), 'a', 201),
+        -1,
+        "too few occurrences"
+    );
+
+    // every third byte is a separator
+    for (size_t i = 2; i < sizeof(buffer); i += 3) {
+        buffer[i] = ',';
+    }
+    uint mismatches = 0;
+    for (size_t len = 1; len <= sizeof(buffer); len += 1) {
+        size_t occurrences = len / 3;
+        for (size_t n = 1; n <= occurrences + 1; n += 1) {
+            llong expected = n <= occurrences ? (llong)(n * 3 - 1) : -1;
+            if (bytes_index_of_nth_byte(buffer, len, ',', n) != expected) {
+                mismatches += 1;
+            }
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "nth occurrence at every length");
+}
+
 static test_case tests[] = {
     {"Bytes copy", test_bytes_copy},
     {"Bytes move no overlap", test_bytes_move_no_overlap},
     {"Bytes move overlap left", test_bytes_move_overlap_left},
     {"Bytes move overlap right", test_bytes_move_overlap_right},
     {"Bytes zero", test_bytes_zero},
-    {"Bytes to hex", test_bytes_to_hex}
+    {"Bytes copy every size", test_bytes_copy_sizes},
+    {"Bytes move overlap every size", test_bytes_move_overlap_sizes},
+    {"Bytes set every size", test_bytes_set_sizes},
+    {"Bytes copy large", test_bytes_copy_large},
+    {"Bytes to hex", test_bytes_to_hex},
+    {"Bytes to hex blocks", test_bytes_to_hex_blocks},
+    {"Bytes from hex", test_bytes_from_hex},
+    {"Bytes index of byte", test_bytes_index_of_byte},
+    {"Bytes last index of byte", test_bytes_last_index_of_byte},
+    {"Bytes count byte", test_bytes_count_byte},
+    {"Bytes count lines", test_bytes_count_lines},
+    {"Bytes index of nth byte", test_bytes_index_of_nth_byte},
+    {"Bytes index of", test_bytes_index_of},
+    {"Bytes index of at every position", test_bytes_index_of_positions},
+    {"Bytes finder", test_bytes_finder},
+    {"Bytes diff index", test_bytes_diff_index},
+    {"Bytes compare", test_bytes_cmp},
+    {"Byte set", test_byteset},
+    {"Bytes index of any", test_bytes_index_of_any}
 };
 
 setup_tests(NULL, tests)
@@ -0,0 +1,156 @@
+#include "std.h"
+#include "testr.h"
+
+static const uint feature_levels[] = {
+    ~0U,
+    cpu_feature_avx2 | cpu_feature_popcnt | cpu_feature_ssse3
+        | cpu_feature_sse2,
+    cpu_feature_ssse3 | cpu_feature_sse2,
+    cpu_feature_sse2,
+    0,
+};
+
+void test_cpu_features_limit(test *t) {
+    uint all = cpu_features();
+#ifndef JP_SIMD_X86
+    assert_eq_uint(t, all, 0, "no features without SIMD");
+#endif
+
+    cpu_features_limit(cpu_feature_sse2);
+    assert_eq_uint(
+        t, cpu_features(), all & cpu_feature_sse2, "features are limited"
+    );
+    assert_false(
+        t, cpu_has_features(cpu_feature_avx2), "limited feature is missing"
+    );
+
+    cpu_features_limit(0);
+    assert_eq_uint(t, cpu_features(), 0, "all features limited");
+    assert_true(t, cpu_has_features(0), "empty feature set is supported");
+
+    cpu_features_limit(~0U);
+    assert_eq_uint(t, cpu_features(), all, "limit lifted");
+}
+
+void test_cpu_dispatch_select(test *t) {
+    static const int wide = 2, narrow = 1, fallback = 0;
+    const cpu_dispatch_variant variants[] = {
+        {cpu_feature_avx512 | cpu_feature_avx2, &wide},
+        {cpu_feature_sse2, &narrow},
+        {0, &fallback},
+    };
+
+    cpu_features_limit(0);
+    assert_true(
+        t,
+        cpu_dispatch_select(variants, countof(variants)) == &fallback,
+        "fallback without features"
+    );
+    assert_true(
+        t,
+        cpu_dispatch_select(variants, 2) == NULL,
+        "no match without a fallback"
+    );
+
+    cpu_features_limit(cpu_feature_sse2 | cpu_feature_avx2);
+    const void *expected = cpu_has_features(cpu_feature_sse2) ? &narrow
+                                                               : &fallback;
+    assert_true(
+        t,
+        cpu_dispatch_select(variants, countof(variants)) == expected,
+        "all required features must be supported"
+    );
+
+    cpu_features_limit(~0U);
+}
+
+void test_cpu_dispatch_bytes(test *t) {
+    uchar buffer[300];
+    for (size_t i = 0; i < sizeof(buffer); i += 1) {
+        buffer[i] = (uchar)(i % 10 == 9 ? '\n' : '0' + i % 10);
+    }
+    uchar other[300];
+    bytes_copy(other, buffer, sizeof(buffer));
+    other[250] = 'x';
+
+    byteset set;
+    byteset_init(&set, "x\n", 2);
+
+    char hex[2 * 40 + 1];
+    uchar decoded[40];
+
+    for (size_t i = 0; i < countof(feature_levels); i += 1) {
+        cpu_features_limit(feature_levels[i]);
+
+        assert_eq_sint(
+            t,
+            bytes_index_of_byte(buffer, sizeof(buffer), '\n'),
+            9,
+            "index of byte"
+        );
+        assert_eq_sint(
+            t,
+            bytes_last_index_of_byte(buffer, sizeof(buffer), '5'),
+            295,
+            "last index of byte"
+        );
+        assert_eq_uint(
+            t, bytes_count_lines(buffer, sizeof(buffer)), 30, "count lines"
+        );
+        assert_eq_sint(
+            t,
+            bytes_index_of_nth_byte(buffer, sizeof(buffer), '\n', 20),
+            199,
+            "index of nth byte"
+        );
+        assert_eq_sint(
+            t,
+            bytes_index_of(buffer, sizeof(buffer), "78\n01", 5),
+            7,
+            "index of"
+        );
+        assert_eq_sint(
+            t,
+            bytes_index_of_any(buffer + 10, sizeof(buffer) - 10, &set),
+            9,
+            "index of any"
+        );
+        assert_eq_sint(
+            t,
+            bytes_diff_index(buffer, other, 0, sizeof(buffer)),
+            250,
+            "diff index"
+        );
+
+        assert_eq_uint(
+            t,
+            bytes_to_hex(hex, sizeof(hex), (const char *)buffer + 5, 40),
+            80,
+            "to hex"
+        );
+        assert_eq_sint(
+            t,
+            bytes_from_hex(decoded, sizeof(decoded), hex, 80),
+            40,
+            "from hex"
+        );
+        assert_true(t, bytes_eq(decoded, buffer + 5, 40), "hex round trip");
+
+        uchar copy[sizeof(buffer)];
+        bytes_set(copy, 0, sizeof(copy));
+        bytes_copy(copy, buffer, sizeof(buffer));
+        bytes_move(copy + 1, copy, sizeof(copy) - 1);
+        assert_true(
+            t, bytes_eq(copy + 1, buffer, sizeof(buffer) - 1), "copy and move"
+        );
+    }
+    cpu_features_limit(~0U);
+}
+
+static test_case tests[] = {
+    {"CPU features limit", test_cpu_features_limit},
+    {"CPU dispatch select", test_cpu_dispatch_select},
+    {"Bytes routines at every feature level", test_cpu_dispatch_bytes},
+};
+
+setup_tests(NULL, tests)
@@ -213,6 +213,39 @@ void test_cstr_split(test *t) {
     }
 }
 
+void test_cstr_split_multiple_chars(test *t) {
+    char str[] = "alpha,beta;gamma\ta sub-string that spans several blocks;;end";
+    const char *expected[] = {
+        "alpha", "beta", "gamma", "a sub-string that spans several blocks",
+        "", "end"
+    };
+    cstr_split split;
+    slice_const split_chars = slice_sstr(",;\t");
+    cstr_split_init_chars(&split, slice_str(str), &split_chars, 0);
+
+    slice_const arr[10] = {0};
+    size_t len = cstr_split_collect(&split, arr, countof(arr));
+    assert_eq_uint(t, len, countof(expected), "number of sub-strings");
+    for (size_t i = 0; i < len && i < countof(expected); i += 1) {
+        assert_eq_cstrl(
+            t, (const char *)arr[i].ptr, expected[i], arr[i].len, "contents"
+        );
+    }
+
+    // a lone split character yields a single empty sub-string
+    char lone[] = ",";
+    cstr_split_init_chars(&split, slice_str(lone), &split_chars, 0);
+    {
+        slice_const s = cstr_split_next(&split);
+        assert_true(t, s.ptr, "lone - first pointer");
+        assert_eq_uint(t, s.len, 0L, "lone - first length");
+    }
+    {
+        slice_const s = cstr_split_next(&split);
+        assert_false(t, s.ptr, "lone - second pointer");
+    }
+}
+
 void test_cstr_split_collect(test *t) {
     char str[] = "collecting all words to an array";
 
@@ -571,6 +604,17 @@ void test_cstr_fmt(test *t) {
     assert_eq_cstr(t, buf, "hex: 61626364;", "6: fmt contents");
     assert_eq_uint(t, res.len, 14, "6: fmt content len");
     assert_true(t, res.ok, "6: ok");
+
+    format = "H!";
+    len = cstr_fmt_len(format, "\x01\xff");
+    assert_eq_uint(t, len, 5, "7: fmt len");
+    res = cstr_fmt(buf, sizeof(buf), format, "\x01\xff");
+    assert_eq_cstr(t, buf, "01ff!", "7: fmt contents");
+    assert_eq_uint(t, res.len, 5, "7: fmt content len");
+    assert_true(t, res.ok, "7: ok");
+
+    res = cstr_fmt(buf, 4, "h", slice_sstr("abcd"));
+    assert_false(t, res.ok, "8: truncated hex is not ok");
 }
 
 static test_case tests[] = {
@@ -582,6 +626,7 @@ static test_case tests[] = {
     {"C string split (UTF-8)", test_cstr_split_utf8},
     {"C string split (ASCII)", test_cstr_split},
     {"C string split edge cases (ASCII)", test_cstr_split_edge_cases},
+    {"C string split multiple chars (ASCII)", test_cstr_split_multiple_chars},
     {"C string split collect (ASCII)", test_cstr_split_collect},
     {"C string split null-terminate (ASCII)", test_cstr_split_null_terminate},
     {"C string split collect strings (ASCII)", test_cstr_split_collect_strings},
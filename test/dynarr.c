@@ -1,5 +1,6 @@
 #include "std.h"
 #include "testr.h"
+#include <stddef.h>
 
 void test_dynarr_push(test *t) {
     ullong capacity = 5;
@@ -104,6 +105,71 @@ void test_dynarr_push_grow(test *t) {
     dynarr_free(arr);
 }
 
+void test_dynarr_push_grow_in_place(test *t) {
+    alignas(max_align_t) uchar buffer[1024];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+
+    int *arr = dynarr_new(4, int, &alloc);
+    if (!assert_true(t, arr, "array must not be null")) {
+        return;
+    }
+    int *first = arr;
+    uint moves = 0;
+    for (int i = 0; i < 100; i += 1) {
+        int *grown = dynarr_push_grow(arr, &i, 1, int);
+        if (!grown) {
+            break;
+        }
+        moves += grown != first;
+        arr = grown;
+    }
+    assert_eq_uint(t, dynarr_len(arr), 100, "all values are pushed");
+    assert_eq_uint(t, moves, 0, "array grows in place in the arena");
+    assert_eq_uint(
+        t,
+        arena.used,
+        dynarr_count_to_bytes(dynarr_capacity(arr), sizeof(int)),
+        "no memory is left behind in the arena"
+    );
+    int mismatches = 0;
+    for (int i = 0; i < 100; i += 1) {
+        mismatches += arr[i] != i;
+    }
+    assert_eq_sint(t, mismatches, 0, "values are kept");
+    dynarr_free(arr);
+}
+
+void test_dynarr_allocation_capacity(test *t) {
+    // the page rounding of the mmap allocator shows up as extra capacity
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    int *arr = dynarr_new(1, int, &mmap_allocator);
+    if (!assert_true(t, arr, "array must not be null")) {
+        return;
+    }
+    ullong capacity = ((ullong)page_size - sizeof(dynarr_header)) / sizeof(int);
+    assert_eq_uint(t, dynarr_capacity(arr), capacity, "capacity of new array");
+
+    arr = dynarr_grow(arr, 1, int);
+    if (!assert_true(t, arr, "grow must succeed")) {
+        return;
+    }
+    capacity = ((ullong)page_size * 2 - sizeof(dynarr_header)) / sizeof(int);
+    assert_eq_uint(t, dynarr_capacity(arr), capacity, "capacity after grow");
+
+    int *arr_clone = dynarr_clone(arr, 1, int);
+    if (!assert_true(t, arr_clone, "clone must succeed")) {
+        dynarr_free(arr);
+        return;
+    }
+    capacity = ((ullong)page_size * 3 - sizeof(dynarr_header)) / sizeof(int);
+    assert_eq_uint(
+        t, dynarr_capacity(arr_clone), capacity, "capacity of clone"
+    );
+    dynarr_free(arr_clone);
+    dynarr_free(arr);
+}
+
 void test_dynarr_clone(test *t) {
     ullong capacity = 5;
     ullong capacity_increase = 3;
@@ -266,6 +332,8 @@ void test_dynarr_remove_uo(test *t) {
 static test_case tests[] = {
     {"Dynamic array push", test_dynarr_push},
     {"Dynamic array push grow", test_dynarr_push_grow},
+    {"Dynamic array push grow in place", test_dynarr_push_grow_in_place},
+    {"Dynamic array allocation capacity", test_dynarr_allocation_capacity},
     {"Dynamic array clone", test_dynarr_clone},
     {"Dynamic array pop", test_dynarr_pop},
     {"Dynamic array remove", test_dynarr_remove},
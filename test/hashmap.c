@@ -0,0 +1,209 @@
+#include "std.h"
+#include "testr.h"
+
+#define key_count 5000
+
+static uint keys[key_count];
+
+static void keys_init(void) {
+    for (uint i = 0; i < key_count; i += 1) {
+        keys[i] = i * 2654435761U;
+    }
+}
+
+static slice_const key_at(size_t i) {
+    return slice_const_new(&keys[i], sizeof(keys[i]));
+}
+
+void test_hashmap_put_get(test *t) {
+    hashmap map;
+    if (!assert_true(
+            t, hashmap_init(&map, 0, int, &std_allocator), "init must succeed"
+        )) {
+        return;
+    }
+
+    assert_true(t, hashmap_get(&map, slice_sstr("a")) == NULL, "empty map");
+    assert_false(t, hashmap_remove(&map, slice_sstr("a")), "remove from empty");
+
+    bool inserted = false;
+    int *value = hashmap_put(&map, slice_sstr("hello"), &inserted);
+    if (!assert_true(t, value, "put must succeed")) {
+        return;
+    }
+    assert_true(t, inserted, "new key is inserted");
+    assert_eq_sint(t, *value, 0, "new value is zeroed");
+    *value = 42;
+
+    value = hashmap_put(&map, slice_sstr("hello"), &inserted);
+    assert_false(t, inserted, "existing key is not inserted");
+    assert_eq_sint(t, *value, 42, "existing value is returned");
+
+    value = hashmap_get(&map, slice_sstr("hello"));
+    assert_true(t, value && *value == 42, "get finds the value");
+    assert_true(t, hashmap_get(&map, slice_sstr("hell")) == NULL, "prefix");
+    assert_true(t, hashmap_get(&map, slice_sstr("hello!")) == NULL, "longer");
+    assert_true(t, hashmap_put(&map, slice_null, NULL) != NULL, "empty key");
+    assert_eq_uint(t, map.len, 2, "two keys");
+
+    hashmap_free(&map);
+}
+
+void test_hashmap_many(test *t) {
+    keys_init();
+    hashmap map;
+    hashmap_init(&map, 0, size_t, &std_allocator);
+
+    uint failures = 0;
+    for (size_t i = 0; i < key_count; i += 1) {
+        size_t *value = hashmap_put(&map, key_at(i), NULL);
+        if (!value) {
+            failures += 1;
+            continue;
+        }
+        *value = i;
+    }
+    assert_eq_uint(t, failures, 0, "every put must succeed");
+    assert_eq_uint(t, map.len, key_count, "all keys are added");
+    assert_true(
+        t, map.len <= map.capacity - map.capacity / 8, "load factor is kept"
+    );
+
+    uint mismatches = 0;
+    for (size_t i = 0; i < key_count; i += 1) {
+        size_t *value = hashmap_get(&map, key_at(i));
+        mismatches += !value || *value != i;
+    }
+    assert_eq_uint(t, mismatches, 0, "every key is found");
+
+    // remove every other key
+    mismatches = 0;
+    for (size_t i = 0; i < key_count; i += 2) {
+        mismatches += !hashmap_remove(&map, key_at(i));
+    }
+    for (size_t i = 0; i < key_count; i += 1) {
+        size_t *value = hashmap_get(&map, key_at(i));
+        if (i % 2 == 0) {
+            mismatches += value != NULL;
+        } else {
+            mismatches += !value || *value != i;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "removed keys are gone");
+    assert_eq_uint(t, map.len, key_count / 2, "half of the keys are left");
+
+    // iteration visits every entry once
+    uint visits[key_count] = {0};
+    hashmap_iter it;
+    hashmap_iter_init(&it, &map);
+    size_t count = 0;
+    while (hashmap_iter_next(&it)) {
+        size_t *value = it.value;
+        visits[*value] += 1;
+        count += 1;
+    }
+    assert_eq_uint(t, count, map.len, "iteration count");
+    mismatches = 0;
+    for (size_t i = 0; i < key_count; i += 1) {
+        mismatches += visits[i] != (i % 2);
+    }
+    assert_eq_uint(t, mismatches, 0, "every entry is visited once");
+
+    // shrink
+    size_t capacity = map.capacity;
+    assert_true(t, hashmap_rehash(&map, 0), "rehash must succeed");
+    assert_true(t, map.capacity < capacity, "rehash shrinks the table");
+    mismatches = 0;
+    for (size_t i = 1; i < key_count; i += 2) {
+        size_t *value = hashmap_get(&map, key_at(i));
+        mismatches += !value || *value != i;
+    }
+    assert_eq_uint(t, mismatches, 0, "keys are found after rehash");
+
+    hashmap_clear(&map);
+    assert_eq_uint(t, map.len, 0, "clear removes all keys");
+    assert_true(t, hashmap_get(&map, key_at(1)) == NULL, "cleared key");
+
+    hashmap_free(&map);
+}
+
+void test_hashmap_remove_shifts(test *t) {
+    keys_init();
+    hashmap map;
+    hashmap_init(&map, 0, uint, &std_allocator);
+
+    // random inserts and removes in a small table to get long probe runs
+    bool present[200] = {0};
+    ullong state = 1;
+    uint mismatches = 0;
+    for (uint op = 0; op < 20000; op += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t k = (size_t)(state >> 33) % countof(present);
+        if ((state >> 20) & 1) {
+            uint *value = hashmap_put(&map, key_at(k), NULL);
+            mismatches += value == NULL;
+            if (value) {
+                *value = (uint)k;
+            }
+            present[k] = true;
+        } else {
+            mismatches += hashmap_remove(&map, key_at(k)) != present[k];
+            present[k] = false;
+        }
+    }
+    size_t len = 0;
+    for (size_t k = 0; k < countof(present); k += 1) {
+        uint *value = hashmap_get(&map, key_at(k));
+        mismatches += present[k] ? !value || *value != k : value != NULL;
+        len += present[k];
+    }
+    assert_eq_uint(t, mismatches, 0, "map matches the reference");
+    assert_eq_uint(t, map.len, len, "map length matches the reference");
+
+    hashmap_free(&map);
+}
+
+void test_hashmap_reserve(test *t) {
+    keys_init();
+    hashmap map;
+    hashmap_init(&map, 100, int, &std_allocator);
+    assert_true(t, map.capacity - map.capacity / 8 >= 100, "init reserves");
+
+    assert_true(t, hashmap_reserve(&map, 1000), "reserve must succeed");
+    uchar *ctrl = map.ctrl;
+    for (size_t i = 0; i < 1000; i += 1) {
+        hashmap_put(&map, key_at(i), NULL);
+    }
+    assert_true(t, map.ctrl == ctrl, "reserved map does not grow");
+    hashmap_free(&map);
+}
+
+void test_hashmap_arena(test *t) {
+    keys_init();
+    static uchar buffer[64 * 1024];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+
+    // a set without values
+    hashmap set;
+    hashmap_init_ut(&set, 0, 0, 1, &alloc);
+    uint failures = 0;
+    for (size_t i = 0; i < 500; i += 1) {
+        failures += hashmap_put(&set, key_at(i), NULL) == NULL;
+    }
+    assert_eq_uint(t, failures, 0, "puts must succeed");
+    assert_eq_uint(t, set.len, 500, "all keys are added");
+    assert_true(t, hashmap_get(&set, key_at(499)) != NULL, "key is found");
+    assert_true(t, hashmap_get(&set, key_at(500)) == NULL, "key is missing");
+    hashmap_free(&set);
+}
+
+static test_case tests[] = {
+    {"Hash map put and get", test_hashmap_put_get},
+    {"Hash map many keys", test_hashmap_many},
+    {"Hash map remove shifts entries", test_hashmap_remove_shifts},
+    {"Hash map reserve", test_hashmap_reserve},
+    {"Hash map with arena", test_hashmap_arena},
+};
+
+setup_tests(NULL, tests)
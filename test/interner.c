@@ -0,0 +1,157 @@
+#include "std.h"
+#include "testr.h"
+
+void test_interner_intern(test *t) {
+    static uchar buffer[4096];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    interner in;
+    if (!assert_true(
+            t, interner_init(&in, 0, &arena, &std_allocator), "init"
+        )) {
+        return;
+    }
+
+    char hello[] = "hello";
+    uint a = interner_intern(&in, slice_sstr("hello"));
+    uint b = interner_intern(&in, slice_const_new(hello, 5));
+    uint c = interner_intern(&in, slice_sstr("world"));
+    assert_eq_uint(t, a, 0, "first id");
+    assert_eq_uint(t, b, a, "duplicate gets the same id");
+    assert_eq_uint(t, c, 1, "second id");
+    assert_eq_uint(t, interner_len(&in), 2, "two unique strings");
+
+    slice_const s = interner_get(&in, a);
+    assert_true(t, slice_const_eq(s, slice_sstr("hello")), "canonical bytes");
+    assert_true(t, s.ptr != (const uchar *)hello, "string is copied");
+    assert_true(t, s.ptr >= buffer && s.ptr < buffer + sizeof(buffer), "arena");
+    assert_eq_uint(t, s.ptr[s.len], 0, "copy is null terminated");
+
+    hello[0] = 'j';
+    slice_const s2 = interner_intern_slice(&in, slice_sstr("hello"));
+    assert_true(t, s2.ptr == s.ptr, "canonical slice is shared");
+    assert_true(t, slice_const_eq(s2, slice_sstr("hello")), "copy is stable");
+
+    uint empty = interner_intern(&in, slice_null);
+    assert_eq_uint(t, empty, 2, "empty string is interned");
+    assert_eq_uint(t, interner_get(&in, empty).len, 0, "empty string");
+    assert_eq_uint(
+        t, interner_intern(&in, slice_sstr("")), empty, "empty string id"
+    );
+
+    assert_eq_uint(
+        t, interner_find(&in, slice_sstr("world")), c, "find interned string"
+    );
+    assert_eq_uint(
+        t,
+        interner_find(&in, slice_sstr("jello")),
+        interner_id_none,
+        "find missing string"
+    );
+    assert_eq_uint(t, interner_len(&in), 3, "find does not intern");
+
+    interner_free(&in);
+}
+
+void test_interner_intern_all(test *t) {
+    static uchar buffer[64 * 1024];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    interner in;
+    interner_init(&in, 16, &arena, &std_allocator);
+
+    slice_const words[] = {
+        slice_sstr("id"),
+        slice_sstr("name"),
+        slice_sstr("id"),
+        slice_sstr("state"),
+        slice_sstr("name"),
+        slice_sstr("id"),
+        slice_sstr("state"),
+        slice_sstr("id"),
+    };
+    uint ids[countof(words)];
+    interner_stats stats;
+    bool ok = interner_intern_all(&in, words, countof(words), ids, &stats);
+    assert_true(t, ok, "intern all must succeed");
+    assert_eq_uint(t, stats.count, 8, "count");
+    assert_eq_uint(t, stats.added, 3, "added");
+    assert_eq_uint(t, stats.bytes, 26, "bytes");
+    assert_eq_uint(t, stats.added_bytes, 11, "added bytes");
+    assert_true(t, ids[0] == ids[2] && ids[2] == ids[7], "same ids");
+    assert_true(t, ids[1] == ids[4] && ids[3] == ids[6], "same ids");
+    assert_true(t, ids[0] != ids[1] && ids[1] != ids[3], "different ids");
+    double ratio = interner_stats_dedup_ratio(stats);
+    assert_true(t, ratio > 0.624 && ratio < 0.626, "dedup ratio");
+
+    // everything is a duplicate the second time
+    ok = interner_intern_all(&in, words, countof(words), NULL, &stats);
+    assert_true(t, ok, "intern all must succeed");
+    assert_eq_uint(t, stats.added, 0, "nothing added");
+    assert_true(t, interner_stats_dedup_ratio(stats) > 0.999, "all duplicates");
+
+    // many unique strings
+    static uint numbers[2000];
+    static slice_const strings[countof(numbers) * 2];
+    for (uint i = 0; i < countof(numbers); i += 1) {
+        numbers[i] = i * 7919;
+        strings[i * 2] = slice_const_new(&numbers[i], sizeof(uint));
+        strings[i * 2 + 1] = slice_const_new(&numbers[i], sizeof(uint));
+    }
+    static uint many_ids[countof(strings)];
+    ok = interner_intern_all(
+        &in, strings, countof(strings), many_ids, &stats
+    );
+    assert_true(t, ok, "intern all must succeed");
+    assert_eq_uint(t, stats.added, countof(numbers), "unique strings added");
+    uint mismatches = 0;
+    for (size_t i = 0; i < countof(strings); i += 2) {
+        mismatches += many_ids[i] != many_ids[i + 1];
+        mismatches +=
+            !slice_const_eq(interner_get(&in, many_ids[i]), strings[i]);
+    }
+    assert_eq_uint(t, mismatches, 0, "ids map back to the strings");
+
+    interner_free(&in);
+}
+
+void test_interner_arena_full(test *t) {
+    uchar buffer[16];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    interner in;
+    interner_init(&in, 0, &arena, &std_allocator);
+
+    slice_const words[] = {
+        slice_sstr("abcdef"),
+        slice_sstr("abcdef"),
+        slice_sstr("ghijklmnopqrstu"),
+        slice_sstr("abcdef"),
+    };
+    uint ids[countof(words)];
+    interner_stats stats;
+    bool ok = interner_intern_all(&in, words, countof(words), ids, &stats);
+    assert_false(t, ok, "intern all must fail when the arena is full");
+    assert_eq_uint(t, stats.count, 2, "strings before the failure");
+    assert_eq_uint(t, stats.added, 1, "added before the failure");
+    assert_eq_uint(
+        t,
+        interner_intern(&in, words[2]),
+        interner_id_none,
+        "string that does not fit"
+    );
+    assert_true(
+        t,
+        interner_intern_slice(&in, words[2]).ptr == NULL,
+        "null slice for a string that does not fit"
+    );
+    assert_eq_uint(t, interner_intern(&in, words[0]), ids[0], "still works");
+    assert_eq_uint(t, interner_len(&in), 1, "one string interned");
+
+    interner_free(&in);
+}
+
+static test_case tests[] = {
+    {"Intern strings", test_interner_intern},
+    {"Intern arrays of strings", test_interner_intern_all},
+    {"Intern strings to full arena", test_interner_arena_full},
+};
+
+setup_tests(NULL, tests)
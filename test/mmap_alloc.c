@@ -22,6 +22,96 @@ void test_mmap_allocation(test *t) {
     alloc_free(&mmap_allocator, s_nums);
 }
 
-static test_case tests[] = {{"mmap allocation", test_mmap_allocation}};
+void test_mmap_realloc(test *t) {
+    long page_size = sysconf(_SC_PAGE_SIZE);
+    allocation a = alloc_malloc(&mmap_allocator, 100, 1);
+    if (!assert_true(t, allocation_exists(a), "allocation must succeed")) {
+        return;
+    }
+    assert_eq_uint(t, a.len, (ullong)page_size, "size is rounded to pages");
+    bytes_set(a.ptr, 'x', a.len);
+
+    allocation b = alloc_realloc(&mmap_allocator, a, a.len * 4 + 1, 1);
+    if (!assert_true(t, allocation_exists(b), "realloc must succeed")) {
+        alloc_free(&mmap_allocator, a);
+        return;
+    }
+    assert_eq_uint(t, b.len, (ullong)page_size * 5, "size is rounded to pages");
+    uchar *bytes = b.ptr;
+    assert_eq_sint(t, bytes[page_size - 1], 'x', "contents are kept");
+    bytes[b.len - 1] = 'y';
+
+    allocation c = alloc_realloc(&mmap_allocator, b, 1, 1);
+    assert_eq_uint(t, c.len, (ullong)page_size, "mapping is shrunk");
+    alloc_free(&mmap_allocator, c);
+}
+
+void test_mmap_aligned(test *t) {
+    size_t alignment = 1024 * 1024;
+    allocation a = alloc_malloc(&mmap_allocator, 100, alignment);
+    if (!assert_true(t, allocation_exists(a), "allocation must succeed")) {
+        return;
+    }
+    assert_eq_uint(t, (uintptr_t)a.ptr % alignment, 0, "mapping is aligned");
+    bytes_set(a.ptr, 'a', a.len);
+
+    allocation b = alloc_realloc(&mmap_allocator, a, alignment * 2, alignment);
+    if (!assert_true(t, allocation_exists(b), "realloc must succeed")) {
+        alloc_free(&mmap_allocator, a);
+        return;
+    }
+    assert_eq_uint(t, (uintptr_t)b.ptr % alignment, 0, "alignment is kept");
+    assert_eq_sint(t, ((char *)b.ptr)[99], 'a', "contents are kept");
+    alloc_free(&mmap_allocator, b);
+}
+
+void test_mmap_options(test *t) {
+    mmap_options options = {
+        .flags = mmap_flag_transparent_huge_pages | mmap_flag_populate,
+    };
+    allocator alloc = mmap_allocator_new(&options);
+    allocation a = alloc_malloc(&alloc, mmap_huge_page_size * 2, 1);
+    if (!assert_true(t, allocation_exists(a), "allocation must succeed")) {
+        return;
+    }
+    assert_eq_uint(
+        t, (uintptr_t)a.ptr % mmap_huge_page_size, 0, "huge page alignment"
+    );
+    uchar *bytes = a.ptr;
+    assert_eq_uint(t, bytes[a.len - 1], 0, "prefaulted memory is zeroed");
+    bytes_set(a.ptr, 'b', a.len);
+
+    allocation b = alloc_realloc(&alloc, a, a.len * 2, 1);
+    if (!assert_true(t, allocation_exists(b), "realloc must succeed")) {
+        alloc_free(&alloc, a);
+        return;
+    }
+    bytes = b.ptr;
+    assert_eq_sint(t, bytes[a.len - 1], 'b', "contents are kept");
+    assert_eq_uint(t, bytes[b.len - 1], 0, "grown memory is zeroed");
+    alloc_free(&alloc, b);
+
+    // explicit huge pages fall back to normal pages when none are reserved
+    options.flags = mmap_flag_huge_pages | mmap_flag_populate;
+    options.alignment = 64 * 1024;
+    allocation c = alloc_malloc(&alloc, 1000, 1);
+    if (!assert_true(t, allocation_exists(c), "allocation must succeed")) {
+        return;
+    }
+    assert_eq_uint(t, (uintptr_t)c.ptr % (64 * 1024), 0, "option alignment");
+    bytes_set(c.ptr, 'c', 1000);
+    allocation d = alloc_realloc(&alloc, c, 10, 1);
+    if (assert_true(t, allocation_exists(d), "shrink must succeed")) {
+        assert_eq_sint(t, ((char *)d.ptr)[9], 'c', "contents are kept");
+        alloc_free(&alloc, d);
+    }
+}
+
+static test_case tests[] = {
+    {"mmap allocation", test_mmap_allocation},
+    {"mmap realloc", test_mmap_realloc},
+    {"mmap aligned", test_mmap_aligned},
+    {"mmap options", test_mmap_options},
+};
 
 setup_tests(NULL, tests)
@@ -0,0 +1,159 @@
+#include "std.h"
+#include "testr.h"
+
+typedef struct {
+    ullong id;
+    double value;
+    char name[20];
+} node;
+
+void test_pool_alloc_free(test *t) {
+    pool p;
+    pool_init_for(&p, node, 0, &std_allocator);
+    assert_eq_uint(t, p.slot_size, 40, "slot size is rounded to alignment");
+    assert_eq_uint(t, p.page_count, 0, "no pages before the first slot");
+
+    node *a = pool_alloc_slot(&p);
+    node *b = pool_alloc_slot(&p);
+    if (!assert_true(t, a && b, "slots must be allocated")) {
+        return;
+    }
+    assert_eq_uint(t, (uintptr_t)b - (uintptr_t)a, 40, "slots are adjacent");
+    assert_eq_uint(t, (uintptr_t)a % alignof(node), 0, "slot is aligned");
+    assert_eq_uint(t, p.used, 2, "two slots in use");
+    assert_eq_uint(t, p.page_count, 1, "one page");
+
+    pool_free_slot(&p, a);
+    assert_eq_uint(t, p.used, 1, "one slot in use");
+    node *c = pool_alloc_slot(&p);
+    assert_true(t, c == a, "freed slot is reused first");
+
+    // fill more than one page
+    size_t count = p.slots_per_page * 3;
+    node **nodes = alloc_new(&std_allocator, node *, count).ptr;
+    uint failures = 0;
+    for (size_t i = 0; i < count; i += 1) {
+        nodes[i] = pool_alloc_slot(&p);
+        failures += nodes[i] == NULL;
+        if (nodes[i]) {
+            nodes[i]->id = i;
+        }
+    }
+    assert_eq_uint(t, failures, 0, "all slots must be allocated");
+    assert_eq_uint(t, p.page_count, 4, "pages are added on demand");
+    uint mismatches = 0;
+    for (size_t i = 0; i < count; i += 1) {
+        mismatches += nodes[i]->id != i;
+    }
+    assert_eq_uint(t, mismatches, 0, "slots do not overlap");
+
+    allocation nodes_alloc = {.ptr = nodes, .len = count * sizeof(node *)};
+    alloc_free(&std_allocator, nodes_alloc);
+    pool_release(&p);
+    assert_eq_uint(t, p.page_count, 0, "release returns all pages");
+    assert_eq_uint(t, p.used, 0, "release frees all slots");
+}
+
+void test_pool_cache_aligned(test *t) {
+    // std_allocator ignores the alignment of the pages
+    allocator *backings[] = {&mmap_allocator, &std_allocator};
+    for (size_t i = 0; i < countof(backings); i += 1) {
+        pool p;
+        pool_init(&p, 24, 8, 4096, pool_flag_cache_aligned, backings[i]);
+        assert_eq_uint(t, p.slot_size, 64, "slot fills a cache line");
+        uint misaligned = 0;
+        for (size_t j = 0; j < 200; j += 1) {
+            void *slot = pool_alloc_slot(&p);
+            misaligned += slot == NULL || (uintptr_t)slot % 64 != 0;
+        }
+        assert_eq_uint(t, misaligned, 0, "slots are cache line aligned");
+        assert_eq_uint(t, pool_trim(&p), 0, "full pages are kept");
+        pool_release(&p);
+    }
+}
+
+void test_pool_trim(test *t) {
+    pool p;
+    pool_init(&p, 32, 8, 1024, 0, &std_allocator);
+    size_t per_page = p.slots_per_page;
+    size_t count = per_page * 4;
+    void *slots[4 * 1024 / 32];
+    if (!assert_true(t, count <= countof(slots), "enough room for slots")) {
+        return;
+    }
+    for (size_t i = 0; i < count; i += 1) {
+        slots[i] = pool_alloc_slot(&p);
+    }
+    assert_eq_uint(t, p.page_count, 4, "four pages");
+    size_t trimmed = pool_trim(&p);
+    assert_eq_uint(t, trimmed, 0, "nothing to trim");
+
+    // free the first and the third page, and all but one slot of the fourth
+    for (size_t i = 0; i < per_page; i += 1) {
+        pool_free_slot(&p, slots[i]);
+        pool_free_slot(&p, slots[2 * per_page + i]);
+        if (i > 0) {
+            pool_free_slot(&p, slots[3 * per_page + i]);
+        }
+    }
+    trimmed = pool_trim(&p);
+    assert_eq_uint(t, trimmed, 2, "two empty pages are returned");
+    assert_eq_uint(t, p.page_count, 2, "two pages are left");
+    assert_eq_uint(t, p.used, per_page + 1, "slots in use are kept");
+
+    // the free list only has slots of the remaining pages
+    size_t reused = 0;
+    uint outside = 0;
+    void *slot;
+    while (reused < per_page - 1 && (slot = pool_alloc_slot(&p))) {
+        bool in_fourth = (uchar *)slot >= (uchar *)slots[3 * per_page]
+            && (uchar *)slot <= (uchar *)slots[4 * per_page - 1];
+        outside += !in_fourth;
+        reused += 1;
+    }
+    assert_eq_uint(t, outside, 0, "free slots come from the kept pages");
+    assert_eq_uint(t, p.page_count, 2, "no pages are added");
+
+    pool_release(&p);
+
+    // a pool with no slots in use returns every page
+    pool_init(&p, 32, 8, 1024, 0, &std_allocator);
+    slot = pool_alloc_slot(&p);
+    pool_free_slot(&p, slot);
+    trimmed = pool_trim(&p);
+    assert_eq_uint(t, trimmed, 1, "unused page is returned");
+    assert_true(t, pool_alloc_slot(&p) != NULL, "pool is usable after trim");
+    pool_release(&p);
+}
+
+void test_pool_allocator(test *t) {
+    pool p;
+    pool_init(&p, 64, 8, 0, 0, &std_allocator);
+    allocator alloc = pool_allocator_new(&p);
+
+    allocation a = alloc_malloc(&alloc, 48, 8);
+    assert_true(t, allocation_exists(a), "allocation must succeed");
+    assert_eq_uint(t, a.len, 64, "allocation covers the slot");
+    allocation big = alloc_malloc(&alloc, 65, 8);
+    assert_false(t, allocation_exists(big), "too large allocation must fail");
+    allocation aligned = alloc_malloc(&alloc, 8, 64);
+    assert_false(t, allocation_exists(aligned), "too strict alignment");
+
+    allocation same = alloc_realloc(&alloc, a, 60, 8);
+    assert_true(t, same.ptr == a.ptr, "realloc within a slot keeps it");
+    allocation grown = alloc_realloc(&alloc, a, 100, 8);
+    assert_false(t, allocation_exists(grown), "realloc beyond a slot fails");
+
+    alloc_free(&alloc, a);
+    assert_eq_uint(t, p.used, 0, "slot is returned");
+    pool_release(&p);
+}
+
+static test_case tests[] = {
+    {"Pool alloc and free", test_pool_alloc_free},
+    {"Pool cache aligned slots", test_pool_cache_aligned},
+    {"Pool trim", test_pool_trim},
+    {"Pool as allocator", test_pool_allocator},
+};
+
+setup_tests(NULL, tests)
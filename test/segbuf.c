@@ -0,0 +1,141 @@
+#include "io.h"
+#include "std.h"
+#include "testr.h"
+#include <stddef.h>
+
+void test_segbuf_write(test *t) {
+    segbuf sbuf = segbuf_new(16, &std_allocator);
+    assert_eq_uint(t, sbuf.chunk_count, 0, "no chunks before writing");
+
+    const char text[] = "abcdefghijklmnopqrstuvwxyz0123456789ABCD";
+    bytebuf_result res = segbuf_write_sstr(&sbuf, text);
+    assert_true(t, res.ok, "write must succeed");
+    assert_eq_uint(t, res.len, lengthof(text), "bytes written");
+    assert_eq_uint(t, sbuf.len, lengthof(text), "buffer length");
+    assert_eq_uint(t, sbuf.chunk_count, 3, "chunks are appended");
+    assert_eq_uint(t, segbuf_iovec_count(&sbuf), 3, "iovec count");
+
+    res = segbuf_fill(&sbuf, 'x', 20);
+    assert_eq_uint(t, res.offset, lengthof(text), "fill offset");
+    assert_eq_uint(t, sbuf.chunk_count, 4, "fill appends a chunk");
+
+    char copy[64] = {0};
+    size_t copied = segbuf_copy(&sbuf, copy, sizeof(copy));
+    assert_eq_uint(t, copied, lengthof(text) + 20, "all bytes are copied");
+    assert_eq_bytes(
+        t,
+        (const uchar *)copy,
+        (const uchar *)text,
+        lengthof(text),
+        "contents are kept in order"
+    );
+    assert_eq_sint(t, copy[copied - 1], 'x', "fill contents");
+
+    // cleared chunks are reused
+    segbuf_chunk *head = sbuf.head;
+    segbuf_clear(&sbuf);
+    assert_eq_uint(t, segbuf_iovec_count(&sbuf), 0, "cleared buffer is empty");
+    segbuf_write_sstr(&sbuf, text);
+    assert_true(t, sbuf.head == head, "first chunk is reused");
+    assert_eq_uint(t, sbuf.chunk_count, 4, "no new chunks");
+
+    segbuf_free(&sbuf);
+    assert_eq_uint(t, sbuf.len, 0, "freed buffer is empty");
+    assert_true(t, sbuf.head == NULL, "chunks are freed");
+}
+
+void test_segbuf_fmt(test *t) {
+    uchar expected_buf[256];
+    bytebuf expected = bytebuf_new_fixed(slice_arr(expected_buf), 0);
+    segbuf sbuf = segbuf_new(7, &std_allocator);
+
+    cstr_fmt_float f = {-3.25, 2};
+    const char *format = "i u I U F S h!";
+    slice_const hex = slice_const_from_cstr_unsafe("hello, world");
+    bytebuf_result expected_res = bytebuf_fmt(
+        &expected, format, -12, 34U, -56LL, 78ULL, f, "str", hex
+    );
+    bytebuf_result res =
+        segbuf_fmt(&sbuf, format, -12, 34U, -56LL, 78ULL, f, "str", hex);
+    assert_true(t, res.ok, "formatting must succeed");
+    assert_eq_uint(t, res.len, expected_res.len, "same length as bytebuf");
+
+    char copy[256];
+    size_t copied = segbuf_copy(&sbuf, copy, sizeof(copy));
+    assert_eq_uint(t, copied, expected.len, "all bytes are copied");
+    assert_eq_bytes(
+        t,
+        (const uchar *)copy,
+        expected.buffer,
+        expected.len,
+        "same contents as bytebuf"
+    );
+
+    segbuf_free(&sbuf);
+}
+
+void test_segbuf_iovec(test *t) {
+    segbuf sbuf = segbuf_new(10, &std_allocator);
+    for (int i = 0; i < 20; i += 1) {
+        segbuf_write_int(&sbuf, i);
+        segbuf_write_sstr(&sbuf, ",");
+    }
+
+    struct iovec iov[8];
+    size_t iov_len = segbuf_iovec(&sbuf, iov, countof(iov), 14);
+    assert_eq_uint(t, iov_len, 4, "iovecs after the offset");
+    assert_eq_uint(t, iov[0].iov_len, 6, "first iovec starts at the offset");
+    assert_eq_bytes(
+        t, iov[0].iov_base, (const uchar *)"7,8,9,", 6, "first iovec contents"
+    );
+    iov_len = segbuf_iovec(&sbuf, iov, 2, 0);
+    assert_eq_uint(t, iov_len, 2, "iovecs are limited");
+
+    int fds[2];
+    if (!assert_eq_sint(t, pipe(fds), 0, "pipe must be created")) {
+        return;
+    }
+    io_result io_res = io_write_segbuf_sync(fds[1], &sbuf);
+    assert_eq_sint(t, io_res.err_code, 0, "no write error");
+    assert_eq_uint(t, io_res.len, sbuf.len, "whole buffer is written");
+
+    char expected[64];
+    char actual[64];
+    size_t expected_len = segbuf_copy(&sbuf, expected, sizeof(expected));
+    ssize_t read_res = read(fds[0], actual, sizeof(actual));
+    assert_eq_sint(t, read_res, (ssize_t)expected_len, "bytes read");
+    assert_eq_bytes(
+        t,
+        (const uchar *)actual,
+        (const uchar *)expected,
+        expected_len,
+        "contents are written in order"
+    );
+
+    close(fds[0]);
+    close(fds[1]);
+    segbuf_free(&sbuf);
+}
+
+void test_segbuf_alloc_failure(test *t) {
+    alignas(max_align_t) uchar buffer[128];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+    segbuf sbuf = segbuf_new(32, &alloc);
+
+    bytebuf_result res = segbuf_fill(&sbuf, 'a', 40);
+    assert_true(t, res.ok, "fill must succeed");
+    res = segbuf_fill(&sbuf, 'b', 100);
+    assert_false(t, res.ok, "fill must fail when chunks run out");
+    assert_eq_uint(t, res.len, 0, "nothing is written");
+    assert_eq_uint(t, sbuf.len, 40, "failed fill keeps the content");
+}
+
+static test_case tests[] = {
+    {"Segmented byte buffer write", test_segbuf_write},
+    {"Segmented byte buffer format", test_segbuf_fmt},
+    {"Segmented byte buffer iovec", test_segbuf_iovec},
+    {"Segmented byte buffer allocation failure", test_segbuf_alloc_failure},
+};
+
+setup_tests(NULL, tests)
@@ -32,6 +32,19 @@ void test_slice_equal(test *t) {
     assert_true(t, slice_eq(s1_1, s2_1), "equals with similar");
 }
 
+void test_slice_compare(test *t) {
+    slice_const abc = slice_sstr("abc");
+    slice_const abd = slice_sstr("abd");
+    slice_const ab = slice_sstr("ab");
+
+    assert_eq_sint(t, slice_const_cmp(abc, abc), 0, "equals with itself");
+    assert_lt_sint(t, slice_const_cmp(abc, abd), 0, "abc < abd");
+    assert_gt_sint(t, slice_const_cmp(abd, abc), 0, "abd > abc");
+    assert_lt_sint(t, slice_const_cmp(ab, abc), 0, "prefix orders first");
+    assert_gt_sint(t, slice_const_cmp(abc, ab), 0, "longer orders last");
+    assert_lt_sint(t, slice_const_cmp(slice_null, ab), 0, "empty orders first");
+}
+
 void test_slice_from_arr(test *t) {
     char str[] = "hello world!";
     int arr[] = {100, 200, 300, 400};
@@ -143,16 +156,180 @@ void test_slice_from_cstr_unsafe(test *t) {
     );
 }
 
+void test_slice_hash_known_values(test *t) {
+    // pinned values catch accidental changes to the hash function
+    assert_eq_uint(
+        t, slice_hash64(slice_null, 0), 0x93228a4de0eec5a2ULL, "empty"
+    );
+    assert_eq_uint(
+        t, slice_hash64(slice_sstr("hello"), 0), 0x49a593f92a7c549fULL, "short"
+    );
+    assert_eq_uint(
+        t, slice_hash64(slice_sstr("hello"), 1), 0xa0f1aca66b12e502ULL, "seeded"
+    );
+    slice_const fox = slice_sstr("The quick brown fox jumps over the lazy dog");
+    assert_eq_uint(t, slice_hash64(fox, 0), 0x08e445df107bb587ULL, "medium");
+    hash128 h = slice_hash128(fox, 0);
+    assert_eq_uint(t, h.lo, 0x08e445df107bb587ULL, "128-bit low half");
+    assert_eq_uint(t, h.hi, 0xc0f0e744bfeb27f1ULL, "128-bit high half");
+}
+
+void test_slice_hash_distinct(test *t) {
+    uchar data[300];
+    for (size_t i = 0; i < sizeof(data); i += 1) {
+        data[i] = (uchar)(i * 7);
+    }
+
+    // every length and a single flipped bit at every position of a long key
+    ullong hashes[countof(data) + 1];
+    for (size_t len = 0; len <= sizeof(data); len += 1) {
+        hashes[len] = slice_hash64(slice_const_new(data, len), 0);
+    }
+    uint collisions = 0;
+    for (size_t i = 0; i < countof(hashes); i += 1) {
+        for (size_t j = i + 1; j < countof(hashes); j += 1) {
+            collisions += hashes[i] == hashes[j];
+        }
+    }
+    assert_eq_uint(t, collisions, 0, "lengths must not collide");
+
+    collisions = 0;
+    ullong base = slice_hash64(slice_const_new(data, 200), 0);
+    hash128 base128 = slice_hash128(slice_const_new(data, 200), 0);
+    for (size_t i = 0; i < 200; i += 1) {
+        data[i] ^= 0x10;
+        collisions += slice_hash64(slice_const_new(data, 200), 0) == base;
+        collisions +=
+            slice_hash128(slice_const_new(data, 200), 0).hi == base128.hi;
+        data[i] ^= 0x10;
+    }
+    assert_eq_uint(t, collisions, 0, "flipped bits must change the hash");
+
+    assert_true(
+        t,
+        slice_hash64(slice_const_new(data, 100), 1)
+            != slice_hash64(slice_const_new(data, 100), 2),
+        "seed must change the hash"
+    );
+}
+
+void test_slice_hash_incremental(test *t) {
+    uchar data[400];
+    for (size_t i = 0; i < sizeof(data); i += 1) {
+        data[i] = (uchar)(i * 13 + 5);
+    }
+
+    const size_t piece_sizes[] = {1, 3, 16, 47, 48, 49, 64, 65, 100};
+    uint mismatches = 0;
+    for (size_t len = 0; len <= sizeof(data); len += 1) {
+        slice_const all = slice_const_new(data, len);
+        ullong expected = slice_hash64(all, 42);
+        hash128 expected128 = slice_hash128(all, 42);
+
+        for (size_t k = 0; k < countof(piece_sizes); k += 1) {
+            slice_hash_state h;
+            slice_hash_init(&h, 42);
+            for (size_t i = 0; i < len; i += piece_sizes[k]) {
+                size_t piece = min(piece_sizes[k], len - i);
+                slice_hash_update(&h, slice_const_new(data + i, piece));
+            }
+            hash128 h128 = slice_hash_final128(&h);
+            mismatches += slice_hash_final64(&h) != expected;
+            mismatches += h128.lo != expected128.lo;
+            mismatches += h128.hi != expected128.hi;
+        }
+    }
+    assert_eq_uint(t, mismatches, 0, "incremental hash equals one-shot hash");
+
+    // finalising does not consume the state
+    slice_hash_state h;
+    slice_hash_init(&h, 0);
+    slice_hash_update(&h, slice_sstr("hello "));
+    slice_hash_final64(&h);
+    slice_hash_update(&h, slice_sstr("world"));
+    assert_eq_uint(
+        t,
+        slice_hash_final64(&h),
+        slice_hash64(slice_sstr("hello world"), 0),
+        "update after final"
+    );
+}
+
+void test_slice_crc32c(test *t) {
+    uchar zeros[32] = {0};
+    uchar ones[32];
+    set_n(ones, 0xFF, countof(ones));
+
+    assert_eq_uint(t, slice_crc32c(slice_null, 0), 0, "empty");
+    assert_eq_uint(
+        t, slice_crc32c(slice_sstr("123456789"), 0), 0xE3069283, "check value"
+    );
+    assert_eq_uint(
+        t,
+        slice_crc32c(slice_const_new(zeros, sizeof(zeros)), 0),
+        0x8A9136AA,
+        "32 zero bytes"
+    );
+    assert_eq_uint(
+        t,
+        slice_crc32c(slice_const_new(ones, sizeof(ones)), 0),
+        0x62A8AB43,
+        "32 0xFF bytes"
+    );
+}
+
+void test_slice_crc32c_pieces(test *t) {
+    size_t len = 20000;
+    allocation a = alloc_new(&std_allocator, uchar, len);
+    uchar *data = a.ptr;
+    if (!assert_true(t, data, "malloc must succeed")) {
+        return;
+    }
+    for (size_t i = 0; i < len; i += 1) {
+        data[i] = (uchar)(i * 31 + (i >> 9));
+    }
+
+    // the table based implementation is the reference for the others
+    cpu_features_limit(0);
+    uint expected = slice_crc32c(slice_const_new(data, len), 0);
+
+    const uint levels[] = {~0U, cpu_feature_sse42, 0};
+    const size_t piece_sizes[] = {1, 7, 100, 777, 6200};
+    uint mismatches = 0;
+    for (size_t l = 0; l < countof(levels); l += 1) {
+        cpu_features_limit(levels[l]);
+        mismatches += slice_crc32c(slice_const_new(data, len), 0) != expected;
+        for (size_t k = 0; k < countof(piece_sizes); k += 1) {
+            uint crc = 0;
+            for (size_t i = 0; i < len; i += piece_sizes[k]) {
+                size_t piece = min(piece_sizes[k], len - i);
+                crc = slice_crc32c(slice_const_new(data + i, piece), crc);
+            }
+            mismatches += crc != expected;
+        }
+    }
+    cpu_features_limit(~0U);
+    assert_eq_uint(t, mismatches, 0, "checksum in pieces at every level");
+
+    alloc_free(&std_allocator, a);
+}
+
 static test_case tests[] = {
     {"Slice span", test_slice_span},
     {"Slice equal", test_slice_equal},
+    {"Slice compare", test_slice_compare},
     {"Slice from array", test_slice_from_arr},
     {"Slice from static C-string", test_slice_from_static_cstr},
     {"Slice const conversion", test_slice_const_conversion},
     {"Slice copy to larger", test_slice_copy_larger},
     {"Slice copy to smaller", test_slice_copy_smaller},
     {"Slice move overlapping", test_slice_move_overlapping},
-    {"Slice from C string (unsafe)", test_slice_from_cstr_unsafe}
+    {"Slice from C string (unsafe)", test_slice_from_cstr_unsafe},
+    {"Slice hash known values", test_slice_hash_known_values},
+    {"Slice hash distinct", test_slice_hash_distinct},
+    {"Slice hash incremental", test_slice_hash_incremental},
+    {"Slice CRC-32C", test_slice_crc32c},
+    {"Slice CRC-32C in pieces", test_slice_crc32c_pieces},
 };
 
 setup_tests(NULL, tests)
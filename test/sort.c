@@ -0,0 +1,171 @@
+#include "std.h"
+#include "testr.h"
+
+#define item_count 3000
+
+static ullong rng_state;
+
+static ullong rng_next(void) {
+    rng_state = rng_state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return rng_state ^ (rng_state >> 29);
+}
+
+void test_sort_radix_int(test *t) {
+    static int keys[item_count];
+    static uint payload[item_count];
+    static int original[item_count];
+    rng_state = 1;
+    for (size_t i = 0; i < item_count; i += 1) {
+        keys[i] = (int)(uint)rng_next();
+        payload[i] = (uint)i;
+    }
+    keys[0] = INT_MIN;
+    keys[1] = INT_MAX;
+    keys[2] = -1;
+    keys[3] = 0;
+    keys[4] = keys[5];
+    bytes_copy(original, keys, sizeof(keys));
+
+    bool ok = sort_radix_int(keys, payload, item_count, &std_allocator);
+    assert_true(t, ok, "sort must succeed");
+    uint unsorted = 0, unstable = 0, mismatches = 0;
+    for (size_t i = 1; i < item_count; i += 1) {
+        unsorted += keys[i - 1] > keys[i];
+        unstable += keys[i - 1] == keys[i] && payload[i - 1] > payload[i];
+    }
+    for (size_t i = 0; i < item_count; i += 1) {
+        mismatches += original[payload[i]] != keys[i];
+    }
+    assert_eq_uint(t, unsorted, 0, "keys are sorted");
+    assert_eq_uint(t, unstable, 0, "sort is stable");
+    assert_eq_uint(t, mismatches, 0, "payload follows the keys");
+    assert_eq_sint(t, keys[0], INT_MIN, "smallest key");
+    assert_eq_sint(t, keys[item_count - 1], INT_MAX, "largest key");
+}
+
+void test_sort_radix_uint(test *t) {
+    static uint keys[item_count];
+    rng_state = 2;
+    for (size_t i = 0; i < item_count; i += 1) {
+        // only the low byte varies, so three passes are skipped
+        keys[i] = (uint)(rng_next() & 0xFF) | 0x12345600U;
+    }
+    bool ok = sort_radix_uint(keys, NULL, item_count, &std_allocator);
+    assert_true(t, ok, "sort must succeed");
+    uint unsorted = 0;
+    for (size_t i = 1; i < item_count; i += 1) {
+        unsorted += keys[i - 1] > keys[i];
+    }
+    assert_eq_uint(t, unsorted, 0, "keys are sorted");
+
+    uint same[] = {7, 7, 7};
+    uint same_payload[] = {2, 1, 0};
+    sort_radix_uint(same, same_payload, countof(same), &std_allocator);
+    assert_eq_uint(t, same_payload[0], 2, "equal keys are not moved");
+    assert_eq_uint(t, same_payload[2], 0, "equal keys are not moved");
+}
+
+void test_sort_radix_llong(test *t) {
+    static llong keys[item_count];
+    static ullong ukeys[item_count];
+    rng_state = 3;
+    for (size_t i = 0; i < item_count; i += 1) {
+        ullong x = rng_next();
+        // mix small and large magnitudes
+        keys[i] = (i % 3) ? (llong)x : (llong)(x % 1000) - 500;
+        ukeys[i] = x >> (i % 64);
+    }
+    keys[0] = LLONG_MIN;
+    keys[1] = LLONG_MAX;
+    sort_radix_llong(keys, NULL, item_count, &std_allocator);
+    sort_radix_ullong(ukeys, NULL, item_count, &std_allocator);
+    uint unsorted = 0;
+    for (size_t i = 1; i < item_count; i += 1) {
+        unsorted += keys[i - 1] > keys[i];
+        unsorted += ukeys[i - 1] > ukeys[i];
+    }
+    assert_eq_uint(t, unsorted, 0, "keys are sorted");
+    assert_true(t, keys[0] == LLONG_MIN, "smallest key");
+    assert_true(t, keys[item_count - 1] == LLONG_MAX, "largest key");
+}
+
+void test_sort_radix_float(test *t) {
+    float keys[] = {3.5f, -0.0f, -2.25f, 1e30f, 0.0f, -1e-30f, -1e30f, 2.0f};
+    uint payload[] = {0, 1, 2, 3, 4, 5, 6, 7};
+    float expected[] = {
+        -1e30f, -2.25f, -1e-30f, -0.0f, 0.0f, 2.0f, 3.5f, 1e30f
+    };
+    uint expected_payload[] = {6, 2, 5, 1, 4, 7, 0, 3};
+    bool ok = sort_radix_float(keys, payload, countof(keys), &std_allocator);
+    assert_true(t, ok, "sort must succeed");
+    assert_eq_bytes(
+        t,
+        (uchar *)keys,
+        (uchar *)expected,
+        sizeof(keys),
+        "floats are sorted by value and sign"
+    );
+    assert_eq_bytes(
+        t,
+        (uchar *)payload,
+        (uchar *)expected_payload,
+        sizeof(payload),
+        "payload follows the keys"
+    );
+
+    static double dkeys[item_count];
+    rng_state = 4;
+    for (size_t i = 0; i < item_count; i += 1) {
+        dkeys[i] = ((double)(llong)rng_next()) / (double)(1 + i);
+    }
+    sort_radix_double(dkeys, NULL, item_count, &std_allocator);
+    uint unsorted = 0;
+    for (size_t i = 1; i < item_count; i += 1) {
+        unsorted += dkeys[i - 1] > dkeys[i];
+    }
+    assert_eq_uint(t, unsorted, 0, "doubles are sorted");
+
+    double dsmall[] = {-0.5, 0.25, -8.0};
+    sort_radix_double(dsmall, NULL, countof(dsmall), &std_allocator);
+    assert_true(
+        t,
+        dsmall[0] < -7.9 && dsmall[1] < -0.4 && dsmall[2] > 0.2,
+        "negative doubles come first"
+    );
+}
+
+void test_sort_radix_arena(test *t) {
+    double keys[] = {4.0, 1.0, 3.0, 2.0};
+    uint payload[] = {0, 1, 2, 3};
+
+    // scratch is two keys and a payload item per key
+    ullong buffer[4 * (2 * sizeof(double) + sizeof(uint)) / sizeof(ullong)];
+    arena arena = arena_new(buffer, sizeof(buffer));
+    allocator alloc = arena_allocator_new(&arena);
+    bool ok = sort_radix_double(keys, payload, countof(keys), &alloc);
+    assert_true(t, ok, "sort with exact scratch must succeed");
+    assert_eq_uint(t, payload[0], 1, "smallest key first");
+    assert_eq_uint(t, payload[3], 0, "largest key last");
+
+    // not enough scratch memory: keys are left untouched
+    int ikeys[] = {3, 2, 1};
+    ok = sort_radix_int(ikeys, payload, countof(ikeys), &alloc);
+    assert_false(t, ok, "sort without scratch memory must fail");
+    assert_eq_sint(t, ikeys[0], 3, "keys are untouched");
+
+    arena_clear(&arena);
+    ok = sort_radix_int(ikeys, NULL, countof(ikeys), &alloc);
+    assert_true(t, ok, "sort must succeed");
+    assert_eq_sint(t, ikeys[0], 1, "keys are sorted");
+    assert_true(t, sort_radix_int(ikeys, NULL, 1, NULL), "single key");
+}
+
+static test_case tests[] = {
+    {"Radix sort ints", test_sort_radix_int},
+    {"Radix sort uints", test_sort_radix_uint},
+    {"Radix sort long longs", test_sort_radix_llong},
+    {"Radix sort floating point numbers", test_sort_radix_float},
+    {"Radix sort with an arena", test_sort_radix_arena},
+};
+
+setup_tests(NULL, tests)
@@ -0,0 +1,145 @@
+#include "mt.h"
+#include "std.h"
+#include "testr.h"
+#include <pthread.h>
+
+#define thread_count 4
+#define ops_per_thread 20000
+
+void test_thread_cache_reuse(test *t) {
+    alloc_stats stats;
+    alloc_stats_init(&stats, &std_allocator);
+    allocator inner = alloc_stats_allocator_new(&stats);
+    thread_cache tc;
+    thread_cache_init(&tc, &inner, 0);
+    allocator alloc = thread_cache_allocator_new(&tc);
+
+    allocation a = alloc_malloc(&alloc, 24, 8);
+    assert_eq_uint(t, a.len, 32, "size is rounded to the size class");
+    size_t refilled = stats.allocs;
+    assert_ge_uint(t, refilled, 2, "cache is refilled in a batch");
+
+    alloc_free(&alloc, a);
+    allocation b = alloc_malloc(&alloc, 20, 8);
+    assert_true(t, b.ptr == a.ptr, "freed object is reused");
+    assert_eq_uint(t, stats.allocs, refilled, "no inner allocations");
+    assert_eq_uint(t, stats.frees, 0, "no inner frees");
+
+    // large sizes and alignments go to the inner allocator
+    allocation large = alloc_malloc(&alloc, thread_cache_max_size + 1, 8);
+    assert_eq_uint(t, stats.allocs, refilled + 1, "large allocation");
+    alloc_free(&alloc, large);
+    assert_eq_uint(t, stats.frees, 1, "large free");
+
+    // realloc within the size class keeps the object
+    allocation c = alloc_realloc(&alloc, b, 30, 8);
+    assert_true(t, c.ptr == b.ptr, "realloc within the class");
+    bytes_set(c.ptr, 'c', 30);
+    allocation d = alloc_realloc(&alloc, c, 1000, 8);
+    assert_eq_uint(t, d.len, 1024, "realloc to a larger class");
+    assert_eq_sint(t, ((char *)d.ptr)[29], 'c', "contents are copied");
+    alloc_free(&alloc, d);
+
+    thread_cache_flush(&tc);
+    thread_cache_release(&tc);
+    assert_eq_uint(t, stats.live_bytes, 0, "all objects are returned");
+    assert_eq_uint(t, stats.allocs, stats.frees, "allocs match frees");
+}
+
+void test_thread_cache_cap(test *t) {
+    alloc_stats stats;
+    alloc_stats_init(&stats, &std_allocator);
+    allocator inner = alloc_stats_allocator_new(&stats);
+    thread_cache tc;
+    thread_cache_init(&tc, &inner, 4096);
+    allocator alloc = thread_cache_allocator_new(&tc);
+
+    void *ptrs[2000];
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        ptrs[i] = alloc_malloc(&alloc, 64, 8).ptr;
+    }
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        allocation a = {.ptr = ptrs[i], .len = 64};
+        alloc_free(&alloc, a);
+    }
+    size_t central = tc.central_bytes;
+    assert_true(t, central <= tc.max_central_bytes, "central cap is kept");
+    assert_ge_uint(t, stats.frees, 1, "overflow goes to inner allocator");
+    assert_true(
+        t,
+        stats.live_bytes <= 4096 + tc.max_central_bytes,
+        "thread cache cap is kept"
+    );
+
+    thread_cache_flush(&tc);
+    thread_cache_release(&tc);
+    assert_eq_uint(t, stats.live_bytes, 0, "all objects are returned");
+}
+
+static void *thread_cache_thread_f(void *ctx) {
+    thread_cache *tc = ctx;
+    allocator alloc = thread_cache_allocator_new(tc);
+    uchar *ptrs[32] = {0};
+    size_t lens[32] = {0};
+    size_t corrupted = 0;
+    ullong state = (ullong)(uintptr_t)&alloc;
+    for (size_t i = 0; i < ops_per_thread; i += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t slot = (size_t)(state >> 33) % countof(ptrs);
+        if (ptrs[slot]) {
+            corrupted += ptrs[slot][0] != (uchar)slot;
+            corrupted += ptrs[slot][lens[slot] - 1] != (uchar)slot;
+            allocation a = {.ptr = ptrs[slot], .len = lens[slot]};
+            alloc_free(&alloc, a);
+        }
+        allocation a = alloc_malloc(&alloc, 1 + (size_t)(state >> 50), 8);
+        ptrs[slot] = a.ptr;
+        lens[slot] = a.len;
+        if (a.ptr) {
+            bytes_set(a.ptr, (uchar)slot, a.len);
+        }
+    }
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        if (ptrs[i]) {
+            allocation a = {.ptr = ptrs[i], .len = lens[i]};
+            alloc_free(&alloc, a);
+        }
+    }
+    thread_cache_flush(tc);
+    return (void *)corrupted;
+}
+
+void test_thread_cache_threads(test *t) {
+    alloc_stats stats;
+    alloc_stats_init(&stats, &std_allocator);
+    allocator inner = alloc_stats_allocator_new(&stats);
+    thread_cache tc;
+    thread_cache_init(&tc, &inner, 64 * 1024);
+
+    pthread_t threads[thread_count];
+    for (size_t i = 0; i < thread_count; i += 1) {
+        int err =
+            pthread_create(&threads[i], NULL, thread_cache_thread_f, &tc);
+        assert_eq_sint(t, err, 0, "thread creation must succeed");
+    }
+    size_t corrupted = 0;
+    for (size_t i = 0; i < thread_count; i += 1) {
+        void *res = NULL;
+        int err = pthread_join(threads[i], &res);
+        assert_eq_sint(t, err, 0, "thread join must succeed");
+        corrupted += (size_t)res;
+    }
+    assert_eq_uint(t, corrupted, 0, "objects are not shared");
+
+    thread_cache_release(&tc);
+    assert_eq_uint(t, stats.live_bytes, 0, "all objects are returned");
+    assert_eq_uint(t, stats.allocs, stats.frees, "allocs match frees");
+}
+
+static test_case tests[] = {
+    {"Thread cache reuse", test_thread_cache_reuse},
+    {"Thread cache cap", test_thread_cache_cap},
+    {"Thread cache threads", test_thread_cache_threads},
+};
+
+setup_tests(NULL, tests)
@@ -0,0 +1,149 @@
+#include "std.h"
+#include "testr.h"
+
+#define region_size (256 * 1024)
+
+void test_tlsf_alloc_free(test *t) {
+    allocation region = alloc_malloc(&std_allocator, region_size, 16);
+    tlsf tl;
+    bool ok = tlsf_init(&tl, slice_new(region.ptr, region.len));
+    if (!assert_true(t, ok, "region must be large enough")) {
+        return;
+    }
+    size_t capacity = tl.size;
+    assert_ge_uint(t, capacity, region_size - 64, "region is used");
+
+    uchar *a = tlsf_alloc_bytes(&tl, 100, 1);
+    uchar *b = tlsf_alloc_bytes(&tl, 2000, 8);
+    uchar *c = tlsf_alloc_bytes(&tl, 1, 1);
+    if (!assert_true(t, a && b && c, "allocations must succeed")) {
+        return;
+    }
+    assert_eq_uint(t, (uintptr_t)a % 16, 0, "memory is aligned");
+    assert_ge_uint(t, tlsf_usable_size(a), 100, "usable size");
+    assert_true(t, a + 100 <= b || b + 2000 <= a, "blocks do not overlap");
+    bytes_set(a, 'a', 100);
+    bytes_set(b, 'b', 2000);
+    bytes_set(c, 'c', 1);
+    assert_eq_sint(t, a[99], 'a', "contents are kept");
+
+    // freed blocks coalesce back into one block spanning the region
+    tlsf_free_bytes(&tl, b);
+    tlsf_free_bytes(&tl, a);
+    tlsf_free_bytes(&tl, c);
+    assert_eq_uint(t, tl.used, 0, "nothing is in use");
+    void *all = tlsf_alloc_bytes(&tl, capacity - 16, 1);
+    assert_true(t, all != NULL, "whole region is available after frees");
+    void *more = tlsf_alloc_bytes(&tl, 1, 1);
+    assert_true(t, more == NULL, "region is exhausted");
+    tlsf_free_bytes(&tl, all);
+
+    alloc_free(&std_allocator, region);
+}
+
+void test_tlsf_aligned(test *t) {
+    allocation region = alloc_malloc(&std_allocator, region_size, 16);
+    tlsf tl;
+    tlsf_init(&tl, slice_new(region.ptr, region.len));
+
+    uint misaligned = 0;
+    void *ptrs[8];
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        size_t alignment = (size_t)32 << i;
+        ptrs[i] = tlsf_alloc_bytes(&tl, 24, alignment);
+        misaligned += ptrs[i] == NULL || (uintptr_t)ptrs[i] % alignment != 0;
+    }
+    assert_eq_uint(t, misaligned, 0, "allocations are aligned");
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        tlsf_free_bytes(&tl, ptrs[i]);
+    }
+    assert_eq_uint(t, tl.used, 0, "nothing is in use");
+    void *all = tlsf_alloc_bytes(&tl, tl.size - 16, 1);
+    assert_true(t, all != NULL, "split blocks are coalesced");
+
+    alloc_free(&std_allocator, region);
+}
+
+void test_tlsf_realloc(test *t) {
+    allocation region = alloc_malloc(&std_allocator, region_size, 16);
+    tlsf tl;
+    tlsf_init(&tl, slice_new(region.ptr, region.len));
+    allocator alloc = tlsf_allocator_new(&tl);
+
+    allocation a = alloc_malloc(&alloc, 64, 8);
+    bytes_set(a.ptr, 'a', 64);
+
+    // the free block after the allocation is absorbed
+    allocation a2 = alloc_realloc(&alloc, a, 1000, 8);
+    assert_true(t, a2.ptr == a.ptr, "grown in place");
+    assert_ge_uint(t, a2.len, 1000, "grown size");
+    assert_eq_sint(t, ((char *)a2.ptr)[63], 'a', "contents are kept");
+
+    // shrinking returns the tail
+    allocation a3 = alloc_realloc(&alloc, a2, 32, 8);
+    assert_true(t, a3.ptr == a.ptr, "shrunk in place");
+    assert_eq_uint(t, tl.used, 48, "tail is freed");
+
+    // a block in the way moves the allocation
+    allocation b = alloc_malloc(&alloc, 16, 8);
+    allocation a4 = alloc_realloc(&alloc, a3, 4000, 8);
+    assert_true(t, a4.ptr != a.ptr, "allocation is moved");
+    assert_eq_sint(t, ((char *)a4.ptr)[31], 'a', "contents are copied");
+
+    allocation c = alloc_realloc(&alloc, a4, region_size * 2, 8);
+    assert_false(t, allocation_exists(c), "growing beyond the region fails");
+    alloc_free(&alloc, a4);
+    alloc_free(&alloc, b);
+    assert_eq_uint(t, tl.used, 0, "nothing is in use");
+
+    alloc_free(&std_allocator, region);
+}
+
+void test_tlsf_random(test *t) {
+    allocation region = alloc_malloc(&std_allocator, region_size, 16);
+    tlsf tl;
+    tlsf_init(&tl, slice_new(region.ptr, region.len));
+
+    uchar *ptrs[64] = {0};
+    size_t sizes[64] = {0};
+    uint corrupted = 0, failures = 0;
+    ullong state = 1;
+    for (size_t i = 0; i < 20000; i += 1) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t slot = (size_t)(state >> 33) % countof(ptrs);
+        if (ptrs[slot]) {
+            for (size_t j = 0; j < sizes[slot]; j += 1) {
+                corrupted += ptrs[slot][j] != (uchar)slot;
+            }
+            tlsf_free_bytes(&tl, ptrs[slot]);
+        }
+        sizes[slot] = 1 + (size_t)(state >> 45) % 3000;
+        size_t alignment = (size_t)1 << ((state >> 20) % 8);
+        ptrs[slot] = tlsf_alloc_bytes(&tl, sizes[slot], alignment);
+        failures += ptrs[slot] == NULL;
+        if (ptrs[slot]) {
+            corrupted += (uintptr_t)ptrs[slot] % alignment != 0;
+            bytes_set(ptrs[slot], (uchar)slot, sizes[slot]);
+        }
+    }
+    assert_eq_uint(t, failures, 0, "allocations must succeed");
+    assert_eq_uint(t, corrupted, 0, "blocks do not overlap");
+
+    for (size_t i = 0; i < countof(ptrs); i += 1) {
+        tlsf_free_bytes(&tl, ptrs[i]);
+    }
+    assert_eq_uint(t, tl.used, 0, "nothing is in use");
+    void *all = tlsf_alloc_bytes(&tl, tl.size - 16, 1);
+    assert_true(t, all != NULL, "all blocks are coalesced");
+
+    alloc_free(&std_allocator, region);
+}
+
+static test_case tests[] = {
+    {"TLSF alloc and free", test_tlsf_alloc_free},
+    {"TLSF aligned", test_tlsf_aligned},
+    {"TLSF realloc", test_tlsf_realloc},
+    {"TLSF random", test_tlsf_random},
+};
+
+setup_tests(NULL, tests)